@@ -121,8 +121,9 @@ static struct {
 	int qcommand;
 } bms_context;
 
-#define GET_U16(_dd_) ((((char *)(_dd_))[0] << 8) | (((char *)(_dd_))[1]))
-#define GET_U32(_dd_) ((((char *)(_dd_))[0] << 0x18) | (((char *)(_dd_))[1]) << 0x10 | (((char *)(_dd_))[2]) << 0x08 | ((char *)(_dd_))[3])
+#define GET_U16(_dd_) ((uint16_t)((((uint8_t *)(_dd_))[0] << 8) | (((uint8_t *)(_dd_))[1])))
+#define GET_U32(_dd_) ((((uint32_t)((uint8_t *)(_dd_))[0]) << 0x18) | (((uint32_t)((uint8_t *)(_dd_))[1]) << 0x10) | \
+					   (((uint32_t)((uint8_t *)(_dd_))[2]) << 0x08) | ((uint32_t)((uint8_t *)(_dd_))[3]))
 
 static void bms_send_mqtt_data(void)
 {
@@ -143,7 +144,7 @@ static void d90_cmd_process(uint8_t *buf)
 	bms_context.data.bat_v = GET_U16(buf) / 10;
 	bms_context.data.acquisition_v =  GET_U16(buf+2) / 10;
 	bms_context.data.bat_i = (GET_U16(buf + 4) - 30000) / 10;
-	bms_context.data.soc_p = GET_U16(buf + 8) / 10;
+	bms_context.data.soc_p = GET_U16(buf + 6) / 10;
 }
 
 /* Max / Min cell voltage */
@@ -205,7 +206,8 @@ static void d96_cmd_process(uint8_t *buf)
 	if (frame >= 3)
 		return;
 	frame *= 7;
-	for (i = 0; i < 7; i++)
+	/* The last frame holds only 2 of the 16 sensors */
+	for (i = 0; i < 7 && (frame + i) < DALY_MAX_TEMPS; i++)
 		bms_context.data.cells_temperature[frame+i] = buf[i+1] - 40;
 }
 
@@ -73,7 +73,7 @@ uint8_t *bms_get_qcommand(daly_qcmd_t idx, int *len)
 	int i;
 
 	for (i = 0; i < qcommads_count; i++) {
-		if (Qcommands[i].id == idx)
+		if (Qcommands[i].id == (int)idx)
 			break;
 	}
 	if (i == qcommads_count)
@@ -129,7 +129,7 @@ int bms_get_qcommand_desc(daly_qcmd_t idx, const char **cmd, const char **desc)
 
 	UNUSED(Scommands);
 	for (i = 0; i < qcommads_count; i++) {
-		if (Qcommands[i].id == idx)
+		if (Qcommands[i].id == (int)idx)
 			break;
 	}
 
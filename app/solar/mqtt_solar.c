@@ -43,43 +43,41 @@ static int mqtt_mppt_discovery_add(mqtt_mppt_data_t *mppt)
 }
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("MQTT %s: Buffer full\n\r", __func__); return; } \
-				count += snprintf(mqtt_solar_context.payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("MQTT %s: Buffer full\n\r", __func__); return; } \
-				     count += snprintf(mqtt_solar_context.payload + count, len - count, _S_, __VA_ARGS__); }
 void mqtt_data_send(bool force)
 {
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 
 	if (force) {
-		ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-		ADD_MQTT_MSG_VAR(",\"in_temp\":%3.2f", mqtt_solar_context.internal_temp);
-		ADD_MQTT_MSG_VAR(",\"mppt_ac_out_v\":%3.2f", mqtt_solar_context.mppt.ac_out_v);
-		ADD_MQTT_MSG_VAR(",\"mppt_ac_out_hz\":%3.2f", mqtt_solar_context.mppt.ac_out_hz);
-		ADD_MQTT_MSG_VAR(",\"mppt_ac_out_va\":%d", mqtt_solar_context.mppt.ac_out_va);
-		ADD_MQTT_MSG_VAR(",\"mppt_ac_out_w\":%d", mqtt_solar_context.mppt.ac_out_w);
-		ADD_MQTT_MSG_VAR(",\"mppt_out_load_p\":%d", mqtt_solar_context.mppt.out_load_p);
-		ADD_MQTT_MSG_VAR(",\"mppt_bus_v\":%d", mqtt_solar_context.mppt.bus_v);
-		ADD_MQTT_MSG_VAR(",\"mppt_bat_v\":%3.2f", mqtt_solar_context.mppt.bat_v);
-		ADD_MQTT_MSG_VAR(",\"mppt_bat_charge_a\":%d", mqtt_solar_context.mppt.bat_charge_a);
-		ADD_MQTT_MSG_VAR(",\"mppt_bat_capacity_p\":%d", mqtt_solar_context.mppt.bat_capacity_p);
-		ADD_MQTT_MSG_VAR(",\"mppt_sink_temp\":%d", mqtt_solar_context.mppt.sink_temp);
-		ADD_MQTT_MSG_VAR(",\"mppt_pv_in_bat_a\":%3.2f", mqtt_solar_context.mppt.pv_in_bat_a);
-		ADD_MQTT_MSG_VAR(",\"mppt_pv_in_v\":%3.2f", mqtt_solar_context.mppt.pv_in_v);
-		ADD_MQTT_MSG_VAR(",\"mppt_bat_discharge_a\":%d", mqtt_solar_context.mppt.bat_discharge_a);
-		ADD_MQTT_MSG_VAR(",\"bms_total_v\":%3.2f", mqtt_solar_context.bms.bat_v);
-		ADD_MQTT_MSG_VAR(",\"bms_current_a\":%3.2f", mqtt_solar_context.bms.bat_i);
-		ADD_MQTT_MSG_VAR(",\"bms_soc_p\":%3.2f", mqtt_solar_context.bms.soc_p);
-		ADD_MQTT_MSG_VAR(",\"bms_life\":%d", mqtt_solar_context.bms.bms_life);
-		ADD_MQTT_MSG_VAR(",\"bms_remain_capacity_mah\":%ld", mqtt_solar_context.bms.remain_capacity);
-		ADD_MQTT_MSG("}");
+		json_begin(&js, mqtt_solar_context.payload, MQTT_DATA_LEN + 1);
+		json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+		json_add_float(&js, "in_temp", mqtt_solar_context.internal_temp, 2);
+		json_add_float(&js, "mppt_ac_out_v", mqtt_solar_context.mppt.ac_out_v, 2);
+		json_add_float(&js, "mppt_ac_out_hz", mqtt_solar_context.mppt.ac_out_hz, 2);
+		json_add_int(&js, "mppt_ac_out_va", mqtt_solar_context.mppt.ac_out_va);
+		json_add_int(&js, "mppt_ac_out_w", mqtt_solar_context.mppt.ac_out_w);
+		json_add_int(&js, "mppt_out_load_p", mqtt_solar_context.mppt.out_load_p);
+		json_add_int(&js, "mppt_bus_v", mqtt_solar_context.mppt.bus_v);
+		json_add_float(&js, "mppt_bat_v", mqtt_solar_context.mppt.bat_v, 2);
+		json_add_int(&js, "mppt_bat_charge_a", mqtt_solar_context.mppt.bat_charge_a);
+		json_add_int(&js, "mppt_bat_capacity_p", mqtt_solar_context.mppt.bat_capacity_p);
+		json_add_int(&js, "mppt_sink_temp", mqtt_solar_context.mppt.sink_temp);
+		json_add_float(&js, "mppt_pv_in_bat_a", mqtt_solar_context.mppt.pv_in_bat_a, 2);
+		json_add_float(&js, "mppt_pv_in_v", mqtt_solar_context.mppt.pv_in_v, 2);
+		json_add_int(&js, "mppt_bat_discharge_a", mqtt_solar_context.mppt.bat_discharge_a);
+		json_add_float(&js, "bms_total_v", mqtt_solar_context.bms.bat_v, 2);
+		json_add_float(&js, "bms_current_a", mqtt_solar_context.bms.bat_i, 2);
+		json_add_float(&js, "bms_soc_p", mqtt_solar_context.bms.soc_p, 2);
+		json_add_int(&js, "bms_life", mqtt_solar_context.bms.bms_life);
+		json_add_int(&js, "bms_remain_capacity_mah", mqtt_solar_context.bms.remain_capacity);
+		if (json_end(&js) < 0) {
+			printf("MQTT %s: Buffer full\n\r", __func__);
+			return;
+		}
 	}
 
 	if (strlen(mqtt_solar_context.payload))
-		mqtt_msg_publish(NULL, mqtt_solar_context.payload, force);
+		mqtt_msg_publish(NULL, mqtt_solar_context.payload);
 }
 
 static void mqtt_solar_run(bool force)
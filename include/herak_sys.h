@@ -29,6 +29,7 @@
 #include "usb/usb_api.h"
 #include "ntp/ntp_api.h"
 #include "wol/wol_api.h"
+#include "core1/core1_api.h"
 #include "webhook/webhook_api.h"
 #include "webserver/webserver_api.h"
 #include "syscmd/syscmd_api.h"
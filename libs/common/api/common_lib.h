@@ -60,6 +60,8 @@ char *system_get_hostname(void);
 int sys_strtof(const char *strp, float *val);
 int sys_asprintf(char **strp, const char *fmt, ...);
 uint8_t sys_value_to_percent(uint32_t range_min, uint32_t range_max, uint32_t val);
+#define SYS_HASH_INIT	2166136261U
+uint32_t sys_hash(uint32_t hash, const void *buf, int len);
 
 uint32_t samples_filter(uint32_t *samples, int total_count, int filter_count);
 char *get_current_time_str(char *buf, int buflen);
@@ -82,6 +84,31 @@ void wd_update(void);
 uint64_t manchester_encode(uint32_t frame, bool invert);
 int manchester_decode(uint64_t mframe, bool invert, uint32_t *value);
 
+/* JSON writer, without heap and printf */
+typedef struct {
+	char *buf;
+	int size;
+	int len;
+	bool truncated;
+	bool first;
+} json_writer_t;
+void json_begin(json_writer_t *js, char *buf, int size);
+int json_end(json_writer_t *js);
+void json_key(json_writer_t *js, const char *key);
+void json_key_idx(json_writer_t *js, const char *prefix, int idx, const char *suffix);
+void json_val_str(json_writer_t *js, const char *val);
+void json_val_int(json_writer_t *js, int32_t val);
+void json_val_uint(json_writer_t *js, uint32_t val);
+void json_val_bool(json_writer_t *js, bool val);
+void json_val_fixed(json_writer_t *js, int32_t val, int scale, int decimals);
+void json_val_float(json_writer_t *js, float val, int decimals);
+void json_add_str(json_writer_t *js, const char *key, const char *val);
+void json_add_int(json_writer_t *js, const char *key, int32_t val);
+void json_add_uint(json_writer_t *js, const char *key, uint32_t val);
+void json_add_bool(json_writer_t *js, const char *key, bool val);
+void json_add_fixed(json_writer_t *js, const char *key, int32_t val, int scale, int decimals);
+void json_add_float(json_writer_t *js, const char *key, float val, int decimals);
+
 typedef void (*gpio_irq_cb_t) (void *context);
 int sys_add_irq_callback(int gpio_pin, gpio_irq_cb_t cb, uint32_t event_mask, void *user_context);
 
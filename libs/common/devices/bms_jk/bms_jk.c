@@ -15,8 +15,14 @@
 #include "params.h"
 #include "bms_jk.h"
 
-#define CMD_POLL_MS	5000 /* Send command each 5s */
+#define CMD_POLL_MIN_MS	5000 /* Poll each 5s while the battery state changes */
+#define CMD_POLL_MAX_MS	30000 /* Poll each 30s while the battery is idle */
+#define CMD_POLL_DEV_MS	300000 /* Request device info each 5min */
+#define POLL_SEC_LIMIT	3600 /* Limit of the intervals in BMS_POLL_SEC, 1h */
+#define POLL_CELL_DELTA_MV	5 /* Cell voltage change, that triggers the fast poll */
+#define POLL_CURR_DELTA_MA	1000 /* Charge current change, that triggers the fast poll */
 #define CMD_TIMEOUT_MS	1000 /* Wait for response 1s */
+#define RECOVER_STEP_MS	60000 /* Max wait for a recovery step to help, before the next one */
 static const uint8_t __in_flash() jk_notify_pkt_start[] = {0x55, 0xAA, 0xEB, 0x90};
 static const uint8_t __in_flash() jk_request_pkt_start[] = {0xAA, 0x55, 0x90, 0xEB};
 
@@ -65,6 +71,10 @@ enum {
 	JK_COMMAND_DEVICE_INFO = 0x97,
 };
 
+static const char * const jk_recover_str[] = {
+	"none", "re-subscribe notifications", "reconnect", "reset BT stack", "reboot"
+};
+
 static bms_context_t *__bms_jk_context;
 
 static bms_context_t *bms_jk_context_get(void)
@@ -160,53 +170,88 @@ static void charc_reset(struct jk_bms_dev_t *dev)
 
 #define BMS_DATA_READ(S, V)\
 	{ if ((S) != (V)) { dev->cell_info.data_force = true; (S) = (V); }}
+/* Analog values, published if they move more than the MQTT step */
+#define BMS_DATA_SET(S, V)	{ (S) = (V); }
+/*
+ * Poll fast while the battery state is changing,
+ * back off up to the max interval while it is idle.
+ */
+static void bms_jk_poll_adapt(struct jk_bms_dev_t *dev, bool changing)
+{
+	uint32_t interval = dev->poll.interval_ms;
+
+	if (changing)
+		interval = dev->poll.min_ms;
+	else
+		interval += interval / 2;
+	if (interval > dev->poll.max_ms)
+		interval = dev->poll.max_ms;
+	if (interval < dev->poll.min_ms)
+		interval = dev->poll.min_ms;
+	if (interval != dev->poll.interval_ms && BMC_DEBUG(dev->ctx))
+		hlog_info(BMS_JK_MODULE, "[%s] Poll interval %d ms", DEV_NAME(dev), interval);
+	dev->poll.interval_ms = interval;
+}
+
 static void jk_bt_process_cell_frame(struct jk_bms_dev_t *dev)
 {
+	bool changing = !dev->cell_info.valid;
+	int32_t curr;
 	uint16_t d;
 	int i;
 
 	dev->cell_info.valid = true;
 	for (i = 0; i < BMS_MAX_CELLS; i++) {
 		d = DATA_UINT16_GET(dev, CELL_FRAME_VOLT + i * 2); // * 0.001f
-		if (dev->cell_info.cells_v[i] != d)
+		if (dev->cell_info.cells_v[i] != d) {
 			dev->cell_info.cell_v_force = true;
+			if (abs((int)d - (int)dev->cell_info.cells_v[i]) >= POLL_CELL_DELTA_MV)
+				changing = true;
+		}
 		dev->cell_info.cells_v[i] = d;
 	}
+	curr = DATA_INT32_GET(dev, CELL_FRAME_BATT_CHARGE);
+	if (llabs((int64_t)curr - dev->cell_info.batt_charge_curr) >= POLL_CURR_DELTA_MA)
+		changing = true;
+	if (DATA_UINT8_GET(dev, CELL_FRAME_BATT_ACTION) != dev->cell_info.batt_action ||
+	    DATA_UINT16_GET(dev, CELL_FRAME_ALARM) != dev->cell_info.alarms)
+		changing = true;
+	bms_jk_poll_adapt(dev, changing);
 	BMS_DATA_READ(dev->cell_info.cells_enabled, DATA_UINT32_GET(dev, CELL_FRAME_ENABLES_CELLS));
-	BMS_DATA_READ(dev->cell_info.v_avg, DATA_UINT16_GET(dev, CELL_FRAME_VOLT_AVG));			// * 0.001f
-	BMS_DATA_READ(dev->cell_info.v_delta, DATA_UINT16_GET(dev, CELL_FRAME_VOLT_DELTA));		// * 0.001f
-	BMS_DATA_READ(dev->cell_info.cell_v_max, DATA_UINT8_GET(dev, CELL_FRAME_CELL_MAX));
-	BMS_DATA_READ(dev->cell_info.cell_v_min, DATA_UINT8_GET(dev, CELL_FRAME_CELL_MIN));
+	BMS_DATA_SET(dev->cell_info.v_avg, DATA_UINT16_GET(dev, CELL_FRAME_VOLT_AVG));			// * 0.001f
+	BMS_DATA_SET(dev->cell_info.v_delta, DATA_UINT16_GET(dev, CELL_FRAME_VOLT_DELTA));		// * 0.001f
+	BMS_DATA_SET(dev->cell_info.cell_v_max, DATA_UINT8_GET(dev, CELL_FRAME_CELL_MAX));
+	BMS_DATA_SET(dev->cell_info.cell_v_min, DATA_UINT8_GET(dev, CELL_FRAME_CELL_MIN));
 	for (i = 0; i < BMS_MAX_CELLS; i++) {
 		d = DATA_UINT16_GET(dev, CELL_FRAME_RESISTANCE + i * 2); // * 0.001f
 		if (dev->cell_info.cells_res[i] != d)
 			dev->cell_info.cell_r_force = true;
 		dev->cell_info.cells_res[i] = d;
 	}
-	BMS_DATA_READ(dev->cell_info.power_temp, DATA_UINT16_GET(dev, CELL_FRAME_POWER_TEMP));	// * 0.1f
+	BMS_DATA_SET(dev->cell_info.power_temp, DATA_UINT16_GET(dev, CELL_FRAME_POWER_TEMP));	// * 0.1f
 	BMS_DATA_READ(dev->cell_info.cell_warn, DATA_UINT32_GET(dev, CELL_FRAME_CELL_WARN));
-	BMS_DATA_READ(dev->cell_info.batt_volt, DATA_UINT32_GET(dev, CELL_FRAME_BATT_VOLT));	// * 0.001f
-	BMS_DATA_READ(dev->cell_info.batt_power, DATA_UINT32_GET(dev, CELL_FRAME_BATT_POWER));
-	BMS_DATA_READ(dev->cell_info.batt_charge_curr, DATA_INT32_GET(dev, CELL_FRAME_BATT_CHARGE)); // * 0.001f
-	BMS_DATA_READ(dev->cell_info.batt_temp1, DATA_UINT16_GET(dev, CELL_FRAME_TEMP_1));		// * 0.1f
-	BMS_DATA_READ(dev->cell_info.batt_temp2, DATA_UINT16_GET(dev, CELL_FRAME_TEMP_2));		// * 0.1f
-	BMS_DATA_READ(dev->cell_info.batt_temp_mos, DATA_UINT16_GET(dev, CELL_FRAME_TEMP_MOS));	// * 0.1f
+	BMS_DATA_SET(dev->cell_info.batt_volt, DATA_UINT32_GET(dev, CELL_FRAME_BATT_VOLT));	// * 0.001f
+	BMS_DATA_SET(dev->cell_info.batt_power, DATA_UINT32_GET(dev, CELL_FRAME_BATT_POWER));
+	BMS_DATA_SET(dev->cell_info.batt_charge_curr, DATA_INT32_GET(dev, CELL_FRAME_BATT_CHARGE)); // * 0.001f
+	BMS_DATA_SET(dev->cell_info.batt_temp1, DATA_UINT16_GET(dev, CELL_FRAME_TEMP_1));		// * 0.1f
+	BMS_DATA_SET(dev->cell_info.batt_temp2, DATA_UINT16_GET(dev, CELL_FRAME_TEMP_2));		// * 0.1f
+	BMS_DATA_SET(dev->cell_info.batt_temp_mos, DATA_UINT16_GET(dev, CELL_FRAME_TEMP_MOS));	// * 0.1f
 	BMS_DATA_READ(dev->cell_info.alarms, DATA_UINT16_GET(dev, CELL_FRAME_ALARM));
-	BMS_DATA_READ(dev->cell_info.batt_balance_curr, DATA_UINT16_GET(dev, CELL_FRAME_BATT_BALANCE));	// * 0.001f
+	BMS_DATA_SET(dev->cell_info.batt_balance_curr, DATA_UINT16_GET(dev, CELL_FRAME_BATT_BALANCE));	// * 0.001f
 	BMS_DATA_READ(dev->cell_info.batt_action, DATA_UINT8_GET(dev, CELL_FRAME_BATT_ACTION));
 	BMS_DATA_READ(dev->cell_info.batt_state, DATA_UINT8_GET(dev, CELL_FRAME_BATT_STATE));
-	BMS_DATA_READ(dev->cell_info.batt_cap_rem, DATA_UINT32_GET(dev, CELL_FRAME_BATT_CAP_REMAIN));	// * 0.001f
+	BMS_DATA_SET(dev->cell_info.batt_cap_rem, DATA_UINT32_GET(dev, CELL_FRAME_BATT_CAP_REMAIN));	// * 0.001f
 	BMS_DATA_READ(dev->cell_info.batt_cap_nom, DATA_UINT32_GET(dev, CELL_FRAME_BATT_CAP_NOMINAL));	// * 0.001f
 	BMS_DATA_READ(dev->cell_info.batt_cycles, DATA_UINT32_GET(dev, CELL_FRAME_CYCLE_COUNT));
-	BMS_DATA_READ(dev->cell_info.batt_cycles_cap, DATA_UINT32_GET(dev, CELL_FRAME_CYCLE_CAP));	// * 0.001f
+	BMS_DATA_SET(dev->cell_info.batt_cycles_cap, DATA_UINT32_GET(dev, CELL_FRAME_CYCLE_CAP));	// * 0.001f
 	BMS_DATA_READ(dev->cell_info.soh, DATA_UINT8_GET(dev, CELL_FRAME_SOH));
-	BMS_DATA_READ(dev->cell_info.run_time, DATA_UINT32_GET(dev, CELL_FRAME_RUNTIME));
+	BMS_DATA_SET(dev->cell_info.run_time, DATA_UINT32_GET(dev, CELL_FRAME_RUNTIME));
 	BMS_DATA_READ(dev->cell_info.charge_enable, DATA_UINT8_GET(dev, CELL_FRAME_CHARGE_ENABLE));
 	BMS_DATA_READ(dev->cell_info.discharge_enable, DATA_UINT8_GET(dev, CELL_FRAME_DISCHARGE_ENABLE));
 	BMS_DATA_READ(dev->cell_info.precharge_enable, DATA_UINT8_GET(dev, CELL_FRAME_PRECHARGE_ENABLE));
 	BMS_DATA_READ(dev->cell_info.ballance_work, DATA_UINT8_GET(dev, CELL_FRAME_BALANCER_WORK));
-	BMS_DATA_READ(dev->cell_info.batt_v, DATA_UINT16_GET(dev, CELL_FRAME_BATTV)); // ?
-	BMS_DATA_READ(dev->cell_info.batt_heat_a, DATA_UINT16_GET(dev, CELL_FRAME_BATT_HEAT_CURR)); // * 0.001f
+	BMS_DATA_SET(dev->cell_info.batt_v, DATA_UINT16_GET(dev, CELL_FRAME_BATTV)); // ?
+	BMS_DATA_SET(dev->cell_info.batt_heat_a, DATA_UINT16_GET(dev, CELL_FRAME_BATT_HEAT_CURR)); // * 0.001f
 }
 
 #define DEV_FRAME_MODEL			6	// 16 bytes, string
@@ -256,55 +301,52 @@ static uint8_t calc_crc(const uint8_t data[], const uint16_t len)
 	return crc;
 }
 
-static void jk_bt_process_terminal(struct jk_bms_dev_t *dev, bt_characteristicvalue_t *val)
+/*
+ * Assemble a frame from the GATT notifications. The frames are longer than the MTU,
+ * so the BMS splits them into chunks at arbitrary positions.
+ */
+static void jk_bt_frame_assemble(struct jk_bms_dev_t *dev, const uint8_t *data, int len)
 {
 	int ssize = ARRAY_SIZE(jk_notify_pkt_start);
 	int csize = 0;
+	int mlen;
 	uint8_t crc;
 
 	if (dev->nbuff_ready) /* Previous frame not processed yet */
 		return;
 
-	if (dev->jk_term_charc.char_id != val->charId) {
-		if (BMC_DEBUG(dev->ctx))
-			hlog_info(BMS_JK_MODULE, "[%s] Not on terminal service, ignoring: %d / %d",
-					  DEV_NAME(dev), dev->jk_term_charc.char_id != val->charId);
-		return;
-	}
-	if (val->len < ssize) {
-		if (BMC_DEBUG(dev->ctx))
-			hlog_info(BMS_JK_MODULE, "[%s] Data not enough, ignoring: %d, at least %d expected",
-					  DEV_NAME(dev), val->len, ssize);
-		return;
-	}
-
-	if (!memcmp(val->data, jk_notify_pkt_start, ssize)) {
+	if (len >= ssize && !memcmp(data, jk_notify_pkt_start, ssize)) {
 		if (BMC_DEBUG(dev->ctx))
 			hlog_info(BMS_JK_MODULE, "[%s] New notification detected", DEV_NAME(dev));
 		/* New notification starts */
 		dev->nbuff_curr = 0;
-		csize = val->len < NOTIFY_PACKET_SIZE ? val->len : NOTIFY_PACKET_SIZE;
+		csize = len < NOTIFY_PACKET_SIZE ? len : NOTIFY_PACKET_SIZE;
 	} else {
 		/* Assemble previous notification */
 		if (BMC_DEBUG(dev->ctx))
-			hlog_info(BMS_JK_MODULE, "[%s] Assemble previous notification: +%d bytes", DEV_NAME(dev), val->len);
+			hlog_info(BMS_JK_MODULE, "[%s] Assemble previous notification: +%d bytes", DEV_NAME(dev), len);
 		csize = NOTIFY_PACKET_SIZE - dev->nbuff_curr;
-		csize = val->len < csize ? val->len : csize;
+		csize = len < csize ? len : csize;
+		/* The start magic can be split in chunks as well */
+		if (dev->nbuff_curr < ssize) {
+			mlen = ssize - dev->nbuff_curr;
+			mlen = csize < mlen ? csize : mlen;
+			if (memcmp(data, jk_notify_pkt_start + dev->nbuff_curr, mlen)) {
+				if (BMC_DEBUG(dev->ctx))
+					hlog_info(BMS_JK_MODULE, "[%s] Data without notification start, ignoring %d bytes",
+							  DEV_NAME(dev), len);
+				dev->nbuff_curr = 0;
+				return;
+			}
+		}
 	}
 
-	memcpy(dev->nbuff + dev->nbuff_curr, val->data, csize);
+	memcpy(dev->nbuff + dev->nbuff_curr, data, csize);
 	dev->nbuff_curr += csize;
 	if (dev->nbuff_curr == NOTIFY_PACKET_SIZE) {
 		if (BMC_DEBUG(dev->ctx))
 			hlog_info(BMS_JK_MODULE, "[%s] Processing frame %d of type %d: %d bytes",
 					  DEV_NAME(dev), dev->nbuff[5], dev->nbuff[4], dev->nbuff_curr);
-		if (memcmp(dev->nbuff, jk_notify_pkt_start, ssize)) {
-			if (BMC_DEBUG(dev->ctx))
-				hlog_info(BMS_JK_MODULE, "[%s] Invalid start magic [0x%X 0x%X 0x%X 0x%X]",
-						  DEV_NAME(dev), dev->nbuff[0], dev->nbuff[1], dev->nbuff[2], dev->nbuff[3]);
-			dev->nbuff_curr = 0;
-			return;
-		}
 		crc = calc_crc(dev->nbuff, dev->nbuff_curr - 1);
 		if (crc != dev->nbuff[dev->nbuff_curr - 1]) {
 			if (BMC_DEBUG(dev->ctx))
@@ -317,6 +359,20 @@ static void jk_bt_process_terminal(struct jk_bms_dev_t *dev, bt_characteristicva
 	}
 }
 
+static void jk_bt_process_terminal(struct jk_bms_dev_t *dev, bt_characteristicvalue_t *val)
+{
+	if (dev->jk_term_charc.char_id != val->charId) {
+		if (BMC_DEBUG(dev->ctx))
+			hlog_info(BMS_JK_MODULE, "[%s] Not on terminal service, ignoring: %d / %d",
+					  DEV_NAME(dev), dev->jk_term_charc.char_id != val->charId);
+		return;
+	}
+	if (!val->len)
+		return;
+
+	jk_bt_frame_assemble(dev, val->data, val->len);
+}
+
 static void bms_jk_frame_process(struct jk_bms_dev_t *dev)
 {
 	if (!dev->nbuff_ready)
@@ -346,6 +402,10 @@ static void bms_jk_frame_process(struct jk_bms_dev_t *dev)
 	dev->nbuff_curr = 0;
 	dev->nbuff_ready = false;
 	dev->wait_reply = false;
+	if (dev->recover_step != JK_RECOVER_NONE) {
+		hlog_info(BMS_JK_MODULE, "[%s] Recovered after %s", DEV_NAME(dev), jk_recover_str[dev->recover_step]);
+		dev->recover_step = JK_RECOVER_NONE;
+	}
 }
 
 static void jk_bt_event(int idx, bt_event_t event, const void *data, int data_len, void *context)
@@ -381,6 +441,7 @@ static void jk_bt_event(int idx, bt_event_t event, const void *data, int data_le
 			hlog_info(BMS_JK_MODULE, "Device %s (%s) is ready", DEV_NAME(dev), dev->name);
 		dev->state = BT_READY;
 		dev->last_reply = time_ms_since_boot();
+		dev->poll.interval_ms = dev->poll.min_ms;
 		break;
 	case BT_NEW_SERVICE:
 		if (data_len != sizeof(bt_service_t))
@@ -449,8 +510,11 @@ static bool get_bms_config(bms_context_t **ctx)
 	char *bt_name = USER_PRAM_GET(BMS_NAME);
 	char *bt_wh_notify = USER_PRAM_GET(BMS_NOTIFY);
 	char *bt_max_charge = USER_PRAM_GET(BMS_CHARGE_CURRENT_THRESHOLD);
+	char *bt_poll = USER_PRAM_GET(BMS_POLL_SEC);
+	char *bt_mqtt_step = USER_PRAM_GET(BMS_MQTT_STEP);
 	char *dev, *addr, *ch;
 	char *mod, *mod_rest;
+	int min_sec, max_sec;
 	float val1, val2;
 	char *rest, *rest1;
 	bt_addr_t address;
@@ -513,6 +577,39 @@ static bool get_bms_config(bms_context_t **ctx)
 		}
 	}
 
+	for (i = 0; i < (*ctx)->count; i++) {
+		(*ctx)->devices[i]->poll.min_ms = CMD_POLL_MIN_MS;
+		(*ctx)->devices[i]->poll.max_ms = CMD_POLL_MAX_MS;
+	}
+	if (bt_poll && strlen(bt_poll) >= 1) {
+		rest = bt_poll;
+		i = 0;
+		while ((dev = strtok_r(rest, ";", &rest))) {
+			rest1 = dev;
+			mod = strtok_r(rest1, ",", &rest1);
+			if (mod && rest1) {
+				min_sec = (int)strtol(mod, NULL, 0);
+				max_sec = (int)strtol(rest1, NULL, 0);
+				if (min_sec > 0 && max_sec >= min_sec && max_sec <= POLL_SEC_LIMIT) {
+					(*ctx)->devices[i]->poll.min_ms = (uint32_t)min_sec * 1000;
+					(*ctx)->devices[i]->poll.max_ms = (uint32_t)max_sec * 1000;
+				}
+			}
+			i++;
+			if (i >= (*ctx)->count)
+				break;
+		}
+	}
+	for (i = 0; i < (*ctx)->count; i++) {
+		/* At least a few requests before the inactivity timeout */
+		if ((*ctx)->devices[i]->timeout_msec &&
+		    (*ctx)->devices[i]->poll.max_ms > (*ctx)->devices[i]->timeout_msec / 4)
+			(*ctx)->devices[i]->poll.max_ms = (*ctx)->devices[i]->timeout_msec / 4;
+		if ((*ctx)->devices[i]->poll.min_ms > (*ctx)->devices[i]->poll.max_ms)
+			(*ctx)->devices[i]->poll.min_ms = (*ctx)->devices[i]->poll.max_ms;
+		(*ctx)->devices[i]->poll.interval_ms = (*ctx)->devices[i]->poll.min_ms;
+	}
+
 	if (bt_batt_cell && strlen(bt_batt_cell) >= 1) {
 		rest = bt_batt_cell;
 		i = 0;
@@ -551,9 +648,33 @@ static bool get_bms_config(bms_context_t **ctx)
 		rest = bt_max_charge;
 		i = 0;
 		while ((dev = strtok_r(rest, ";", &rest))) {
-			val1 = (int)strtol(dev, NULL, 0);
-			if (val1 > 0)
-				jk_bt_enable_solar_track((*ctx)->devices[i], val1);
+			res = (int)strtol(dev, NULL, 0);
+			if (res > 0 && res <= UINT16_MAX)
+				jk_bt_enable_solar_track((*ctx)->devices[i], res);
+			i++;
+			if (i >= (*ctx)->count)
+				break;
+		}
+	}
+
+	if (bt_mqtt_step && strlen(bt_mqtt_step) >= 1) {
+		rest = bt_mqtt_step;
+		i = 0;
+		while ((dev = strtok_r(rest, ";", &rest))) {
+			rest1 = dev;
+			mod = strtok_r(rest1, ",", &rest1);			// volt
+			addr = rest1 ? strtok_r(rest1, ",", &rest1) : NULL;	// ohm
+			if (mod && addr && rest1) {				// ampere
+				res = sys_strtof(mod, &val1);
+				if (!res && val1 > 0 && val1 < CELL_VOLTAGE_MAX)
+					(*ctx)->devices[i]->mqtt.step_v = (uint16_t)(val1 * 1000);
+				res = sys_strtof(addr, &val1);
+				if (!res && val1 > 0 && val1 < 60)
+					(*ctx)->devices[i]->mqtt.step_r = (uint16_t)(val1 * 1000);
+				res = sys_strtof(rest1, &val1);
+				if (!res && val1 > 0 && val1 < 60)
+					(*ctx)->devices[i]->mqtt.step_a = (uint16_t)(val1 * 1000);
+			}
 			i++;
 			if (i >= (*ctx)->count)
 				break;
@@ -576,6 +697,10 @@ out:
 		free(bt_timeout);
 	if (bt_max_charge)
 		free(bt_max_charge);
+	if (bt_poll)
+		free(bt_poll);
+	if (bt_mqtt_step)
+		free(bt_mqtt_step);
 	if (!ret) {
 		if ((*ctx)) {
 			for (i = 0; i < (*ctx)->count; i++) {
@@ -634,40 +759,99 @@ out_err:
 	return false;
 }
 
-static void bms_jk_send_request(struct jk_bms_dev_t *dev)
+static void bms_jk_send_request(struct jk_bms_dev_t *dev, uint64_t now)
 {
-	if (dev->request_count % 10)
-		bms_jk_read_cmd(dev, JK_COMMAND_CELL_INFO, 0, 0);
-	else
+	/* The device info rarely changes, request it on its own slow interval */
+	if (!dev->poll.dev_time || (now - dev->poll.dev_time) >= CMD_POLL_DEV_MS) {
 		bms_jk_read_cmd(dev, JK_COMMAND_DEVICE_INFO, 0, 0);
+		dev->poll.dev_time = now;
+	} else if (!dev->poll.cell_time || (now - dev->poll.cell_time) >= dev->poll.interval_ms) {
+		bms_jk_read_cmd(dev, JK_COMMAND_CELL_INFO, 0, 0);
+		dev->poll.cell_time = now;
+	} else {
+		return;
+	}
 	dev->request_count++;
-	dev->send_time = time_ms_since_boot();
+	dev->send_time = now;
 	dev->wait_reply = true;
 }
 
-static void bms_jk_timeout_check(bms_context_t *ctx)
+static bool bms_jk_recover_possible(struct jk_bms_dev_t *dev, enum jk_recover_t step)
+{
+	switch (step) {
+	case JK_RECOVER_NOTIFY:
+		return dev->state == BT_READY && TERM_IS_ACTIVE(dev);
+	case JK_RECOVER_RECONNECT:
+		return dev->state != BT_DISCONNECTED;
+	default:
+		break;
+	}
+	return true;
+}
+
+/* Run the next recovery step, the reboot is the last one */
+static void bms_jk_recover(struct jk_bms_dev_t *dev, uint64_t now)
 {
 	char tbuf[TIME_STR_LEN];
 	struct tm date;
+
+	do {
+		dev->recover_step++;
+	} while (dev->recover_step < JK_RECOVER_REBOOT && !bms_jk_recover_possible(dev, dev->recover_step));
+	dev->recover_count[dev->recover_step]++;
+	dev->recover_time = now;
+
+	time_msec2datetime(&date, now - dev->last_reply);
+	time_date2str(tbuf, TIME_STR_LEN, &date);
+	hlog_info(BMS_JK_MODULE, "Timeout on device %s: %s, going to %s ...",
+			  DEV_NAME(dev), tbuf, jk_recover_str[dev->recover_step]);
+
+	switch (dev->recover_step) {
+	case JK_RECOVER_NOTIFY:
+		bt_characteristic_notify(dev->jk_term_charc.char_id, false);
+		dev->jk_term_charc.notify = false;
+		dev->nbuff_curr = 0;
+		dev->nbuff_ready = false;
+		dev->wait_reply = false;
+		break;
+	case JK_RECOVER_RECONNECT:
+		bt_device_disconnect(dev->bt_index);
+		break;
+	case JK_RECOVER_BT_RESET:
+		bt_stack_reset();
+		break;
+	case JK_RECOVER_REBOOT:
+	default:
+		system_force_reboot(0);
+		break;
+	}
+}
+
+static void bms_jk_timeout_check(bms_context_t *ctx)
+{
+	struct jk_bms_dev_t *dev;
+	uint64_t since, wait;
 	uint64_t now;
 	uint32_t i;
 
 	now = time_ms_since_boot();
 	for (i = 0; i < ctx->count; i++) {
-		if (!ctx->devices[i]->timeout_msec || !ctx->devices[i]->last_reply)
+		dev = ctx->devices[i];
+		if (!dev->timeout_msec || !dev->last_reply)
 			continue;
-		if ((now - ctx->devices[i]->last_reply) > ctx->devices[i]->timeout_msec)
-			break;
+		if (dev->recover_step >= JK_RECOVER_REBOOT)
+			continue;
+		/* The first step on timeout, the next ones if the previous did not help */
+		if (dev->recover_step == JK_RECOVER_NONE) {
+			since = dev->last_reply;
+			wait = dev->timeout_msec;
+		} else {
+			since = dev->last_reply > dev->recover_time ? dev->last_reply : dev->recover_time;
+			wait = dev->timeout_msec < RECOVER_STEP_MS ? dev->timeout_msec : RECOVER_STEP_MS;
+		}
+		if ((now - since) > wait)
+			bms_jk_recover(dev, now);
 	}
-	if (i >= ctx->count)
-		return;
-
-	time_msec2datetime(&date, now - ctx->devices[i]->last_reply);
-	time_date2str(tbuf, TIME_STR_LEN, &date);
-	hlog_info(BMS_JK_MODULE, "Timeout on device %s: %s, going to reboot ...",
-			  DEV_NAME(ctx->devices[i]), tbuf);
-
-	system_force_reboot(0);
 }
 
 static void bms_jk_process(bms_context_t *ctx)
@@ -697,8 +881,8 @@ static void bms_jk_run(void *context)
 				ctx->devices[i]->nbuff_ready = false;
 				ctx->devices[i]->wait_reply = false;
 			}
-		} else if ((now - ctx->devices[i]->send_time) >= CMD_POLL_MS) {
-			bms_jk_send_request(ctx->devices[i]);
+		} else {
+			bms_jk_send_request(ctx->devices[i], now);
 		}
 	}
 	bms_jk_process(ctx);
@@ -790,8 +974,15 @@ static bool bms_jk_log(void *context)
 			  dev->jk_term_charc.notify ? "registered" : "not registered");
 	hlog_info(BMS_JK_MODULE, "\tLast valid response [%s] ago, connection count %d",
 			  tbuf, dev->connect_count);
-	if (dev->timeout_msec)
+	hlog_info(BMS_JK_MODULE, "\tPoll interval %d sec (%d..%d), requests sent %d",
+			  dev->poll.interval_ms / 1000, dev->poll.min_ms / 1000,
+			  dev->poll.max_ms / 1000, dev->request_count);
+	if (dev->timeout_msec) {
 		hlog_info(BMS_JK_MODULE, "\tInactivity timeout %lld sec", dev->timeout_msec / 1000);
+		hlog_info(BMS_JK_MODULE, "\tRecovery attempts: re-subscribe %d, reconnect %d, BT stack reset %d",
+				  dev->recover_count[JK_RECOVER_NOTIFY], dev->recover_count[JK_RECOVER_RECONNECT],
+				  dev->recover_count[JK_RECOVER_BT_RESET]);
+	}
 
 	if (!dev->dev_info.valid)
 		hlog_info(BMS_JK_MODULE, "\tNo valid device info received");
@@ -90,8 +90,20 @@ typedef struct {
 	mqtt_component_t *bms_info;
 	mqtt_component_t mqtt_comp[BMS_MQTT_COMPONENTS];
 	char payload[BMS_MQTT_DATA_LEN + 1];
-	uint8_t send_id;
-	uint64_t last_send;
+	/* Publish only changes bigger than the step */
+	uint16_t step_v;				// * 0.001, V
+	uint16_t step_r;				// * 0.001, ohms
+	uint16_t step_a;				// * 0.001, A
+	/* Values in the last published payloads */
+	uint16_t pub_cells_v[BMS_MAX_CELLS];
+	uint16_t pub_cells_res[BMS_MAX_CELLS];
+	uint16_t pub_v_avg;
+	uint16_t pub_v_delta;
+	uint32_t pub_batt_volt;
+	uint32_t pub_cap_rem;
+	int32_t pub_charge_curr;
+	uint16_t pub_balance_curr;
+	uint16_t pub_temp[4];			// power, temp1, temp2, mos
 } bms_jk_mqtt_t;
 
 typedef struct {
@@ -108,6 +120,25 @@ typedef struct {
 
 #define TERM_IS_ACTIVE(D) ((D)->jk_term_charc.valid)
 
+/* Adaptive schedule of the requests to the BMS */
+typedef struct {
+	uint32_t min_ms;		/* Poll interval while the battery state is changing */
+	uint32_t max_ms;		/* Poll interval while the battery is idle */
+	uint32_t interval_ms;	/* Current poll interval of the cell info */
+	uint64_t cell_time;		/* Last cell info request */
+	uint64_t dev_time;		/* Last device info request */
+} bms_jk_poll_t;
+
+/* Steps to recover from BMS timeout, in order */
+enum jk_recover_t {
+	JK_RECOVER_NONE = 0,
+	JK_RECOVER_NOTIFY,		/* Subscribe again for notifications */
+	JK_RECOVER_RECONNECT,	/* Disconnect and connect again to the device */
+	JK_RECOVER_BT_RESET,	/* Reset the BT stack */
+	JK_RECOVER_REBOOT,		/* Reboot the system */
+	JK_RECOVER_MAX
+};
+
 #define BMS_MAX_DEVICES	4
 
 struct bms_context_type;
@@ -137,6 +168,7 @@ struct jk_bms_dev_t {
 	uint64_t send_time;
 	uint64_t last_reply;
 	uint32_t request_count;
+	bms_jk_poll_t poll;
 	bt_event_t state;
 	bms_dev_info_t dev_info;
 	bms_cells_info_t cell_info;
@@ -148,6 +180,9 @@ struct jk_bms_dev_t {
 	bms_jk_mqtt_t mqtt;
 	uint32_t connect_count;
 	uint64_t timeout_msec;
+	enum jk_recover_t recover_step;
+	uint64_t recover_time;
+	uint32_t recover_count[JK_RECOVER_MAX];
 
 	/* track battery */
 	struct bt_auto_action_t auto_batt; // Actions on battery state
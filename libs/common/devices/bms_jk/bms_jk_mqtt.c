@@ -4,134 +4,187 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "string.h"
 #include "pico/stdlib.h"
 #include "lwip/apps/mqtt.h"
 #include "bms_jk.h"
 
 #define TIME_STR	64
-#define MQTT_SEND_INTERVAL_MS 20000
+#define MQTT_REFRESH_MS	300000 /* Send all payloads at least each 5min */
+#define MQTT_STEP_V	10	/* Default publish step of the voltages, mV */
+#define MQTT_STEP_R	10	/* Default publish step of the cell resistances, mOhm */
+#define MQTT_STEP_A	500	/* Default publish step of the currents, mA */
+#define MQTT_STEP_T	10	/* Publish step of the temperatures, 0.1 *C */
+#define MQTT_STEP_PACK_V	100	/* Publish step of the pack voltage, mV */
+#define MQTT_STEP_CAP	100	/* Publish step of the remaining capacity, mAh */
 #define IS_MQTT_LOG(C) ((C) && LOG_MQTT_DEBUG)
 
-enum {
-	MQTT_SEND_CELL_V = 0,
-	MQTT_SEND_CELL_R,
-	MQTT_SEND_DATA,
-	MQTT_SEND_DEV,
-	MQTT_SEND_MAX
-};
-
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("MQTT %s: Buffer full\n\r", __func__); return -1; } \
-				count += snprintf(dev->mqtt.payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("MQTT %s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(dev->mqtt.payload + count, len - count, _S_, __VA_ARGS__); }
+#define MQTT_MOVED(V, P, S)	(llabs((int64_t)(V) - (int64_t)(P)) >= (S))
+
+static void mqtt_refresh_check(mqtt_component_t *comp, uint64_t now)
+{
+	if (!comp->force && (now - comp->last_send) >= MQTT_REFRESH_MS)
+		comp->force = true;
+}
+
+static bool mqtt_cells_moved(const uint16_t *cells, const uint16_t *pub, uint16_t step)
+{
+	int i;
+
+	for (i = 0; i < BMS_MAX_CELLS; i++) {
+		if (MQTT_MOVED(cells[i], pub[i], step))
+			return true;
+	}
+	return false;
+}
+
+static bool mqtt_data_moved(struct jk_bms_dev_t *dev)
+{
+	bms_jk_mqtt_t *mqtt = &dev->mqtt;
+
+	return MQTT_MOVED(dev->cell_info.v_avg, mqtt->pub_v_avg, mqtt->step_v) ||
+	       MQTT_MOVED(dev->cell_info.v_delta, mqtt->pub_v_delta, mqtt->step_v) ||
+	       MQTT_MOVED(dev->cell_info.batt_volt, mqtt->pub_batt_volt, MQTT_STEP_PACK_V) ||
+	       MQTT_MOVED(dev->cell_info.batt_cap_rem, mqtt->pub_cap_rem, MQTT_STEP_CAP) ||
+	       MQTT_MOVED(dev->cell_info.batt_charge_curr, mqtt->pub_charge_curr, mqtt->step_a) ||
+	       MQTT_MOVED(dev->cell_info.batt_balance_curr, mqtt->pub_balance_curr, mqtt->step_a) ||
+	       MQTT_MOVED(dev->cell_info.power_temp, mqtt->pub_temp[0], MQTT_STEP_T) ||
+	       MQTT_MOVED(dev->cell_info.batt_temp1, mqtt->pub_temp[1], MQTT_STEP_T) ||
+	       MQTT_MOVED(dev->cell_info.batt_temp2, mqtt->pub_temp[2], MQTT_STEP_T) ||
+	       MQTT_MOVED(dev->cell_info.batt_temp_mos, mqtt->pub_temp[3], MQTT_STEP_T);
+}
+
+static int mqtt_payload_end(json_writer_t *js)
+{
+	if (json_end(js) < 0) {
+		printf("MQTT %s: Buffer full\n\r", __func__);
+		return -1;
+	}
+	return 0;
+}
+
 static int mqtt_cells_v_send(struct jk_bms_dev_t *dev)
 {
 	static char time_buff[TIME_STR];
-	int len = BMS_MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 	int i;
 
 	if (!dev->cell_info.valid)
 		return 0;
 	/* Cells voltage */
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
+	json_begin(&js, dev->mqtt.payload, BMS_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
 	for (i = 0; i < BMS_MAX_CELLS; i++) {
-		ADD_MQTT_MSG_VAR(",\"cell_%d_v\":%3.2f", i, dev->cell_info.cells_v[i] * 0.001);
+		json_key_idx(&js, "cell_", i, "_v");
+		json_val_fixed(&js, dev->cell_info.cells_v[i], 3, 2);
 	}
-	ADD_MQTT_MSG("}");
+	if (mqtt_payload_end(&js))
+		return -1;
 
-	dev->mqtt.payload[BMS_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(dev->mqtt.cells_v, dev->mqtt.payload);
 	dev->cell_info.cell_v_force = false;
+	if (!ret)
+		memcpy(dev->mqtt.pub_cells_v, dev->cell_info.cells_v, sizeof(dev->mqtt.pub_cells_v));
 	if (IS_MQTT_LOG(dev->ctx->debug))
-		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT cells voltages: %d", strlen(dev->mqtt.payload), ret);
+		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT cells voltages: %d", js.len, ret);
 	return ret;
 }
 
 static int mqtt_cells_r_send(struct jk_bms_dev_t *dev)
 {
 	static char time_buff[TIME_STR];
-	int len = BMS_MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 	int i;
 
 	if (!dev->cell_info.valid)
 		return 0;
 
-	/* Cells voltage */
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
+	/* Cells resistance */
+	json_begin(&js, dev->mqtt.payload, BMS_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
 	for (i = 0; i < BMS_MAX_CELLS; i++) {
-		ADD_MQTT_MSG_VAR(",\"cell_%d_r\":%3.2f", i, dev->cell_info.cells_res[i] * 0.001);
+		json_key_idx(&js, "cell_", i, "_r");
+		json_val_fixed(&js, dev->cell_info.cells_res[i], 3, 2);
 	}
-	ADD_MQTT_MSG("}");
+	if (mqtt_payload_end(&js))
+		return -1;
 
-	dev->mqtt.payload[BMS_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(dev->mqtt.cells_res, dev->mqtt.payload);
 	dev->cell_info.cell_r_force = false;
+	if (!ret)
+		memcpy(dev->mqtt.pub_cells_res, dev->cell_info.cells_res, sizeof(dev->mqtt.pub_cells_res));
 	if (IS_MQTT_LOG(dev->ctx->debug))
-		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT cells resistances: %d", strlen(dev->mqtt.payload), ret);
+		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT cells resistances: %d", js.len, ret);
 	return ret;
 }
 
 static int mqtt_cells_data_send(struct jk_bms_dev_t *dev)
 {
 	static char time_buff[TIME_STR];
-	int len = BMS_MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
 	if (!dev->cell_info.valid)
 		return 0;
 
 	/* Cells info  */
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"v_avg\":%3.2f", dev->cell_info.v_avg*0.001);
-	ADD_MQTT_MSG_VAR(",\"v_delta\":%3.2f", dev->cell_info.v_delta*0.001);
-	ADD_MQTT_MSG_VAR(",\"cell_v_min\":%d", dev->cell_info.cell_v_min);
-	ADD_MQTT_MSG_VAR(",\"cell_v_max\":%d", dev->cell_info.cell_v_max);
-	ADD_MQTT_MSG_VAR(",\"batt_action\":%d", dev->cell_info.batt_action);
-	ADD_MQTT_MSG_VAR(",\"power_temp\":%3.2f", dev->cell_info.power_temp*0.1);
-	ADD_MQTT_MSG_VAR(",\"batt_temp1\":%3.2f", dev->cell_info.batt_temp1*0.1);
-	ADD_MQTT_MSG_VAR(",\"batt_temp2\":%3.2f", dev->cell_info.batt_temp2*0.1);
-	ADD_MQTT_MSG_VAR(",\"batt_temp_mos\":%3.2f", dev->cell_info.batt_temp_mos*0.1);
-	ADD_MQTT_MSG_VAR(",\"batt_volt\":%3.2f", dev->cell_info.batt_volt*0.001);
-	ADD_MQTT_MSG_VAR(",\"batt_power\":%ld", dev->cell_info.batt_power);
-	ADD_MQTT_MSG_VAR(",\"batt_state\":%d", dev->cell_info.batt_state);
-	ADD_MQTT_MSG_VAR(",\"batt_cycles\":%ld", dev->cell_info.batt_cycles);
-	ADD_MQTT_MSG_VAR(",\"batt_charge_curr\":%3.2f", dev->cell_info.batt_charge_curr*0.001);
-	ADD_MQTT_MSG_VAR(",\"batt_balance_curr\":%3.2f", dev->cell_info.batt_balance_curr*0.001);
-	ADD_MQTT_MSG_VAR(",\"batt_cap_rem\":%3.2f", dev->cell_info.batt_cap_rem*0.001);
-	ADD_MQTT_MSG_VAR(",\"batt_cap_nom\":%3.2f", dev->cell_info.batt_cap_nom*0.001);
-	ADD_MQTT_MSG_VAR(",\"batt_cycles_cap\":%3.2f", dev->cell_info.batt_cycles_cap*0.001);
-	ADD_MQTT_MSG_VAR(",\"soh\":%d", dev->cell_info.soh);
-	ADD_MQTT_MSG_VAR(",\"batt_v\":%3.2f", dev->cell_info.batt_v*0.001);
-	ADD_MQTT_MSG_VAR(",\"batt_heat_a\":%3.2f", dev->cell_info.batt_heat_a*0.001);
+	json_begin(&js, dev->mqtt.payload, BMS_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_fixed(&js, "v_avg", dev->cell_info.v_avg, 3, 2);
+	json_add_fixed(&js, "v_delta", dev->cell_info.v_delta, 3, 2);
+	json_add_int(&js, "cell_v_min", dev->cell_info.cell_v_min);
+	json_add_int(&js, "cell_v_max", dev->cell_info.cell_v_max);
+	json_add_int(&js, "batt_action", dev->cell_info.batt_action);
+	json_add_fixed(&js, "power_temp", dev->cell_info.power_temp, 1, 2);
+	json_add_fixed(&js, "batt_temp1", dev->cell_info.batt_temp1, 1, 2);
+	json_add_fixed(&js, "batt_temp2", dev->cell_info.batt_temp2, 1, 2);
+	json_add_fixed(&js, "batt_temp_mos", dev->cell_info.batt_temp_mos, 1, 2);
+	json_add_fixed(&js, "batt_volt", dev->cell_info.batt_volt, 3, 2);
+	json_add_int(&js, "batt_power", dev->cell_info.batt_power);
+	json_add_int(&js, "batt_state", dev->cell_info.batt_state);
+	json_add_int(&js, "batt_cycles", dev->cell_info.batt_cycles);
+	json_add_fixed(&js, "batt_charge_curr", dev->cell_info.batt_charge_curr, 3, 2);
+	json_add_fixed(&js, "batt_balance_curr", dev->cell_info.batt_balance_curr, 3, 2);
+	json_add_fixed(&js, "batt_cap_rem", dev->cell_info.batt_cap_rem, 3, 2);
+	json_add_fixed(&js, "batt_cap_nom", dev->cell_info.batt_cap_nom, 3, 2);
+	json_add_fixed(&js, "batt_cycles_cap", dev->cell_info.batt_cycles_cap, 3, 2);
+	json_add_int(&js, "soh", dev->cell_info.soh);
+	json_add_fixed(&js, "batt_v", dev->cell_info.batt_v, 3, 2);
+	json_add_fixed(&js, "batt_heat_a", dev->cell_info.batt_heat_a, 3, 2);
 	if (dev->auto_batt.enabled)
-		ADD_MQTT_MSG_VAR(",\"batt_low\":%d", !dev->auto_batt.state);
+		json_add_int(&js, "batt_low", !dev->auto_batt.state);
 	if (dev->auto_solar.enabled)
-		ADD_MQTT_MSG_VAR(",\"solar_excess\":%d", dev->auto_solar.state);
-	ADD_MQTT_MSG("}");
+		json_add_int(&js, "solar_excess", dev->auto_solar.state);
+	if (mqtt_payload_end(&js))
+		return -1;
 
-	dev->mqtt.payload[BMS_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(dev->mqtt.bms_data, dev->mqtt.payload);
 	dev->cell_info.data_force = false;
+	if (!ret) {
+		dev->mqtt.pub_v_avg = dev->cell_info.v_avg;
+		dev->mqtt.pub_v_delta = dev->cell_info.v_delta;
+		dev->mqtt.pub_batt_volt = dev->cell_info.batt_volt;
+		dev->mqtt.pub_cap_rem = dev->cell_info.batt_cap_rem;
+		dev->mqtt.pub_charge_curr = dev->cell_info.batt_charge_curr;
+		dev->mqtt.pub_balance_curr = dev->cell_info.batt_balance_curr;
+		dev->mqtt.pub_temp[0] = dev->cell_info.power_temp;
+		dev->mqtt.pub_temp[1] = dev->cell_info.batt_temp1;
+		dev->mqtt.pub_temp[2] = dev->cell_info.batt_temp2;
+		dev->mqtt.pub_temp[3] = dev->cell_info.batt_temp_mos;
+	}
 	if (IS_MQTT_LOG(dev->ctx->debug))
-		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT cells info: %d", strlen(dev->mqtt.payload), ret);
+		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT cells info: %d", js.len, ret);
 	return ret;
 }
 
 static int mqtt_dev_info_send(struct jk_bms_dev_t *dev)
 {
-	int len = BMS_MQTT_DATA_LEN;
 	char time_buff[TIME_STR];
+	json_writer_t js;
 	struct tm date;
-	int count = 0;
 	int ret;
 
 	if (!dev->dev_info.valid)
@@ -139,88 +192,63 @@ static int mqtt_dev_info_send(struct jk_bms_dev_t *dev)
 
 	time_msec2datetime(&date, dev->dev_info.Uptime * 1000);
 	/* Device Info  */
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"Vendor\":\"%s\"", dev->dev_info.Vendor);
-	ADD_MQTT_MSG_VAR(",\"Model\":\"%s\"", dev->dev_info.Model);
-	ADD_MQTT_MSG_VAR(",\"Hardware\":\"%s\"", dev->dev_info.Hardware);
-	ADD_MQTT_MSG_VAR(",\"Software\":\"%s\"", dev->dev_info.Software);
-	ADD_MQTT_MSG_VAR(",\"SerialN\":\"%s\"", dev->dev_info.SerialN);
-	ADD_MQTT_MSG_VAR(",\"Uptime\":\"%s\"", time_date2str(time_buff, TIME_STR, &date));
-	ADD_MQTT_MSG_VAR(",\"PowerOnCount\":\"%d\"", dev->dev_info.PowerOnCount);
-	ADD_MQTT_MSG("}");
-
-	dev->mqtt.payload[BMS_MQTT_DATA_LEN] = 0;
+	json_begin(&js, dev->mqtt.payload, BMS_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_str(&js, "Vendor", dev->dev_info.Vendor);
+	json_add_str(&js, "Model", dev->dev_info.Model);
+	json_add_str(&js, "Hardware", dev->dev_info.Hardware);
+	json_add_str(&js, "Software", dev->dev_info.Software);
+	json_add_str(&js, "SerialN", dev->dev_info.SerialN);
+	json_add_str(&js, "Uptime", time_date2str(time_buff, TIME_STR, &date));
+	json_add_uint(&js, "PowerOnCount", dev->dev_info.PowerOnCount);
+	if (mqtt_payload_end(&js))
+		return -1;
+
 	ret = mqtt_msg_component_publish(dev->mqtt.bms_info, dev->mqtt.payload);
 	dev->cell_info.dev_force = false;
 	if (IS_MQTT_LOG(dev->ctx->debug))
-		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT device info: %d", strlen(dev->mqtt.payload), ret);
+		hlog_info(BMS_JK_MODULE, "Published %d bytes MQTT device info: %d", js.len, ret);
 	return ret;
 }
 
 void bms_jk_mqtt_send(struct jk_bms_dev_t *dev)
 {
 	uint64_t now = time_ms_since_boot();
-	int ret;
 
 	if (!mqtt_is_discovery_sent())
 		return;
 
-	if (dev->cell_info.cell_v_force)
-		dev->mqtt.cells_v->force = true;
-	if (dev->cell_info.cell_r_force)
-		dev->mqtt.cells_res->force = true;
-	if (dev->cell_info.data_force)
+	/* Publish on new values only if they moved more than the step, or on refresh */
+	if (dev->cell_info.cell_v_force) {
+		if (mqtt_cells_moved(dev->cell_info.cells_v, dev->mqtt.pub_cells_v, dev->mqtt.step_v))
+			dev->mqtt.cells_v->force = true;
+		dev->cell_info.cell_v_force = false;
+	}
+	if (dev->cell_info.cell_r_force) {
+		if (mqtt_cells_moved(dev->cell_info.cells_res, dev->mqtt.pub_cells_res, dev->mqtt.step_r))
+			dev->mqtt.cells_res->force = true;
+		dev->cell_info.cell_r_force = false;
+	}
+	if (dev->cell_info.data_force || (dev->cell_info.valid && mqtt_data_moved(dev)))
 		dev->mqtt.bms_data->force = true;
 	if (dev->cell_info.dev_force)
 		dev->mqtt.bms_info->force = true;
 
-	if (dev->mqtt.cells_v->force) {
+	/* Each message is refreshed on its own, regardless how often the others are sent */
+	mqtt_refresh_check(dev->mqtt.cells_v, now);
+	mqtt_refresh_check(dev->mqtt.cells_res, now);
+	mqtt_refresh_check(dev->mqtt.bms_data, now);
+	mqtt_refresh_check(dev->mqtt.bms_info, now);
+
+	/* One message per run */
+	if (dev->mqtt.cells_v->force)
 		mqtt_cells_v_send(dev);
-		goto out;
-	}
-	if (dev->mqtt.cells_res->force) {
+	else if (dev->mqtt.cells_res->force)
 		mqtt_cells_r_send(dev);
-		goto out;
-	}
-	if (dev->mqtt.bms_data->force) {
+	else if (dev->mqtt.bms_data->force)
 		mqtt_cells_data_send(dev);
-		goto out;
-	}
-	if (dev->mqtt.bms_info->force) {
+	else if (dev->mqtt.bms_info->force)
 		mqtt_dev_info_send(dev);
-		goto out;
-	}
-
-	if (dev->mqtt.last_send &&
-	    (now - dev->mqtt.last_send) < MQTT_SEND_INTERVAL_MS)
-		return;
-
-	if (dev->mqtt.send_id >= MQTT_SEND_MAX)
-		dev->mqtt.send_id = 0;
-
-	switch (dev->mqtt.send_id) {
-	case MQTT_SEND_CELL_V:
-		ret = mqtt_cells_v_send(dev);
-		break;
-	case MQTT_SEND_CELL_R:
-		ret = mqtt_cells_r_send(dev);
-		break;
-	case MQTT_SEND_DATA:
-		ret = mqtt_cells_data_send(dev);
-		break;
-	case MQTT_SEND_DEV:
-		ret = mqtt_dev_info_send(dev);
-		break;
-	default:
-		ret = 0;
-		break;
-	}
-	if (!ret)
-		dev->mqtt.send_id++;
-
-out:
-	dev->mqtt.last_send	= now;
 }
 
 #define MQTT_ADD_CELL_V(T, N) do {\
@@ -297,6 +325,13 @@ void bms_jk_mqtt_init(bms_context_t *ctx, int idx)
 	char *name, *templ, *mod_name;
 	int i = 0, j;
 
+	if (!mqtt->step_v)
+		mqtt->step_v = MQTT_STEP_V;
+	if (!mqtt->step_r)
+		mqtt->step_r = MQTT_STEP_R;
+	if (!mqtt->step_a)
+		mqtt->step_a = MQTT_STEP_A;
+
 	sys_asprintf(&mod_name, "%s%d", BMS_JK_MODULE, idx);
 	/* Cells V */
 	mqtt->cells_v = &mqtt->mqtt_comp[i];
@@ -9,6 +9,7 @@
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
 #include "hardware/adc.h"
+#include "hardware/dma.h"
 
 #include "herak_sys.h"
 #include "common_internal.h"
@@ -24,6 +25,16 @@
 /* Filter out the 5 biggest and the 5 smallest */
 #define MEASURE_DROP	5
 
+#define ADC_INPUTS		5
+/* Conversions per second, of all inputs in the round robin */
+#define ADC_SAMPLE_HZ	10000
+#define ADC_CLOCK_HZ	48000000
+/* Ring of 256 conversions, must hold MEASURE_COUNT rounds of all inputs */
+#define ADC_RING_BITS	9
+#define ADC_RING_LEN	((1 << ADC_RING_BITS) / sizeof(uint16_t))
+/* Rounds of the ring in one DMA run, ~22h at 3 inputs */
+#define ADC_RUN_ROUNDS	(1 << 20)
+
 static struct {
 	int gp_id;
 	int adc_id;
@@ -47,19 +58,137 @@ struct adc_sensor_t {
 	uint32_t raw;
 };
 
+/*
+ * The ADC converts all used inputs in round robin mode, and the DMA stores
+ * the conversions in a ring, wrapped by the hardware. When the data channel
+ * completes its run, it chains to the control channel that restarts it, so
+ * the sampling never stops and there is no interrupt. The length of the run
+ * is a multiple of the ring and of the inputs, so the position and the input
+ * of each conversion are known from the transfers done in the current run.
+ */
+static struct {
+	bool init;
+	int data_chan;
+	int ctrl_chan;
+	dma_channel_config data_cfg;
+	uint32_t mask;
+	int count;
+	int slot[ADC_INPUTS];
+	uint32_t run_len;
+	bool ready;
+	uint16_t ring[ADC_RING_LEN] __attribute__((aligned(1 << ADC_RING_BITS)));
+} adc_dma;
+
+static void adc_dma_start(void)
+{
+	int first = __builtin_ctz(adc_dma.mask);
+
+	adc_dma.run_len = ADC_RING_LEN * adc_dma.count * ADC_RUN_ROUNDS;
+	adc_dma.ready = false;
+	adc_select_input(first);
+	channel_config_set_chain_to(&adc_dma.data_cfg, adc_dma.ctrl_chan);
+	dma_channel_configure(adc_dma.data_chan, &adc_dma.data_cfg, adc_dma.ring, &adc_hw->fifo,
+			      adc_dma.run_len, true);
+	adc_run(true);
+}
+
+static void adc_dma_stop(void)
+{
+	/* Break the chain, the aborted data channel must not restart itself */
+	channel_config_set_chain_to(&adc_dma.data_cfg, adc_dma.data_chan);
+	dma_channel_set_config(adc_dma.data_chan, &adc_dma.data_cfg, false);
+	dma_channel_abort(adc_dma.ctrl_chan);
+	dma_channel_abort(adc_dma.data_chan);
+	adc_run(false);
+	while (!(adc_hw->cs & ADC_CS_READY_BITS))
+		tight_loop_contents();
+	adc_fifo_drain();
+}
+
 static void adc_sys_init(void)
 {
-	static bool init;
+	dma_channel_config cfg;
 
-	if (init)
+	if (adc_dma.init)
 		return;
 	adc_init();
 	adc_set_round_robin(0);
 	adc_irq_set_enabled(false);
 	adc_run(false);
 	adc_fifo_drain();
+	adc_fifo_setup(true, true, 1, false, false);
+	adc_set_clkdiv((ADC_CLOCK_HZ / ADC_SAMPLE_HZ) - 1);
 
-	init = true;
+	adc_dma.data_chan = dma_claim_unused_channel(true);
+	adc_dma.ctrl_chan = dma_claim_unused_channel(true);
+	adc_dma.data_cfg = dma_channel_get_default_config(adc_dma.data_chan);
+	channel_config_set_transfer_data_size(&adc_dma.data_cfg, DMA_SIZE_16);
+	channel_config_set_read_increment(&adc_dma.data_cfg, false);
+	channel_config_set_write_increment(&adc_dma.data_cfg, true);
+	channel_config_set_ring(&adc_dma.data_cfg, true, ADC_RING_BITS);
+	channel_config_set_dreq(&adc_dma.data_cfg, DREQ_ADC);
+
+	/* Reload the transfer count of the data channel, that triggers it again */
+	cfg = dma_channel_get_default_config(adc_dma.ctrl_chan);
+	channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+	channel_config_set_read_increment(&cfg, false);
+	channel_config_set_write_increment(&cfg, false);
+	dma_channel_configure(adc_dma.ctrl_chan, &cfg, &dma_hw->ch[adc_dma.data_chan].al1_transfer_count_trig,
+			      &adc_dma.run_len, 1, false);
+
+	adc_dma.init = true;
+}
+
+/* Add the input in the round robin and restart the conversions */
+static void adc_dma_input_add(unsigned int adc_id)
+{
+	unsigned int i;
+	int slot = 0;
+
+	if (adc_dma.mask & (1 << adc_id))
+		return;
+
+	if (adc_dma.count)
+		adc_dma_stop();
+	adc_dma.mask |= (1 << adc_id);
+	for (i = 0; i < ADC_INPUTS; i++) {
+		if (adc_dma.mask & (1 << i))
+			adc_dma.slot[i] = slot++;
+	}
+	adc_dma.count = slot;
+	adc_set_round_robin(adc_dma.count > 1 ? adc_dma.mask : 0);
+	adc_dma_start();
+}
+
+/* Conversions stored by the data channel in its current run */
+static uint32_t adc_dma_done(void)
+{
+	return adc_dma.run_len - dma_channel_hw_addr(adc_dma.data_chan)->transfer_count;
+}
+
+/* Copy the latest samples of the input from the ring */
+static bool adc_dma_samples_get(unsigned int adc_id, uint32_t *samples)
+{
+	uint32_t window = adc_dma.count * MEASURE_COUNT;
+	uint32_t done, last;
+	int i;
+
+	do {
+		done = adc_dma_done();
+		if (!adc_dma.ready) {
+			if (done < window)
+				return false;
+			adc_dma.ready = true;
+		}
+		/* The last conversion of the input, counted from the previous run */
+		last = done + adc_dma.run_len - 1;
+		last -= ((last % adc_dma.count) + adc_dma.count - adc_dma.slot[adc_id]) % adc_dma.count;
+		for (i = 0; i < MEASURE_COUNT; i++)
+			samples[i] = adc_dma.ring[(last - (i * adc_dma.count)) % ADC_RING_LEN];
+		/* Read again, if the DMA has overwritten the oldest samples meanwhile */
+	} while (((adc_dma_done() + adc_dma.run_len - done) % adc_dma.run_len) > ADC_RING_LEN - window);
+
+	return true;
 }
 
 struct adc_sensor_t *adc_sensor_init(int pin, double a, double b)
@@ -87,7 +216,9 @@ struct adc_sensor_t *adc_sensor_init(int pin, double a, double b)
 		return NULL;
 	memcpy(s, &sensor, sizeof(struct adc_sensor_t));
 	adc_sys_init();
-	adc_gpio_init(pin);
+	if (pin >= 0)
+		adc_gpio_init(pin);
+	adc_dma_input_add(s->adc_id);
 	return s;
 }
 
@@ -96,24 +227,14 @@ bool adc_sensor_measure(struct adc_sensor_t *sensor)
 	bool ret = false;
 	uint32_t av;
 	double val;
-	int p, i;
+	int p;
 
 	if (!sensor)
 		return false;
 
-	adc_select_input(sensor->adc_id);
-	if (adc_get_selected_input() != sensor->adc_id)
+	/* get the samples, converted in background */
+	if (!adc_dma_samples_get(sensor->adc_id, sensor->samples))
 		return false;
-	adc_fifo_drain();
-	sleep_us(20);
-	adc_read();
-	sleep_us(100);
-
-	/* read the samples */
-	for (i = 0; i < MEASURE_COUNT; i++) {
-		sensor->samples[i] = adc_read();
-		sleep_us(20);
-	}
 
 	/* filter biggest and smallest */
 	av = samples_filter(sensor->samples, MEASURE_COUNT, MEASURE_DROP);
@@ -177,48 +177,45 @@ static void flow_yf_reset(struct flow_yf_sensor *sensor)
 	}
 }
 
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int flow_yf_mqtt_data_send(struct flow_yf_context_t *ctx, int idx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
 	struct tm dt = {0};
+	json_writer_t js;
 	float tot = 0.0;
-	int count = 0;
 	int ret = -1;
 
-	ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\": \"%s\"", get_current_time_str(time_buff, TIME_STR));
-		ADD_MQTT_MSG_VAR(",\"flow\": \"%3.2f\"", ctx->sensors[idx]->flow);
-		if (ctx->sensors[idx]->send_total) {
-			tot = (float)ctx->sensors[idx]->total_ml / 1000.0; // ml -> l
-			flow_yf_reset(ctx->sensors[idx]);
-			ctx->sensors[idx]->send_total = false;
-		}
-		ADD_MQTT_MSG_VAR(",\"total\": \"%3.2f\"", tot);
-		if (ctx->sensors[idx]->last_reset_date) {
-			epoch2time(&ctx->sensors[idx]->last_reset_date, &dt);
-			time_to_str(time_buff, TIME_STR, &dt);
-			ADD_MQTT_MSG_VAR(",\"last_reset\": \"%s\"", time_buff);
-		} else {
-			ADD_MQTT_MSG(",\"last_reset\":\"N/A\"");
-		}
-		ADD_MQTT_MSG_VAR(",\"total_flow\": \"%3.2f\"", (float)ctx->sensors[idx]->total_flow_ml / 1000.0); // ml -> l
-		if (ctx->sensors[idx]->last_flow_date) {
-			epoch2time(&ctx->sensors[idx]->last_flow_date, &dt);
-			time_to_str(time_buff, TIME_STR, &dt);
-			ADD_MQTT_MSG_VAR(",\"last_flow\": \"%s\"", time_buff);
-		} else {
-			ADD_MQTT_MSG(",\"last_flow\":\"N/A\"");
-		}
-		ADD_MQTT_MSG_VAR(",\"duration_flow\": \"%lld\"", ctx->sensors[idx]->duration_ms / 60000); // ms -> min
-	ADD_MQTT_MSG("}")
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_float(&js, "flow", ctx->sensors[idx]->flow, 2);
+	if (ctx->sensors[idx]->send_total) {
+		tot = (float)ctx->sensors[idx]->total_ml / 1000.0; // ml -> l
+		flow_yf_reset(ctx->sensors[idx]);
+		ctx->sensors[idx]->send_total = false;
+	}
+	json_add_float(&js, "total", tot, 2);
+	if (ctx->sensors[idx]->last_reset_date) {
+		epoch2time(&ctx->sensors[idx]->last_reset_date, &dt);
+		time_to_str(time_buff, TIME_STR, &dt);
+		json_add_str(&js, "last_reset", time_buff);
+	} else {
+		json_add_str(&js, "last_reset", "N/A");
+	}
+	json_add_float(&js, "total_flow", (float)ctx->sensors[idx]->total_flow_ml / 1000.0, 2); // ml -> l
+	if (ctx->sensors[idx]->last_flow_date) {
+		epoch2time(&ctx->sensors[idx]->last_flow_date, &dt);
+		time_to_str(time_buff, TIME_STR, &dt);
+		json_add_str(&js, "last_flow", time_buff);
+	} else {
+		json_add_str(&js, "last_flow", "N/A");
+	}
+	json_add_uint(&js, "duration_flow", ctx->sensors[idx]->duration_ms / 60000); // ms -> min
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(&ctx->sensors[idx]->mqtt_comp[FLOW_YF_MQTT_FLOW], ctx->mqtt_payload);
 	ctx->sensors[idx]->force = false;
 
@@ -239,10 +236,8 @@ static void flow_yf_mqtt_send(struct flow_yf_context_t *ctx)
 			ctx->sensors[i]->mqtt_comp[FLOW_YF_MQTT_FLOW].force = true;
 
 	for (i = 0; i < ctx->count; i++) {
-		if (ctx->sensors[i]->mqtt_comp[FLOW_YF_MQTT_FLOW].force == true) {
+		if (ctx->sensors[i]->mqtt_comp[FLOW_YF_MQTT_FLOW].force == true)
 			flow_yf_mqtt_data_send(ctx, i);
-			return;
-		}
 	}
 
 	if ((now - ctx->mqtt_last_send) < MQTT_DELAY_MS)
@@ -260,7 +255,8 @@ static void flow_yf_sensor_data(struct flow_yf_context_t *ctx, int idx)
 	float interval;
 	uint32_t data;
 
-	if (now - sensor->last_read < MEASURE_TIME_MS)
+	/* Called on each MEASURE_TIME_MS, the flow is scaled to the actual time since the last read */
+	if (now == sensor->last_read)
 		return;
 
 	data = __atomic_exchange_n(&(sensor->pulse), 0, __ATOMIC_RELAXED);
@@ -448,6 +444,7 @@ void flow_yf_register(void)
 
 	ctx->mod.name = FLOW_YF_MODULE;
 	ctx->mod.run = flow_yf_run;
+	ctx->mod.run_interval_ms = MEASURE_TIME_MS;
 	ctx->mod.log = flow_yf_log;
 	ctx->mod.debug = flow_yf_debug_set;
 	ctx->mod.commands.hooks = flow_yf_requests;
@@ -50,6 +50,12 @@ struct one_wire_line {
 	uint64_t	meassure_last;
 	uint64_t	saved_mapping[ONEWIRE_SENORS_MAX];
 	struct one_wire_sensor sensors[ONEWIRE_SENORS_MAX];
+#ifdef HAVE_SYS_CORE1
+	/* The sensors are measured on core1, once detected on core0 */
+	core1_job_t	job;
+	bool		job_registered;
+	bool		job_ready;
+#endif /* HAVE_SYS_CORE1 */
 };
 
 struct one_wire_context_t {
@@ -170,35 +176,106 @@ static void one_wire_start_measure(struct one_wire_line *line)
 	line->meassure_now += time_ms_since_boot();
 }
 
+static void one_wire_sensor_update(struct one_wire_context_t *ctx, struct one_wire_line *line, int i, float val)
+{
+	line->sensors[i].valid = false;
+	if (val == One_wire::invalid_conversion) {
+		if (ctx->debug)
+			hlog_info(ONEWIRE_MODULE, "CRC error reading sensor 0x%llX on GPIO %d",
+					  line->sensors[i].address, line->pin);
+		line->sensors[i].err_stat++;
+	} else {
+		if (ctx->debug)
+			hlog_info(ONEWIRE_MODULE, "Got %3.2f°C from sensor 0x%llX on GPIO %d",
+					  val, line->sensors[i].address, line->pin);
+		line->sensors[i].valid = true;
+		if (line->sensors[i].temperature != val) {
+			line->sensors[i].mqtt_comp.force = true;
+			line->sensors[i].temperature = val;
+		}
+		line->sensors[i].ok_stat++;
+	}
+}
+
 static void one_wire_read_measure(struct one_wire_context_t *ctx, uint8_t idx)
 {
 	struct one_wire_line *line = ctx->lines[idx];
+	int i;
+
+	for (i = 0; i < ONEWIRE_SENORS_MAX; i++) {
+		if (!line->sensors[i].address)
+			continue;
+		one_wire_sensor_update(ctx, line, i, line->tempSensor->temperature(line->sensors[i].rom_addr));
+	}
+}
+
+#ifdef HAVE_SYS_CORE1
+struct one_wire_job_data {
+	uint32_t valid;
+	float temperature[ONEWIRE_SENORS_MAX];
+};
+static_assert(sizeof(struct one_wire_job_data) <= CORE1_DATA_MAX, "One-wire job data is too big");
+
+/* Runs on core1, the bus is not touched by core0 after the sensors are detected */
+static int one_wire_job_acquire(void *context, void *data)
+{
+	struct one_wire_job_data *res = (struct one_wire_job_data *)data;
+	struct one_wire_line *line = (struct one_wire_line *)context;
 	float val;
 	int i;
 
+	if (!__atomic_load_n(&line->job_ready, __ATOMIC_ACQUIRE))
+		return -1;
+	/* Wait for the conversion here, core0 is not blocked */
+	line->tempSensor->convert_temperature(line->sensors[0].rom_addr, true, true);
 	for (i = 0; i < ONEWIRE_SENORS_MAX; i++) {
 		if (!line->sensors[i].address)
 			continue;
-		line->sensors[i].valid = false;
 		val = line->tempSensor->temperature(line->sensors[i].rom_addr);
-		if (val == One_wire::invalid_conversion) {
-			if (ctx->debug)
-				hlog_info(ONEWIRE_MODULE, "CRC error reading sensor 0x%llX on GPIO %d",
-						  line->sensors[i].address, line->pin);
-			line->sensors[i].err_stat++;
-		} else {
-			if (ctx->debug)
-				hlog_info(ONEWIRE_MODULE, "Got %3.2f°C from sensor 0x%llX on GPIO %d",
-						  val, line->sensors[i].address, line->pin);
-			line->sensors[i].valid = true;
-			if (line->sensors[i].temperature != val) {
-				line->sensors[i].mqtt_comp.force = true;
-				line->sensors[i].temperature = val;
-			}
-			line->sensors[i].ok_stat++;
-		}
+		if (val == One_wire::invalid_conversion)
+			continue;
+		res->valid |= (1 << i);
+		res->temperature[i] = val;
+	}
+	return 0;
+}
+
+static void one_wire_job_collect(void *context, void *data)
+{
+	struct one_wire_job_data *res = (struct one_wire_job_data *)data;
+	struct one_wire_line *line = (struct one_wire_line *)context;
+	struct one_wire_context_t *ctx = one_wire_context_get();
+	float val;
+	int i;
+
+	for (i = 0; i < ONEWIRE_SENORS_MAX; i++) {
+		if (!line->sensors[i].address)
+			continue;
+		val = One_wire::invalid_conversion;
+		if (res->valid & (1 << i))
+			val = res->temperature[i];
+		one_wire_sensor_update(ctx, line, i, val);
+	}
+	line->meassure_last = time_ms_since_boot();
+}
+
+static void one_wire_jobs_register(struct one_wire_context_t *ctx)
+{
+	struct one_wire_line *line;
+	int i;
+
+	for (i = 0; i < ctx->count; i++) {
+		line = ctx->lines[i];
+		line->job.name = ONEWIRE_MODULE;
+		line->job.interval_ms = READ_INTERVAL_MS;
+		line->job.acquire = one_wire_job_acquire;
+		line->job.collect = one_wire_job_collect;
+		line->job.context = line;
+		/* Measured on core0, if there is no free job */
+		line->job_registered = !core1_job_register(&line->job);
 	}
 }
+#endif /* HAVE_SYS_CORE1 */
 
 static void one_wire_mqtt_init(struct one_wire_context_t *ctx, int line)
 {
@@ -279,6 +356,14 @@ static void one_wire_run(void *context)
 		goto out;
 	}
 
+#ifdef HAVE_SYS_CORE1
+	if (line->job_registered) {
+		/* Detected, hand the bus over to core1 */
+		__atomic_store_n(&line->job_ready, true, __ATOMIC_RELEASE);
+		goto out;
+	}
+#endif /* HAVE_SYS_CORE1 */
+
 	if (line->meassure_now) {
 		if (line->meassure_now > now)
 			goto out;
@@ -395,6 +480,9 @@ static bool one_wire_init(struct one_wire_context_t **ctx)
 
 	for (i = 0; i < (*ctx)->count; i++)
 		scount += one_wire_sensors_detect(*ctx, i);
+#ifdef HAVE_SYS_CORE1
+	one_wire_jobs_register(*ctx);
+#endif /* HAVE_SYS_CORE1 */
 
 	hlog_info(ONEWIRE_MODULE, "Initialise successfully %d lines with %d attached sensors",
 			  (*ctx)->count, scount);
@@ -299,6 +299,25 @@ typedef struct {
 	gpio_function_t pio_func;
 } pio_prog_t;
 
+enum ot_pio_state_t {
+	OT_PIO_IDLE = 0,
+	OT_PIO_WAIT,		/* Waiting for the minimal interval between the frames */
+	OT_PIO_EXCHANGE,	/* Frame is sent, waiting for the reply */
+	OT_PIO_FIND_WAIT,	/* Device lookup, waiting for the interval before the next frame */
+	OT_PIO_FIND,		/* Device lookup, frame is sent, waiting for the reply */
+};
+
+enum ot_frame_state_t {
+	OT_FRAME_SEND = 0,	/* Transmitter is running */
+	OT_FRAME_RECEIVE,	/* Frame is sent, receiver is running */
+};
+
+enum ot_find_phase_t {
+	OT_FIND_FREQ = 0,	/* Looking for a frequency with a valid reply */
+	OT_FIND_MIN,		/* Lowest frequency with a valid reply */
+	OT_FIND_MAX,		/* Highest frequency with a valid reply */
+};
+
 typedef struct {
 	int rx_hz;
 	uint32_t *log_mask;
@@ -307,6 +326,22 @@ typedef struct {
 	uint64_t last_valid;
 	pio_prog_t pio_rx;
 	pio_prog_t pio_tx;
+	/* Asynchronous exchange */
+	enum ot_pio_state_t state;
+	enum ot_frame_state_t frame_state;
+	uint64_t frame;
+	int retry;
+	uint64_t state_start;
+	uint64_t last_frame;
+	/* Asynchronous device lookup */
+	struct {
+		enum ot_find_phase_t phase;
+		int hz;
+		int step;
+		bool up;
+		int min;
+		int max;
+	} find;
 } opentherm_pio_t;
 
 typedef union {
@@ -319,9 +354,8 @@ typedef union {
 
 struct opentherm_context_type;
 
-typedef opentherm_cmd_response_t (*data_handler_t)(struct opentherm_context_type *ctx,
-												   opentherm_cmd_id_t cmd, ot_data_t *out,
-												   ot_data_t *in, bool write);
+/* Convert the data to the raw 16 bit OpenTherm value, or the raw value to data */
+typedef void (*data_handler_t)(ot_data_t *data, uint16_t *raw, bool encode);
 
 
 enum val_type {
@@ -346,13 +380,23 @@ typedef struct {
 	data_handler_t func;
 } ot_commands_t;
 
+#define OT_JOBS_MAX	4
+struct ot_job_t;
+
 typedef struct {
 	uint64_t last_send;
 	uint64_t last_dev_lookup;
+	bool dev_lookup;
 	uint64_t last_err_read;
 	uint64_t last_stat_read;
 	uint64_t last_cfg_read;
 	ot_commands_t ot_commands[DATA_ID_CMD_MAX];
+	/* Queue of commands, sent one by one from the run callback */
+	const struct ot_job_t *jobs[OT_JOBS_MAX];
+	int jobs_count;
+	int job_cmd;
+	bool job_busy;
+	bool flame_valid;
 } opentherm_dev_t;
 
 typedef struct opentherm_context_type {
@@ -384,8 +428,11 @@ void opentherm_reset_statistics(opentherm_context_t *ctx);
 
 int opentherm_dev_pio_init(opentherm_pio_t *pio);
 int opentherm_dev_pio_exchange(opentherm_pio_t *pio, opentherm_msg_t *request, opentherm_msg_t *reply);
+int opentherm_dev_pio_start(opentherm_pio_t *pio, opentherm_msg_t *request);
+int opentherm_dev_pio_poll(opentherm_pio_t *pio, opentherm_msg_t *reply);
 int opentherm_dev_pio_attached(opentherm_pio_t *pio);
-int opentherm_dev_pio_find(opentherm_pio_t *pio);
+int opentherm_dev_pio_find_start(opentherm_pio_t *pio);
+int opentherm_dev_pio_find_poll(opentherm_pio_t *pio);
 void opentherm_dev_pio_log(opentherm_pio_t *pio);
 
 void opentherm_mqtt_init(opentherm_context_t *ctx);
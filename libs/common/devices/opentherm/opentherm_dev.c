@@ -21,164 +21,115 @@
 
 #define FLAME_MIN_UA	10
 
-opentherm_cmd_response_t
-opentherm_dev_read(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, uint16_t send, uint16_t *value)
-{
-	opentherm_msg_t req = {0}, repl = {0};
-
-	req.id = cmd;
-	req.msg_type = MSG_TYPE_READ_DATA;
-	req.value = send;
-	if (opentherm_dev_pio_exchange(&ctx->pio, &req, &repl))
-		return CMD_RESPONSE_L1_ERR;
+struct ot_job_t {
+	const uint8_t *ids;
+	int count;
+	bool write;
+	/* Set the data to be sent, return false to skip the command */
+	bool (*prepare)(opentherm_context_t *ctx, int id, ot_data_t *out);
+	/* Handle the valid reply */
+	void (*apply)(opentherm_context_t *ctx, int id, ot_data_t *in);
+	/* Called when all commands are sent */
+	void (*done)(opentherm_context_t *ctx);
+};
 
-	if (repl.msg_type == MSG_TYPE_READ_ACK && repl.id == cmd) {
-		if (value)
-			*value = repl.value;
+static opentherm_cmd_response_t
+opentherm_reply_check(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, bool write, opentherm_msg_t *repl)
+{
+	if (repl->msg_type == (write ? MSG_TYPE_WRITE_ACK : MSG_TYPE_READ_ACK) && repl->id == cmd)
 		return CMD_RESPONSE_OK;
-	}
 
 	if (IS_CMD_LOG(ctx->log_mask))
-		hlog_warning(OTHM_MODULE, "Not expected read msg received for commands %d: %d",
-					 repl.id, repl.msg_type);
-	if (repl.msg_type == MSG_TYPE_DATA_INVALID)
+		hlog_warning(OTHM_MODULE, "Not expected %s msg received: cmd %d, type %d",
+					 write ? "write" : "read", repl->id, repl->msg_type);
+	if (repl->msg_type == MSG_TYPE_DATA_INVALID)
 		return CMD_RESPONSE_INVALID;
-	if (repl.msg_type == MSG_TYPE_UNKNOWN_DATA_ID)
+	if (repl->msg_type == MSG_TYPE_UNKNOWN_DATA_ID)
 		return CMD_RESPONSE_UNKNOWN;
 
 	return CMD_RESPONSE_WRONG_PARAM;
 }
 
-opentherm_cmd_response_t
-opentherm_dev_write(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, uint16_t send, uint16_t *value)
+static opentherm_cmd_response_t
+opentherm_dev_exchange(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, bool write, uint16_t send, uint16_t *value)
 {
 	opentherm_msg_t req = {0}, repl = {0};
+	opentherm_cmd_response_t ret;
 
 	req.id = cmd;
-	req.msg_type = MSG_TYPE_WRITE_DATA;
+	req.msg_type = write ? MSG_TYPE_WRITE_DATA : MSG_TYPE_READ_DATA;
 	req.value = send;
 	if (opentherm_dev_pio_exchange(&ctx->pio, &req, &repl))
 		return CMD_RESPONSE_L1_ERR;
 
-	if (repl.msg_type == MSG_TYPE_WRITE_ACK && repl.id == cmd) {
-		if (value)
-			*value = repl.value;
-		return CMD_RESPONSE_OK;
-	}
-
-	if (IS_CMD_LOG(ctx->log_mask))
-		hlog_warning(OTHM_MODULE, "Not expected write msg received: cmd %d, type %d",
-					 repl.id, repl.msg_type);
-
-	if (repl.msg_type == MSG_TYPE_DATA_INVALID)
-		return CMD_RESPONSE_INVALID;
-	if (repl.msg_type == MSG_TYPE_UNKNOWN_DATA_ID)
-		return CMD_RESPONSE_UNKNOWN;
-
-	return CMD_RESPONSE_WRONG_PARAM;
+	ret = opentherm_reply_check(ctx, cmd, write, &repl);
+	if (ret == CMD_RESPONSE_OK && value)
+		*value = repl.value;
+	return ret;
 }
 
-static opentherm_cmd_response_t
-opentherm_cmd_uint16(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, ot_data_t *out, ot_data_t *in, bool write)
+/* Blocking read, the periodic exchange with the device is done by the job queue */
+opentherm_cmd_response_t
+opentherm_dev_read(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, uint16_t send, uint16_t *value)
 {
-	opentherm_cmd_response_t ret;
-	uint16_t v = 0;
-
-	if (write)
-		ret = opentherm_dev_write(ctx, cmd, out?out->u16:0, &v);
-	else
-		ret = opentherm_dev_read(ctx, cmd, out?out->u16:0, &v);
-	if (ret != CMD_RESPONSE_OK)
-		return ret;
-
-	if (in)
-		in->u16 = v;
-	return ret;
+	return opentherm_dev_exchange(ctx, cmd, false, send, value);
 }
 
-static opentherm_cmd_response_t
-opentherm_cmd_int16(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, ot_data_t *out, ot_data_t *in, bool write)
+opentherm_cmd_response_t
+opentherm_dev_write(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, uint16_t send, uint16_t *value)
 {
-	opentherm_cmd_response_t ret;
-	uint16_t v = 0;
+	return opentherm_dev_exchange(ctx, cmd, true, send, value);
+}
 
-	if (write)
-		ret = opentherm_dev_write(ctx, cmd, out?out->u16:0, &v);
+static void opentherm_cmd_uint16(ot_data_t *data, uint16_t *raw, bool encode)
+{
+	if (encode)
+		*raw = data->u16;
 	else
-		ret = opentherm_dev_read(ctx, cmd, out?out->u16:0, &v);
-	if (ret != CMD_RESPONSE_OK)
-		return ret;
+		data->u16 = *raw;
+}
 
-	if (in) // Signed int16 conversion
-		in->i16 = (int16_t)((v ^ 0x8000) - 0x8000);
-	return ret;
+static void opentherm_cmd_int16(ot_data_t *data, uint16_t *raw, bool encode)
+{
+	if (encode)
+		*raw = data->u16;
+	else // Signed int16 conversion
+		data->i16 = (int16_t)((*raw ^ 0x8000) - 0x8000);
 }
 
-static opentherm_cmd_response_t
-opentherm_cmd_float(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, ot_data_t *out, ot_data_t *in, bool write)
+static void opentherm_cmd_float(ot_data_t *data, uint16_t *raw, bool encode)
 {
-	opentherm_cmd_response_t ret;
-	int16_t i16, s = 0;
-	uint16_t v = 0;
+	int16_t i16;
 
-	if (out) { // Fixed-point 8.8 conversion
-		if (out->f >= 0)
-			s = 0x100*out->f;
+	if (encode) { // Fixed-point 8.8 conversion
+		if (data->f >= 0)
+			*raw = 0x100*data->f;
 		else
-			s = 0x10000 - (0x100*out->f);
-	}
-	if (write)
-		ret = opentherm_dev_write(ctx, cmd, s, &v);
-	else
-		ret	= opentherm_dev_read(ctx, cmd, s, &v);
-	if (ret != CMD_RESPONSE_OK)
-		return ret;
-
-	if (in) { // Fixed-point 8.8 conversion
-		i16 = (int16_t)((v ^ 0x8000) - 0x8000);
-		in->f = (float)i16 / 256.0f;
+			*raw = 0x10000 - (0x100*data->f);
+	} else {
+		i16 = (int16_t)((*raw ^ 0x8000) - 0x8000);
+		data->f = (float)i16 / 256.0f;
 	}
-	return ret;
 }
 
-static opentherm_cmd_response_t
-opentherm_cmd_int8arr(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, ot_data_t *out, ot_data_t *in, bool write)
+static void opentherm_cmd_int8arr(ot_data_t *data, uint16_t *raw, bool encode)
 {
-	opentherm_cmd_response_t ret;
-	uint16_t v = 0;
-
-	if (write)
-		ret = opentherm_dev_write(ctx, cmd, out?out->u16:0, &v);
-	else
-		ret = opentherm_dev_read(ctx, cmd, out?out->u16:0, &v);
-	if (ret != CMD_RESPONSE_OK)
-		return ret;
-
-	if (in) { // Signed 8-bit conversion
-		in->i8arr[0] = (int8_t)(((v & 0xFF) ^ 0x80) - 0x80);
-		in->i8arr[1] = (int8_t)(((v >> 8) ^ 0x80) - 0x80);
+	if (encode) {
+		*raw = data->u16;
+	} else { // Signed 8-bit conversion
+		data->i8arr[0] = (int8_t)(((*raw & 0xFF) ^ 0x80) - 0x80);
+		data->i8arr[1] = (int8_t)(((*raw >> 8) ^ 0x80) - 0x80);
 	}
-	return ret;
 }
 
-static opentherm_cmd_response_t
-opentherm_cmd_uint8arr(opentherm_context_t *ctx, opentherm_cmd_id_t cmd, ot_data_t *out, ot_data_t *in, bool write)
+static void opentherm_cmd_uint8arr(ot_data_t *data, uint16_t *raw, bool encode)
 {
-	opentherm_cmd_response_t ret;
-	uint16_t v = 0;
-
-	if (write)
-		ret = opentherm_dev_write(ctx, cmd, out?out->u16:0, &v);
-	else
-		ret = opentherm_dev_read(ctx, cmd, out?out->u16:0, &v);
-	if (ret != CMD_RESPONSE_OK)
-		return ret;
-
-	if (in) { // Unsigned 8-bit conversion
-		in->u8arr[0] = (int8_t)((v & 0xFF));
-		in->u8arr[1] = (int8_t)((v >> 8));
+	if (encode) {
+		*raw = data->u16;
+	} else { // Unsigned 8-bit conversion
+		data->u8arr[0] = (int8_t)((*raw & 0xFF));
+		data->u8arr[1] = (int8_t)((*raw >> 8));
 	}
-	return ret;
 }
 
 static int ot_cmd_data_validate(struct val_limits *limits, ot_data_t *val)
@@ -208,48 +159,36 @@ static int ot_cmd_data_validate(struct val_limits *limits, ot_data_t *val)
 	return -1;
 }
 
-static int ot_cmd_read(opentherm_context_t *ctx, int id, ot_data_t *out, ot_data_t *in)
+static bool ot_cmd_allowed(opentherm_context_t *ctx, int id, bool write)
 {
-	ot_commands_t *cmd;
-	int ret;
-
 	if (id >= DATA_ID_CMD_MAX)
-		return -1;
-	if (!(ctx->dev.ot_commands[id].cmd_type & CMD_READ))
-		return -1;
-	if (!ctx->dev.ot_commands[id].supported)
-		return -1;
-	cmd = &ctx->dev.ot_commands[id];
-	ret = cmd->func(ctx, id, out, in, false);
-	if (ret == CMD_RESPONSE_UNKNOWN)
-		ctx->dev.ot_commands[id].supported--;
+		return false;
+	if (!(ctx->dev.ot_commands[id].cmd_type & (write ? CMD_WRITE : CMD_READ)))
+		return false;
 	if (!ctx->dev.ot_commands[id].supported)
-		hlog_warning(OTHM_MODULE, "Command %d is not supported by the OT device", id);
-	if (ret == CMD_RESPONSE_OK && ot_cmd_data_validate(&ctx->dev.ot_commands[id].limits, in))
-		ret = CMD_RESPONSE_WRONG_PARAM;
-
-	return  ret == CMD_RESPONSE_OK ? 0 : -1;
+		return false;
+	return true;
 }
 
-static int ot_cmd_write(opentherm_context_t *ctx, int id, ot_data_t *out, ot_data_t *in)
+/* Check the reply of a command and convert the received data */
+static int ot_cmd_reply(opentherm_context_t *ctx, int id, bool write, opentherm_msg_t *repl, ot_data_t *in)
 {
-	ot_commands_t *cmd;
-	int ret;
+	ot_commands_t *cmd = &ctx->dev.ot_commands[id];
+	opentherm_cmd_response_t ret;
 
-	if (id >= DATA_ID_CMD_MAX)
-		return -1;
-	if (!(ctx->dev.ot_commands[id].cmd_type & CMD_WRITE))
-		return -1;
-	if (!ctx->dev.ot_commands[id].supported)
-		return -1;
-	cmd = &ctx->dev.ot_commands[id];
-	ret = cmd->func(ctx, id, out, in, true);
+	ret = opentherm_reply_check(ctx, id, write, repl);
 	if (ret == CMD_RESPONSE_UNKNOWN)
-		ctx->dev.ot_commands[id].supported--;
-	if (!ctx->dev.ot_commands[id].supported)
+		cmd->supported--;
+	if (!cmd->supported)
 		hlog_warning(OTHM_MODULE, "Command %d is not supported by the OT device", id);
+	if (ret != CMD_RESPONSE_OK)
+		return -1;
 
-	return  ret == CMD_RESPONSE_OK ? 0 : -1;
+	cmd->func(in, &repl->value, false);
+	if (!write && ot_cmd_data_validate(&cmd->limits, in))
+		return -1;
+
+	return 0;
 }
 
 static void opentherm_gas_calc(opentherm_context_t *ctx)
@@ -288,228 +227,398 @@ static void opentherm_gas_calc(opentherm_context_t *ctx)
 
 #define DATA_READ(S, V)\
 	{ if ((S) != (V)) { ctx->data.data.force = true; (S) = (V); }}
-static bool opentherm_read_data(opentherm_context_t *ctx)
+static const uint8_t ot_data_ids[] = {
+	DATA_ID_FLAME_CURRENT, DATA_ID_REL_MOD_LEVEL, DATA_ID_CH_PRESSURE, DATA_ID_DHW_FLOW_RATE,
+	DATA_ID_TBOILER, DATA_ID_TDHW, DATA_ID_TRET, DATA_ID_TEXHAUST
+};
+static void opentherm_read_data(opentherm_context_t *ctx, int id, ot_data_t *repl)
 {
-	ot_data_t repl = {0};
-	bool flame = false;
-
-	if (!ot_cmd_read(ctx, DATA_ID_FLAME_CURRENT, NULL, &repl)) {
-		DATA_READ(ctx->data.data.flame_current, repl.f);
-		flame = true;
-	}
-	if (!ot_cmd_read(ctx, DATA_ID_REL_MOD_LEVEL, NULL, &repl)) {
-		DATA_READ(ctx->data.data.modulation_level, repl.f);
+	switch (id) {
+	case DATA_ID_FLAME_CURRENT:
+		DATA_READ(ctx->data.data.flame_current, repl->f);
+		ctx->dev.flame_valid = true;
+		break;
+	case DATA_ID_REL_MOD_LEVEL:
+		DATA_READ(ctx->data.data.modulation_level, repl->f);
 		if (ctx->data.data.modulation_level < 0)
 			ctx->data.data.modulation_level = 0;
-		if (flame && ctx->data.qmin > 0 && ctx->data.qmax > 0)
+		if (ctx->dev.flame_valid && ctx->data.qmin > 0 && ctx->data.qmax > 0)
 			opentherm_gas_calc(ctx);
+		break;
+	case DATA_ID_CH_PRESSURE:
+		DATA_READ(ctx->data.data.ch_pressure, repl->f);
+		break;
+	case DATA_ID_DHW_FLOW_RATE:
+		DATA_READ(ctx->data.data.dhw_flow_rate, repl->f);
+		break;
+	case DATA_ID_TBOILER:
+		DATA_READ(ctx->data.data.flow_temperature, repl->f);
+		break;
+	case DATA_ID_TDHW:
+		DATA_READ(ctx->data.data.dhw_temperature, repl->f);
+		break;
+	case DATA_ID_TRET:
+		DATA_READ(ctx->data.data.return_temperature, repl->f);
+		break;
+	case DATA_ID_TEXHAUST:
+		DATA_READ(ctx->data.data.exhaust_temperature, repl->f);
+		break;
+	default:
+		break;
 	}
-	if (!ot_cmd_read(ctx, DATA_ID_CH_PRESSURE, NULL, &repl))
-		DATA_READ(ctx->data.data.ch_pressure, repl.f);
-	if (!ot_cmd_read(ctx, DATA_ID_DHW_FLOW_RATE, NULL, &repl))
-		DATA_READ(ctx->data.data.dhw_flow_rate, repl.f);
-	if (!ot_cmd_read(ctx, DATA_ID_TBOILER, NULL, &repl))
-		DATA_READ(ctx->data.data.flow_temperature, repl.f);
-	if (!ot_cmd_read(ctx, DATA_ID_TDHW, NULL, &repl))
-		DATA_READ(ctx->data.data.dhw_temperature, repl.f);
-	if (!ot_cmd_read(ctx, DATA_ID_TRET, NULL, &repl))
-		DATA_READ(ctx->data.data.return_temperature, repl.f);
-	if (!ot_cmd_read(ctx, DATA_ID_TEXHAUST, NULL, &repl))
-		DATA_READ(ctx->data.data.exhaust_temperature, repl.f);
-
-	return true;
 }
 
-static int opentherm_sync_param_f(opentherm_context_t *ctx, int cmd, float *desired, float *actual)
+static void opentherm_read_data_done(opentherm_context_t *ctx)
 {
-	ot_data_t req = {0}, repl = {0};
-	int ret = 0;
+	ctx->dev.flame_valid = false;
+}
 
-	if (*desired != *actual) {
-		if (IS_CMD_LOG(ctx->log_mask))
-			hlog_info(OTHM_MODULE, "Sync parameter %d with device: desired %f vs actual %f", cmd, *desired, *actual);
-		req.f = *desired;
-		ret = ot_cmd_write(ctx, cmd, &req, &repl);
-		if (!ret)
-			*actual = repl.f;
+static const struct ot_job_t ot_job_data = {
+	ot_data_ids, ARRAY_SIZE(ot_data_ids), false, NULL, opentherm_read_data, opentherm_read_data_done
+};
+
+static const uint8_t ot_sync_ids[] = {
+	DATA_ID_MAXTSET, DATA_ID_TDHWSET, DATA_ID_TSET
+};
+static void opentherm_sync_param_get(opentherm_context_t *ctx, int id, float **desired, float **actual)
+{
+	switch (id) {
+	case DATA_ID_MAXTSET:
+		*desired = &ctx->data.param_desired.ch_max;
+		*actual = &ctx->data.param_actual.ch_max;
+		break;
+	case DATA_ID_TDHWSET:
+		*desired = &ctx->data.param_desired.dhw_temperature_setpoint;
+		*actual = &ctx->data.param_actual.dhw_temperature_setpoint;
+		break;
+	case DATA_ID_TSET:
+		*desired = &ctx->data.param_desired.ch_temperature_setpoint;
+		*actual = &ctx->data.param_actual.ch_temperature_setpoint;
+		break;
+	default:
+		*desired = NULL;
+		*actual = NULL;
+		break;
 	}
-	return ret;
 }
 
-static bool opentherm_sync_params(opentherm_context_t *ctx)
+static bool opentherm_sync_param_prepare(opentherm_context_t *ctx, int id, ot_data_t *req)
 {
-	opentherm_sync_param_f(ctx, DATA_ID_MAXTSET,
-						   &ctx->data.param_desired.ch_max,
-						   &ctx->data.param_actual.ch_max);
-	opentherm_sync_param_f(ctx, DATA_ID_TDHWSET,
-						   &ctx->data.param_desired.dhw_temperature_setpoint,
-						   &ctx->data.param_actual.dhw_temperature_setpoint);
-	opentherm_sync_param_f(ctx, DATA_ID_TSET,
-						   &ctx->data.param_desired.ch_temperature_setpoint,
-						   &ctx->data.param_actual.ch_temperature_setpoint);
+	float *desired, *actual;
 
+	opentherm_sync_param_get(ctx, id, &desired, &actual);
+	if (!desired || *desired == *actual)
+		return false;
+	if (IS_CMD_LOG(ctx->log_mask))
+		hlog_info(OTHM_MODULE, "Sync parameter %d with device: desired %f vs actual %f", id, *desired, *actual);
+	req->f = *desired;
 	return true;
 }
 
+static void opentherm_sync_param(opentherm_context_t *ctx, int id, ot_data_t *repl)
+{
+	float *desired, *actual;
+
+	opentherm_sync_param_get(ctx, id, &desired, &actual);
+	if (actual)
+		*actual = repl->f;
+}
+
+static const struct ot_job_t ot_job_sync = {
+	ot_sync_ids, ARRAY_SIZE(ot_sync_ids), true, opentherm_sync_param_prepare, opentherm_sync_param, NULL
+};
+
 #define ERRORS_READ(S, V)\
 	{ if ((S) != (V)) { ctx->data.errors.force = true; (S) = (V); }}
-static void opentherm_read_errors(opentherm_context_t *ctx)
+static const uint8_t ot_errors_ids[] = {
+	DATA_ID_ASF_FAULT, DATA_ID_UNSUCCESSFUL_BURNER_STARTS,
+	DATA_ID_FLAME_SIGNAL_LOW_COUNT, DATA_ID_OEM_DIAGNOSTIC_CODE
+};
+static void opentherm_read_errors(opentherm_context_t *ctx, int id, ot_data_t *repl)
 {
-	ot_data_t repl = {0};
-
-	if (!ot_cmd_read(ctx, DATA_ID_ASF_FAULT, NULL, &repl)) {
-		ERRORS_READ(ctx->data.errors.fault_code, repl.u8arr[0]);
-		ERRORS_READ(ctx->data.errors.fault_svc_needed, ((repl.u8arr[1] & 0x01) ? 1 : 0));
-		ERRORS_READ(ctx->data.errors.fault_low_water_pressure, ((repl.u8arr[1] & 0x04) ? 1 : 0));
-		ERRORS_READ(ctx->data.errors.fault_flame, ((repl.u8arr[1] & 0x08) ? 1 : 0));
-		ERRORS_READ(ctx->data.errors.fault_low_air_pressure, ((repl.u8arr[1] & 0x10) ? 1 : 0));
-		ERRORS_READ(ctx->data.errors.fault_high_water_temperature, ((repl.u8arr[1] & 0x20) ? 1 : 0));
+	switch (id) {
+	case DATA_ID_ASF_FAULT:
+		ERRORS_READ(ctx->data.errors.fault_code, repl->u8arr[0]);
+		ERRORS_READ(ctx->data.errors.fault_svc_needed, ((repl->u8arr[1] & 0x01) ? 1 : 0));
+		ERRORS_READ(ctx->data.errors.fault_low_water_pressure, ((repl->u8arr[1] & 0x04) ? 1 : 0));
+		ERRORS_READ(ctx->data.errors.fault_flame, ((repl->u8arr[1] & 0x08) ? 1 : 0));
+		ERRORS_READ(ctx->data.errors.fault_low_air_pressure, ((repl->u8arr[1] & 0x10) ? 1 : 0));
+		ERRORS_READ(ctx->data.errors.fault_high_water_temperature, ((repl->u8arr[1] & 0x20) ? 1 : 0));
+		break;
+	case DATA_ID_UNSUCCESSFUL_BURNER_STARTS:
+		ERRORS_READ(ctx->data.errors.fault_burner_starts, repl->u16);
+		break;
+	case DATA_ID_FLAME_SIGNAL_LOW_COUNT:
+		ERRORS_READ(ctx->data.errors.fault_flame_low, repl->u16);
+		break;
+	case DATA_ID_OEM_DIAGNOSTIC_CODE:
+		ERRORS_READ(ctx->data.errors.fault_oem_code, repl->u16);
+		break;
+	default:
+		break;
 	}
-	if (!ot_cmd_read(ctx, DATA_ID_UNSUCCESSFUL_BURNER_STARTS, NULL, &repl))
-		ERRORS_READ(ctx->data.errors.fault_burner_starts, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_FLAME_SIGNAL_LOW_COUNT, NULL, &repl))
-		ERRORS_READ(ctx->data.errors.fault_flame_low, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_OEM_DIAGNOSTIC_CODE, NULL, &repl))
-		ERRORS_READ(ctx->data.errors.fault_oem_code, repl.u16);
-
 }
 
+static const struct ot_job_t ot_job_errors = {
+	ot_errors_ids, ARRAY_SIZE(ot_errors_ids), false, NULL, opentherm_read_errors, NULL
+};
+
 #define STATUS_READ(S, V)\
 	{ if ((S) != (V)) { ctx->data.status.force = true; (S) = (V); }}
-static int opentherm_exchange_status(opentherm_context_t *ctx)
+static const uint8_t ot_status_ids[] = { DATA_ID_STATUS };
+static bool opentherm_status_prepare(opentherm_context_t *ctx, int id, ot_data_t *req)
 {
-	ot_data_t req = {0}, repl = {0};
-	int ret;
+	UNUSED(id);
 
 	if (ctx->data.status.ch_enabled)
-		req.u8arr[1] |= 0x01;
+		req->u8arr[1] |= 0x01;
 	if (ctx->data.status.dhw_enabled)
-		req.u8arr[1] |= 0x02;
+		req->u8arr[1] |= 0x02;
 	if (ctx->data.status.cooling_enabled)
-		req.u8arr[1] |= 0x04;
+		req->u8arr[1] |= 0x04;
 	if (ctx->data.status.otc_active)
-		req.u8arr[1] |= 0x08;
+		req->u8arr[1] |= 0x08;
 	if (ctx->data.status.ch2_enabled)
-		req.u8arr[1] |= 0x10;
+		req->u8arr[1] |= 0x10;
+
+	return true;
+}
+
+static void opentherm_exchange_status(opentherm_context_t *ctx, int id, ot_data_t *repl)
+{
+	UNUSED(id);
 
-	ret = ot_cmd_read(ctx, DATA_ID_STATUS, &req, &repl);
-	if (ret) {
-		if (IS_CMD_LOG(ctx->log_mask))
-			hlog_warning(OTHM_MODULE, "Failed to get valid status");
-		return ret;
-	}
 	if (IS_CMD_LOG(ctx->log_mask))
-		hlog_info(OTHM_MODULE, "Got valid status: %0X %0X", repl.u8arr[0], repl.u8arr[1]);
-	ERRORS_READ(ctx->data.errors.fault_active, ((repl.u8arr[0] & 0x01) ? 1 : 0));
-	STATUS_READ(ctx->data.status.ch_active, ((repl.u8arr[0] & 0x02) ? 1 : 0));
-	STATUS_READ(ctx->data.status.dhw_active, ((repl.u8arr[0] & 0x04) ? 1 : 0));
-	STATUS_READ(ctx->data.status.flame_active, ((repl.u8arr[0] & 0x08) ? 1 : 0));
-	STATUS_READ(ctx->data.status.cooling_active, ((repl.u8arr[0] & 0x10) ? 1 : 0));
-	STATUS_READ(ctx->data.status.ch2_active, ((repl.u8arr[0] & 0x20) ? 1 : 0));
-	ERRORS_READ(ctx->data.errors.diagnostic_event, ((repl.u8arr[0] & 0x40) ? 1 : 0));
-	return ret;
+		hlog_info(OTHM_MODULE, "Got valid status: %0X %0X", repl->u8arr[0], repl->u8arr[1]);
+	ERRORS_READ(ctx->data.errors.fault_active, ((repl->u8arr[0] & 0x01) ? 1 : 0));
+	STATUS_READ(ctx->data.status.ch_active, ((repl->u8arr[0] & 0x02) ? 1 : 0));
+	STATUS_READ(ctx->data.status.dhw_active, ((repl->u8arr[0] & 0x04) ? 1 : 0));
+	STATUS_READ(ctx->data.status.flame_active, ((repl->u8arr[0] & 0x08) ? 1 : 0));
+	STATUS_READ(ctx->data.status.cooling_active, ((repl->u8arr[0] & 0x10) ? 1 : 0));
+	STATUS_READ(ctx->data.status.ch2_active, ((repl->u8arr[0] & 0x20) ? 1 : 0));
+	ERRORS_READ(ctx->data.errors.diagnostic_event, ((repl->u8arr[0] & 0x40) ? 1 : 0));
 }
 
+static const struct ot_job_t ot_job_status = {
+	ot_status_ids, ARRAY_SIZE(ot_status_ids), false, opentherm_status_prepare, opentherm_exchange_status, NULL
+};
+
 #define CFG_READ(S, V)\
 	{ if ((S) != (V)) { ctx->data.dev_config.force = true; (S) = (V); }}
-static void opentherm_read_cfg_data(opentherm_context_t *ctx)
+static const uint8_t ot_cfg_ids[] = {
+	DATA_ID_MAXTSET_BOUNDS, DATA_ID_TDHWSET_BOUNDS, DATA_ID_MAXTSET
+};
+static void opentherm_read_cfg_data(opentherm_context_t *ctx, int id, ot_data_t *repl)
 {
-	ot_data_t repl = {0};
-
-	if (!ot_cmd_read(ctx, DATA_ID_MAXTSET_BOUNDS, NULL, &repl)) {
-		CFG_READ(ctx->data.dev_config.ch_max_cfg, repl.u8arr[1]);
-		CFG_READ(ctx->data.dev_config.ch_min_cfg, repl.u8arr[0]);
+	switch (id) {
+	case DATA_ID_MAXTSET_BOUNDS:
+		CFG_READ(ctx->data.dev_config.ch_max_cfg, repl->u8arr[1]);
+		CFG_READ(ctx->data.dev_config.ch_min_cfg, repl->u8arr[0]);
 		if (ctx->data.dev_config.ch_max_cfg) {
 			ctx->data.param_desired.ch_max = ctx->data.dev_config.ch_max_cfg;
 			ctx->data.dev_config.ch_temperature_setpoint_rangemax = ctx->data.dev_config.ch_max_cfg;
 		}
 		if (ctx->data.dev_config.ch_min_cfg > 0)
 			ctx->data.dev_config.ch_temperature_setpoint_rangemin = ctx->data.dev_config.ch_min_cfg;
-	}
-	if (!ot_cmd_read(ctx, DATA_ID_TDHWSET_BOUNDS, NULL, &repl)) {
-		CFG_READ(ctx->data.dev_config.dhw_max_cfg, repl.u8arr[1]);
-		CFG_READ(ctx->data.dev_config.dhw_min_cfg, repl.u8arr[0]);
+		break;
+	case DATA_ID_TDHWSET_BOUNDS:
+		CFG_READ(ctx->data.dev_config.dhw_max_cfg, repl->u8arr[1]);
+		CFG_READ(ctx->data.dev_config.dhw_min_cfg, repl->u8arr[0]);
 		if (ctx->data.dev_config.dhw_max_cfg) {
 			ctx->data.param_desired.dhw_max = ctx->data.dev_config.dhw_max_cfg;
 			ctx->data.dev_config.dhw_temperature_setpoint_rangemax = ctx->data.dev_config.dhw_max_cfg;
 		}
 		if (ctx->data.dev_config.dhw_min_cfg > 0)
 			ctx->data.dev_config.dhw_temperature_setpoint_rangemin = ctx->data.dev_config.dhw_min_cfg;
+		break;
+	case DATA_ID_MAXTSET:
+		CFG_READ(ctx->data.param_actual.ch_max, repl->f);
+		break;
+	default:
+		break;
 	}
-	if (!ot_cmd_read(ctx, DATA_ID_MAXTSET, NULL, &repl))
-		CFG_READ(ctx->data.param_actual.ch_max, repl.f);
-	//if (!ot_cmd_read(ctx, DATA_ID_TDHWSET, NULL, &repl))
-	//	CFG_READ(ctx->data.param_actual.dhw_max, repl.f);
 }
 
+static const struct ot_job_t ot_job_cfg = {
+	ot_cfg_ids, ARRAY_SIZE(ot_cfg_ids), false, NULL, opentherm_read_cfg_data, NULL
+};
+
 #define STATIC_READ(S, V)\
 	{ if ((S) != (V)) { ctx->data.dev_static.force = true; (S) = (V); }}
-static bool opentherm_read_static_data(opentherm_context_t *ctx)
-{
-	ot_data_t repl = {0};
-
-	if (!ot_cmd_read(ctx, DATA_ID_SECONDARY_CONFIG, NULL, &repl)) {
-		STATIC_READ(ctx->data.dev_static.dwh_present, ((repl.u8arr[1] & 0x01) ? 1 : 0));
-		STATIC_READ(ctx->data.dev_static.control_type, ((repl.u8arr[1] & 0x02) ? 1 : 0));
-		STATIC_READ(ctx->data.dev_static.cool_present, ((repl.u8arr[1] & 0x04) ? 1 : 0));
-		STATIC_READ(ctx->data.dev_static.dhw_config, ((repl.u8arr[1] & 0x08) ? 1 : 0));
-		STATIC_READ(ctx->data.dev_static.pump_control, ((repl.u8arr[1] & 0x10) ? 1 : 0));
-		STATIC_READ(ctx->data.dev_static.ch2_present, ((repl.u8arr[1] & 0x20) ? 1 : 0));
-		STATIC_READ(ctx->data.dev_static.dev_id, repl.u8arr[0]);
-	}
-	if (!ot_cmd_read(ctx, DATA_ID_SECONDARY_VERSION, NULL, &repl)) {
-		STATIC_READ(ctx->data.dev_static.dev_type, repl.u8arr[1]);
-		STATIC_READ(ctx->data.dev_static.dev_ver, repl.u8arr[0]);
+static const uint8_t ot_static_ids[] = {
+	DATA_ID_SECONDARY_CONFIG, DATA_ID_SECONDARY_VERSION, DATA_ID_OPENTHERM_VERSION_SECONDARY
+	// DATA_ID_BRAND, DATA_ID_BRAND_VER, DATA_ID_BRAD_SNUMBER
+};
+static void opentherm_read_static_data(opentherm_context_t *ctx, int id, ot_data_t *repl)
+{
+	switch (id) {
+	case DATA_ID_SECONDARY_CONFIG:
+		STATIC_READ(ctx->data.dev_static.dwh_present, ((repl->u8arr[1] & 0x01) ? 1 : 0));
+		STATIC_READ(ctx->data.dev_static.control_type, ((repl->u8arr[1] & 0x02) ? 1 : 0));
+		STATIC_READ(ctx->data.dev_static.cool_present, ((repl->u8arr[1] & 0x04) ? 1 : 0));
+		STATIC_READ(ctx->data.dev_static.dhw_config, ((repl->u8arr[1] & 0x08) ? 1 : 0));
+		STATIC_READ(ctx->data.dev_static.pump_control, ((repl->u8arr[1] & 0x10) ? 1 : 0));
+		STATIC_READ(ctx->data.dev_static.ch2_present, ((repl->u8arr[1] & 0x20) ? 1 : 0));
+		STATIC_READ(ctx->data.dev_static.dev_id, repl->u8arr[0]);
+		break;
+	case DATA_ID_SECONDARY_VERSION:
+		STATIC_READ(ctx->data.dev_static.dev_type, repl->u8arr[1]);
+		STATIC_READ(ctx->data.dev_static.dev_ver, repl->u8arr[0]);
+		break;
+	case DATA_ID_OPENTHERM_VERSION_SECONDARY:
+		STATIC_READ(ctx->data.dev_static.ot_ver, ((int)(100*repl->f)));
+		break;
+	default:
+		break;
 	}
-	if (!ot_cmd_read(ctx, DATA_ID_OPENTHERM_VERSION_SECONDARY, NULL, &repl))
-		STATIC_READ(ctx->data.dev_static.ot_ver, ((int)(100*repl.f)));
+}
 
-	// DATA_ID_BRAND, DATA_ID_BRAND_VER, DATA_ID_BRAD_SNUMBER
+static const struct ot_job_t ot_job_static = {
+	ot_static_ids, ARRAY_SIZE(ot_static_ids), false, NULL, opentherm_read_static_data, NULL
+};
+
+static const uint8_t ot_stats_reset_ids[] = {
+	DATA_ID_UNSUCCESSFUL_BURNER_STARTS, DATA_ID_FLAME_SIGNAL_LOW_COUNT,
+	DATA_ID_BURNER_STARTS, DATA_ID_CH_PUMP_STARTS, DATA_ID_DHW_PUMP_STARTS,
+	DATA_ID_DHW_BURNER_STARTS, DATA_ID_BURNER_OPERATION_HOURS, DATA_ID_CH_PUMP_OPERATION_HOURS,
+	DATA_ID_DHW_PUMP_OPERATION_HOURS, DATA_ID_DHW_BURNER_OPERATION_HOURS
+};
+static bool opentherm_stats_reset_prepare(opentherm_context_t *ctx, int id, ot_data_t *req)
+{
+	UNUSED(ctx);
+	UNUSED(id);
 
+	req->u16 = 0;
 	return true;
 }
 
-void opentherm_reset_statistics(opentherm_context_t *ctx)
+static void opentherm_stats_reset_done(opentherm_context_t *ctx)
 {
-	ot_data_t req = {0};
-
-	ot_cmd_write(ctx, DATA_ID_UNSUCCESSFUL_BURNER_STARTS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_FLAME_SIGNAL_LOW_COUNT, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_BURNER_STARTS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_CH_PUMP_STARTS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_DHW_PUMP_STARTS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_DHW_BURNER_STARTS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_BURNER_OPERATION_HOURS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_CH_PUMP_OPERATION_HOURS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_DHW_PUMP_OPERATION_HOURS, &req, NULL);
-	ot_cmd_write(ctx, DATA_ID_DHW_BURNER_OPERATION_HOURS, &req, NULL);
-
 	ctx->data.stats.stat_reset_time = time_ms_since_boot();
 	ctx->data.stats.force = true;
 }
 
+static const struct ot_job_t ot_job_stats_reset = {
+	ot_stats_reset_ids, ARRAY_SIZE(ot_stats_reset_ids), true,
+	opentherm_stats_reset_prepare, NULL, opentherm_stats_reset_done
+};
+
 #define STATISTIC_READ(S, V)\
 	{ if ((S) != (V)) { ctx->data.stats.force = true; (S) = (V); }}
-static void opentherm_read_statistics(opentherm_context_t *ctx)
-{
-	ot_data_t repl = {0};
-
-	if (!ot_cmd_read(ctx, DATA_ID_BURNER_STARTS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_burner_starts, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_CH_PUMP_STARTS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_ch_pump_starts, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_DHW_PUMP_STARTS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_dhw_pump_starts, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_DHW_BURNER_STARTS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_dhw_burn_burner_starts, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_BURNER_OPERATION_HOURS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_burner_hours, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_CH_PUMP_OPERATION_HOURS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_ch_pump_hours, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_DHW_PUMP_OPERATION_HOURS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_dhw_pump_hours, repl.u16);
-	if (!ot_cmd_read(ctx, DATA_ID_DHW_BURNER_OPERATION_HOURS, NULL, &repl))
-		STATISTIC_READ(ctx->data.stats.stat_dhw_burn_hours, repl.u16);
+static const uint8_t ot_stats_ids[] = {
+	DATA_ID_BURNER_STARTS, DATA_ID_CH_PUMP_STARTS, DATA_ID_DHW_PUMP_STARTS,
+	DATA_ID_DHW_BURNER_STARTS, DATA_ID_BURNER_OPERATION_HOURS, DATA_ID_CH_PUMP_OPERATION_HOURS,
+	DATA_ID_DHW_PUMP_OPERATION_HOURS, DATA_ID_DHW_BURNER_OPERATION_HOURS
+};
+static void opentherm_read_statistics(opentherm_context_t *ctx, int id, ot_data_t *repl)
+{
+	switch (id) {
+	case DATA_ID_BURNER_STARTS:
+		STATISTIC_READ(ctx->data.stats.stat_burner_starts, repl->u16);
+		break;
+	case DATA_ID_CH_PUMP_STARTS:
+		STATISTIC_READ(ctx->data.stats.stat_ch_pump_starts, repl->u16);
+		break;
+	case DATA_ID_DHW_PUMP_STARTS:
+		STATISTIC_READ(ctx->data.stats.stat_dhw_pump_starts, repl->u16);
+		break;
+	case DATA_ID_DHW_BURNER_STARTS:
+		STATISTIC_READ(ctx->data.stats.stat_dhw_burn_burner_starts, repl->u16);
+		break;
+	case DATA_ID_BURNER_OPERATION_HOURS:
+		STATISTIC_READ(ctx->data.stats.stat_burner_hours, repl->u16);
+		break;
+	case DATA_ID_CH_PUMP_OPERATION_HOURS:
+		STATISTIC_READ(ctx->data.stats.stat_ch_pump_hours, repl->u16);
+		break;
+	case DATA_ID_DHW_PUMP_OPERATION_HOURS:
+		STATISTIC_READ(ctx->data.stats.stat_dhw_pump_hours, repl->u16);
+		break;
+	case DATA_ID_DHW_BURNER_OPERATION_HOURS:
+		STATISTIC_READ(ctx->data.stats.stat_dhw_burn_hours, repl->u16);
+		break;
+	default:
+		break;
+	}
+}
+
+static const struct ot_job_t ot_job_stats = {
+	ot_stats_ids, ARRAY_SIZE(ot_stats_ids), false, NULL, opentherm_read_statistics, NULL
+};
+
+static int opentherm_job_add(opentherm_context_t *ctx, const struct ot_job_t *job)
+{
+	if (ctx->dev.jobs_count >= OT_JOBS_MAX)
+		return -1;
+	ctx->dev.jobs[ctx->dev.jobs_count++] = job;
+	return 0;
+}
+
+static void opentherm_job_next(opentherm_context_t *ctx)
+{
+	int i;
+
+	if (ctx->dev.jobs[0]->done)
+		ctx->dev.jobs[0]->done(ctx);
+	for (i = 1; i < ctx->dev.jobs_count; i++)
+		ctx->dev.jobs[i - 1] = ctx->dev.jobs[i];
+	ctx->dev.jobs_count--;
+	ctx->dev.job_cmd = 0;
+	if (!ctx->dev.jobs_count)
+		ctx->dev.last_send = time_ms_since_boot();
+}
+
+/* Send the commands from the queue, one exchange at a time. Never waits for the device */
+static void opentherm_jobs_run(opentherm_context_t *ctx)
+{
+	const struct ot_job_t *job = ctx->dev.jobs[0];
+	opentherm_msg_t req = {0}, repl = {0};
+	ot_data_t out, in;
+	int ret, id;
+
+	if (ctx->dev.job_busy) {
+		ret = opentherm_dev_pio_poll(&ctx->pio, &repl);
+		if (ret > 0)
+			return;
+		ctx->dev.job_busy = false;
+		id = job->ids[ctx->dev.job_cmd++];
+		memset(&in, 0, sizeof(in));
+		if (!ret && !ot_cmd_reply(ctx, id, job->write, &repl, &in)) {
+			if (job->apply)
+				job->apply(ctx, id, &in);
+		} else if (IS_CMD_LOG(ctx->log_mask)) {
+			hlog_warning(OTHM_MODULE, "Failed to %s command %d", job->write ? "write" : "read", id);
+		}
+		if (ctx->dev.job_cmd >= job->count)
+			opentherm_job_next(ctx);
+		return;
+	}
+
+	while (ctx->dev.job_cmd < job->count) {
+		id = job->ids[ctx->dev.job_cmd];
+		memset(&out, 0, sizeof(out));
+		if (!ot_cmd_allowed(ctx, id, job->write) ||
+		    (job->prepare && !job->prepare(ctx, id, &out))) {
+			ctx->dev.job_cmd++;
+			continue;
+		}
+		req.id = id;
+		req.msg_type = job->write ? MSG_TYPE_WRITE_DATA : MSG_TYPE_READ_DATA;
+		ctx->dev.ot_commands[id].func(&out, &req.value, true);
+		if (opentherm_dev_pio_start(&ctx->pio, &req))
+			break;
+		ctx->dev.job_busy = true;
+		return;
+	}
+
+	/* All commands are sent, or the device is detached */
+	opentherm_job_next(ctx);
+}
+
+void opentherm_reset_statistics(opentherm_context_t *ctx)
+{
+	if (opentherm_job_add(ctx, &ot_job_stats_reset))
+		hlog_warning(OTHM_MODULE, "Failed to reset the statistics, too many pending requests");
 }
 
 bool opentherm_dev_log(opentherm_context_t *ctx)
@@ -592,47 +701,63 @@ void opentherm_dev_run(opentherm_context_t *ctx)
 	uint64_t now = time_ms_since_boot();
 	static int find_attempts;
 	static bool cmd_static;
+	int ret;
 
 	if (!opentherm_dev_pio_attached(&ctx->pio)) {
-		if (find_attempts >= DEV_FIND_ATTEMPTS)
-			return;
-		if (ctx->dev.last_dev_lookup &&
-			(now - ctx->dev.last_dev_lookup) < DEV_FIND_INTERVAL_MS)
+		/* Drop the pending requests */
+		while (ctx->dev.jobs_count)
+			opentherm_job_next(ctx);
+		ctx->dev.job_busy = false;
+		if (!ctx->dev.dev_lookup) {
+			if (find_attempts >= DEV_FIND_ATTEMPTS)
+				return;
+			if (ctx->dev.last_dev_lookup &&
+				(now - ctx->dev.last_dev_lookup) < DEV_FIND_INTERVAL_MS)
+				return;
+			opentherm_dev_pio_find_start(&ctx->pio);
+			ctx->dev.dev_lookup = true;
+		}
+		/* Send one lookup frame at a time, without waiting for the reply */
+		ret = opentherm_dev_pio_find_poll(&ctx->pio);
+		if (ret > 0)
 			return;
-		opentherm_dev_pio_find(&ctx->pio);
+		ctx->dev.dev_lookup = false;
 		ctx->dev.last_dev_lookup = time_ms_since_boot();
-		if (!opentherm_dev_pio_attached(&ctx->pio)) {
+		if (ret) {
 			find_attempts++;
 			return;
 		}
 		find_attempts = 0;
 	}
 
+	if (ctx->dev.jobs_count) {
+		opentherm_jobs_run(ctx);
+		return;
+	}
+
 	if (!cmd_static) {
-		cmd_static = opentherm_read_static_data(ctx);
-		goto out;
+		cmd_static = true;
+		opentherm_job_add(ctx, &ot_job_static);
+		return;
 	}
 	if (ctx->dev.last_send &&
 	    (now - ctx->dev.last_send) < CMD_SEND_INTERVAL_MS)
 		return;
-	opentherm_exchange_status(ctx);
-	opentherm_sync_params(ctx);
+	opentherm_job_add(ctx, &ot_job_status);
+	opentherm_job_add(ctx, &ot_job_sync);
 
 	if ((now - ctx->dev.last_cfg_read) > CMD_CFG_INTERVAL_MS) {
-		opentherm_read_cfg_data(ctx);
-		ctx->dev.last_cfg_read = time_ms_since_boot();
+		opentherm_job_add(ctx, &ot_job_cfg);
+		ctx->dev.last_cfg_read = now;
 	} else if ((now - ctx->dev.last_err_read) > CMD_ERR_INTERVAL_MS) {
-		opentherm_read_errors(ctx);
-		ctx->dev.last_err_read = time_ms_since_boot();
+		opentherm_job_add(ctx, &ot_job_errors);
+		ctx->dev.last_err_read = now;
 	} else if ((now - ctx->dev.last_stat_read) > CMD_STATS_INTERVAL_MS) {
-		opentherm_read_statistics(ctx);
-		ctx->dev.last_stat_read = time_ms_since_boot();
+		opentherm_job_add(ctx, &ot_job_stats);
+		ctx->dev.last_stat_read = now;
 	} else {
-		opentherm_read_data(ctx);
+		opentherm_job_add(ctx, &ot_job_data);
 	}
-
-out:
-	ctx->dev.last_send = time_ms_since_boot();
 }
 
 #define CMD_ARR_INIT(A, I, T, F, TYPE, MIN, MAX) do {\
@@ -13,48 +13,45 @@
 #define MQTT_SEND_INTERVAL_MS 10000
 #define IS_CMD_LOG(C) ((C) && LOG_MQTT_DEBUG)
 
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("MQTT %s: Buffer full\n\r", __func__); return -1; } \
-				count += snprintf(ctx->mqtt.payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("MQTT %s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt.payload + count, len - count, _S_, __VA_ARGS__); }
 static int mqtt_data_send(opentherm_context_t *ctx)
 {
 	static char time_buff[TIME_STR];
-	int len = OTH_MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
 	/* Data */
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"ch_set\":%3.2f", ctx->data.param_actual.ch_temperature_setpoint);
-	ADD_MQTT_MSG_VAR(",\"dhw_set\":%3.2f", ctx->data.param_actual.dhw_temperature_setpoint);
-	ADD_MQTT_MSG_VAR(",\"ch\":%d", ctx->data.status.ch_active);
-	ADD_MQTT_MSG_VAR(",\"dhw\":%d", ctx->data.status.dhw_active);
-	ADD_MQTT_MSG_VAR(",\"ch_enabled\":%d", ctx->data.status.ch_enabled);
-	ADD_MQTT_MSG_VAR(",\"dhw_enabled\":%d", ctx->data.status.dhw_enabled);
-	ADD_MQTT_MSG_VAR(",\"flame\":%d", ctx->data.status.flame_active);
-	ADD_MQTT_MSG_VAR(",\"flow_temp\":%3.2f", ctx->data.data.flow_temperature);
-	ADD_MQTT_MSG_VAR(",\"ret_temp\":%3.2f", ctx->data.data.return_temperature);
-	ADD_MQTT_MSG_VAR(",\"exh_temp\":%d", ctx->data.data.exhaust_temperature);
-	ADD_MQTT_MSG_VAR(",\"dhw_temp\":%3.2f", ctx->data.data.dhw_temperature);
-	ADD_MQTT_MSG_VAR(",\"ch_press\":%3.2f", ctx->data.data.ch_pressure);
-	ADD_MQTT_MSG_VAR(",\"mdl_level\":%3.2f", ctx->data.data.modulation_level);
-	ADD_MQTT_MSG_VAR(",\"gas_flow\":%3.6f", ctx->data.data.gas_flow * 60 * 60); // L/h
+	json_begin(&js, ctx->mqtt.payload, OTH_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_float(&js, "ch_set", ctx->data.param_actual.ch_temperature_setpoint, 2);
+	json_add_float(&js, "dhw_set", ctx->data.param_actual.dhw_temperature_setpoint, 2);
+	json_add_int(&js, "ch", ctx->data.status.ch_active);
+	json_add_int(&js, "dhw", ctx->data.status.dhw_active);
+	json_add_int(&js, "ch_enabled", ctx->data.status.ch_enabled);
+	json_add_int(&js, "dhw_enabled", ctx->data.status.dhw_enabled);
+	json_add_int(&js, "flame", ctx->data.status.flame_active);
+	json_add_float(&js, "flow_temp", ctx->data.data.flow_temperature, 2);
+	json_add_float(&js, "ret_temp", ctx->data.data.return_temperature, 2);
+	json_add_int(&js, "exh_temp", ctx->data.data.exhaust_temperature);
+	json_add_float(&js, "dhw_temp", ctx->data.data.dhw_temperature, 2);
+	json_add_float(&js, "ch_press", ctx->data.data.ch_pressure, 2);
+	json_add_float(&js, "mdl_level", ctx->data.data.modulation_level, 2);
+	json_add_float(&js, "gas_flow", ctx->data.data.gas_flow * 60 * 60, 3); // L/h
 	if (ctx->data.gas_send) {
-		ADD_MQTT_MSG_VAR(",\"gas_total\":%3.6f", ctx->data.gas_total);
+		json_add_float(&js, "gas_total", ctx->data.gas_total, 3);
 		ctx->data.gas_send = false;
 		ctx->data.gas_total = 0;
 		ctx->data.gas_reset = time_ms_since_boot();
 	}
-	ADD_MQTT_MSG_VAR(",\"flame_ua\":%3.2f", ctx->data.data.flame_current);
-	ADD_MQTT_MSG_VAR(",\"ch_max\":%d", ctx->data.dev_config.ch_max_cfg);
-	ADD_MQTT_MSG_VAR(",\"ch_min\":%d", ctx->data.dev_config.ch_min_cfg);
-	ADD_MQTT_MSG_VAR(",\"dhw_max\":%d", ctx->data.dev_config.dhw_max_cfg);
-	ADD_MQTT_MSG_VAR(",\"dhw_min\":%d", ctx->data.dev_config.dhw_min_cfg);
-	ADD_MQTT_MSG("}");
+	json_add_float(&js, "flame_ua", ctx->data.data.flame_current, 2);
+	json_add_int(&js, "ch_max", ctx->data.dev_config.ch_max_cfg);
+	json_add_int(&js, "ch_min", ctx->data.dev_config.ch_min_cfg);
+	json_add_int(&js, "dhw_max", ctx->data.dev_config.dhw_max_cfg);
+	json_add_int(&js, "dhw_min", ctx->data.dev_config.dhw_min_cfg);
+	if (json_end(&js) < 0) {
+		printf("MQTT %s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt.payload[OTH_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(ctx->mqtt.data, ctx->mqtt.payload);
 	ctx->data.data.force = false;
 	ctx->data.status.force = false;
@@ -68,26 +65,27 @@ static int mqtt_data_send(opentherm_context_t *ctx)
 static int mqtt_errors_send(opentherm_context_t *ctx)
 {
 	static char time_buff[TIME_STR];
-	int len = OTH_MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"diag\":%d", ctx->data.errors.diagnostic_event);
-	ADD_MQTT_MSG_VAR(",\"service\":%d", ctx->data.errors.fault_svc_needed);
-	ADD_MQTT_MSG_VAR(",\"fault\":%d", ctx->data.errors.fault_active);
-	ADD_MQTT_MSG_VAR(",\"fault_lwp\":%d", ctx->data.errors.fault_low_water_pressure);
-	ADD_MQTT_MSG_VAR(",\"fault_fl\":%d", ctx->data.errors.fault_flame);
-	ADD_MQTT_MSG_VAR(",\"fault_lap\":%d", ctx->data.errors.fault_low_air_pressure);
-	ADD_MQTT_MSG_VAR(",\"fault_hwt\":%d", ctx->data.errors.fault_high_water_temperature);
-	ADD_MQTT_MSG_VAR(",\"fault_code\":%2d", ctx->data.errors.fault_code);
-	ADD_MQTT_MSG_VAR(",\"fault_burn_start\":%2d", ctx->data.errors.fault_burner_starts);
-	ADD_MQTT_MSG_VAR(",\"fault_low_flame\":%2d", ctx->data.errors.fault_flame_low);
-	ADD_MQTT_MSG_VAR(",\"fault_oem_code\":%2d", ctx->data.errors.fault_oem_code);
-	ADD_MQTT_MSG("}");
+	json_begin(&js, ctx->mqtt.payload, OTH_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_int(&js, "diag", ctx->data.errors.diagnostic_event);
+	json_add_int(&js, "service", ctx->data.errors.fault_svc_needed);
+	json_add_int(&js, "fault", ctx->data.errors.fault_active);
+	json_add_int(&js, "fault_lwp", ctx->data.errors.fault_low_water_pressure);
+	json_add_int(&js, "fault_fl", ctx->data.errors.fault_flame);
+	json_add_int(&js, "fault_lap", ctx->data.errors.fault_low_air_pressure);
+	json_add_int(&js, "fault_hwt", ctx->data.errors.fault_high_water_temperature);
+	json_add_int(&js, "fault_code", ctx->data.errors.fault_code);
+	json_add_int(&js, "fault_burn_start", ctx->data.errors.fault_burner_starts);
+	json_add_int(&js, "fault_low_flame", ctx->data.errors.fault_flame_low);
+	json_add_int(&js, "fault_oem_code", ctx->data.errors.fault_oem_code);
+	if (json_end(&js) < 0) {
+		printf("MQTT %s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt.payload[OTH_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(ctx->mqtt.errors, ctx->mqtt.payload);
 	if (IS_CMD_LOG(ctx->log_mask))
 		hlog_info(OTHM_MODULE, "Published %d bytes MQTT errors: %d / %d",
@@ -99,27 +97,28 @@ static int mqtt_errors_send(opentherm_context_t *ctx)
 static int mqtt_stats_send(opentherm_context_t *ctx)
 {
 	static char time_buff[TIME_STR];
-	int len = OTH_MQTT_DATA_LEN;
 	struct tm dt = {0};
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
 	/* Stats  */
-	ADD_MQTT_MSG("{");
+	json_begin(&js, ctx->mqtt.payload, OTH_MQTT_DATA_LEN + 1);
 	time_msec2datetime(&dt, time_ms_since_boot() - ctx->data.stats.stat_reset_time);
-	ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"stat_reset_time\":\"%s\"", time_date2str(time_buff, TIME_STR, &dt));
-	ADD_MQTT_MSG_VAR(",\"burner_starts\":%2d", ctx->data.stats.stat_burner_starts);
-	ADD_MQTT_MSG_VAR(",\"ch_pump_starts\":%2d", ctx->data.stats.stat_ch_pump_starts);
-	ADD_MQTT_MSG_VAR(",\"dhw_pump_starts\":%2d", ctx->data.stats.stat_dhw_pump_starts);
-	ADD_MQTT_MSG_VAR(",\"dhw_burner_starts\":%2d", ctx->data.stats.stat_dhw_burn_burner_starts);
-	ADD_MQTT_MSG_VAR(",\"burner_hours\":%2d", ctx->data.stats.stat_burner_hours);
-	ADD_MQTT_MSG_VAR(",\"ch_pump_hours\":%2d", ctx->data.stats.stat_ch_pump_hours);
-	ADD_MQTT_MSG_VAR(",\"dhw_pump_hours\":%2d", ctx->data.stats.stat_dhw_pump_hours);
-	ADD_MQTT_MSG_VAR(",\"dhw_burner_hours\":%2d", ctx->data.stats.stat_dhw_burn_hours);
-	ADD_MQTT_MSG("}");
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_str(&js, "stat_reset_time", time_date2str(time_buff, TIME_STR, &dt));
+	json_add_int(&js, "burner_starts", ctx->data.stats.stat_burner_starts);
+	json_add_int(&js, "ch_pump_starts", ctx->data.stats.stat_ch_pump_starts);
+	json_add_int(&js, "dhw_pump_starts", ctx->data.stats.stat_dhw_pump_starts);
+	json_add_int(&js, "dhw_burner_starts", ctx->data.stats.stat_dhw_burn_burner_starts);
+	json_add_int(&js, "burner_hours", ctx->data.stats.stat_burner_hours);
+	json_add_int(&js, "ch_pump_hours", ctx->data.stats.stat_ch_pump_hours);
+	json_add_int(&js, "dhw_pump_hours", ctx->data.stats.stat_dhw_pump_hours);
+	json_add_int(&js, "dhw_burner_hours", ctx->data.stats.stat_dhw_burn_hours);
+	if (json_end(&js) < 0) {
+		printf("MQTT %s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt.payload[OTH_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(ctx->mqtt.stats, ctx->mqtt.payload);
 	if (IS_CMD_LOG(ctx->log_mask))
 		hlog_info(OTHM_MODULE, "Published %d bytes MQTT statistics: %d / %d",
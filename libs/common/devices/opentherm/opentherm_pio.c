@@ -47,10 +47,9 @@ static int opentherm_frame_decode(opentherm_pio_t *pio, uint32_t frame, openther
 	return 0;
 }
 
-static int opentherm_exchange_frame(opentherm_pio_t *pio, uint64_t out, uint32_t *in)
+// Start sending a frame, the receiver is enabled by opentherm_frame_poll() when the frame is sent
+static void opentherm_frame_start(opentherm_pio_t *pio, uint64_t out)
 {
-	uint64_t tstart;
-
 	// Setup PIO
 	pio_sm_init(pio->pio_tx.p, pio->pio_tx.sm, pio->pio_tx.offset, &pio->pio_tx.cfg);
 	pio_sm_init(pio->pio_rx.p, pio->pio_rx.sm, pio->pio_rx.offset, &pio->pio_rx.cfg);
@@ -60,37 +59,46 @@ static int opentherm_exchange_frame(opentherm_pio_t *pio, uint64_t out, uint32_t
 	while (pio_sm_get_rx_fifo_level(pio->pio_rx.p, pio->pio_rx.sm) > 0)
 		pio_sm_get(pio->pio_rx.p, pio->pio_rx.sm);
 
-	// Send data using transmitter PIO
+	// Send data using transmitter PIO, the FIFO is empty and it does not block
 	pio_sm_put_blocking(pio->pio_tx.p, pio->pio_tx.sm, (uint32_t)(out >> 32));
 	pio_sm_put_blocking(pio->pio_tx.p, pio->pio_tx.sm, (uint32_t)(out));
 	pio_sm_set_enabled(pio->pio_tx.p, pio->pio_tx.sm, true);
 
-	// Wait for TX to finish
-	tstart = time_ms_since_boot();
-	while (pio_sm_get_tx_fifo_level(pio->pio_tx.p, pio->pio_tx.sm) > 0) {
-		tight_loop_contents();
-		if (time_ms_since_boot() - tstart > OT_TIMEOUT_MS) {
+	pio->frame_state = OT_FRAME_SEND;
+	pio->state_start = time_ms_since_boot();
+}
+
+// Drive the frame exchange, never blocks.
+// Returns 1 if in progress, 0 if a reply is read, -1 on send and -2 on receive timeout
+static int opentherm_frame_poll(opentherm_pio_t *pio, uint32_t *in)
+{
+	uint64_t now = time_ms_since_boot();
+	int ret = 0;
+
+	if (pio->frame_state == OT_FRAME_SEND) {
+		if (pio_sm_get_tx_fifo_level(pio->pio_tx.p, pio->pio_tx.sm) > 0) {
+			if ((now - pio->state_start) <= OT_TIMEOUT_MS)
+				return 1;
 			// Time Out sending the request
-			pio_sm_set_enabled(pio->pio_tx.p, pio->pio_tx.sm, false);
-			return -1;
+			ret = -1;
+		} else {
+			// Wait for response
+			pio_sm_set_enabled(pio->pio_rx.p, pio->pio_rx.sm, true);
+			pio->frame_state = OT_FRAME_RECEIVE;
+			pio->state_start = now;
+			return 1;
 		}
-	}
-
-	// Wait for response
-	pio_sm_set_enabled(pio->pio_rx.p, pio->pio_rx.sm, true);
-	tstart = time_ms_since_boot();
-	while (pio_sm_get_rx_fifo_level(pio->pio_rx.p, pio->pio_rx.sm) < 3 &&
-		(time_ms_since_boot() - tstart) < OT_TIMEOUT_MS) {
-		sleep_ms(1);
+	} else if (pio_sm_get_rx_fifo_level(pio->pio_rx.p, pio->pio_rx.sm) < 3) {
+		if ((now - pio->state_start) < OT_TIMEOUT_MS)
+			return 1;
+		ret = -2;
 	}
 
 	pio_sm_set_enabled(pio->pio_tx.p, pio->pio_tx.sm, false);
 	pio_sm_set_enabled(pio->pio_rx.p, pio->pio_rx.sm, false);
+	if (ret)
+		return ret;
 
-
-	// Check timeout
-	if (pio_sm_get_rx_fifo_level(pio->pio_rx.p, pio->pio_rx.sm) < 3)
-		return -2;
 	// Read response
 	in[0] = pio_sm_get(pio->pio_rx.p, pio->pio_rx.sm);
 	in[1] = pio_sm_get(pio->pio_rx.p, pio->pio_rx.sm);
@@ -100,22 +108,12 @@ static int opentherm_exchange_frame(opentherm_pio_t *pio, uint64_t out, uint32_t
 }
 
 #define END_BIT 0x80000000
-// OpenTherm exchange function
-static int opentherm_exchange_run(opentherm_pio_t *pio, opentherm_msg_t *request, opentherm_msg_t *reply)
+// Decode the received frame
+static int opentherm_reply_decode(opentherm_pio_t *pio, uint32_t *in, opentherm_msg_t *reply)
 {
-	uint32_t f = opentherm_frame_encode(request->msg_type, request->id, request->value);
-	uint64_t m = manchester_encode(f, true);
-	uint32_t in[3];
-	int ret;
-
-	ret = opentherm_exchange_frame(pio, m, in);
-	if (ret) {
-		if (IS_PIO_LOG(pio->log_mask))
-			hlog_warning(OTHM_MODULE, "> PIO %s frame timeout.\n", ret == -1 ? "send":"receive");
-		return -1;
-	}
+	uint64_t m;
+	uint32_t f;
 
-	// Decode response
 	if (in[2] != END_BIT) {
 		if (IS_PIO_LOG(pio->log_mask))
 			hlog_warning(OTHM_MODULE, "> PIO no valid EndBit received: 0x%X.\n", in[2]);
@@ -133,23 +131,59 @@ static int opentherm_exchange_run(opentherm_pio_t *pio, opentherm_msg_t *request
 	return opentherm_frame_decode(pio, f, reply);
 }
 
-int opentherm_dev_pio_exchange(opentherm_pio_t *pio, opentherm_msg_t *request, opentherm_msg_t *reply)
+// Queue a request, it is sent by opentherm_dev_pio_poll()
+int opentherm_dev_pio_start(opentherm_pio_t *pio, opentherm_msg_t *request)
 {
-	int retry = MAX_RETRIES;
+	uint32_t f;
 
 	if (!pio->attached)
 		return -1;
 
-	do {
-		sleep_ms(MIN_INTERVAL_MS);
-		wd_update();
-		if (!opentherm_exchange_run(pio, request, reply)) {
-			pio->last_valid = time_ms_since_boot();
+	f = opentherm_frame_encode(request->msg_type, request->id, request->value);
+	pio->frame = manchester_encode(f, true);
+	pio->retry = MAX_RETRIES;
+	pio->state = OT_PIO_WAIT;
+
+	return 0;
+}
+
+// Drive the exchange, never blocks. Returns 1 if in progress, 0 if a valid reply is received
+int opentherm_dev_pio_poll(opentherm_pio_t *pio, opentherm_msg_t *reply)
+{
+	uint64_t now = time_ms_since_boot();
+	uint32_t in[3];
+	int ret;
+
+	switch (pio->state) {
+	case OT_PIO_WAIT:
+		if (pio->last_frame && (now - pio->last_frame) < MIN_INTERVAL_MS)
+			return 1;
+		opentherm_frame_start(pio, pio->frame);
+		pio->state = OT_PIO_EXCHANGE;
+		return 1;
+	case OT_PIO_EXCHANGE:
+		ret = opentherm_frame_poll(pio, in);
+		if (ret > 0)
+			return 1;
+		pio->last_frame = now;
+		if (ret) {
+			if (IS_PIO_LOG(pio->log_mask))
+				hlog_warning(OTHM_MODULE, "> PIO %s frame timeout.\n", ret == -1 ? "send":"receive");
+		} else if (!opentherm_reply_decode(pio, in, reply)) {
+			pio->last_valid = pio->last_frame;
+			pio->state = OT_PIO_IDLE;
 			return 0;
 		}
-		retry--;
-	} while (retry > 0);
+		if (--pio->retry > 0) {
+			pio->state = OT_PIO_WAIT;
+			return 1;
+		}
+		break;
+	default:
+		return -1;
+	}
 
+	pio->state = OT_PIO_IDLE;
 	if ((time_ms_since_boot() - pio->last_valid) > DEAD_INTERVAL_MS) {
 		if (IS_PIO_LOG(pio->log_mask))
 			hlog_warning(OTHM_MODULE, "PIO connection lost.");
@@ -159,96 +193,158 @@ int opentherm_dev_pio_exchange(opentherm_pio_t *pio, opentherm_msg_t *request, o
 	return -1;
 }
 
-int opentherm_dev_pio_find(opentherm_pio_t *pio)
+// Blocking exchange, an asynchronous exchange in progress is aborted
+int opentherm_dev_pio_exchange(opentherm_pio_t *pio, opentherm_msg_t *request, opentherm_msg_t *reply)
 {
-	uint32_t f = opentherm_frame_encode(MSG_TYPE_READ_DATA, DATA_ID_STATUS, 0);
-	uint64_t m = manchester_encode(f, true);
-	int min = 0, max = 0;
-	bool found = false;
-	int step = 10000;
-	uint32_t in[3];
-	bool up = true;
-	uint32_t hz = 1;
 	int ret;
 
-	if (IS_PIO_LOG(pio->log_mask))
-		hlog_info(OTHM_MODULE, "Looking for devices ... ");
-	// Find frequency
-	do {
-		sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / hz);
-		ret = opentherm_exchange_frame(pio, m, in);
-		if (!in[2] || ret) {
-			if (!up) {
-				up = true;
-				step /= 10;
-			}
-			hz += step;
-		} else if (in[2] != END_BIT) {
-			if (up) {
-				up = false;
-				step /= 10;
-			}
-			hz -= step;
-		} else if (manchester_decode(((uint64_t)in[0] << 32) | in[1], false, &f)) {
-			if (up) {
-				up = false;
-				step /= 10;
+	if (opentherm_dev_pio_start(pio, request))
+		return -1;
+	while ((ret = opentherm_dev_pio_poll(pio, reply)) > 0) {
+		sleep_ms(1);
+		wd_update();
+	}
+
+	return ret;
+}
+
+enum {
+	OT_FIND_REPLY_OK = 0,
+	OT_FIND_REPLY_NONE,
+	OT_FIND_REPLY_INVALID,
+};
+
+static int opentherm_find_reply(int ret, uint32_t *in)
+{
+	uint32_t f;
+
+	if (ret || !in[2])
+		return OT_FIND_REPLY_NONE;
+	if (in[2] != END_BIT)
+		return OT_FIND_REPLY_INVALID;
+	if (manchester_decode(((uint64_t)in[0] << 32) | in[1], false, &f))
+		return OT_FIND_REPLY_INVALID;
+	return OT_FIND_REPLY_OK;
+}
+
+static void opentherm_find_rx_hz(opentherm_pio_t *pio)
+{
+	int hz = pio->find.hz;
+
+	if (pio->find.phase == OT_FIND_MIN)
+		hz -= pio->find.min;
+	else if (pio->find.phase == OT_FIND_MAX)
+		hz += pio->find.max;
+	sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / hz);
+}
+
+// Move the lookup to the next frequency. Returns 1 if in progress, 0 if found, -1 if not found
+static int opentherm_find_next(opentherm_pio_t *pio, int reply)
+{
+	switch (pio->find.phase) {
+	case OT_FIND_FREQ:
+		if (reply == OT_FIND_REPLY_OK) {
+			pio->find.phase = OT_FIND_MIN;
+			pio->find.min = 10;
+			break;
+		}
+		if (reply == OT_FIND_REPLY_NONE) {
+			if (!pio->find.up) {
+				pio->find.up = true;
+				pio->find.step /= 10;
 			}
-			hz -= step;
+			pio->find.hz += pio->find.step;
 		} else {
-			found = true;
-			break;
+			if (pio->find.up) {
+				pio->find.up = false;
+				pio->find.step /= 10;
+			}
+			pio->find.hz -= pio->find.step;
 		}
-		if (!ret)
-			sleep_ms(MIN_INTERVAL_MS);
-		wd_update();
-	} while (step && hz > 0 && hz < MAX_SEARCH_HZ);
-
-	if (!found) {
+		if (pio->find.step && pio->find.hz > 0 && pio->find.hz < MAX_SEARCH_HZ)
+			break;
 		if (IS_PIO_LOG(pio->log_mask))
 			hlog_info(OTHM_MODULE, "No devices found");
 		sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / pio->rx_hz);
 		return -1;
-	}
-
-	// Find min frequency
-	do {
-		min += 10;
-		sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / (hz - min));
-		ret = opentherm_exchange_frame(pio, m, in);
-		if (in[2] != END_BIT || ret)
-			break;
-		if (manchester_decode(((uint64_t)in[0] << 32) | in[1], false, &f))
-			break;
-		sleep_ms(MIN_INTERVAL_MS);
-		wd_update();
-	} while (1);
-	min -= 10;
-
-	// Find max frequency
-	do {
-		max += 10;
-		sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / (hz + max));
-		ret = opentherm_exchange_frame(pio, m, in);
-		if (in[2] != END_BIT || ret)
+	case OT_FIND_MIN:
+		if (reply == OT_FIND_REPLY_OK) {
+			pio->find.min += 10;
 			break;
-		if (manchester_decode(((uint64_t)in[0] << 32) | in[1], false, &f))
+		}
+		pio->find.min -= 10;
+		pio->find.phase = OT_FIND_MAX;
+		pio->find.max = 10;
+		break;
+	case OT_FIND_MAX:
+		if (reply == OT_FIND_REPLY_OK) {
+			pio->find.max += 10;
 			break;
-		sleep_ms(MIN_INTERVAL_MS);
-		wd_update();
-	} while (1);
-	max -= 10;
+		}
+		pio->find.max -= 10;
+		pio->find.hz += ((pio->find.max - pio->find.min)/2);
+		sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / pio->find.hz);
+		hlog_info(OTHM_MODULE, "Device attached at %dhz", pio->find.hz);
+		pio->rx_hz = pio->find.hz;
+		pio->attached = true;
+		pio->conn_count++;
+		pio->last_valid = time_ms_since_boot();
+		return 0;
+	}
+
+	return 1;
+}
+
+// Start looking for a device, by sending status requests at different receiver frequencies
+int opentherm_dev_pio_find_start(opentherm_pio_t *pio)
+{
+	if (IS_PIO_LOG(pio->log_mask))
+		hlog_info(OTHM_MODULE, "Looking for devices ... ");
+	pio->frame = manchester_encode(opentherm_frame_encode(MSG_TYPE_READ_DATA, DATA_ID_STATUS, 0), true);
+	pio->find.phase = OT_FIND_FREQ;
+	pio->find.hz = 1;
+	pio->find.step = 10000;
+	pio->find.up = true;
+	pio->find.min = 0;
+	pio->find.max = 0;
+	pio->last_frame = 0;
+	pio->state = OT_PIO_FIND_WAIT;
 
-	hz += ((max-min)/2);
-	sm_config_set_clkdiv(&pio->pio_rx.cfg, (float)clock_get_hz(clk_sys) / hz);
-	hlog_info(OTHM_MODULE, "Device attached at %dhz", hz);
-	pio->rx_hz = hz;
-	pio->attached = true;
-	pio->conn_count++;
-	pio->last_valid = time_ms_since_boot();
 	return 0;
 }
 
+// Drive the device lookup, one frame at a time, never blocks.
+// Returns 1 if in progress, 0 if a device is attached, -1 if not found
+int opentherm_dev_pio_find_poll(opentherm_pio_t *pio)
+{
+	uint64_t now = time_ms_since_boot();
+	uint32_t in[3] = {0};
+	int ret;
+
+	switch (pio->state) {
+	case OT_PIO_FIND_WAIT:
+		if (pio->last_frame && (now - pio->last_frame) < MIN_INTERVAL_MS)
+			return 1;
+		opentherm_find_rx_hz(pio);
+		opentherm_frame_start(pio, pio->frame);
+		pio->state = OT_PIO_FIND;
+		return 1;
+	case OT_PIO_FIND:
+		ret = opentherm_frame_poll(pio, in);
+		if (ret > 0)
+			return 1;
+		// Keep the interval only after a reply, as the timeout is longer
+		pio->last_frame = ret ? 0 : now;
+		ret = opentherm_find_next(pio, opentherm_find_reply(ret, in));
+		pio->state = ret > 0 ? OT_PIO_FIND_WAIT : OT_PIO_IDLE;
+		return ret;
+	default:
+		break;
+	}
+
+	return -1;
+}
+
 static int load_pio_program(pio_prog_t *prog)
 {
 	PIO pall[] = {pio0, pio1};
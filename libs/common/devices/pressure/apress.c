@@ -41,28 +41,24 @@ struct apress_context_t {
 	uint64_t mqtt_last_send;
 	char mqtt_payload[MQTT_DATA_LEN + 1];
 	uint32_t debug;
-	uint64_t last_run;
 };
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int apress_mqtt_sensor_send(struct apress_context_t *ctx, int idx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"timestamp\": \"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"id\": \"%d\"", idx);
-	ADD_MQTT_MSG_VAR(",\"pressure\": \"%f\"", adc_sensor_get_value(ctx->sensors[idx].adc));
-	ADD_MQTT_MSG("}")
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "timestamp", get_current_time_str(time_buff, TIME_STR));
+	json_add_int(&js, "id", idx);
+	json_add_float(&js, "pressure", adc_sensor_get_value(ctx->sensors[idx].adc), 3);
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 	ret = mqtt_msg_component_publish(&ctx->sensors[idx].mqtt_comp, ctx->mqtt_payload);
 
 	if (!ret)
@@ -97,12 +93,8 @@ static void apress_mqtt_send(struct apress_context_t *ctx)
 static void apress_run(void *context)
 {
 	struct apress_context_t *ctx = (struct apress_context_t *)context;
-	uint64_t now = time_ms_since_boot();
 	int i;
 
-	if ((now - ctx->last_run) < MEASURE_INTERVAL_MS)
-		return;
-
 	for (i = 0; i < ctx->sensors_count; i++) {
 		if (adc_sensor_measure(ctx->sensors[i].adc)) {
 			ctx->sensors[i].mqtt_comp.force = true;
@@ -115,7 +107,6 @@ static void apress_run(void *context)
 	}
 
 	apress_mqtt_send(ctx);
-	ctx->last_run = now;
 }
 
 static bool apress_log(void *context)
@@ -250,6 +241,7 @@ void apress_register(void)
 
 	ctx->mod.name = APRESS_MODULE;
 	ctx->mod.run = apress_run;
+	ctx->mod.run_interval_ms = MEASURE_INTERVAL_MS;
 	ctx->mod.log = apress_log;
 	ctx->mod.debug = apress_debug_set;
 	ctx->mod.commands.description = "Pressure measure";
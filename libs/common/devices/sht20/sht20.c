@@ -18,10 +18,12 @@
 
 #define SHT20_MODULE		"sht20"
 #define SHT20_SENORS_MAX	6
+#define SHT20_BUS_MAX		2
 #define MQTT_DATA_LEN	128
 #define MQTT_REFRESH_MS	10000	// 10s
 
 #define I2C_TIMEOUT_US	1000
+#define I2C_XFER_TIMEOUT_US(N)	(((N) + 1) * I2C_TIMEOUT_US)
 #define SHT20_ADDR	0x40
 #define SHT20_CLOCK	50000
 #define SHT20_DATA_SIZE		3
@@ -29,7 +31,11 @@
 #define SHT20_DATA_COUNT	5
 
 #define SHT0_READ_INTERVAL_MS		1000
-#define SHT0_MEASURE_DELAY_MS		100
+// Max conversion time at 14 bits temperature and 12 bits humidity resolution, with a margin
+#define SHT0_MEASURE_T_DELAY_MS		90
+#define SHT0_MEASURE_RH_DELAY_MS	35
+// The sensor does not acknowledge the read until the conversion is ready
+#define SHT0_MEASURE_TIMEOUT_MS		200
 #define SHT0_POWER_UP_DELAY_MS		50
 #define SHT0_POWER_DOWN_DELAY_MS	100
 // 1 min delay in power down state if more than 20 connection errors are detected
@@ -84,6 +90,7 @@ struct sht20_sensor {
 	int sda_pin;
 	int scl_pin;
 	int power_pin;
+	uint8_t bus;
 	uint8_t  raw_idx;
 	uint32_t raw_data[SHT20_DATA_COUNT];
 	float temperature;
@@ -111,7 +118,8 @@ struct sht20_sensor {
 struct sht20_context_t {
 	sys_module_t mod;
 	uint8_t count;
-	uint8_t idx;
+	uint8_t idx[SHT20_BUS_MAX];	/* The sensors on different I2C buses are read in parallel */
+	uint8_t bus;
 	uint64_t last_read;
 	struct sht20_sensor *sensors[SHT20_SENORS_MAX];
 	uint32_t debug;
@@ -138,7 +146,8 @@ static int sht20_sensor_write(struct sht20_sensor *sensor, uint8_t cmd)
 
 static int sht20_sensor_read(struct sht20_sensor *sensor, uint8_t *cmd, uint8_t count)
 {
-	if (count == i2c_read_blocking(sensor->i2c, sensor->sht20_addr, cmd, count, false))
+	if (count == i2c_read_timeout_us(sensor->i2c, sensor->sht20_addr, cmd, count, false,
+					 I2C_XFER_TIMEOUT_US(count)))
 		return SHT20_RET_OK;
 
 	return SHT20_RET_ERR;
@@ -282,6 +291,7 @@ static bool init_sht20_i2c_params(struct sht20_sensor *sensor)
 	case 16:
 	case 20:
 		sensor->i2c = i2c0;
+		sensor->bus = 0;
 		sensor->scl_pin = sensor->sda_pin + 1;
 		break;
 	case 2:
@@ -291,6 +301,7 @@ static bool init_sht20_i2c_params(struct sht20_sensor *sensor)
 	case 18:
 	case 26:
 		sensor->i2c = i2c1;
+		sensor->bus = 1;
 		sensor->scl_pin = sensor->sda_pin + 1;
 		break;
 	default:
@@ -394,42 +405,37 @@ static void sht20_debug_set(uint32_t debug, void *context)
 }
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int sth20_mqtt_data_send(struct sht20_context_t *ctx, int idx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
 	mqtt_component_t *ms;
-	int count = 0;
+	json_writer_t js;
 	int ret = -1;
 
 	ms = &ctx->sensors[idx]->mqtt_comp[SHT20_MQTT_TEMPERATURE];
-	ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\": \"%s\"", get_current_time_str(time_buff, TIME_STR));
-		if (ctx->sensors[idx]->valid_t) {
-			ADD_MQTT_MSG_VAR(",\"temperature\": \"%3.2f\"", ctx->sensors[idx]->temperature);
-		} else {
-			ADD_MQTT_MSG_VAR(",\"temperature\": \"%s\"", "nan");
-		}
-		if (ctx->sensors[idx]->valid_h) {
-			ADD_MQTT_MSG_VAR(",\"humidity\": \"%3.2f\"", ctx->sensors[idx]->humidity);
-		} else {
-			ADD_MQTT_MSG_VAR(",\"humidity\": \"%s\"", "nan");
-		}
-		if (ctx->sensors[idx]->valid_t && ctx->sensors[idx]->valid_h) {
-			ADD_MQTT_MSG_VAR(",\"vpd\": \"%3.2f\"", ctx->sensors[idx]->vpd);
-			ADD_MQTT_MSG_VAR(",\"dew_point\": \"%3.2f\"", ctx->sensors[idx]->dew_point);
-		} else {
-			ADD_MQTT_MSG_VAR(",\"vpd\": \"%s\"", "nan");
-			ADD_MQTT_MSG_VAR(",\"dew_point\": \"%s\"", "nan");
-		}
-	ADD_MQTT_MSG("}")
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	if (ctx->sensors[idx]->valid_t)
+		json_add_float(&js, "temperature", ctx->sensors[idx]->temperature, 2);
+	else
+		json_add_str(&js, "temperature", "nan");
+	if (ctx->sensors[idx]->valid_h)
+		json_add_float(&js, "humidity", ctx->sensors[idx]->humidity, 2);
+	else
+		json_add_str(&js, "humidity", "nan");
+	if (ctx->sensors[idx]->valid_t && ctx->sensors[idx]->valid_h) {
+		json_add_float(&js, "vpd", ctx->sensors[idx]->vpd, 2);
+		json_add_float(&js, "dew_point", ctx->sensors[idx]->dew_point, 2);
+	} else {
+		json_add_str(&js, "vpd", "nan");
+		json_add_str(&js, "dew_point", "nan");
+	}
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(ms, ctx->mqtt_payload);
 	if (!ret)
 		ctx->mqtt_last_send = now;
@@ -466,10 +472,11 @@ static int sht20_sensor_request_data(struct sht20_sensor *sensor)
 {
 	int ret;
 
-	ret = i2c_write_blocking(sensor->i2c,
-							 sensor->sht20_addr,
-							 &(sensor->read_cmd),
-							 sizeof(sensor->read_cmd), false);
+	ret = i2c_write_timeout_us(sensor->i2c,
+							   sensor->sht20_addr,
+							   &(sensor->read_cmd),
+							   sizeof(sensor->read_cmd), false,
+							   I2C_XFER_TIMEOUT_US(sizeof(sensor->read_cmd)));
 	if (ret != sizeof(sensor->read_cmd)) {
 		sensor->err_stat++;
 		if (IS_DEBUG(sensor->ctx))
@@ -511,13 +518,19 @@ static int sht20_sensor_get_data(struct sht20_sensor *sensor)
 	uint8_t buff[SHT20_DATA_SIZE];
 	int ret = SHT20_RET_ERR;
 	float data, f1, f2;
+	bool humid_next;
 	uint16_t raw;
 
-	if ((now - sensor->read_requested) < SHT0_MEASURE_DELAY_MS)
+	if ((now - sensor->read_requested) <
+	    (sensor->read_cmd == SHT20_TEMP ? SHT0_MEASURE_T_DELAY_MS : SHT0_MEASURE_RH_DELAY_MS))
 		return SHT20_RET_IN_PROGRESS;
 
+	ret = i2c_read_timeout_us(sensor->i2c, sensor->sht20_addr, buff, SHT20_DATA_SIZE, false,
+				  I2C_XFER_TIMEOUT_US(SHT20_DATA_SIZE));
+	/* Not acknowledged, the conversion is still running */
+	if (ret == PICO_ERROR_GENERIC && (now - sensor->read_requested) < SHT0_MEASURE_TIMEOUT_MS)
+		return SHT20_RET_IN_PROGRESS;
 	sensor->read_requested = 0;
-	ret = i2c_read_blocking(sensor->i2c, sensor->sht20_addr, buff, SHT20_DATA_SIZE, false);
 	if (ret != SHT20_DATA_SIZE) {
 		ret = SHT20_RET_ERR;
 		goto out;
@@ -544,6 +557,8 @@ static int sht20_sensor_get_data(struct sht20_sensor *sensor)
 	}
 	raw = samples_filter(sensor->raw_data, SHT20_DATA_COUNT, 1);
 	sensor->raw_idx = 0;
+	/* Read the humidity in the same power cycle, right after the temperature */
+	humid_next = (sensor->read_cmd == SHT20_TEMP);
 	if (sensor->read_cmd == SHT20_TEMP) {
 		data = raw * (175.72 / 65536.0)-46.85;
 		if (sensor->temperature != data) {
@@ -585,6 +600,12 @@ static int sht20_sensor_get_data(struct sht20_sensor *sensor)
 				  sensor->temperature, sensor->humidity, sensor->vpd, sensor->dew_point);
 
 	ret = SHT20_RET_OK;
+	if (humid_next) {
+		if (sht20_sensor_request_data(sensor) != SHT20_RET_OK)
+			ret = SHT20_RET_ERR;
+		else
+			ret = SHT20_RET_IN_PROGRESS;
+	}
 
 out:
 	if (ret == SHT20_RET_ERR) {
@@ -600,13 +621,16 @@ out:
 	return ret;
 }
 
-static int sht20_shutdown_check(struct sht20_context_t *ctx)
+/* Wait all sensors on the same bus to power down */
+static int sht20_shutdown_check(struct sht20_context_t *ctx, uint8_t bus)
 {
 	uint64_t now = time_ms_since_boot();
 	int ret = SHT20_RET_OK;
 	int i;
 
 	for (i = 0; i < ctx->count; i++) {
+		if (ctx->sensors[i]->bus != bus)
+			continue;
 		if (ctx->sensors[i]->power_state == SHT20_POWER_DOWN &&
 		    (now - ctx->sensors[i]->power_state_change) < SHT0_POWER_DOWN_DELAY_MS)
 			ret = SHT20_RET_IN_PROGRESS;
@@ -633,7 +657,7 @@ static int sht20_sensor_data(struct sht20_sensor *sensor)
 		return SHT20_RET_OK;
 	}
 
-	if (sht20_shutdown_check(sensor->ctx) == SHT20_RET_IN_PROGRESS)
+	if (sht20_shutdown_check(sensor->ctx, sensor->bus) == SHT20_RET_IN_PROGRESS)
 		return SHT20_RET_IN_PROGRESS;
 
 	if (sht20_sensor_init(sensor) == SHT20_RET_IN_PROGRESS)
@@ -653,20 +677,36 @@ static void sht20_run(void *context)
 {
 	struct sht20_context_t *ctx = (struct sht20_context_t *)context;
 	uint64_t now = time_ms_since_boot();
-
-	if (ctx->idx < ctx->count) {
-		if (sht20_sensor_data(ctx->sensors[ctx->idx]) != SHT20_RET_IN_PROGRESS) {
+	bool busy = false;
+	uint8_t *idx;
+	int i, bus;
+
+	/*
+	 * The sensors on different buses convert in parallel, but each call
+	 * services only one bus, to keep the time spent in I2C transfers low.
+	 */
+	for (i = 0; i < SHT20_BUS_MAX; i++) {
+		bus = (ctx->bus + i) % SHT20_BUS_MAX;
+		idx = &ctx->idx[bus];
+		while (*idx < ctx->count && ctx->sensors[*idx]->bus != bus)
+			(*idx)++;
+		if (*idx >= ctx->count)
+			continue;
+		busy = true;
+		if (sht20_sensor_data(ctx->sensors[*idx]) != SHT20_RET_IN_PROGRESS) {
 			ctx->last_read = now;
-			ctx->idx++;
+			(*idx)++;
 		}
-		sht20_mqtt_send(ctx);
-		return;
+		ctx->bus = (bus + 1) % SHT20_BUS_MAX;
+		break;
 	}
 
 	sht20_mqtt_send(ctx);
+	if (busy)
+		return;
 	if (((now - ctx->last_read) < SHT0_READ_INTERVAL_MS))
 		return;
-	ctx->idx = 0;
+	memset(ctx->idx, 0, sizeof(ctx->idx));
 }
 
 static void sht20_mqtt_components_add(struct sht20_context_t *ctx)
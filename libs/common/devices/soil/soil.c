@@ -56,7 +56,6 @@ struct soil_context_t {
 	uint64_t mqtt_last_send;
 	char mqtt_payload[MQTT_DATA_LEN + 1];
 	uint32_t debug;
-	uint64_t last_run;
 	bool wh_notify;
 };
 
@@ -81,26 +80,23 @@ static void wh_notify_send(struct soil_context_t *ctx, int id)
 }
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int soil_mqtt_sensor_send(struct soil_context_t *ctx, int idx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"timestamp\": \"%s\"", get_current_time_str(time_buff, TIME_STR))
-	ADD_MQTT_MSG_VAR(",\"id\": \"%d\"", idx);
-	ADD_MQTT_MSG_VAR(",\"value_d\": \"%d\"", ctx->sensors[idx].last_digital);
-	ADD_MQTT_MSG_VAR(",\"value_a\": \"%d\"",
-					 ctx->sensors[idx].analog ? adc_sensor_get_percent(ctx->sensors[idx].analog->adc) : 0);
-	ADD_MQTT_MSG("}")
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "timestamp", get_current_time_str(time_buff, TIME_STR));
+	json_add_int(&js, "id", idx);
+	json_add_int(&js, "value_d", ctx->sensors[idx].last_digital);
+	json_add_int(&js, "value_a",
+				 ctx->sensors[idx].analog ? adc_sensor_get_percent(ctx->sensors[idx].analog->adc) : 0);
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 	ret = mqtt_msg_component_publish(&ctx->sensors[idx].mqtt_comp, ctx->mqtt_payload);
 
 	if (!ret)
@@ -149,12 +145,8 @@ static void measure_digital(struct soil_context_t *ctx, int id)
 static void soil_run(void *context)
 {
 	struct soil_context_t *ctx = (struct soil_context_t *)context;
-	uint64_t now = time_ms_since_boot();
 	int i;
 
-	if ((now - ctx->last_run) < MEASURE_INTERVAL_MS)
-		return;
-
 	for (i = 0; i < ctx->sensors_count; i++) {
 		if (ctx->sensors[i].analog && adc_sensor_measure(ctx->sensors[i].analog->adc))
 			ctx->sensors[i].mqtt_comp.force = true;
@@ -166,7 +158,6 @@ static void soil_run(void *context)
 	}
 
 	soil_mqtt_send(ctx);
-	ctx->last_run = now;
 }
 
 static int soil_read_pin_cfg(struct soil_context_t *ctx, char *config, bool digital)
@@ -337,6 +328,7 @@ void soil_register(void)
 
 	ctx->mod.name = SOIL_MODULE;
 	ctx->mod.run = soil_run;
+	ctx->mod.run_interval_ms = MEASURE_INTERVAL_MS;
 	ctx->mod.log = soil_log;
 	ctx->mod.debug = soil_debug_set;
 	ctx->mod.commands.description = "Soil moisture measure";
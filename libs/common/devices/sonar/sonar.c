@@ -26,6 +26,13 @@
 /* Filter out the 5 biggest and the 5 smallest */
 #define SONAR_MEASURE_DROP	5
 
+enum sonar_echo_state_t {
+	SONAR_ECHO_IDLE = 0,
+	SONAR_ECHO_ARMED,	/* Trigger is sent, waiting for the echo pulse */
+	SONAR_ECHO_HIGH,	/* Echo pulse started */
+	SONAR_ECHO_DONE,	/* Echo pulse received */
+};
+
 struct sonar_context_t {
 	sys_module_t mod;
 	bool force;
@@ -36,30 +43,34 @@ struct sonar_context_t {
 	uint32_t send_time;
 	uint32_t last_distance;
 	uint32_t samples[SONAR_MEASURE_COUNT];
+	int samples_count;
+	bool measure;
 	uint64_t last_measure;
+	/* Echo pulse, captured in the GPIO interrupt */
+	volatile enum sonar_echo_state_t echo_state;
+	volatile uint64_t echo_start;
+	volatile uint64_t echo_end;
+	uint64_t trigger_time;
 	uint32_t debug;
 	char mqtt_payload[MQTT_DATA_LEN + 1];
 };
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int sonar_mqtt_data_send(struct sonar_context_t *ctx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret = -1;
 
-	ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\": \"%s\"", get_current_time_str(time_buff, TIME_STR));
-		ADD_MQTT_MSG_VAR(",\"distance\": \"%3.2f\"", (float)(ctx->last_distance/10));
-	ADD_MQTT_MSG("}")
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_float(&js, "distance", (float)(ctx->last_distance/10), 2);
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(&ctx->mqtt_comp, ctx->mqtt_payload);
 
 	if (!ret)
@@ -88,47 +99,85 @@ static void sonar_mqtt_send(struct sonar_context_t *ctx)
 	sonar_mqtt_data_send(ctx);
 }
 
-static uint32_t sonar_read(struct sonar_context_t *ctx)
+static void sonar_echo_irq(void *context)
 {
-	absolute_time_t start, end, timeout;
-	uint32_t duration_us, distance;
+	struct sonar_context_t *ctx = (struct sonar_context_t *)context;
+	uint64_t now = time_us_64();
+
+	if (gpio_get(ctx->echo_pin)) {
+		if (ctx->echo_state == SONAR_ECHO_ARMED) {
+			ctx->echo_start = now;
+			ctx->echo_state = SONAR_ECHO_HIGH;
+		}
+	} else {
+		if (ctx->echo_state == SONAR_ECHO_HIGH) {
+			ctx->echo_end = now;
+			ctx->echo_state = SONAR_ECHO_DONE;
+		}
+	}
+}
 
-	gpio_put(ctx->trigger_pin, 0);
-	busy_wait_ms(STARTUP_TIME_MSEC);
+static void sonar_trigger(struct sonar_context_t *ctx)
+{
+	ctx->echo_state = SONAR_ECHO_ARMED;
 	gpio_put(ctx->trigger_pin, 1);
 	busy_wait_us(TRIGGER_TIME_USEC);
 	gpio_put(ctx->trigger_pin, 0);
+	ctx->trigger_time = time_us_64();
+}
 
-	timeout = get_absolute_time();
-	start = get_absolute_time();
-	while (!gpio_get(ctx->echo_pin)) {
-		start = get_absolute_time();
-		if (absolute_time_diff_us(timeout, start) > MAX_TIME_USEC)
-			return 0;
-	}
-
-	timeout = get_absolute_time();
-	end = get_absolute_time();
-	while (gpio_get(ctx->echo_pin)) {
-		end = get_absolute_time();
-		if (absolute_time_diff_us(timeout, end) > MAX_TIME_USEC)
-			return 0;
+/* Returns 1 if the sample is not ready yet, 0 when the distance is read. Never blocks */
+static int sonar_read(struct sonar_context_t *ctx, uint64_t now, uint32_t *distance)
+{
+	uint32_t duration_us;
+
+	switch (ctx->echo_state) {
+	case SONAR_ECHO_ARMED:
+		if ((now - ctx->trigger_time) <= MAX_TIME_USEC)
+			return 1;
+		break;
+	case SONAR_ECHO_HIGH:
+		if ((now - ctx->echo_start) <= MAX_TIME_USEC)
+			return 1;
+		break;
+	case SONAR_ECHO_DONE:
+		duration_us = ctx->echo_end - ctx->echo_start;
+		ctx->echo_state = SONAR_ECHO_IDLE;
+		if (duration_us > MAX_TIME_USEC)
+			break;
+		*distance = (duration_us * 17)/100;
+		return 0;
+	default:
+		break;
 	}
 
-	duration_us = absolute_time_diff_us(start, end);
-	distance = (duration_us * 17)/100;
-
-	return distance;
+	/* No echo, out of range */
+	ctx->echo_state = SONAR_ECHO_IDLE;
+	*distance = 0;
+	return 0;
 }
 
 static void sonar_measure(struct sonar_context_t *ctx)
 {
+	uint64_t now = time_us_64();
 	uint32_t av;
-	int i;
 
-	/* read the samples */
-	for (i = 0; i < SONAR_MEASURE_COUNT; i++)
-		ctx->samples[i] = sonar_read(ctx);
+	/* Take one sample per loop iteration */
+	if (ctx->echo_state != SONAR_ECHO_IDLE) {
+		if (sonar_read(ctx, now, &ctx->samples[ctx->samples_count]))
+			return;
+		ctx->samples_count++;
+		/* Keep the trigger low between the samples */
+		ctx->trigger_time = now;
+		return;
+	}
+	if (ctx->samples_count < SONAR_MEASURE_COUNT) {
+		if ((now - ctx->trigger_time) < (STARTUP_TIME_MSEC * 1000))
+			return;
+		sonar_trigger(ctx);
+		return;
+	}
+
 	/* filter biggest and smallest */
 	av = samples_filter(ctx->samples, SONAR_MEASURE_COUNT, SONAR_MEASURE_DROP);
 
@@ -137,6 +186,7 @@ static void sonar_measure(struct sonar_context_t *ctx)
 		ctx->last_distance = av;
 	}
 
+	ctx->measure = false;
 	ctx->last_measure = time_ms_since_boot();
 }
 
@@ -145,7 +195,11 @@ static void sonar_run(void *context)
 	struct sonar_context_t *ctx = (struct sonar_context_t *)context;
 	uint64_t now = time_ms_since_boot();
 
-	if ((now - ctx->last_measure) >= MEASURE_TIME_MS)
+	if (!ctx->measure && (now - ctx->last_measure) >= MEASURE_TIME_MS) {
+		ctx->samples_count = 0;
+		ctx->measure = true;
+	}
+	if (ctx->measure)
 		sonar_measure(ctx);
 	sonar_mqtt_send(ctx);
 }
@@ -191,6 +245,7 @@ static bool sonar_init(struct sonar_context_t **ctx)
 		goto out_error;
 
 	free(config);
+	config = NULL;
 
 	gpio_init((*ctx)->echo_pin);
 	gpio_set_dir((*ctx)->echo_pin, GPIO_IN);
@@ -200,12 +255,18 @@ static bool sonar_init(struct sonar_context_t **ctx)
 	gpio_set_dir((*ctx)->trigger_pin, GPIO_OUT);
 	gpio_put((*ctx)->trigger_pin, 0);
 
+	if (sys_add_irq_callback((*ctx)->echo_pin, sonar_echo_irq,
+				 GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, *ctx))
+		goto out_error;
+
 	sonar_mqtt_init(*ctx);
 
 	return true;
 
 out_error:
 	free(config);
+	free(*ctx);
+	*ctx = NULL;
 	return false;
 }
 
@@ -19,6 +19,8 @@
 #define SSR_MODULE	"ssr"
 #define MAX_SSR_COUNT (GPIO_PIN_MAX + 1)
 #define MQTT_DELAY_MS 20000
+/* Resolution of the relay delay and run timers */
+#define RUN_INTERVAL_MS	100
 
 #define MQTT_DATA_LEN   256
 
@@ -61,17 +63,12 @@ static struct ssr_context_t *ssr_context_get(void)
 }
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int ssr_mqtt_data_send(struct ssr_context_t *ctx, uint8_t idx, int sens)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
 	struct ssr_t *relay;
-	int count = 0;
+	json_writer_t js;
 
 	if (idx >= MAX_SSR_COUNT || !(ctx->relays[idx]))
 		return -1;
@@ -82,32 +79,29 @@ static int ssr_mqtt_data_send(struct ssr_context_t *ctx, uint8_t idx, int sens)
 	if (!relay->mqtt_comp[sens].force && ((now - relay->mqtt_comp[sens].last_send) < MQTT_DELAY_MS))
 		return -1;
 
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"timestamp\": \"%s\"", get_current_time_str(time_buff, TIME_STR))
-	ADD_MQTT_MSG_VAR(",\"ssr_id\": \"%d\"", idx);
-	ADD_MQTT_MSG_VAR(",\"ssr_state\": \"%d\"", relay->state_actual == ctx->on_state);
-	ADD_MQTT_MSG_VAR(",\"run_time\": \"%d\"", relay->time_remain_ms/1000);
-	ADD_MQTT_MSG_VAR(",\"delay\": \"%d\"", relay->drelay_remain_ms/1000);
-	ADD_MQTT_MSG("}")
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "timestamp", get_current_time_str(time_buff, TIME_STR));
+	json_add_int(&js, "ssr_id", idx);
+	json_add_int(&js, "ssr_state", relay->state_actual == ctx->on_state);
+	json_add_int(&js, "run_time", relay->time_remain_ms/1000);
+	json_add_int(&js, "delay", relay->drelay_remain_ms/1000);
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 	return mqtt_msg_component_publish(&relay->mqtt_comp[sens], ctx->mqtt_payload);
 }
 
 static void ssr_mqtt_send(struct ssr_context_t *ctx)
 {
-	static uint8_t midx;
+	int i;
 
 	if (!mqtt_is_discovery_sent())
 		return;
 
-	while (true) {
-		if (midx >= MAX_SSR_COUNT)
-			midx = 0;
-		if (ctx->relays[midx]) {
-			ssr_mqtt_data_send(ctx, midx++, SSR_MQTT_SENSOR_STATE);
-			return;
-		}
-		midx++;
+	for (i = 0; i < MAX_SSR_COUNT; i++) {
+		if (ctx->relays[i])
+			ssr_mqtt_data_send(ctx, i, SSR_MQTT_SENSOR_STATE);
 	}
 }
 
@@ -436,6 +430,7 @@ void ssr_register(void)
 
 	ctx->mod.name = SSR_MODULE;
 	ctx->mod.run = ssr_run;
+	ctx->mod.run_interval_ms = RUN_INTERVAL_MS;
 	ctx->mod.log = ssr_log;
 	ctx->mod.debug = ssr_debug_set;
 	ctx->mod.commands.hooks = ssr_requests;
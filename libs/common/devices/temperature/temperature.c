@@ -43,7 +43,6 @@ struct temperature_t {
 	float		max;
 	float		temperature;
 	bool		valid;
-	uint64_t	last_read;
 	uint		count;
 	enum temp_sensor_type	type;
 	void		*params;
@@ -54,7 +53,6 @@ struct temperature_t {
 struct temperature_context_t {
 	sys_module_t mod;
 	uint32_t debug;
-	int idx;
 	int count;
 	struct temperature_t *sensors[MAX_SENSORS];
 	uint64_t mqtt_last_send;
@@ -82,33 +80,26 @@ static const char *temperature_type_str(enum temp_sensor_type type)
 }
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int temperature_mqtt_data_send(struct temperature_context_t *ctx, int idx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
 	mqtt_component_t *ms;
-	int count = 0;
+	json_writer_t js;
 	int ret = -1;
 
 	ms = &ctx->sensors[idx]->mqtt_comp;
-	ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\": \"%s\"", get_current_time_str(time_buff, TIME_STR));
-		if (ctx->sensors[idx]->valid) {
-			ADD_MQTT_MSG_VAR(",\"%s\": \"%3.2f\"",
-							 ctx->sensors[idx]->mqtt_comp.name,
-							 ctx->sensors[idx]->temperature);
-		} else {
-			ADD_MQTT_MSG_VAR(",\"%s\": \"%s\"",
-							 ctx->sensors[idx]->mqtt_comp.name, "nan");
-		}
-	ADD_MQTT_MSG("}")
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	if (ctx->sensors[idx]->valid)
+		json_add_float(&js, ctx->sensors[idx]->mqtt_comp.name, ctx->sensors[idx]->temperature, 2);
+	else
+		json_add_str(&js, ctx->sensors[idx]->mqtt_comp.name, "nan");
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(ms, ctx->mqtt_payload);
 
 	if (!ret)
@@ -235,17 +226,10 @@ out_err:
 	return false;
 }
 
-static void temperature_measure(struct temperature_context_t *ctx)
+static void temperature_measure(struct temperature_context_t *ctx, struct temperature_t *sensor)
 {
-	uint64_t now = time_ms_since_boot();
-	struct temperature_t *sensor;
 	float temp;
 
-	if (ctx->idx >= ctx->count)
-		ctx->idx = 0;
-	sensor = ctx->sensors[ctx->idx];
-	if (now - sensor->last_read < READ_INTERVAL_MS)
-		goto out;
 	sensor->valid = false;
 	adc_sensor_measure(sensor->adc);
 	temp = sensor->calc(sensor, adc_sensor_get_volt(sensor->adc));
@@ -257,13 +241,10 @@ static void temperature_measure(struct temperature_context_t *ctx)
 		sensor->temperature = temp;
 	}
 
-	sensor->last_read = now;
 	if (IS_DEBUG(ctx))
 		hlog_info(TEMP_MODULE, "Measured [%s]: %3.2f*C / %3.2fV",
 				  temperature_type_str(sensor->type), sensor->temperature,
 				  adc_sensor_get_volt(sensor->adc));
-out:
-	ctx->idx++;
 }
 
 static void temperature_mqtt_send(struct temperature_context_t *ctx)
@@ -273,10 +254,8 @@ static void temperature_mqtt_send(struct temperature_context_t *ctx)
 	int i;
 
 	for (i = 0; i < ctx->count; i++) {
-		if (ctx->sensors[i]->mqtt_comp.force == true) {
+		if (ctx->sensors[i]->mqtt_comp.force == true)
 			temperature_mqtt_data_send(ctx, i);
-			return;
-		}
 	}
 
 	if ((now - ctx->mqtt_last_send) < MQTT_DELAY_MS)
@@ -286,11 +265,14 @@ static void temperature_mqtt_send(struct temperature_context_t *ctx)
 	temperature_mqtt_data_send(ctx, idx++);
 }
 
+/* The samples are converted in background, all sensors are read on each READ_INTERVAL_MS */
 static void temperature_run(void *context)
 {
 	struct temperature_context_t *ctx = (struct temperature_context_t *)context;
+	int i;
 
-	temperature_measure(ctx);
+	for (i = 0; i < ctx->count; i++)
+		temperature_measure(ctx, ctx->sensors[i]);
 	temperature_mqtt_send(ctx);
 }
 
@@ -327,6 +309,7 @@ void temperature_register(void)
 
 	ctx->mod.name = TEMP_MODULE;
 	ctx->mod.run = temperature_run;
+	ctx->mod.run_interval_ms = READ_INTERVAL_MS;
 	ctx->mod.log = temperature_log;
 	ctx->mod.debug = temperature_debug_set;
 	ctx->mod.context = ctx;
@@ -59,7 +59,6 @@ struct thermostat_context_t {
 	sys_module_t mod;
 	uint32_t debug;
 	uint8_t dev_count;
-	uint64_t last_run;
 	uint64_t mqtt_last_send;
 	struct therm_device_t *devices[MAX_THERMOSTAT_DEVICES];
 	char mqtt_payload[MQTT_DATA_LEN + 1];
@@ -84,64 +83,56 @@ static char *therm_temp_senor_name(int temp_provider)
 }
 
 #define TIME_STR	64
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int therm_mqtt_dvice_send(struct thermostat_context_t *ctx, int idx)
 {
 	struct therm_device_t *dev = ctx->devices[idx];
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 
 	if (!dev)
 		return -1;
 
 	ssr_api_state_get(dev->ssr_id, &(dev->ssr_state), NULL, NULL);
 
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"timestamp\": \"%s\"", get_current_time_str(time_buff, TIME_STR));
-	ADD_MQTT_MSG_VAR(",\"id\": \"%d\"", idx);
-	ADD_MQTT_MSG_VAR(",\"state\": \"%d\"", dev->enable);
-	ADD_MQTT_MSG_VAR(",\"valve\": \"%d\"", dev->ssr_state);
-	ADD_MQTT_MSG_VAR(",\"temperature\": \"%3.2f\"", dev->current_t);
-	ADD_MQTT_MSG_VAR(",\"t_on\": \"%3.2f\"", dev->on_t);
-	ADD_MQTT_MSG_VAR(",\"t_off\": \"%3.2f\"", dev->off_t);
-	ADD_MQTT_MSG_VAR(",\"hysteresis\": \"%3.2f\"", dev->off_t - dev->on_t);
-	ADD_MQTT_MSG("}")
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "timestamp", get_current_time_str(time_buff, TIME_STR));
+	json_add_int(&js, "id", idx);
+	json_add_int(&js, "state", dev->enable);
+	json_add_int(&js, "valve", dev->ssr_state);
+	json_add_float(&js, "temperature", dev->current_t, 2);
+	json_add_float(&js, "t_on", dev->on_t, 2);
+	json_add_float(&js, "t_off", dev->off_t, 2);
+	json_add_float(&js, "hysteresis", dev->off_t - dev->on_t, 2);
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
 	return mqtt_msg_component_publish(&ctx->devices[idx]->mqtt_comp[THERM_MQTT_STATE], ctx->mqtt_payload);
 }
 
+/* All forced states are sent at once, the module runs on each MEASURE_INTERVAL_MS */
 static void therm_mqtt_send(struct thermostat_context_t *ctx)
 {
-	static int idx;
-	uint64_t now;
+	uint64_t now = time_ms_since_boot();
 	int i;
 
-	if (idx >= ctx->dev_count)
-		idx = 0;
-	for (; idx < ctx->dev_count; idx++) {
-		if (!ctx->devices[idx])
-			continue;
-		if (ctx->devices[idx]->mqtt_comp[THERM_MQTT_STATE].force) {
-			therm_mqtt_dvice_send(ctx, idx++);
-			return;
+	if (!ctx->mqtt_last_send ||
+	    (now - ctx->mqtt_last_send) >= MQTT_SEND_INTERVAL_MS) {
+		for (i = 0; i < ctx->dev_count; i++) {
+			if (!ctx->devices[i])
+				continue;
+			ctx->devices[i]->mqtt_comp[THERM_MQTT_STATE].force = true;
 		}
+		ctx->mqtt_last_send = now;
 	}
 
-	now = time_ms_since_boot();
-	if (ctx->mqtt_last_send &&
-	    (now - ctx->mqtt_last_send) < MQTT_SEND_INTERVAL_MS)
-		return;
 	for (i = 0; i < ctx->dev_count; i++) {
 		if (!ctx->devices[i])
 			continue;
-		ctx->devices[i]->mqtt_comp[THERM_MQTT_STATE].force = true;
+		if (ctx->devices[i]->mqtt_comp[THERM_MQTT_STATE].force)
+			therm_mqtt_dvice_send(ctx, i);
 	}
-	ctx->mqtt_last_send = now;
 }
 
 static int therm_device_read_temperature(struct therm_device_t *dev)
@@ -226,19 +217,14 @@ static int therm_device_run(struct thermostat_context_t *ctx, int idx)
 static void therm_run(void *context)
 {
 	struct thermostat_context_t *ctx = (struct thermostat_context_t *)context;
-	uint64_t now = time_ms_since_boot();
 	int i;
 
-	therm_mqtt_send(ctx);
-	if ((now - ctx->last_run) < MEASURE_INTERVAL_MS)
-		return;
-
 	for (i = 0; i < ctx->dev_count; i++) {
 		if (ctx->devices[i])
 			therm_device_run(ctx, i);
 	}
 
-	ctx->last_run = now;
+	therm_mqtt_send(ctx);
 }
 
 static bool therm_log(void *context)
@@ -534,8 +520,10 @@ static int therm_set_temperatures(struct thermostat_context_t *ctx,
 			hlog_info(THERMOSTAT_MODULE, "Set %d Ton to %f", idx, ctx->devices[idx]->on_t);
 		}
 	}
-	if (update)
+	if (update) {
 		ctx->devices[idx]->mqtt_comp[THERM_MQTT_STATE].force = true;
+		sys_module_wakeup(&ctx->mod);
+	}
 
 	return 0;
 }
@@ -586,6 +574,8 @@ static int therm_set_state(struct thermostat_context_t *ctx, int idx, bool state
 				hlog_info(THERMOSTAT_MODULE, "%s %d ", state ? "Enable" : "Disable", i);
 		}
 	}
+	/* Send the new state without waiting for the next measure */
+	sys_module_wakeup(&ctx->mod);
 
 	return ret;
 }
@@ -671,6 +661,7 @@ void thermostat_register(void)
 
 	ctx->mod.name = THERMOSTAT_MODULE;
 	ctx->mod.run = therm_run;
+	ctx->mod.run_interval_ms = MEASURE_INTERVAL_MS;
 	ctx->mod.log = therm_log;
 	ctx->mod.debug = therm_debug_set;
 	ctx->mod.commands.hooks = therm_requests;
@@ -89,6 +89,9 @@ struct bt_context_t {
 	bool started;
 	bool running;
 	bool scanning;
+	bool power_cycle;
+	bool power_on;
+	uint32_t reset_count;
 	mutex_t lock;
 	uint32_t debug;
 };
@@ -688,6 +691,14 @@ static void bt_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *pa
 
 	switch (hci_event_packet_get_type(packet)) {
 	case BTSTACK_EVENT_STATE:
+		// Power cycle in progress, the stack is down and can be powered on again
+		if (btstack_event_state_get_state(packet) == HCI_STATE_OFF && ctx->power_cycle) {
+			BT_LOCAL_LOCK(ctx);
+				ctx->power_cycle = false;
+				ctx->power_on = true;
+			BT_LOCAL_UNLOCK(ctx);
+			break;
+		}
 		// BTstack activated, get started
 		if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING)
 			break;
@@ -1047,6 +1058,12 @@ static void sys_bt_run(void *context)
 			ctx->started = true;
 		return;
 	}
+	if (ctx->power_on) {
+		hlog_info(BTLOG, "Power on BT stack");
+		if (!hci_power_control(HCI_POWER_ON))
+			ctx->power_on = false;
+		return;
+	}
 	if (!ctx->running)
 		return;
 
@@ -1071,6 +1088,8 @@ static bool sys_bt_log(void *context)
 		hlog_info(BTLOG, "BT stack started, %s, %s.",
 					ctx->running?"running":"not running yet",
 					ctx->scanning?"scanning for devices":"not scanning for devices");
+		if (ctx->reset_count)
+			hlog_info(BTLOG, "\tThe stack was reset %d times", ctx->reset_count);
 		for (i = 0; i < ctx->dev_count; i++) {
 			dev = ctx->devcies[i];
 			if (!dev)
@@ -1122,6 +1141,40 @@ int bt_characteristic_notify(uint32_t char_id, bool enable)
 	return ret;
 }
 
+int bt_device_disconnect(int device_idx)
+{
+	struct bt_device_t *dev = get_device_by_id(device_idx);
+
+	if (!dev || dev->state == BT_DEV_DISCONNECTED)
+		return -1;
+	hlog_info(BTLOG, "Disconnecting [%s] ...", dev->name);
+	if (gap_disconnect(dev->connection_handle))
+		return -1;
+	return 0;
+}
+
+/*
+ * Power off the BT controller, it is powered on again when the stack reports HCI_STATE_OFF.
+ * The devices are reset by the disconnect events, sent by the stack while halting.
+ */
+int bt_stack_reset(void)
+{
+	struct bt_context_t *ctx = bt_get_context(NULL);
+
+	if (!ctx || !ctx->started || ctx->power_cycle || ctx->power_on)
+		return -1;
+
+	hlog_info(BTLOG, "Reset BT stack");
+	BT_LOCAL_LOCK(ctx);
+		ctx->running = false;
+		ctx->scanning = false;
+		ctx->power_cycle = true;
+		ctx->reset_count++;
+	BT_LOCAL_UNLOCK(ctx);
+	hci_power_control(HCI_POWER_OFF);
+	return 0;
+}
+
 int bt_characteristic_get_uuid(uint32_t id, bt_uuid128_t *u128, uint16_t *u16)
 {
 	struct bt_char_t *charc;
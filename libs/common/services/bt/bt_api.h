@@ -57,6 +57,8 @@ int bt_characteristic_get_uuid(uint32_t id, bt_uuid128_t *u128, uint16_t *u16);
 int bt_characteristic_read(uint32_t char_id);
 int bt_characteristic_write(uint32_t char_id, uint8_t *data, uint16_t data_len);
 int bt_characteristic_notify(uint32_t char_id, bool enable);
+int bt_device_disconnect(int device_idx);
+int bt_stack_reset(void);
 
 #ifdef __cplusplus
 }
@@ -16,18 +16,43 @@
 
 #define CFGS_MODULE "config"
 #define CFG_DIR     "/device_cfg"
+#define CFG_JOURNAL	"/device_cfg.jrn"
+#define CFG_JOURNAL_TMP	"/device_cfg.tmp"
 #define MAX_VARS     100
 #define BUFF_SIZE    300
+#define JRN_LINE_MAX	512
+#define JRN_SLACK	32
 
+#define JRN_OP_SET	'S'
+#define JRN_OP_DEL	'D'
+
+#define IS_DEBUG(C)	((C)->debug)
+
+/*
+ * All parameters are kept in RAM. Every change is appended as a record to a
+ * journal file, one record per line:
+ *	<op>:<name>:<base64 value>:<hash>
+ * The hash covers the rest of the line, so a record torn by a power cut is
+ * detected and ignored on load. The new line is written before the record,
+ * so a torn record never merges with the next one. The journal is compacted
+ * when there are too many stale records, by writing a new file and renaming
+ * it over the old one.
+ */
 struct cfg_store_t {
 	char *name;
+	uint32_t hash;
+	char *value;
+	bool known;
 };
 
 struct cfgs_context_t {
 	sys_module_t mod;
 	char buff[BUFF_SIZE];
+	char line[JRN_LINE_MAX];
 	struct cfg_store_t *cfg_params[MAX_VARS];
 	int count;
+	int stored;
+	int jrn_records;
 	uint32_t debug;
 };
 
@@ -42,7 +67,8 @@ static bool sys_cfgs_log_status(void *context)
 {
 	struct cfgs_context_t *ctx = (struct cfgs_context_t *)context;
 
-	UNUSED(ctx);
+	hlog_info(CFGS_MODULE, "%d parameters, %d stored, %d records in the journal",
+			  ctx->count, ctx->stored, ctx->jrn_records);
 
 	return true;
 }
@@ -54,36 +80,13 @@ static void sys_cfgs_debug_set(uint32_t lvl, void *context)
 	ctx->debug = lvl;
 }
 
-static bool sys_cfgs_init(struct cfgs_context_t **ctx)
-{
-	int fd;
-
-	if (!fs_is_mounted())
-		return false;
-
-	(*ctx) = (struct cfgs_context_t *)calloc(1, sizeof(struct cfgs_context_t));
-	if (!(*ctx))
-		return false;
-
-	fd = pico_dir_open(CFG_DIR);
-	if (fd < 0)
-		pico_mkdir(CFG_DIR);
-	else
-		pico_dir_close(fd);
-
-	__cfgs_context = *ctx;
-
-	return true;
-}
-
 static struct cfg_store_t *cfgs_param_find(struct cfgs_context_t *ctx, char *name)
 {
+	uint32_t hash = sys_hash(SYS_HASH_INIT, name, strlen(name));
 	int i;
 
-	for (i = 0; i < MAX_VARS; i++) {
-		if (!ctx->cfg_params[i])
-			break;
-		if (strlen(name) != strlen(ctx->cfg_params[i]->name))
+	for (i = 0; i < ctx->count; i++) {
+		if (ctx->cfg_params[i]->hash != hash)
 			continue;
 		if (strcmp(name, ctx->cfg_params[i]->name))
 			continue;
@@ -94,119 +97,339 @@ static struct cfg_store_t *cfgs_param_find(struct cfgs_context_t *ctx, char *nam
 
 static struct cfg_store_t *cfgs_param_register(struct cfgs_context_t *ctx, char *name)
 {
+	struct cfg_store_t *var;
+
 	if (ctx->count >= MAX_VARS)
 		return NULL;
-	ctx->cfg_params[ctx->count] = (struct cfg_store_t *)calloc(1, sizeof(struct cfg_store_t));
-	if (!ctx->cfg_params[ctx->count])
+	var = (struct cfg_store_t *)calloc(1, sizeof(struct cfg_store_t));
+	if (!var)
 		return NULL;
-	ctx->cfg_params[ctx->count]->name = strdup(name);
-	if (!ctx->cfg_params[ctx->count]->name)
+	var->name = strdup(name);
+	if (!var->name) {
+		free(var);
 		return NULL;
-	ctx->count++;
-	return ctx->cfg_params[ctx->count - 1];
+	}
+	var->hash = sys_hash(SYS_HASH_INIT, name, strlen(name));
+	ctx->cfg_params[ctx->count++] = var;
+	return var;
 }
 
-static char *cfgs_param_read(struct cfgs_context_t *ctx, struct cfg_store_t *var)
+static struct cfg_store_t *cfgs_param_get_var(struct cfgs_context_t *ctx, char *name)
 {
-	char *ret = NULL;
-	int sz;
-	int fd;
+	struct cfg_store_t *var;
+
+	var = cfgs_param_find(ctx, name);
+	if (!var)
+		var = cfgs_param_register(ctx, name);
+	return var;
+}
+
+/* Set the value in RAM only, value is NULL to delete it */
+static int cfgs_param_val_set(struct cfgs_context_t *ctx, struct cfg_store_t *var, char *value)
+{
+	char *val = NULL;
+
+	if (value && strlen(value)) {
+		val = strdup(value);
+		if (!val)
+			return -1;
+	}
+	if (var->value)
+		ctx->stored--;
+	free(var->value);
+	var->value = val;
+	if (var->value)
+		ctx->stored++;
+	return 0;
+}
+
+static int cfgs_jrn_record_write(struct cfgs_context_t *ctx, int fd, char op, char *name, char *value)
+{
+	char *enc_val = NULL;
+	uint32_t hash;
+	int len, ret = -1;
+
+	if (value) {
+		enc_val = base64_encode(value, strlen(value));
+		if (!enc_val)
+			return -1;
+	}
+	len = snprintf(ctx->line, JRN_LINE_MAX, "\n%c:%s:%s", op, name, enc_val ? enc_val : "");
+	if (len < 0 || len + 10 >= JRN_LINE_MAX)
+		goto out;
+	hash = sys_hash(SYS_HASH_INIT, ctx->line + 1, len - 1);
+	len += snprintf(ctx->line + len, JRN_LINE_MAX - len, ":%08X", (unsigned int)hash);
+	if (fs_write(fd, ctx->line, len) != len)
+		goto out;
+	ret = 0;
+
+out:
+	free(enc_val);
+	return ret;
+}
 
-	snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, var->name);
+/* Write all stored parameters in a new journal, replace the old one */
+static int cfgs_jrn_compact(struct cfgs_context_t *ctx)
+{
+	int ret = -1;
+	int fd, i;
 
-	fd = pico_open(ctx->buff, LFS_O_RDONLY);
+	fd = fs_open(CFG_JOURNAL_TMP, LFS_O_WRONLY | LFS_O_TRUNC | LFS_O_CREAT);
 	if (fd < 0)
-		return NULL;
-	sz = pico_read(fd, ctx->buff, BUFF_SIZE);
-	if (sz > 1)
-		ret = base64_decode(ctx->buff, sz);
-	pico_close(fd);
+		return -1;
+	for (i = 0; i < ctx->count; i++) {
+		if (!ctx->cfg_params[i]->value)
+			continue;
+		if (cfgs_jrn_record_write(ctx, fd, JRN_OP_SET,
+					  ctx->cfg_params[i]->name, ctx->cfg_params[i]->value))
+			break;
+	}
+	fs_close(fd);
+	if (i < ctx->count)
+		goto out;
+
+	if (fs_rename(CFG_JOURNAL_TMP, CFG_JOURNAL) < 0)
+		goto out;
+	ctx->jrn_records = ctx->stored;
+	ret = 0;
+
+	if (IS_DEBUG(ctx))
+		hlog_info(CFGS_MODULE, "Journal compacted, %d records", ctx->jrn_records);
+out:
+	if (ret)
+		hlog_warning(CFGS_MODULE, "Failed to compact the journal");
 	return ret;
 }
 
-static void cfgs_purge_uknown(struct cfgs_context_t *ctx)
+static int cfgs_jrn_append(struct cfgs_context_t *ctx, char op, char *name, char *value)
 {
-	struct lfs_info linfo;
 	int ret;
 	int fd;
 
-	fd = pico_dir_open(CFG_DIR);
+	fd = fs_open(CFG_JOURNAL, LFS_O_WRONLY | LFS_O_APPEND | LFS_O_CREAT);
 	if (fd < 0)
-		return;
+		return -1;
+	ret = cfgs_jrn_record_write(ctx, fd, op, name, value);
+	fs_close(fd);
+	if (ret)
+		return ret;
+
+	ctx->jrn_records++;
+	if (ctx->jrn_records > 2 * ctx->stored + JRN_SLACK)
+		cfgs_jrn_compact(ctx);
+	return 0;
+}
+
+/* Returns 1 if the record is applied, 0 if it is invalid */
+static int cfgs_jrn_record_apply(struct cfgs_context_t *ctx, char *line)
+{
+	struct cfg_store_t *var;
+	char *name, *val, *hstr;
+	char *value = NULL;
+	uint32_t hash;
+	int ret = 0;
+
+	hstr = strrchr(line, ':');
+	if (!hstr || strlen(hstr + 1) != 8)
+		return 0;
+	hash = strtoul(hstr + 1, NULL, 16);
+	*hstr = 0;
+	if (hash != sys_hash(SYS_HASH_INIT, line, strlen(line)))
+		return 0;
+	if ((line[0] != JRN_OP_SET && line[0] != JRN_OP_DEL) || line[1] != ':')
+		return 0;
+	name = line + 2;
+	val = strchr(name, ':');
+	if (!val || val == name)
+		return 0;
+	*val++ = 0;
+	if (line[0] == JRN_OP_SET && strlen(val)) {
+		value = base64_decode(val, strlen(val));
+		if (!value)
+			return 0;
+	}
+	var = cfgs_param_find(ctx, name);
+	if (!var && value)
+		var = cfgs_param_register(ctx, name);
+	if (var && !cfgs_param_val_set(ctx, var, value))
+		ret = 1;
+	free(value);
+	return ret;
+}
 
+static bool cfgs_jrn_load(struct cfgs_context_t *ctx)
+{
+	bool valid = true;
+	int ret;
+	int fd;
+
+	fd = fs_open(CFG_JOURNAL, LFS_O_RDONLY);
+	if (fd < 0)
+		return true;
 	do {
-		ret = pico_dir_read(fd, &linfo);
-		if (ret > 0 && linfo.type == LFS_TYPE_REG) {
-			if (!cfgs_param_find(ctx, linfo.name)) {
-				snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, linfo.name);
-				pico_remove(ctx->buff);
-			}
-		}
-		if (ret <= 0)
+		ret = fs_gets(fd, ctx->line, JRN_LINE_MAX);
+		if (ret < 0)
 			break;
+		if (!ret)
+			continue;
+		ctx->jrn_records++;
+		if (ret >= JRN_LINE_MAX - 1 || !cfgs_jrn_record_apply(ctx, ctx->line))
+			valid = false;
 	} while (true);
+	fs_close(fd);
+
+	if (IS_DEBUG(ctx))
+		hlog_info(CFGS_MODULE, "Loaded %d parameters from %d records%s", ctx->stored,
+				  ctx->jrn_records, valid ? "" : ", some are corrupted");
+	return valid;
+}
+
+/* Move the parameters from the old store, one file per parameter, in the journal */
+static bool cfgs_legacy_import(struct cfgs_context_t *ctx)
+{
+	struct cfg_store_t *var;
+	struct lfs_info linfo;
+	bool found = false;
+	char *val;
+	int fd, vfd;
+	int sz;
 
+	fd = pico_dir_open(CFG_DIR);
+	if (fd < 0)
+		return false;
+	while (pico_dir_read(fd, &linfo) > 0) {
+		if (linfo.type != LFS_TYPE_REG)
+			continue;
+		found = true;
+		if (cfgs_param_find(ctx, linfo.name))
+			continue;
+		snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, linfo.name);
+		vfd = pico_open(ctx->buff, LFS_O_RDONLY);
+		if (vfd < 0)
+			continue;
+		sz = pico_read(vfd, ctx->buff, BUFF_SIZE);
+		pico_close(vfd);
+		if (sz <= 1)
+			continue;
+		val = base64_decode(ctx->buff, sz);
+		if (!val)
+			continue;
+		var = cfgs_param_register(ctx, linfo.name);
+		if (var)
+			cfgs_param_val_set(ctx, var, val);
+		free(val);
+	}
 	pico_dir_close(fd);
+
+	return found;
 }
 
-static int cfgs_param_store(struct cfgs_context_t *ctx, char *name, char *value)
+static void cfgs_legacy_remove(struct cfgs_context_t *ctx)
 {
-	struct cfg_store_t *var = NULL;
-	char *enc_val = NULL;
-	unsigned int sz;
-	int ret = -1;
+	struct lfs_info linfo;
 	int fd;
 
-	var = cfgs_param_find(ctx, name);
-	if (!var)
-		var = cfgs_param_register(ctx, name);
+	do {
+		fd = pico_dir_open(CFG_DIR);
+		if (fd < 0)
+			return;
+		do {
+			if (pico_dir_read(fd, &linfo) <= 0) {
+				pico_dir_close(fd);
+				fs_remove(CFG_DIR);
+				return;
+			}
+		} while (linfo.type != LFS_TYPE_REG);
+		snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, linfo.name);
+		pico_dir_close(fd);
+	} while (fs_remove(ctx->buff) >= 0);
+}
 
-	snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, name);
+static bool sys_cfgs_init(struct cfgs_context_t **ctx)
+{
+	bool compact;
 
-	fd = pico_open(ctx->buff, LFS_O_WRONLY|LFS_O_TRUNC|LFS_O_CREAT);
-	if (fd < 0)
-		return -1;
-	enc_val = base64_encode(value, strlen(value));
-	if (!enc_val)
-		goto out;
+	if (!fs_is_mounted())
+		return false;
 
-	sz = pico_write(fd, enc_val, strlen(enc_val));
-	if (sz == strlen(enc_val))
-		ret = 0;
+	(*ctx) = (struct cfgs_context_t *)calloc(1, sizeof(struct cfgs_context_t));
+	if (!(*ctx))
+		return false;
 
-out:
-	if (enc_val)
-		free(enc_val);
-	pico_close(fd);
-	return ret;
+	compact = !cfgs_jrn_load(*ctx);
+	if (cfgs_legacy_import(*ctx)) {
+		if (!cfgs_jrn_compact(*ctx))
+			cfgs_legacy_remove(*ctx);
+	} else if (compact) {
+		cfgs_jrn_compact(*ctx);
+	}
+
+	__cfgs_context = *ctx;
+
+	return true;
+}
+
+static void cfgs_purge_uknown(struct cfgs_context_t *ctx)
+{
+	int i, j;
+
+	for (i = 0, j = 0; i < ctx->count; i++) {
+		if (!ctx->cfg_params[i]->known) {
+			cfgs_param_val_set(ctx, ctx->cfg_params[i], NULL);
+			free(ctx->cfg_params[i]->name);
+			free(ctx->cfg_params[i]);
+			continue;
+		}
+		ctx->cfg_params[j++] = ctx->cfg_params[i];
+	}
+	for (i = j; i < ctx->count; i++)
+		ctx->cfg_params[i] = NULL;
+	ctx->count = j;
+	cfgs_jrn_compact(ctx);
+}
+
+static int cfgs_param_store(struct cfgs_context_t *ctx, char *name, char *value)
+{
+	struct cfg_store_t *var;
+
+	var = cfgs_param_get_var(ctx, name);
+	if (!var)
+		return -1;
+	var->known = true;
+	if (var->value && value && !strcmp(var->value, value))
+		return 0;
+	if (cfgs_param_val_set(ctx, var, value))
+		return -1;
+
+	if (var->value)
+		return cfgs_jrn_append(ctx, JRN_OP_SET, name, var->value);
+	return cfgs_jrn_append(ctx, JRN_OP_DEL, name, NULL);
 }
 
 static void cfgs_param_remove(struct cfgs_context_t *ctx, char *param)
 {
-	snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, param);
-	pico_remove(ctx->buff);
+	struct cfg_store_t *var;
+
+	var = cfgs_param_find(ctx, param);
+	if (!var || !var->value)
+		return;
+	cfgs_param_val_set(ctx, var, NULL);
+	cfgs_jrn_append(ctx, JRN_OP_DEL, param, NULL);
 }
 
 /* API */
 bool cfgs_param_check(char *param)
 {
 	struct cfgs_context_t *ctx = cfgs_context_get();
-	struct cfg_store_t var;
-	char *val;
+	struct cfg_store_t *var;
 
 	if (!ctx)
 		return false;
-	if (cfgs_param_find(ctx, param))
-		return true;
-	memset(&var, 0, sizeof(var));
-	var.name = param;
-	val = cfgs_param_read(ctx, &var);
-	if (val) {
-		free(val);
-		cfgs_param_register(ctx, param);
-		return true;
-	}
-	return false;
+	var = cfgs_param_find(ctx, param);
+	if (!var)
+		return false;
+	var->known = true;
+	return true;
 }
 
 int cfgs_param_set(char *param, char *value)
@@ -226,12 +449,13 @@ char *cfgs_param_get(char *param)
 
 	if (!ctx)
 		return NULL;
-	var = cfgs_param_find(ctx, param);
-	if (!var)
-		var = cfgs_param_register(ctx, param);
+	var = cfgs_param_get_var(ctx, param);
 	if (!var)
 		return NULL;
-	return cfgs_param_read(ctx, var);
+	var->known = true;
+	if (!var->value)
+		return NULL;
+	return strdup(var->value);
 }
 
 int cfgs_param_del(char *param)
@@ -248,19 +472,12 @@ int cfgs_param_del(char *param)
 
 static void cfgs_reset_all(struct cfgs_context_t *ctx)
 {
-	struct lfs_info linfo;
-	int fd;
+	int i;
 
-	do {
-		fd = pico_dir_open(CFG_DIR);
-		if (fd < 0)
-			break;
-		if (pico_dir_read(fd, &linfo) <= 0)
-			break;
-		snprintf(ctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, linfo.name);
-		pico_remove(ctx->buff);
-		pico_dir_close(fd);
-	} while (true);
+	for (i = 0; i < ctx->count; i++)
+		cfgs_param_val_set(ctx, ctx->cfg_params[i], NULL);
+	fs_remove(CFG_JOURNAL);
+	ctx->jrn_records = 0;
 }
 
 static int cfgs_reset_cmd(cmd_run_context_t *ctx, char *cmd, char *params, void *user_data)
@@ -279,7 +496,6 @@ static int cfgs_reset_cmd(cmd_run_context_t *ctx, char *cmd, char *params, void
 static int cfgs_list_cmd(cmd_run_context_t *ctx, char *cmd, char *params, void *user_data)
 {
 	struct cfgs_context_t *wctx = (struct cfgs_context_t *)user_data;
-	int fd;
 	int i;
 
 	UNUSED(cmd);
@@ -288,13 +504,11 @@ static int cfgs_list_cmd(cmd_run_context_t *ctx, char *cmd, char *params, void *
 
 	hlog_info(CFGS_MODULE, "Supported config parameters:");
 	for (i = 0; i < wctx->count; i++) {
-		snprintf(wctx->buff, BUFF_SIZE, "%s/%s", CFG_DIR, wctx->cfg_params[i]->name);
-		fd = pico_open(wctx->buff, LFS_O_RDONLY);
+		if (!wctx->cfg_params[i]->known)
+			continue;
 		hlog_info(CFGS_MODULE, "\t [%c] %s",
-				  fd >= 0 ? '*' : ' ',
+				  wctx->cfg_params[i]->value ? '*' : ' ',
 				  wctx->cfg_params[i]->name);
-		if (fd >= 0)
-			pico_close(fd);
 	}
 
 	return 0;
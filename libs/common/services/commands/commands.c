@@ -13,6 +13,7 @@
 #define MAX_CMD_MOD_HANDLERS	64
 #define MAX_CMD_MOD_HOOKS		2
 #define CMD_PARAM_DELIMITER		'?'
+#define CMD_HASH_MIN_SIZE		64
 
 #define IS_DEBUG(C)	((C) && (C)->debug)
 
@@ -29,10 +30,25 @@ struct cmd_mod_handler_t {
 	struct cmd_handler_t *mod_cb[MAX_CMD_MOD_HOOKS];
 };
 
+/* Open addressing hash table of all commands, keyed by "<module>?<command>" */
+struct cmd_hash_entry_t {
+	uint32_t hash;
+	char *module;
+	app_command_t *cmd;
+	void *user_data;
+};
+
+struct cmd_hash_t {
+	struct cmd_hash_entry_t *entries;
+	int size;
+	int count;
+};
+
 struct cmd_context_t {
 	sys_module_t mod;
 	int count;
 	struct cmd_mod_handler_t *handlers[MAX_CMD_MOD_HANDLERS];
+	struct cmd_hash_t table;
 	uint32_t debug;
 };
 
@@ -157,55 +173,134 @@ print_about:
 	return 0;
 }
 
+static uint32_t cmd_hash(const char *module, int mod_len, const char *cmd, int cmd_len)
+{
+	uint32_t hash = SYS_HASH_INIT;
+
+	hash = sys_hash(hash, module, mod_len);
+	hash = sys_hash(hash, "?", 1);
+	return sys_hash(hash, cmd, cmd_len);
+}
+
+static bool cmd_str_eq(const char *str, const char *key, int key_len)
+{
+	return (strlen(str) == (size_t)key_len && !strncmp(str, key, key_len));
+}
+
+static struct cmd_hash_entry_t *cmd_hash_find(struct cmd_hash_t *table, const char *module, int mod_len,
+											  const char *cmd, int cmd_len)
+{
+	struct cmd_hash_entry_t *entry;
+	uint32_t hash;
+	int i;
+
+	if (!table->size)
+		return NULL;
+
+	hash = cmd_hash(module, mod_len, cmd, cmd_len);
+	i = hash & (table->size - 1);
+	while (table->entries[i].cmd) {
+		entry = &table->entries[i];
+		if (entry->hash == hash &&
+		    cmd_str_eq(entry->module, module, mod_len) &&
+		    cmd_str_eq(entry->cmd->command, cmd, cmd_len))
+			return entry;
+		i = (i + 1) & (table->size - 1);
+	}
+
+	return NULL;
+}
+
+static void cmd_hash_insert(struct cmd_hash_t *table, struct cmd_hash_entry_t *new)
+{
+	int i = new->hash & (table->size - 1);
+
+	while (table->entries[i].cmd)
+		i = (i + 1) & (table->size - 1);
+	table->entries[i] = *new;
+	table->count++;
+}
+
+/* Keep the load factor of the table below 1/2 */
+static int cmd_hash_reserve(struct cmd_hash_t *table, int count)
+{
+	struct cmd_hash_entry_t *old = table->entries;
+	int old_size = table->size;
+	int size;
+	int i;
+
+	size = table->size ? table->size : CMD_HASH_MIN_SIZE;
+	while ((table->count + count) * 2 > size)
+		size *= 2;
+	if (size == table->size)
+		return 0;
+
+	table->entries = calloc(size, sizeof(struct cmd_hash_entry_t));
+	if (!table->entries) {
+		table->entries = old;
+		return -1;
+	}
+	table->size = size;
+	table->count = 0;
+	for (i = 0; i < old_size; i++) {
+		if (old[i].cmd)
+			cmd_hash_insert(table, &old[i]);
+	}
+	free(old);
+
+	return 0;
+}
+
+static int cmd_hash_add(struct cmd_hash_t *table, char *module,
+						app_command_t *commands, int commands_cont, void *user_data)
+{
+	struct cmd_hash_entry_t entry;
+	int i;
+
+	if (cmd_hash_reserve(table, commands_cont))
+		return -1;
+
+	for (i = 0; i < commands_cont; i++) {
+		if (!commands[i].cb || !commands[i].command)
+			continue;
+		/* The first registered command with given name wins */
+		if (cmd_hash_find(table, module, strlen(module),
+						  commands[i].command, strlen(commands[i].command)))
+			continue;
+		entry.hash = cmd_hash(module, strlen(module),
+							  commands[i].command, strlen(commands[i].command));
+		entry.module = module;
+		entry.cmd = &commands[i];
+		entry.user_data = user_data;
+		cmd_hash_insert(table, &entry);
+	}
+
+	return 0;
+}
+
 /* API */
 int cmd_exec(cmd_run_context_t *cmd_ctx, char *cmd_str)
 {
 	struct cmd_context_t *ctx = cmd_context_get();
-	app_command_t *cmd;
+	struct cmd_hash_entry_t *entry;
 	bool exec = false;
-	int data_offset;
+	int mod_len, cmd_len;
+	char *cmd, *delim;
 	int ret = -1;
-	int i, j, k;
-	char *url;
 
 	if (!ctx || !cmd_str)
 		return -1;
 
-	for (i = 0; i < ctx->count; i++) {
-		url = ctx->handlers[i]->module;
-		if (!url)
-			continue;
-		if (strlen(url) > strlen(cmd_str))
-			continue;
-		if (strncmp(url, cmd_str, strlen(url)))
-			continue;
-		data_offset = strlen(url);
-		if (cmd_str[data_offset] != CMD_PARAM_DELIMITER)
-			continue;
-		data_offset++;
-		for (j = 0; j < ctx->handlers[i]->count; j++) {
-			for (k = 0; k < ctx->handlers[i]->mod_cb[j]->count; k++) {
-				cmd = &ctx->handlers[i]->mod_cb[j]->cmd_cb[k];
-				if (!cmd->cb)
-					continue;
-				if (strlen(cmd->command) > strlen(cmd_str + data_offset))
-					continue;
-				if (strncmp(cmd->command, cmd_str + data_offset, strlen(cmd->command)))
-					continue;
-				if (strlen(cmd_str + data_offset) > strlen(cmd->command)) {
-					if (cmd_str[data_offset + strlen(cmd->command)] != ':')
-						continue;
-				}
-				data_offset += strlen(cmd->command);
-				ret = cmd->cb(cmd_ctx, cmd->command, cmd_str + data_offset,
-							  ctx->handlers[i]->mod_cb[j]->user_data);
-				exec = true;
-				break;
-			}
-			if (k < ctx->handlers[i]->mod_cb[j]->count)
-				break;
+	delim = strchr(cmd_str, CMD_PARAM_DELIMITER);
+	if (delim) {
+		mod_len = delim - cmd_str;
+		cmd = delim + 1;
+		cmd_len = strcspn(cmd, ":");
+		entry = cmd_hash_find(&ctx->table, cmd_str, mod_len, cmd, cmd_len);
+		if (entry) {
+			ret = entry->cmd->cb(cmd_ctx, entry->cmd->command, cmd + cmd_len, entry->user_data);
+			exec = true;
 		}
-		break;
 	}
 
 	if (!exec) {
@@ -268,6 +363,10 @@ int cmd_handler_add(char *module, app_command_t *commands, int commands_cont, ch
 	cmd_handler = calloc(1, sizeof(struct cmd_handler_t));
 	if (!cmd_handler)
 		return -1;
+	if (cmd_hash_add(&ctx->table, mod_handler->module, commands, commands_cont, user_data)) {
+		free(cmd_handler);
+		return -1;
+	}
 	cmd_handler->description = description;
 	cmd_handler->count = commands_cont;
 	cmd_handler->user_data = user_data;
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#define CORE1_MODULE		"core1"
+#define CORE1_JOBS_MAX		8
+/* Must be power of 2 */
+#define CORE1_QUEUE_SIZE	16
+#define CORE1_IDLE_MS		1
+/* Max messages, processed on core0 per main loop iteration */
+#define CORE1_COLLECT_MAX	8
+
+/* The data is first and word aligned, the jobs may cast it to their own struct */
+struct core1_msg_t {
+	uint32_t data[CORE1_DATA_MAX / 4];
+	uint32_t job;
+};
+
+/*
+ * Single producer (core1), single consumer (core0) queue. Only core1 moves
+ * the head and only core0 moves the tail.
+ */
+struct core1_queue_t {
+	struct core1_msg_t msgs[CORE1_QUEUE_SIZE];
+	uint32_t head;
+	uint32_t tail;
+};
+
+struct core1_context_t {
+	sys_module_t mod;
+	uint32_t debug;
+	bool running;
+	core1_job_t *jobs[CORE1_JOBS_MAX];
+	int jobs_count;
+	struct core1_queue_t queue;
+	uint32_t loop_max_us;
+};
+
+/* Static, as the devices may register jobs before the module is initialized */
+static struct core1_context_t __core1_context;
+
+static struct core1_context_t *core1_context_get(void)
+{
+	return &__core1_context;
+}
+
+static bool core1_queue_put(struct core1_queue_t *q, uint32_t job, const uint32_t *data)
+{
+	uint32_t head = q->head;
+
+	if ((head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE)) >= CORE1_QUEUE_SIZE)
+		return false;
+	q->msgs[head & (CORE1_QUEUE_SIZE - 1)].job = job;
+	memcpy(q->msgs[head & (CORE1_QUEUE_SIZE - 1)].data, data, CORE1_DATA_MAX);
+	__atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+static struct core1_msg_t *core1_queue_peek(struct core1_queue_t *q)
+{
+	uint32_t tail = q->tail;
+
+	if (tail == __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+		return NULL;
+	return &q->msgs[tail & (CORE1_QUEUE_SIZE - 1)];
+}
+
+static void core1_queue_pop(struct core1_queue_t *q)
+{
+	__atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Main loop of core1, runs the jobs only */
+static void core1_main(void)
+{
+	struct core1_context_t *ctx = core1_context_get();
+	uint32_t data[CORE1_DATA_MAX / 4];
+	uint64_t now;
+	uint32_t start;
+	int i;
+
+	/* Allow flash_safe_execute() on core0 to pause this core, while writing to the flash */
+	multicore_lockout_victim_init();
+
+	while (true) {
+		start = time_us_32();
+		now = time_ms_since_boot();
+		for (i = 0; i < ctx->jobs_count; i++) {
+			if (ctx->jobs[i]->last_run &&
+			    (now - ctx->jobs[i]->last_run) < ctx->jobs[i]->interval_ms)
+				continue;
+			ctx->jobs[i]->last_run = now;
+			ctx->jobs[i]->runs++;
+			memset(data, 0, CORE1_DATA_MAX);
+			if (ctx->jobs[i]->acquire(ctx->jobs[i]->context, data))
+				continue;
+			if (!core1_queue_put(&ctx->queue, i, data))
+				ctx->jobs[i]->dropped++;
+		}
+		start = time_us_32() - start;
+		if (start > ctx->loop_max_us)
+			ctx->loop_max_us = start;
+		sleep_ms(CORE1_IDLE_MS);
+	}
+}
+
+static void core1_run(void *context)
+{
+	struct core1_context_t *ctx = (struct core1_context_t *)context;
+	struct core1_msg_t *msg;
+	int i;
+
+	/* All modules are initialized, start the jobs */
+	if (!ctx->running) {
+		if (!ctx->jobs_count)
+			return;
+		multicore_launch_core1(core1_main);
+		ctx->running = true;
+		hlog_info(CORE1_MODULE, "Started %d jobs on core1", ctx->jobs_count);
+		return;
+	}
+
+	for (i = 0; i < CORE1_COLLECT_MAX; i++) {
+		msg = core1_queue_peek(&ctx->queue);
+		if (!msg)
+			break;
+		if ((int)msg->job < ctx->jobs_count && ctx->jobs[msg->job]->collect)
+			ctx->jobs[msg->job]->collect(ctx->jobs[msg->job]->context, msg->data);
+		core1_queue_pop(&ctx->queue);
+	}
+}
+
+static bool core1_log_status(void *context)
+{
+	struct core1_context_t *ctx = (struct core1_context_t *)context;
+	int i;
+
+	if (!ctx->jobs_count) {
+		hlog_info(CORE1_MODULE, "No jobs, core1 is not used");
+		return true;
+	}
+	hlog_info(CORE1_MODULE, "%s %d jobs, max loop %uus",
+		  ctx->running ? "Running" : "Not started", ctx->jobs_count, ctx->loop_max_us);
+	for (i = 0; i < ctx->jobs_count; i++)
+		hlog_info(CORE1_MODULE, "\t%s: every %ums, %u runs, %u dropped",
+			  ctx->jobs[i]->name, ctx->jobs[i]->interval_ms,
+			  ctx->jobs[i]->runs, ctx->jobs[i]->dropped);
+
+	return true;
+}
+
+static void core1_debug_set(uint32_t lvl, void *context)
+{
+	struct core1_context_t *ctx = (struct core1_context_t *)context;
+
+	ctx->debug = lvl;
+}
+
+/* API */
+int core1_job_register(core1_job_t *job)
+{
+	struct core1_context_t *ctx = core1_context_get();
+
+	if (!job || !job->acquire)
+		return -1;
+	if (ctx->running || ctx->jobs_count >= CORE1_JOBS_MAX)
+		return -1;
+	ctx->jobs[ctx->jobs_count++] = job;
+
+	return 0;
+}
+
+/* The flash writes must pause core1, while it runs */
+bool core1_running(void)
+{
+	return core1_context_get()->running;
+}
+
+void sys_core1_register(void)
+{
+	struct core1_context_t *ctx = core1_context_get();
+
+	ctx->mod.name = CORE1_MODULE;
+	ctx->mod.run = core1_run;
+	ctx->mod.log = core1_log_status;
+	ctx->mod.debug = core1_debug_set;
+	ctx->mod.context = ctx;
+	sys_module_register(&ctx->mod);
+}
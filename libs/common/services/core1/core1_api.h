@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _LIB_SYS_CORE1_API_H_
+#define _LIB_SYS_CORE1_API_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Max size of the data, passed from core1 to core0. Multiple of 4, the data is word aligned */
+#define CORE1_DATA_MAX	32
+
+typedef struct {
+	const char *name;
+	uint32_t interval_ms;
+	/* Runs on core1. Returns 0 if new data is stored in data */
+	int (*acquire)(void *context, void *data);
+	/* Runs on core0, from the main loop, with the data from acquire */
+	void (*collect)(void *context, void *data);
+	void *context;
+	/* Internal */
+	uint64_t last_run;
+	uint32_t runs;
+	uint32_t dropped;
+} core1_job_t;
+
+int core1_job_register(core1_job_t *job);
+
+#ifdef HAVE_SYS_CORE1
+bool core1_running(void);
+#else /* HAVE_SYS_CORE1 */
+#define core1_running()	false
+#endif /* HAVE_SYS_CORE1 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LIB_SYS_CORE1_API_H_ */
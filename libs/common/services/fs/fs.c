@@ -7,6 +7,7 @@
 #include <stdarg.h>
 
 #include "pico/stdlib.h"
+#include "pico/flash.h"
 #include "pico_hal.h"
 
 #include "herak_sys.h"
@@ -16,6 +17,7 @@
 #include "fs_internal.h"
 
 #define HAVE_CAT_COMMAND	1
+#define FS_FLASH_TIMEOUT_MS	1000
 
 static __in_flash() struct {
 	enum lfs_error err;
@@ -40,6 +42,126 @@ static __in_flash() struct {
 
 static struct fs_context_t *__fs_context;
 
+/* File system calls, that may write to the flash */
+enum fs_flash_op_t {
+	FS_OP_MOUNT = 0,
+	FS_OP_UNMOUNT,
+	FS_OP_OPEN,
+	FS_OP_CLOSE,
+	FS_OP_WRITE,
+	FS_OP_LSEEK,
+	FS_OP_REMOVE,
+	FS_OP_RENAME,
+	FS_OP_MKDIR,
+};
+
+struct fs_flash_call_t {
+	enum fs_flash_op_t op;
+	int fd;
+	const char *path;
+	const char *new_path;
+	const void *buff;
+	int arg;
+	int whence;
+	int ret;
+};
+
+static void fs_flash_call_run(void *param)
+{
+	struct fs_flash_call_t *call = (struct fs_flash_call_t *)param;
+
+	switch (call->op) {
+	case FS_OP_MOUNT:
+		call->ret = pico_mount(call->arg);
+		break;
+	case FS_OP_UNMOUNT:
+		call->ret = pico_unmount();
+		break;
+	case FS_OP_OPEN:
+		call->ret = pico_open(call->path, call->arg);
+		break;
+	case FS_OP_CLOSE:
+		call->ret = pico_close(call->fd);
+		break;
+	case FS_OP_WRITE:
+		call->ret = pico_write(call->fd, call->buff, call->arg);
+		break;
+	case FS_OP_LSEEK:
+		call->ret = pico_lseek(call->fd, call->arg, call->whence);
+		break;
+	case FS_OP_REMOVE:
+		call->ret = pico_remove(call->path);
+		break;
+	case FS_OP_RENAME:
+		call->ret = pico_rename(call->path, call->new_path);
+		break;
+	case FS_OP_MKDIR:
+		call->ret = pico_mkdir(call->path);
+		break;
+	default:
+		call->ret = LFS_ERR_INVAL;
+		break;
+	}
+}
+
+/*
+ * The littlefs HAL disables the interrupts while it erases or programs the flash.
+ * The code runs from the flash, so core1 must not run meanwhile too: if it is
+ * started, flash_safe_execute() pauses it for the call.
+ */
+static int fs_flash_call(struct fs_flash_call_t *call)
+{
+	if (!core1_running()) {
+		fs_flash_call_run(call);
+		return call->ret;
+	}
+	if (flash_safe_execute(fs_flash_call_run, call, FS_FLASH_TIMEOUT_MS) != PICO_OK)
+		return LFS_ERR_IO;
+	return call->ret;
+}
+
+static int fs_flash_mount(bool format)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_MOUNT, .arg = format };
+
+	return fs_flash_call(&call);
+}
+
+static int fs_flash_unmount(void)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_UNMOUNT };
+
+	return fs_flash_call(&call);
+}
+
+static int fs_flash_open(const char *path, int flags)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_OPEN, .path = path, .arg = flags };
+
+	return fs_flash_call(&call);
+}
+
+static int fs_flash_close(int fd)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_CLOSE, .fd = fd };
+
+	return fs_flash_call(&call);
+}
+
+static int fs_flash_write(int fd, const void *buff, int size)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_WRITE, .fd = fd, .buff = buff, .arg = size };
+
+	return fs_flash_call(&call);
+}
+
+static int fs_flash_lseek(int fd, int off, int whence)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_LSEEK, .fd = fd, .arg = off, .whence = whence };
+
+	return fs_flash_call(&call);
+}
+
 struct fs_context_t *fs_context_get(void)
 {
 	return __fs_context;
@@ -81,9 +203,9 @@ static bool sys_fs_init(struct fs_context_t **ctx)
 	if (!(*ctx))
 		return false;
 
-	if (pico_mount(false) < 0) {
+	if (fs_flash_mount(false) < 0) {
 		hlog_info(FS_MODULE, "Fromatting new FS in flash.");
-		if (pico_mount(true) < 0)
+		if (fs_flash_mount(true) < 0)
 			goto out_err;
 	}
 	(*ctx)->copy_job.local_fd = -1;
@@ -100,16 +222,53 @@ static bool sys_fs_init(struct fs_context_t **ctx)
 	return false;
 }
 
+static void fs_read_buf_free(struct fs_context_t *ctx, int fd)
+{
+	free(ctx->read_buf[fd].data);
+	memset(&ctx->read_buf[fd], 0, sizeof(struct fs_read_buf_t));
+}
+
+/* Drop the buffered data and move the file position back to the last byte consumed by the user */
+static void fs_read_buf_sync(struct fs_context_t *ctx, int fd)
+{
+	struct fs_read_buf_t *rbuf = &ctx->read_buf[fd];
+
+	if (rbuf->pos < rbuf->len)
+		fs_flash_lseek(ctx->open_fd[fd], -(lfs_soff_t)(rbuf->len - rbuf->pos), LFS_SEEK_CUR);
+	rbuf->len = 0;
+	rbuf->pos = 0;
+}
+
+static int fs_read_buf_fill(struct fs_context_t *ctx, int fd)
+{
+	struct fs_read_buf_t *rbuf = &ctx->read_buf[fd];
+	int ret;
+
+	if (!rbuf->data) {
+		rbuf->data = malloc(FS_READ_BUF_SIZE);
+		if (!rbuf->data)
+			return -1;
+	}
+	rbuf->pos = 0;
+	rbuf->len = 0;
+	ret = pico_read(ctx->open_fd[fd], rbuf->data, FS_READ_BUF_SIZE);
+	if (ret > 0)
+		rbuf->len = ret;
+
+	return ret;
+}
+
 static void fs_close_all(struct fs_context_t *ctx)
 {
 	int i;
 
 	for (i = 0; i < MAX_OPENED_FILES; i++) {
 		if (ctx->open_fd[i] >= 0) {
-			pico_close(ctx->open_fd[i]);
+			fs_flash_close(ctx->open_fd[i]);
 			if (IS_DEBUG(ctx))
 				hlog_info(FS_MODULE, "Closing fd %d", ctx->open_fd[i]);
 			ctx->open_fd[i] = -1;
+			fs_read_buf_free(ctx, i);
 		}
 	}
 }
@@ -125,9 +284,10 @@ static int fs_format(cmd_run_context_t *ctx, char *cmd, char *params, void *user
 
 	hlog_info(FS_MODULE, "Formatting file system ...");
 
-	ret = pico_unmount();
+	ret = fs_flash_unmount();
 	if (!ret)
-		ret = pico_mount(true);
+		ret = fs_flash_mount(true);
+	wctx->changes++;
 
 	if (IS_DEBUG(wctx))
 		hlog_info(FS_MODULE, "\tFormatted new FS: [%s]", fs_get_err_msg(ret));
@@ -150,7 +310,7 @@ static int fs_rm_path(cmd_run_context_t *ctx, char *cmd, char *params, void *use
 	} else {
 		path = strtok_r(params, ":", &rest);
 	}
-	ret = pico_remove(path);
+	ret = fs_remove(path);
 	if (ret < 0)
 		hlog_info(FS_MODULE, "\tDeletion of [%s] failed with [%s]", path, fs_get_err_msg(ret));
 
@@ -294,7 +454,7 @@ out:
 	if (dfd >= 0)
 		fs_close(dfd);
 	if (ret < 0)
-		pico_remove(dst);
+		fs_remove(dst);
 	return ret;
 }
 
@@ -328,7 +488,7 @@ static int fs_mv_file(cmd_run_context_t *ctx, char *cmd, char *params, void *use
 		goto out;
 	}
 
-	ret = pico_rename(copy.src.fname, copy.dst.fname);
+	ret = fs_rename(copy.src.fname, copy.dst.fname);
 	if (ret != LFS_ERR_OK) {
 		hlog_warning(FS_MODULE, "\tFailed to move files: %s", fs_get_err_msg(ret));
 		ret = -1;
@@ -560,6 +720,17 @@ int fs_get_files_count(char *dir_path, char *ext)
 	return count;
 }
 
+/* Count of the changes made through the FS API, can be used to detect modified files */
+uint32_t fs_get_changes(void)
+{
+	struct fs_context_t *ctx = fs_context_get();
+
+	if (!ctx)
+		return 0;
+
+	return ctx->changes;
+}
+
 #define FS_UKNOWN_STR	32
 char *fs_get_err_msg(int err)
 {
@@ -594,13 +765,15 @@ int fs_open(char *path, enum lfs_open_flags flags)
 		return -1;
 	}
 
-	fd = pico_open(path, flags);
+	fd = fs_flash_open(path, flags);
 	if (fd < 0) {
 		if (IS_DEBUG(ctx))
 			hlog_info(FS_MODULE, "Fail to open [%s]: [%s]", path, fs_get_err_msg(fd));
 		return -1;
 	}
 	ctx->open_fd[i] = fd;
+	if (flags & LFS_O_WRONLY)
+		ctx->changes++;
 	if (IS_DEBUG(ctx))
 		hlog_info(FS_MODULE, "Open file [%s]: %d %d", path, fd, i);
 
@@ -620,18 +793,20 @@ void fs_close(int fd)
 			hlog_info(FS_MODULE, "Cannot close [%d]: invalid descriptor", fd);
 		return;
 	}
-	ret = pico_close(ctx->open_fd[fd]);
+	ret = fs_flash_close(ctx->open_fd[fd]);
 	if (IS_DEBUG(ctx))
 		hlog_info(FS_MODULE, "Close %d %d: [%s]", ctx->open_fd[fd], fd, fs_get_err_msg(ret));
 	ctx->open_fd[fd] = -1;
+	fs_read_buf_free(ctx, fd);
 }
 
 static int fs_read_check(int fd, char *buff, int buff_size, char *stops, int count_stops)
 {
 	struct fs_context_t *ctx = fs_context_get();
+	struct fs_read_buf_t *rbuf;
 	int count = 0;
-	char byte;
-	int i, ret;
+	int i, n, ret = 0;
+	char *data;
 
 	if (!ctx)
 		return -1;
@@ -641,35 +816,52 @@ static int fs_read_check(int fd, char *buff, int buff_size, char *stops, int cou
 			hlog_info(FS_MODULE, "Cannot read [%d]: invalid descriptor", fd);
 		return -1;
 	}
+	rbuf = &ctx->read_buf[fd];
 
 	if (stops && count_stops > 0) {
-		do {
-			ret = pico_read(ctx->open_fd[fd], &byte, 1);
-			if (ret != 1) {
-				if (ret <= 0)
-					count = -1;
-				break;
+		/* Look for the stop characters in the read ahead buffer */
+		while (count < buff_size) {
+			if (rbuf->pos >= rbuf->len) {
+				ret = fs_read_buf_fill(ctx, fd);
+				if (ret <= 0) {
+					if (!count)
+						count = -1;
+					break;
+				}
 			}
-			for (i = 0; i < count_stops; i++) {
-				if (byte == stops[i])
+			data = rbuf->data + rbuf->pos;
+			n = MIN(rbuf->len - rbuf->pos, buff_size - count);
+			for (i = 0; i < n; i++) {
+				if (memchr(stops, data[i], count_stops))
 					break;
 			}
-			if (i < count_stops)
+			memcpy(buff + count, data, i);
+			count += i;
+			rbuf->pos += i;
+			if (i < n) {
+				/* Consume the stop character */
+				rbuf->pos++;
 				break;
-			buff[count++] = byte;
-			if (count >= buff_size)
-				break;
-		} while (true);
+			}
+		}
 	} else {
-		ret = pico_read(ctx->open_fd[fd], buff, buff_size);
-		if (ret < 0)
-			count = -1;
-		else
-			count = ret;
+		/* Get the buffered data first, read the rest directly in the user buffer */
+		if (rbuf->pos < rbuf->len) {
+			count = MIN(rbuf->len - rbuf->pos, buff_size);
+			memcpy(buff, rbuf->data + rbuf->pos, count);
+			rbuf->pos += count;
+		}
+		if (count < buff_size) {
+			ret = pico_read(ctx->open_fd[fd], buff + count, buff_size - count);
+			if (ret > 0)
+				count += ret;
+			else if (ret < 0 && !count)
+				count = -1;
+		}
 	}
 	if (IS_DEBUG(ctx))
 		hlog_info(FS_MODULE, "Read %d bytes from %d: %s", count, fd,
-				  count < 0 ? fs_get_err_msg(ret) : fs_get_err_msg(LFS_ERR_OK));
+				  ret < 0 ? fs_get_err_msg(ret) : fs_get_err_msg(LFS_ERR_OK));
 
 	return count;
 }
@@ -680,11 +872,10 @@ int fs_gets(int fd, char *buff, int buff_size)
 	int ret;
 
 	buff[0] = 0;
-	ret = fs_read_check(fd, buff, buff_size, new_line, ARRAY_SIZE(new_line));
-	if (ret > 0 && ret < buff_size)
+	/* Leave room for the terminator, the rest of a long line is returned by the next call */
+	ret = fs_read_check(fd, buff, buff_size - 1, new_line, ARRAY_SIZE(new_line));
+	if (ret > 0)
 		buff[ret] = 0;
-	else
-		buff[buff_size - 1] = 0;
 
 	return ret;
 }
@@ -707,7 +898,7 @@ int fs_get_pos(int fd)
 		return -1;
 	}
 
-	return (int)pico_tell(ctx->open_fd[fd]);
+	return (int)pico_tell(ctx->open_fd[fd]) - (ctx->read_buf[fd].len - ctx->read_buf[fd].pos);
 }
 
 int fs_lseek(int fd, int off, int whence)
@@ -722,7 +913,8 @@ int fs_lseek(int fd, int off, int whence)
 			hlog_info(FS_MODULE, "Cannot read [%d]: invalid descriptor", fd);
 		return -1;
 	}
-	return (int)pico_lseek(ctx->open_fd[fd], (lfs_soff_t)off, whence);
+	fs_read_buf_sync(ctx, fd);
+	return fs_flash_lseek(ctx->open_fd[fd], off, whence);
 }
 
 int fs_write(int fd, char *buff, int buff_size)
@@ -739,7 +931,10 @@ int fs_write(int fd, char *buff, int buff_size)
 		return -1;
 	}
 
-	ret = pico_write(ctx->open_fd[fd], buff, buff_size);
+	fs_read_buf_sync(ctx, fd);
+	ret = fs_flash_write(ctx->open_fd[fd], buff, buff_size);
+	if (ret > 0)
+		ctx->changes++;
 
 	if (IS_DEBUG(ctx))
 		hlog_info(FS_MODULE, "Write %d bytes to %d: %d %s", buff_size, fd, ret,
@@ -747,6 +942,39 @@ int fs_write(int fd, char *buff, int buff_size)
 	return ret;
 }
 
+int fs_remove(char *path)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_REMOVE, .path = path };
+	struct fs_context_t *ctx = fs_context_get();
+
+	if (!ctx)
+		return -1;
+	ctx->changes++;
+	return fs_flash_call(&call);
+}
+
+int fs_rename(char *old_path, char *new_path)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_RENAME, .path = old_path, .new_path = new_path };
+	struct fs_context_t *ctx = fs_context_get();
+
+	if (!ctx)
+		return -1;
+	ctx->changes++;
+	return fs_flash_call(&call);
+}
+
+int fs_mkdir(char *path)
+{
+	struct fs_flash_call_t call = { .op = FS_OP_MKDIR, .path = path };
+	struct fs_context_t *ctx = fs_context_get();
+
+	if (!ctx)
+		return -1;
+	ctx->changes++;
+	return fs_flash_call(&call);
+}
+
 static app_command_t fs_cmd_requests[] = {
 	{"format", " - format the file system", fs_format},
 #ifdef HAVE_CAT_COMMAND
@@ -18,6 +18,7 @@ extern "C" {
 bool fs_is_mounted(void);
 char *fs_get_err_msg(int err);
 int fs_get_files_count(char *dir_path, char *ext);
+uint32_t fs_get_changes(void);
 
 int fs_open(char *path, enum lfs_open_flags flags);
 void fs_close(int fd);
@@ -26,6 +27,9 @@ int fs_read(int fd, char *buff, int buff_size);
 int fs_write(int fd, char *buff, int buff_size);
 int fs_get_pos(int fd);
 int fs_lseek(int fd, int off, int whence);
+int fs_remove(char *path);
+int fs_rename(char *old_path, char *new_path);
+int fs_mkdir(char *path);
 
 #ifdef __cplusplus
 }
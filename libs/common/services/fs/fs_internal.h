@@ -11,6 +11,8 @@
 struct fs_context_t;
 
 #define MAX_OPENED_FILES	10
+/* Read ahead buffer, matches the flash page size used as littlefs cache */
+#define FS_READ_BUF_SIZE	256
 #define IS_DEBUG(C)	((C) && (C)->debug)
 
 struct fs_file_copy_t {
@@ -21,11 +23,19 @@ struct fs_file_copy_t {
 	int web_idx;
 	struct fs_context_t *fs_ctx;
 };
+struct fs_read_buf_t {
+	char *data;
+	int len;
+	int pos;
+};
+
 struct fs_context_t {
 	sys_module_t mod;
 	uint32_t debug;
 	struct fs_file_copy_t copy_job;
 	int open_fd[MAX_OPENED_FILES];
+	struct fs_read_buf_t read_buf[MAX_OPENED_FILES];
+	uint32_t changes;
 };
 
 struct fs_context_t *fs_context_get(void);
@@ -28,7 +28,7 @@ static int tftp_dirs_create(struct fs_context_t *ctx, const char *fname)
 	i++;
 	while (fname[i] && i < FS_MAX_FILE_PATH) {
 		if (fname[i] == '/') {
-			ret = pico_mkdir(fcreate);
+			ret = fs_mkdir(fcreate);
 			if (IS_DEBUG(ctx))
 				hlog_warning(FS_MODULE, "Create directory [%s]: %s", fcreate, fs_get_err_msg(ret));
 			if (ret && ret != LFS_ERR_EXIST)
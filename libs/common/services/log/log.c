@@ -31,6 +31,21 @@
 
 #define IP_TIMEOUT_MS	10000
 
+/* Messages to the syslog server are queued and sent from the module's run callback */
+#define LOG_RING_SIZE	4096	/* Must be power of 2 */
+#define LOG_RING_MASK	(LOG_RING_SIZE - 1)
+#define LOG_FLUSH_MAX	16
+#define LOG_REC_HDR		2
+
+struct log_ring_t {
+	char data[LOG_RING_SIZE];
+	uint32_t head;
+	uint32_t tail;
+	uint32_t queued;
+	uint32_t sent;
+	uint32_t dropped;
+};
+
 struct log_context_t {
 	sys_module_t mod;
 	char *server_url;
@@ -43,6 +58,7 @@ struct log_context_t {
 	struct udp_pcb *log_pcb;
 	int log_level;
 	mutex_t lock;
+	struct log_ring_t ring;
 	uint32_t debug;
 };
 
@@ -109,6 +125,7 @@ static bool sys_log_status(void *context)
 	struct log_context_t *ctx = (struct log_context_t *)context;
 	ip_resolve_state_t sever_ip_state;
 	ip_addr_t server_addr;
+	uint32_t queued, sent, dropped;
 	int dcount;
 
 	if (!ctx->server_url) {
@@ -120,6 +137,9 @@ static bool sys_log_status(void *context)
 		memcpy(&server_addr, &(ctx->server_addr), sizeof(ip_addr_t));
 		sever_ip_state = ctx->sever_ip_state;
 		dcount = ctx->connect_count;
+		queued = ctx->ring.queued;
+		sent = ctx->ring.sent;
+		dropped = ctx->ring.dropped;
 	LOG_UNLOCK(ctx);
 
 	switch (sever_ip_state) {
@@ -134,6 +154,7 @@ static bool sys_log_status(void *context)
 				  ctx->server_url, inet_ntoa(server_addr), dcount);
 		break;
 	}
+	hlog_info(LOG_MODULE, "Messages queued %lu, sent %lu, dropped %lu", queued, sent, dropped);
 
 	return true;
 }
@@ -263,27 +284,95 @@ out:
 		} \
 	}}
 
-static void slog_send(struct log_context_t *ctx, char *log_buff)
+static void log_ring_copy_in(struct log_ring_t *ring, uint32_t off, const char *buf, int len)
 {
-	int len = strlen(log_buff)+1;
+	uint32_t idx = off & LOG_RING_MASK;
+	int chunk = MIN(len, LOG_RING_SIZE - (int)idx);
+
+	memcpy(ring->data + idx, buf, chunk);
+	memcpy(ring->data, buf + chunk, len - chunk);
+}
+
+static void log_ring_copy_out(struct log_ring_t *ring, uint32_t off, char *buf, int len)
+{
+	uint32_t idx = off & LOG_RING_MASK;
+	int chunk = MIN(len, LOG_RING_SIZE - (int)idx);
+
+	memcpy(buf, ring->data + idx, chunk);
+	memcpy(buf + chunk, ring->data, len - chunk);
+}
+
+/* Must be called with the log lock held, never blocks */
+static void log_ring_put(struct log_ring_t *ring, char *log_buff, int len)
+{
+	uint8_t hdr[LOG_REC_HDR];
+
+	if (len + LOG_REC_HDR > LOG_RING_SIZE - (int)(ring->head - ring->tail)) {
+		ring->dropped++;
+		return;
+	}
+	hdr[0] = len & 0xFF;
+	hdr[1] = (len >> 8) & 0xFF;
+	log_ring_copy_in(ring, ring->head, (char *)hdr, LOG_REC_HDR);
+	log_ring_copy_in(ring, ring->head + LOG_REC_HDR, log_buff, len);
+	ring->head += len + LOG_REC_HDR;
+	ring->queued++;
+}
+
+/*
+ * Send up to LOG_FLUSH_MAX queued messages, one message per datagram as in RFC5426.
+ * A message is removed from the queue only when it is sent, on error it is sent
+ * again on the next run or after reconnect.
+ */
+static void slog_flush(struct log_context_t *ctx)
+{
+	uint8_t hdr[LOG_REC_HDR];
 	struct pbuf *p;
 	err_t err;
+	int i, len;
 
-	LWIP_LOCK_START;
-		p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
-	LWIP_LOCK_END;
-	if (!p)
-		return;
+	for (i = 0; i < LOG_FLUSH_MAX; i++) {
+		LOG_LOCK(ctx);
+			if (ctx->sever_ip_state != IP_RESOLVED || ctx->ring.head == ctx->ring.tail) {
+				LOG_UNLOCK(ctx);
+				break;
+			}
+			log_ring_copy_out(&ctx->ring, ctx->ring.tail, (char *)hdr, LOG_REC_HDR);
+			len = hdr[0] | (hdr[1] << 8);
+			LWIP_LOCK_START;
+				p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+			LWIP_LOCK_END;
+			/* Only the run callback consumes the queue, the record stays in place until sent */
+			if (p)
+				log_ring_copy_out(&ctx->ring, ctx->ring.tail + LOG_REC_HDR, p->payload, len);
+		LOG_UNLOCK(ctx);
+		if (!p)
+			break;
 
-	memcpy(p->payload, log_buff, len);
-	LWIP_LOCK_START;
-		err = udp_sendto(ctx->log_pcb, p, &ctx->server_addr, ctx->server_port);
-		pbuf_free(p);
-	LWIP_LOCK_END;
-	if (err != ERR_OK && err != ERR_MEM)
-		ctx->sever_ip_state = IP_NOT_RESOLEVED;
-	else
-		ctx->last_send = time_ms_since_boot();
+		LWIP_LOCK_START;
+			err = udp_sendto(ctx->log_pcb, p, &ctx->server_addr, ctx->server_port);
+			pbuf_free(p);
+		LWIP_LOCK_END;
+		LOG_LOCK(ctx);
+			if (err == ERR_OK) {
+				ctx->ring.tail += len + LOG_REC_HDR;
+				ctx->last_send = time_ms_since_boot();
+				ctx->ring.sent++;
+			} else if (err != ERR_MEM) {
+				ctx->sever_ip_state = IP_NOT_RESOLEVED;
+			}
+		LOG_UNLOCK(ctx);
+		if (err != ERR_OK)
+			break;
+	}
+}
+
+static void sys_log_run(void *context)
+{
+	struct log_context_t *ctx = (struct log_context_t *)context;
+
+	sys_log_connect(ctx);
+	slog_flush(ctx);
 }
 
 void hlog_any(int severity, const char *topic, const char *fmt, ...)
@@ -318,7 +407,7 @@ void hlog_any(int severity, const char *topic, const char *fmt, ...)
 		printf("%s", log_buff);
 		/* rsyslog server */
 		if (ctx && ctx->sever_ip_state == IP_RESOLVED)
-			slog_send(ctx, log_buff);
+			log_ring_put(&ctx->ring, log_buff, strlen(log_buff) + 1);
 		/* http */
 #ifdef HAVE_SYS_COMMANDS
 		if (ctx && ctx->http_log) {
@@ -344,7 +433,7 @@ void sys_log_register(void)
 		return;
 
 	ctx->mod.name = LOG_MODULE;
-	ctx->mod.run = sys_log_connect;
+	ctx->mod.run = sys_log_run;
 	ctx->mod.reconnect = sys_log_reconnect;
 	ctx->mod.log = sys_log_status;
 	ctx->mod.debug = sys_log_debug_set;
@@ -26,11 +26,12 @@ typedef struct {
 	int id;
 	bool force;
 	uint64_t last_send;
+	uint32_t discovery_hash;
 } mqtt_component_t;
 
 /* MQTT */
 #define MQTT_DEV_QOS    2
-int mqtt_msg_publish(char *topic, char *message, bool force);
+int mqtt_msg_publish(char *topic, char *message);
 int mqtt_msg_component_publish(mqtt_component_t *component, char *message);
 int mqtt_msg_component_register(mqtt_component_t *component);
 
@@ -105,8 +105,9 @@ static void mqtt_config_send(struct mqtt_context_t *ctx)
 		goto out;
 	}
 	if (ctx->config.discovery_comp) {
-
-		ret = mqtt_msg_discovery_send(ctx);
+		/* Skip the components, already discovered with the same configuration */
+		while ((ret = mqtt_msg_discovery_send(ctx)) > 0)
+			ctx->discovery.send_idx++;
 		if (!ret) {
 			sent++;
 			ctx->config.discovery_send++;
@@ -150,6 +151,7 @@ static void mqtt_hook(mqtt_client_t *client, void *arg, mqtt_connection_status_t
 				hlog_info(MQTT_MODULE, "Connected to server %s", ctx->server_url);
 		}
 		ctx->state = MQTT_CLIENT_CONNECTED;
+		mqtt_msg_discovery_reset(ctx);
 		ctx->config.discovery_send = 0;
 		ctx->config.last_send = 0;
 		ctx->send_err_count = 0;
@@ -197,6 +199,7 @@ static bool sys_mqtt_log_status(void *context)
 {
 	struct mqtt_context_t  *ctx = (struct mqtt_context_t *)context;
 	static int log_idx;
+	mqtt_topic_t *topic;
 	int i;
 
 	if (!mqtt_is_connected_ctx(ctx)) {
@@ -208,14 +211,13 @@ static bool sys_mqtt_log_status(void *context)
 	if (!log_idx) {
 		hlog_info(MQTT_MODULE, "Connected to server %s, publish rate limit %dppm, connect count %d",
 				ctx->server_url, ctx->max_ppm, ctx->connect_count);
+		hlog_info(MQTT_MODULE, "Rate limited messages: %d pending, %d queued, %d replaced, %d dropped",
+				ctx->pending.count, ctx->pending.queued, ctx->pending.replaced, ctx->pending.dropped);
 		if (ctx->listen.count) {
-			i = 0;
 			hlog_info(MQTT_MODULE, "Listen for %d topics:", ctx->listen.count);
-			while (ctx->listen.topics[i] && i < MQTT_MAX_TOPICS) {
+			for (topic = ctx->listen.topics; topic; topic = topic->next)
 				hlog_info(MQTT_MODULE, "\t[%s], subscribed %d",
-						  ctx->listen.topics[i]->topic, ctx->listen.topics[i]->subscribed);
-				i++;
-			}
+						  topic->topic, topic->subscribed);
 		}
 
 		if (ctx->status_topic[0]) {
@@ -375,6 +377,7 @@ static void sys_mqtt_run(void *context)
 		return;
 	if (mqtt_incoming_ready(ctx))
 		return;
+	mqtt_msg_pending_send(ctx);
 	mqtt_config_send(ctx);
 }
 
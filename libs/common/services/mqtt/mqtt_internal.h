@@ -16,8 +16,10 @@
 #define MQTT_DISCOVERY_MAX_COUNT	512
 #define MQTT_DISCOVERY_BUFF_SIZE	640
 #define MQTT_MAX_TOPIC_SIZE			96
-#define MQTT_MAX_TOPICS				20
+#define MQTT_MAX_TOPICS				128
 #define MQTT_LISTEN_BUFFERS			2
+/* Queue slots for topics, not registered as components. The queue grows on demand */
+#define MQTT_PENDING_MAX			8
 
 #define ONLINE_MSG				"online"
 #define OFFLINE_MSG				"offline"
@@ -42,18 +44,30 @@ struct mqtt_topic_cb_t {
 	struct mqtt_topic_cb_t *next;
 };
 
-typedef struct {
+struct mqtt_topic_t;
+typedef struct mqtt_topic_t {
 	char topic[MQTT_MAX_TOPIC_SIZE];
 	bool subscribed;
 	bool json;
 	struct mqtt_topic_cb_t *hooks;
+	struct mqtt_topic_t *next;
 } mqtt_topic_t;
 
+/* Topic trie, one node per topic level. Levels may be MQTT wildcards "+" and "#" */
+struct mqtt_topic_node_t;
+struct mqtt_topic_node_t {
+	char *level;
+	mqtt_topic_t *sub;
+	struct mqtt_topic_node_t *children;
+	struct mqtt_topic_node_t *next;
+};
+
 typedef struct {
 	int tot_len;
 	bool in_progress;
 	bool ready;
-	mqtt_topic_t *topic;
+	bool json;
+	char topic[MQTT_MAX_TOPIC_SIZE];
 	char msg[MQTT_OUTPUT_RINGBUF_SIZE];
 	int size;
 	lwjson_token_t json_tokens[MAX_JSON_TOKENS];
@@ -61,7 +75,8 @@ typedef struct {
 } mqtt_listen_buff_t;
 
 typedef struct {
-	mqtt_topic_t *topics[MQTT_MAX_TOPICS];
+	mqtt_topic_t *topics;
+	struct mqtt_topic_node_t root;
 	int count;
 	mqtt_listen_buff_t *current;
 	mqtt_listen_buff_t buffers[MQTT_LISTEN_BUFFERS];
@@ -73,6 +88,24 @@ typedef struct {
 	uint16_t send_idx;
 } mqtt_discovery_context_t;
 
+/* Messages held back by the rate limit, the latest payload per topic wins */
+typedef struct {
+	char topic[MQTT_MAX_TOPIC_SIZE];
+	char *msg;
+	int msg_size;
+	uint64_t queued;
+	bool ready;
+} mqtt_pending_t;
+
+typedef struct {
+	mqtt_pending_t *msgs;
+	int size;
+	int count;
+	uint32_t queued;
+	uint32_t replaced;
+	uint32_t dropped;
+} mqtt_pending_queue_t;
+
 typedef struct {
 	uint64_t last_send;
 	uint32_t discovery_send;
@@ -95,6 +128,7 @@ struct mqtt_context_t {
 	uint16_t cmp_count;
 	mqtt_discovery_context_t discovery;
 	mqtt_config_send_context_t config;
+	mqtt_pending_queue_t pending;
 	int server_port;
 	uint32_t max_payload_size;
 	uint32_t max_ppm;
@@ -119,6 +153,8 @@ bool mqtt_is_connected_ctx(struct mqtt_context_t *ctx);
 int mqtt_msg_send(struct mqtt_context_t *ctx, char *topic, char *message);
 int mqtt_msg_discovery_send(struct mqtt_context_t *ctx);
 int mqtt_msg_discovery_send_device(struct mqtt_context_t *ctx);
+void mqtt_msg_discovery_reset(struct mqtt_context_t *ctx);
+void mqtt_msg_pending_send(struct mqtt_context_t *ctx);
 
 int mqtt_send_subscribe(struct mqtt_context_t *ctx);
 void mqtt_subscribe_all(struct mqtt_context_t *ctx);
@@ -16,30 +16,149 @@
 
 #include "mqtt_internal.h"
 
+#define IS_LEVEL(L, W)	((L)[0] == (W) && !(L)[1])
+
+typedef void (*mqtt_topic_match_cb_t)(mqtt_topic_t *sub, void *data);
+
+static bool mqtt_topic_level_eq(const char *level, const char *str, int len)
+{
+	return ((int)strlen(level) == len && !strncmp(level, str, len));
+}
+
+static void mqtt_topic_match_sub(mqtt_topic_t *sub, mqtt_topic_match_cb_t cb, void *data, int *count)
+{
+	if (!sub)
+		return;
+	if (cb)
+		cb(sub, data);
+	(*count)++;
+}
+
+/* Walk the topics trie and call cb for each subscription, matching the topic */
+static int mqtt_topic_match(struct mqtt_topic_node_t *node, const char *topic, bool root,
+							mqtt_topic_match_cb_t cb, void *data)
+{
+	struct mqtt_topic_node_t *child, *wild;
+	const char *end;
+	int count = 0;
+	int len;
+
+	end = strchr(topic, '/');
+	len = end ? end - topic : (int)strlen(topic);
+
+	for (child = node->children; child; child = child->next) {
+		if (IS_LEVEL(child->level, '#') || IS_LEVEL(child->level, '+')) {
+			/* Topics starting with '$' are not matched by wildcards on the first level */
+			if (root && topic[0] == '$')
+				continue;
+		}
+		if (IS_LEVEL(child->level, '#')) {
+			mqtt_topic_match_sub(child->sub, cb, data, &count);
+			continue;
+		}
+		if (!IS_LEVEL(child->level, '+') &&
+		    !mqtt_topic_level_eq(child->level, topic, len))
+			continue;
+		if (end) {
+			count += mqtt_topic_match(child, end + 1, false, cb, data);
+			continue;
+		}
+		mqtt_topic_match_sub(child->sub, cb, data, &count);
+		/* "level/#" matches the parent "level" as well */
+		for (wild = child->children; wild; wild = wild->next) {
+			if (IS_LEVEL(wild->level, '#'))
+				mqtt_topic_match_sub(wild->sub, cb, data, &count);
+		}
+	}
+
+	return count;
+}
+
+/* Wildcards must occupy a whole level, "#" must be the last one */
+static bool mqtt_topic_valid(const char *topic)
+{
+	const char *start = topic;
+	const char *end;
+	int len;
+
+	do {
+		end = strchr(start, '/');
+		len = end ? end - start : (int)strlen(start);
+		if (len > 1 && (memchr(start, '+', len) || memchr(start, '#', len)))
+			return false;
+		if (len == 1 && start[0] == '#' && end)
+			return false;
+		start = end ? end + 1 : NULL;
+	} while (start);
+
+	return true;
+}
+
+static struct mqtt_topic_node_t *mqtt_topic_node_get(struct mqtt_topic_node_t *root, const char *topic)
+{
+	struct mqtt_topic_node_t *node = root;
+	struct mqtt_topic_node_t *child;
+	const char *start = topic;
+	const char *end;
+	int len;
+
+	do {
+		end = strchr(start, '/');
+		len = end ? end - start : (int)strlen(start);
+		for (child = node->children; child; child = child->next) {
+			if (mqtt_topic_level_eq(child->level, start, len))
+				break;
+		}
+		if (!child) {
+			child = calloc(1, sizeof(struct mqtt_topic_node_t));
+			if (!child)
+				return NULL;
+			child->level = malloc(len + 1);
+			if (!child->level) {
+				free(child);
+				return NULL;
+			}
+			memcpy(child->level, start, len);
+			child->level[len] = 0;
+			child->next = node->children;
+			node->children = child;
+		}
+		node = child;
+		start = end ? end + 1 : NULL;
+	} while (start);
+
+	return node;
+}
+
+static void mqtt_topic_json_check(mqtt_topic_t *sub, void *data)
+{
+	bool *json = (bool *)data;
+
+	if (sub->json)
+		*json = true;
+}
+
 void mqtt_incoming_publish(void *arg, const char *topic, u32_t tot_len)
 {
 	struct mqtt_context_t *ctx = (struct mqtt_context_t *)arg;
-	int i, j;
+	bool json = false;
+	int i;
 
+	ctx->listen.current = NULL;
 	for (i = 0; i < MQTT_LISTEN_BUFFERS; i++)
 		if (!ctx->listen.buffers[i].in_progress)
 			break;
-	if (i >= MQTT_LISTEN_BUFFERS || tot_len >= MQTT_OUTPUT_RINGBUF_SIZE)
+	if (i >= MQTT_LISTEN_BUFFERS || tot_len >= MQTT_OUTPUT_RINGBUF_SIZE ||
+	    strlen(topic) >= MQTT_MAX_TOPIC_SIZE)
 		return;
-	j = 0;
-	while (ctx->listen.topics[j] && j < MQTT_MAX_TOPICS) {
-		if (strlen(topic) == strlen(ctx->listen.topics[j]->topic) &&
-			!strcmp(topic, ctx->listen.topics[j]->topic))
-			break;
-		j++;
-	}
-	if (j >= MQTT_MAX_TOPICS || !ctx->listen.topics[j])
+	if (!mqtt_topic_match(&ctx->listen.root, topic, true, mqtt_topic_json_check, &json))
 		return;
 	ctx->listen.buffers[i].in_progress = true;
 	ctx->listen.buffers[i].ready = false;
 	ctx->listen.buffers[i].size = 0;
 	ctx->listen.buffers[i].tot_len = tot_len;
-	ctx->listen.buffers[i].topic = ctx->listen.topics[j];
+	ctx->listen.buffers[i].json = json;
+	strcpy(ctx->listen.buffers[i].topic, topic);
 	ctx->listen.current = &(ctx->listen.buffers[i]);
 }
 
@@ -59,17 +178,31 @@ void mqtt_incoming_data(void *arg, const u8_t *data, u16_t len, u8_t flags)
 		ctx->listen.current->msg[ctx->listen.current->size] = '\0';
 		if (IS_DEBUG(ctx))
 			hlog_info(MQTT_MODULE, "Got topic [%s] %d bytes: [%s]",
-					  ctx->listen.current->topic->topic,
+					  ctx->listen.current->topic,
 					  ctx->listen.current->size, ctx->listen.current->msg);
 		ctx->listen.current->ready = true;
 		ctx->listen.current = NULL;
 	}
 }
 
-bool mqtt_incoming_ready(struct mqtt_context_t *ctx)
+struct mqtt_topic_dispatch_t {
+	mqtt_listen_buff_t *buff;
+	lwjson_t *lwjson;
+};
+
+static void mqtt_topic_dispatch(mqtt_topic_t *sub, void *data)
 {
+	struct mqtt_topic_dispatch_t *dispatch = (struct mqtt_topic_dispatch_t *)data;
 	struct mqtt_topic_cb_t *cb;
-	bool json_parsed = false;
+
+	for (cb = sub->hooks; cb; cb = cb->next)
+		cb->func(cb->arg, dispatch->buff->topic, dispatch->buff->msg,
+				 dispatch->buff->size, dispatch->lwjson);
+}
+
+bool mqtt_incoming_ready(struct mqtt_context_t *ctx)
+{
+	struct mqtt_topic_dispatch_t dispatch = {0};
 	bool json_init = false;
 	lwjsonr_t ret;
 	int i;
@@ -80,7 +213,7 @@ bool mqtt_incoming_ready(struct mqtt_context_t *ctx)
 
 	if (i >= MQTT_LISTEN_BUFFERS)
 		return false;
-	if (ctx->listen.buffers[i].topic->json) {
+	if (ctx->listen.buffers[i].json) {
 		ret = lwjson_init(&(ctx->listen.buffers[i].lwjson), ctx->listen.buffers[i].json_tokens,
 					LWJSON_ARRAYSIZE(ctx->listen.buffers[i].json_tokens));
 		if (ret == lwjsonOK) {
@@ -88,22 +221,19 @@ bool mqtt_incoming_ready(struct mqtt_context_t *ctx)
 			ret = lwjson_parse_ex(&(ctx->listen.buffers[i].lwjson),
 									ctx->listen.buffers[i].msg, ctx->listen.buffers[i].size);
 			if (ret == lwjsonOK)
-				json_parsed = true;
+				dispatch.lwjson = &(ctx->listen.buffers[i].lwjson);
 		}
 	}
-	cb = ctx->listen.buffers[i].topic->hooks;
-	while (cb) {
-		cb->func(cb->arg, ctx->listen.buffers[i].topic->topic,
-				 ctx->listen.buffers[i].msg, ctx->listen.buffers[i].size,
-				 json_parsed ? &(ctx->listen.buffers[i].lwjson) : NULL);
-		cb = cb->next;
-	}
+	dispatch.buff = &(ctx->listen.buffers[i]);
+	mqtt_topic_match(&ctx->listen.root, ctx->listen.buffers[i].topic, true,
+					 mqtt_topic_dispatch, &dispatch);
 
 	ctx->listen.buffers[i].in_progress = false;
 	ctx->listen.buffers[i].ready = false;
+	ctx->listen.buffers[i].json = false;
 	ctx->listen.buffers[i].tot_len = 0;
 	ctx->listen.buffers[i].size = 0;
-	ctx->listen.buffers[i].topic = NULL;
+	ctx->listen.buffers[i].topic[0] = 0;
 
 	if (json_init)
 		lwjson_free(&(ctx->listen.buffers[i].lwjson));
@@ -113,42 +243,37 @@ bool mqtt_incoming_ready(struct mqtt_context_t *ctx)
 
 void mqtt_subscribe_all(struct mqtt_context_t *ctx)
 {
-	int i;
+	mqtt_topic_t *topic;
 
-	i = 0;
-	while (ctx->listen.topics[i] && i <= MQTT_MAX_TOPICS) {
-		ctx->listen.topics[i]->subscribed = false;
-		i++;
-	}
+	for (topic = ctx->listen.topics; topic; topic = topic->next)
+		topic->subscribed = false;
 	ctx->config.subscribe = 0;
 }
 
 int mqtt_send_subscribe(struct mqtt_context_t *ctx)
 {
+	mqtt_topic_t *topic;
 	err_t ret = -1;
-	int i;
 
 	if (ctx->state != MQTT_CLIENT_CONNECTED)
 		goto out;
 
-	i = 0;
-	while (ctx->listen.topics[i] && i <= MQTT_MAX_TOPICS) {
-		if (!ctx->listen.topics[i]->subscribed)
+	for (topic = ctx->listen.topics; topic; topic = topic->next) {
+		if (!topic->subscribed)
 			break;
-		i++;
 	}
-	if (i >= MQTT_MAX_TOPICS || !ctx->listen.topics[i] || strlen(ctx->listen.topics[i]->topic) < 1)
+	if (!topic)
 		goto out;
 
 	LWIP_LOCK_START;
-		ret = mqtt_subscribe(ctx->client, ctx->listen.topics[i]->topic, MQTT_QOS, NULL, NULL);
+		ret = mqtt_subscribe(ctx->client, topic->topic, MQTT_QOS, NULL, NULL);
 	LWIP_LOCK_END;
 
 	if (!ret) {
-		ctx->listen.topics[i]->subscribed = true;
+		topic->subscribed = true;
 		ctx->config.subscribe++;
 		if (IS_DEBUG(ctx))
-			hlog_info(MQTT_MODULE, "Subscribed to MQTT topic [%s]", ctx->listen.topics[i]->topic);
+			hlog_info(MQTT_MODULE, "Subscribed to MQTT topic [%s]", topic->topic);
 	}
 
 out:
@@ -159,26 +284,30 @@ out:
 int mqtt_topic_listen(char *topic, mqtt_topic_cb_t func, void *context, bool json)
 {
 	struct mqtt_context_t *ctx = mqtt_context_get();
+	struct mqtt_topic_node_t *node;
 	struct mqtt_topic_cb_t *hook;
-	int i;
+	mqtt_topic_t **last;
 
-	if (!ctx)
+	if (!ctx || !topic)
 		return -1;
-	i = 0;
-	while (ctx->listen.topics[i] && i < MQTT_MAX_TOPICS) {
-		if (strlen(topic) == strlen(ctx->listen.topics[i]->topic) &&
-			!strcmp(topic, ctx->listen.topics[i]->topic))
-			break;
-		i++;
-	}
-	if (i >= MQTT_MAX_TOPICS || !ctx->listen.topics[i]) {
-		i = ctx->listen.count;
-		if (i >= MQTT_MAX_TOPICS || ctx->listen.topics[i])
+	if (strlen(topic) < 1 || strlen(topic) >= MQTT_MAX_TOPIC_SIZE || !mqtt_topic_valid(topic))
+		return -1;
+
+	node = mqtt_topic_node_get(&ctx->listen.root, topic);
+	if (!node)
+		return -1;
+	if (!node->sub) {
+		if (ctx->listen.count >= MQTT_MAX_TOPICS)
 			return -1;
-		ctx->listen.topics[i] = calloc(1, sizeof(mqtt_topic_t));
-		if (!ctx->listen.topics[i])
+		node->sub = calloc(1, sizeof(mqtt_topic_t));
+		if (!node->sub)
 			return -1;
-		strncpy(ctx->listen.topics[i]->topic, topic, MQTT_MAX_TOPIC_SIZE - 1);
+		strcpy(node->sub->topic, topic);
+		/* Keep the order of the subscriptions */
+		last = &ctx->listen.topics;
+		while (*last)
+			last = &(*last)->next;
+		*last = node->sub;
 		ctx->listen.count++;
 	}
 	hook = calloc(1, sizeof(struct mqtt_topic_cb_t));
@@ -186,9 +315,9 @@ int mqtt_topic_listen(char *topic, mqtt_topic_cb_t func, void *context, bool jso
 		return -1;
 	hook->func = func;
 	hook->arg = context;
-	hook->next = ctx->listen.topics[i]->hooks;
+	hook->next = node->sub->hooks;
 	if (json)
-		ctx->listen.topics[i]->json = true;
-	ctx->listen.topics[i]->hooks = hook;
+		node->sub->json = true;
+	node->sub->hooks = hook;
 	return 0;
 }
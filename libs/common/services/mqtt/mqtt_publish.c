@@ -162,9 +162,50 @@ int mqtt_msg_discovery_send_device(struct mqtt_context_t *ctx)
 	return ret;
 }
 
+static uint32_t mqtt_hash_str(uint32_t hash, const char *str)
+{
+	/* Include the terminating zero, to separate the fields */
+	if (str)
+		return sys_hash(hash, str, strlen(str) + 1);
+
+	return sys_hash(hash, "\xFF", 1);
+}
+
+/* Hash of all inputs of the component discovery message */
+static uint32_t mqtt_discovery_hash_component(struct mqtt_context_t *ctx, mqtt_component_t *component)
+{
+	uint32_t hash = SYS_HASH_INIT;
+
+	hash = mqtt_hash_str(hash, ctx->client_info.client_id);
+	hash = mqtt_hash_str(hash, ctx->state_topic);
+	hash = mqtt_hash_str(hash, component->module);
+	hash = mqtt_hash_str(hash, component->name);
+	hash = mqtt_hash_str(hash, component->platform);
+	hash = mqtt_hash_str(hash, component->dev_class);
+	hash = mqtt_hash_str(hash, component->unit);
+	hash = mqtt_hash_str(hash, component->value_template);
+	hash = mqtt_hash_str(hash, component->payload_on);
+	hash = mqtt_hash_str(hash, component->payload_off);
+	hash = mqtt_hash_str(hash, component->state_topic);
+
+	/* 0 is reserved for "not sent" */
+	return hash ? hash : 1;
+}
+
+/* Force sending all discovery messages, i.e. on a new connection to the server */
+void mqtt_msg_discovery_reset(struct mqtt_context_t *ctx)
+{
+	int i;
+
+	for (i = 0; i < ctx->cmp_count; i++)
+		ctx->components[i]->discovery_hash = 0;
+}
+
+/* Returns 1 if the component is already discovered with the same configuration */
 int mqtt_msg_discovery_send(struct mqtt_context_t *ctx)
 {
 	mqtt_component_t *comp;
+	uint32_t hash;
 	int ret = -1;
 	int msize;
 
@@ -172,11 +213,16 @@ int mqtt_msg_discovery_send(struct mqtt_context_t *ctx)
 		return -1;
 
 	comp = ctx->components[ctx->discovery.send_idx];
+	hash = mqtt_discovery_hash_component(ctx, comp);
+	if (comp->discovery_hash == hash)
+		return 1;
+
 	msize = mqtt_discovery_generate_component(ctx, comp);
 	if (msize > 0)
 		ret = mqtt_msg_send(ctx, ctx->discovery.topic, ctx->discovery.buff);
 
 	if (!ret) {
+		comp->discovery_hash = hash;
 		if (IS_DEBUG(ctx))
 			hlog_info(MQTT_MODULE, "Send %d bytes discovery message of %s/%s",
 					  strlen(ctx->discovery.buff), comp->module, comp->name);
@@ -189,6 +235,146 @@ int mqtt_msg_discovery_send(struct mqtt_context_t *ctx)
 	return ret;
 }
 
+/* Rate limit the packets, returns 1 if the message is not sent because of the limit */
+static int mqtt_msg_rate_send(struct mqtt_context_t *ctx, char *topic, char *message)
+{
+	bool reset_filter = false;
+	uint64_t now;
+	int ret;
+
+	now = time_ms_since_boot();
+	if (ctx->filter_pkt_count >= ctx->max_ppm) {
+		if ((now - ctx->filter_pkt_send) >= MSEC2MIN)
+			reset_filter = true;
+		else if (ctx->last_send)
+			return 1;
+	}
+
+	ret = mqtt_msg_send(ctx, topic, message);
+	if (!ret) {
+		ctx->last_send = now;
+		if (reset_filter) {
+			ctx->filter_pkt_count = 0;
+			ctx->filter_pkt_send = now;
+		}
+	}
+	ctx->filter_pkt_count++;
+	return ret;
+}
+
+static mqtt_pending_t *mqtt_pending_find(struct mqtt_context_t *ctx, char *topic)
+{
+	int i;
+
+	for (i = 0; i < ctx->pending.size; i++) {
+		if (ctx->pending.msgs[i].ready &&
+		    !strcmp(ctx->pending.msgs[i].topic, topic))
+			return &ctx->pending.msgs[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Get a free slot in the queue. The queue grows up to one slot per registered
+ * component, plus MQTT_PENDING_MAX slots for other topics.
+ */
+static mqtt_pending_t *mqtt_pending_slot(struct mqtt_context_t *ctx)
+{
+	mqtt_pending_t *msgs;
+	int size;
+	int i;
+
+	for (i = 0; i < ctx->pending.size; i++) {
+		if (!ctx->pending.msgs[i].ready)
+			return &ctx->pending.msgs[i];
+	}
+
+	size = ctx->pending.size + MQTT_PENDING_MAX;
+	if (size > ctx->cmp_count + MQTT_PENDING_MAX)
+		size = ctx->cmp_count + MQTT_PENDING_MAX;
+	if (size <= ctx->pending.size)
+		return NULL;
+	msgs = realloc(ctx->pending.msgs, size * sizeof(mqtt_pending_t));
+	if (!msgs)
+		return NULL;
+	memset(msgs + ctx->pending.size, 0, (size - ctx->pending.size) * sizeof(mqtt_pending_t));
+	ctx->pending.msgs = msgs;
+	i = ctx->pending.size;
+	ctx->pending.size = size;
+
+	return &ctx->pending.msgs[i];
+}
+
+static int mqtt_pending_add(struct mqtt_context_t *ctx, char *topic, char *message)
+{
+	int len = strlen(message) + 1;
+	mqtt_pending_t *pmsg;
+	char *buf;
+
+	pmsg = mqtt_pending_find(ctx, topic);
+	if (!pmsg) {
+		if (strlen(topic) >= MQTT_MAX_TOPIC_SIZE)
+			goto out_drop;
+		pmsg = mqtt_pending_slot(ctx);
+		if (!pmsg)
+			goto out_drop;
+	}
+
+	if (pmsg->msg_size < len) {
+		buf = realloc(pmsg->msg, len);
+		if (!buf)
+			goto out_drop;
+		pmsg->msg = buf;
+		pmsg->msg_size = len;
+	}
+	memcpy(pmsg->msg, message, len);
+
+	if (pmsg->ready) {
+		ctx->pending.replaced++;
+	} else {
+		strcpy(pmsg->topic, topic);
+		pmsg->queued = time_ms_since_boot();
+		pmsg->ready = true;
+		ctx->pending.count++;
+		ctx->pending.queued++;
+	}
+
+	if (IS_DEBUG(ctx))
+		hlog_info(MQTT_MODULE, "Queued %d bytes to [%s], %d pending", len - 1, topic, ctx->pending.count);
+	return 0;
+
+out_drop:
+	ctx->pending.dropped++;
+	if (IS_DEBUG(ctx))
+		hlog_info(MQTT_MODULE, "Dropped %d bytes to [%s], %d pending", len - 1, topic, ctx->pending.count);
+	return -1;
+}
+
+/* Send the oldest queued message, if the rate limit allows it */
+void mqtt_msg_pending_send(struct mqtt_context_t *ctx)
+{
+	mqtt_pending_t *pmsg = NULL;
+	int i;
+
+	if (!ctx->pending.count || ctx->state != MQTT_CLIENT_CONNECTED)
+		return;
+
+	for (i = 0; i < ctx->pending.size; i++) {
+		if (!ctx->pending.msgs[i].ready)
+			continue;
+		if (!pmsg || ctx->pending.msgs[i].queued < pmsg->queued)
+			pmsg = &ctx->pending.msgs[i];
+	}
+	if (!pmsg)
+		return;
+
+	if (!mqtt_msg_rate_send(ctx, pmsg->topic, pmsg->msg)) {
+		pmsg->ready = false;
+		ctx->pending.count--;
+	}
+}
+
 /* API */
 
 bool mqtt_is_discovery_sent(void)
@@ -204,16 +390,12 @@ bool mqtt_is_discovery_sent(void)
 	return false;
 }
 
-int mqtt_msg_publish(char *topic, char *message, bool force)
+int mqtt_msg_publish(char *topic, char *message)
 {
 	struct mqtt_context_t *ctx = mqtt_context_get();
-	bool reset_filter = false;
 	char *topic_str;
-	uint64_t now;
 	int ret;
 
-	UNUSED(force);
-
 	if (!ctx)
 		return -1;
 
@@ -226,24 +408,14 @@ int mqtt_msg_publish(char *topic, char *message, bool force)
 		return -1;
 	}
 
-	/* Rate limit the packets */
-	now = time_ms_since_boot();
-	if (ctx->filter_pkt_count >= ctx->max_ppm) {
-		if ((now - ctx->filter_pkt_send) >= MSEC2MIN)
-			reset_filter = true;
-		else if (ctx->last_send)
-			return -1;
-	}
+	/* Keep the order of the messages, if there are already queued ones */
+	if (ctx->pending.count)
+		return mqtt_pending_add(ctx, topic_str, message);
+
+	ret = mqtt_msg_rate_send(ctx, topic_str, message);
+	if (ret > 0)
+		return mqtt_pending_add(ctx, topic_str, message);
 
-	ret = mqtt_msg_send(ctx, topic_str, message);
-	if (!ret) {
-		ctx->last_send = now;
-		if (reset_filter) {
-			ctx->filter_pkt_count = 0;
-			ctx->filter_pkt_send = now;
-		}
-	}
-	ctx->filter_pkt_count++;
 	return ret;
 }
 
@@ -254,7 +426,7 @@ int mqtt_msg_component_publish(mqtt_component_t *component, char *message)
 	if (!mqtt_is_discovery_sent())
 		return -1;
 
-	ret = mqtt_msg_publish(component->state_topic, message, component->force);
+	ret = mqtt_msg_publish(component->state_topic, message);
 	if (!ret) {
 		component->force = false;
 		component->last_send = time_ms_since_boot();
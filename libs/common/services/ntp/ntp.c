@@ -18,6 +18,8 @@
 #include "params.h"
 
 #define NTP_MODULE	"ntp"
+/* Check for WiFi connection, a time sync wakes the module up */
+#define RUN_INTERVAL_MS	1000
 
 #define TIME_LOCK(C)	do { if (C) mutex_enter_blocking(&((C)->lock)); } while (0)
 #define TIME_UNLOCK(C)	do { if (C) mutex_exit(&((C)->lock)); } while (0)
@@ -163,6 +165,7 @@ void herak_set_system_time(uint32_t sec)
 	TIME_LOCK(ctx);
 		ctx->time_synched = true;
 	TIME_UNLOCK(ctx);
+	sys_module_wakeup(&ctx->mod);
 }
 
 static void sys_ntp_debug_set(uint32_t lvl, void *context)
@@ -208,6 +211,7 @@ void sys_ntp_register(void)
 
 	ctx->mod.name = NTP_MODULE;
 	ctx->mod.run = sys_ntp_connect;
+	ctx->mod.run_interval_ms = RUN_INTERVAL_MS;
 	ctx->mod.reconnect = sys_ntp_reconnect;
 	ctx->mod.log = sys_ntp_log_status;
 	ctx->mod.debug = sys_ntp_debug_set;
@@ -14,6 +14,7 @@
 #include "ota_internal.h"
 
 #define TIME_STR	64
+#define OTA_VER_STR	256
 #define APPLY_RETRIES	3
 
 static struct ota_context_t *__ota_context;
@@ -61,33 +62,33 @@ static bool sys_ota_log_status(void *context)
 	return true;
 }
 
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int ota_mqtt_send(struct ota_context_t *ctx)
 {
 	char *name = NULL, *ver = NULL, *commit = NULL;
 	char *date = NULL, *time = NULL, *peer = NULL;
-	int len = OTA_MQTT_DATA_LEN;
+	char ver_buff[OTA_VER_STR];
 	char time_buff[TIME_STR];
-	int count = 0;
+	json_writer_t js;
 	int ret = -1;
 
-	ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-		ADD_MQTT_MSG_VAR(",\"current_version\": \"%s %s\"", SYS_VERSION_STR, SYS_BUILD_DATE);
-		if (ota_update_get_new(&ctx->check, &name, &ver, &commit, &date, &time, &peer)) {
-			ADD_MQTT_MSG_VAR(",\"update\": \"%d\"", 0);
-		} else {
-			ADD_MQTT_MSG_VAR(",\"update\": \"%d\"", 1);
-			ADD_MQTT_MSG_VAR(",\"new_version\": \"%s %s-%s %s-%s from %s\"",
-							 name ? name : "N/A", ver ? ver : "N/A", commit ? commit : "N/A",
-							 date ? date : "N/A", time ? time : "N/A", peer ? peer : "N/A");
-		}
-	ADD_MQTT_MSG("}")
+	json_begin(&js, ctx->mqtt_payload, OTA_MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	snprintf(ver_buff, OTA_VER_STR, "%s %s", SYS_VERSION_STR, SYS_BUILD_DATE);
+	json_add_str(&js, "current_version", ver_buff);
+	if (ota_update_get_new(&ctx->check, &name, &ver, &commit, &date, &time, &peer)) {
+		json_add_int(&js, "update", 0);
+	} else {
+		json_add_int(&js, "update", 1);
+		snprintf(ver_buff, OTA_VER_STR, "%s %s-%s %s-%s from %s",
+				 name ? name : "N/A", ver ? ver : "N/A", commit ? commit : "N/A",
+				 date ? date : "N/A", time ? time : "N/A", peer ? peer : "N/A");
+		json_add_str(&js, "new_version", ver_buff);
+	}
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt_payload[OTA_MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(&(ctx->mqtt_comp[0]), ctx->mqtt_payload);
 
 	return ret;
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 
+#include "pico/flash.h"
 #include <pico_fota_bootloader/core.h>
 #include "herak_sys.h"
 #include "common_internal.h"
@@ -13,6 +14,37 @@
 
 #define DEBUG_DUMP_MS		1000
 #define APPLY_DELAY_MS		2000
+#define FLASH_TIMEOUT_MS	1000
+
+/*
+ * The download slot is in the flash. Write it with flash_safe_execute(),
+ * so the other core, if started, does not run code from the flash meanwhile.
+ */
+struct ota_flash_write_t {
+	uint8_t *buff;
+	uint32_t offset;
+	int ret;
+};
+
+static void ota_flash_slot_reset(void *param)
+{
+	UNUSED(param);
+	pfb_mark_download_slot_as_invalid();
+	pfb_initialize_download_slot();
+}
+
+static void ota_flash_slot_valid(void *param)
+{
+	UNUSED(param);
+	pfb_mark_download_slot_as_valid();
+}
+
+static void ota_flash_slot_write(void *param)
+{
+	struct ota_flash_write_t *wr = (struct ota_flash_write_t *)param;
+
+	wr->ret = pfb_write_to_flash_aligned_256_bytes(wr->buff, wr->offset, BUFF_SIZE);
+}
 
 static void *ota_tftp_update_open(const char *fname, const char *mode, u8_t is_write)
 {
@@ -29,8 +61,11 @@ static void *ota_tftp_update_open(const char *fname, const char *mode, u8_t is_w
 
 	hlog_info(OTA_MODULE, "Updating .... %s", fname);
 	sys_job_state_set(OTA_JOB);
-	pfb_mark_download_slot_as_invalid();
-	pfb_initialize_download_slot();
+	if (flash_safe_execute(ota_flash_slot_reset, NULL, FLASH_TIMEOUT_MS) != PICO_OK) {
+		hlog_warning(OTA_MODULE, "Failed to initialize the download slot");
+		sys_job_state_clear(OTA_JOB);
+		return NULL;
+	}
 	mbedtls_sha256_init(&update->sha);
 	mbedtls_sha256_starts(&update->sha, 0);
 	update->buff_p = 0;
@@ -43,7 +78,9 @@ static void *ota_tftp_update_open(const char *fname, const char *mode, u8_t is_w
 
 static int ota_buff_commit(struct ota_update_t *update, int size)
 {
-	if (pfb_write_to_flash_aligned_256_bytes(update->buff, update->flash_offset, BUFF_SIZE))
+	struct ota_flash_write_t wr = { .buff = update->buff, .offset = update->flash_offset };
+
+	if (flash_safe_execute(ota_flash_slot_write, &wr, FLASH_TIMEOUT_MS) != PICO_OK || wr.ret)
 		return -1;
 
 	if (mbedtls_sha256_update(&update->sha, update->buff, size))
@@ -145,8 +182,7 @@ void ota_update_reset(struct ota_update_t *update)
 	memset(&(update->sha), 0, sizeof(update->sha));
 	update->flash_offset = 0;
 	if (!update->apply) {
-		pfb_mark_download_slot_as_invalid();
-		pfb_initialize_download_slot();
+		flash_safe_execute(ota_flash_slot_reset, NULL, FLASH_TIMEOUT_MS);
 		sys_job_state_clear(OTA_JOB);
 	}
 #ifdef HAVE_SYS_WEBSERVER
@@ -180,10 +216,13 @@ static int ota_update_validate(struct ota_update_t *update)
 	if (res) {
 		hlog_warning(OTA_MODULE, "Invalid image");
 	} else {
-		hlog_info(OTA_MODULE, "Valid image, going to boot it ... ");
-		pfb_mark_download_slot_as_valid();
-		update->apply = time_ms_since_boot();
-		ret = 0;
+		if (flash_safe_execute(ota_flash_slot_valid, NULL, FLASH_TIMEOUT_MS) == PICO_OK) {
+			hlog_info(OTA_MODULE, "Valid image, going to boot it ... ");
+			update->apply = time_ms_since_boot();
+			ret = 0;
+		} else {
+			hlog_warning(OTA_MODULE, "Failed to mark the image as valid");
+		}
 	}
 
 out:
@@ -5,6 +5,8 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <ctype.h>
+#include <limits.h>
 
 #include "pico/stdlib.h"
 #include "pico_hal.h"
@@ -88,16 +90,51 @@ struct script_mqtt_t {
 	mqtt_component_t corn;
 };
 
+enum script_op_t {
+	SCRIPT_OP_NOP = 0,
+	SCRIPT_OP_CMD,
+	SCRIPT_OP_WAIT,
+	SCRIPT_OP_JUMP,
+};
+
+/* Compiled script instruction */
+struct script_instr_t {
+	uint8_t op;
+	int32_t arg;	/* CMD: offset in the text, WAIT: msec, JUMP: index of the instruction */
+	int limit;
+	int count;
+};
+
+/* The script, parsed once and cached in RAM */
+struct script_code_t {
+	struct script_instr_t *instr;
+	int count;
+	int size;
+	char *text;
+	int text_len;
+	int text_size;
+	int pc;
+	uint32_t fs_changes;
+	bool valid;
+	bool oom;
+};
+
 struct script_label_t {
 	char name[LABEL_NAME_MAX];
 	int offset;
 };
 
 struct script_jump_t {
-	struct script_label_t *to;
-	int offset;
-	int limit;
-	int count;
+	char label[LABEL_NAME_MAX];
+	int instr;
+};
+
+/* Labels and not yet resolved jumps, used while compiling a script */
+struct script_compile_t {
+	struct script_label_t labels[LABEL_COUNT_MAX];
+	int label_count;
+	struct script_jump_t jumps[JUMP_COUNT_MAX];
+	int jump_count;
 };
 
 struct scripts_context_t;
@@ -110,15 +147,13 @@ struct script_t {
 	uint64_t wait;
 	int32_t startup_ms;
 	int exec_count;
-	int fd;
 	bool notify_enable;
 	uint64_t last_run;
 	time_t last_run_date;
 	struct scripts_context_t *ctx;
 	struct script_cron_t cron;
 	struct script_mqtt_t mqtt;
-	struct script_label_t *labels[LABEL_COUNT_MAX];
-	struct script_jump_t *jumps[JUMP_COUNT_MAX];
+	struct script_code_t code;
 };
 
 struct scripts_context_t {
@@ -130,6 +165,7 @@ struct scripts_context_t {
 	uint8_t startup_count;
 	uint64_t last_cron;
 	cmd_run_context_t cmd_ctx;
+	struct script_compile_t compile;
 	char line[MAX_LINE];
 	char mqtt_payload[MQTT_DATA_LEN + 1];
 };
@@ -214,6 +250,58 @@ static void script_cron_set_next(struct scripts_context_t *ctx, struct script_t
 
 }
 
+#define CODE_ALLOC_STEP	16
+static int script_code_add(struct script_code_t *code, uint8_t op, int32_t arg, int limit)
+{
+	struct script_instr_t *instr;
+
+	if (code->count >= code->size) {
+		instr = realloc(code->instr, (code->size + CODE_ALLOC_STEP) * sizeof(struct script_instr_t));
+		if (!instr) {
+			code->oom = true;
+			return -1;
+		}
+		code->instr = instr;
+		code->size += CODE_ALLOC_STEP;
+	}
+	code->instr[code->count].op = op;
+	code->instr[code->count].arg = arg;
+	code->instr[code->count].limit = limit;
+	code->instr[code->count].count = 0;
+
+	return code->count++;
+}
+
+static int script_code_add_text(struct script_code_t *code, char *str)
+{
+	int len = strlen(str) + 1;
+	int off = code->text_len;
+	char *text;
+	int size;
+
+	if (code->text_len + len > code->text_size) {
+		size = code->text_size + MAX(len, MAX_LINE);
+		text = realloc(code->text, size);
+		if (!text) {
+			code->oom = true;
+			return -1;
+		}
+		code->text = text;
+		code->text_size = size;
+	}
+	memcpy(code->text + off, str, len);
+	code->text_len += len;
+
+	return off;
+}
+
+static void script_code_free(struct script_code_t *code)
+{
+	free(code->instr);
+	free(code->text);
+	memset(code, 0, sizeof(struct script_code_t));
+}
+
 /* @name <script_name> */
 static int script_exec_name(struct script_t *script, char *param, bool init)
 {
@@ -294,19 +382,15 @@ static int script_exec_startup(struct script_t *script, char *param, bool init)
 /* @wait <ms> */
 static int script_exec_wait(struct script_t *script, char *param, bool init)
 {
-	int32_t w;
+	long w;
 
-	if (init)
-		return -1;
+	UNUSED(init);
 
 	w = strtol(param, NULL, 0);
-	if (w == LONG_MIN || w == LONG_MAX || w <= 0) {
-		script->wait = 0;
-	} else {
-		script->wait = w + time_ms_since_boot();
-		if (IS_DEBUG(script->ctx))
-			hlog_info(SCRIPTS_MODULE, "Wait for [%ld] msec", w);
-	}
+	if (w == LONG_MIN || w == LONG_MAX || w <= 0)
+		w = 0;
+	if (script_code_add(&script->code, SCRIPT_OP_WAIT, w, 0) < 0)
+		return -1;
 
 	return 0;
 }
@@ -314,101 +398,58 @@ static int script_exec_wait(struct script_t *script, char *param, bool init)
 /* @label <label_name> */
 static int script_exec_label(struct script_t *script, char *param, bool init)
 {
-	int i;
+	struct script_compile_t *comp = &script->ctx->compile;
+	struct script_label_t *label;
 
-	if (!init)
-		return -1;
+	UNUSED(init);
 
-	for (i = 0; i < LABEL_COUNT_MAX; i++) {
-		if (!script->labels[i])
-			break;
-	}
-	if (i >= LABEL_COUNT_MAX)
+	if (comp->label_count >= LABEL_COUNT_MAX)
 		return -1;
-	script->labels[i] = calloc(1, sizeof(struct script_label_t));
-	if (!script->labels[i])
-		return -1;
-	strncpy(script->labels[i]->name, param, LABEL_NAME_MAX);
-	script->labels[i]->name[LABEL_NAME_MAX - 1] = 0;
-	script->labels[i]->offset = fs_get_pos(script->fd);
+	label = &comp->labels[comp->label_count++];
+	strncpy(label->name, param, LABEL_NAME_MAX);
+	label->name[LABEL_NAME_MAX - 1] = 0;
+	label->offset = script->code.count;
 	if (IS_DEBUG(script->ctx))
-		hlog_info(SCRIPTS_MODULE, "Got script label [%s] at position %d",
-				  script->labels[i]->name, script->labels[i]->offset);
+		hlog_info(SCRIPTS_MODULE, "Got script label [%s] at instruction %d",
+				  label->name, label->offset);
 	return 0;
 }
 
 /* @jump <label>;<count> */
 static int script_exec_jump(struct script_t *script, char *param,  bool init)
 {
+	struct script_compile_t *comp = &script->ctx->compile;
 	char *count_str = NULL;
 	char *label = NULL;
-	int32_t limit;
-	int pos, i, j;
+	long limit;
+	int idx;
 
-	if (init)
-		return -1;
+	UNUSED(init);
 
-	pos = fs_get_pos(script->fd);
-	for (i = 0; i < JUMP_COUNT_MAX; i++) {
-		if (!script->jumps[i])
-			break;
-		if (script->jumps[i]->offset == pos)
-			break;
-	}
-	if (i >= JUMP_COUNT_MAX) {
+	if (comp->jump_count >= JUMP_COUNT_MAX) {
 		if (IS_DEBUG(script->ctx))
 			hlog_info(SCRIPTS_MODULE, "Max jump count %d reached, ignoring", JUMP_COUNT_MAX);
 		return -1;
 	}
-	if (!script->jumps[i]) {
-		script->jumps[i] = calloc(1, sizeof(struct script_jump_t));
-		if (!script->jumps[i]) {
-			if (IS_DEBUG(script->ctx))
-				hlog_info(SCRIPTS_MODULE, "Failed to alloc new jump, ignoring");
-			return -1;
-		}
-		label = strtok_r(param, ";", &count_str);
-		if (!label || !count_str) {
-			if (IS_DEBUG(script->ctx))
-				hlog_info(SCRIPTS_MODULE, "Invalid jump params [%s], ignoring", param);
-			return -1;
-		}
-		limit = strtol(count_str, NULL, 0);
-		if (limit == LONG_MIN || limit == LONG_MAX || limit < 0) {
-			if (IS_DEBUG(script->ctx))
-				hlog_info(SCRIPTS_MODULE, "Invalid jump count param [%s], ignoring", param);
-			return -1;
-		}
-		for (j = 0; j < LABEL_COUNT_MAX; j++) {
-			if (!script->labels[j])
-				break;
-			if (strlen(label) == strlen(script->labels[j]->name) &&
-				!strncmp(label, script->labels[j]->name, strlen(label))) {
-				script->jumps[i]->to = script->labels[j];
-				break;
-			}
-		}
-		script->jumps[i]->offset = pos;
-		script->jumps[i]->limit = limit;
-	}
-	if (!script->jumps[i]->to) {
+	label = strtok_r(param, ";", &count_str);
+	if (!label || !count_str || strlen(label) >= LABEL_NAME_MAX) {
 		if (IS_DEBUG(script->ctx))
-			hlog_info(SCRIPTS_MODULE, "Jump to uknown label [%s], ignoring", param);
+			hlog_info(SCRIPTS_MODULE, "Invalid jump params [%s], ignoring", param);
 		return -1;
 	}
-	if (script->jumps[i]->limit &&
-		script->jumps[i]->count >= script->jumps[i]->limit) {
+	limit = strtol(count_str, NULL, 0);
+	if (limit == LONG_MIN || limit == LONG_MAX || limit < 0) {
 		if (IS_DEBUG(script->ctx))
-			hlog_info(SCRIPTS_MODULE, "Jump at %d limit %d reached, ignoring",
-					  script->jumps[i]->offset, script->jumps[i]->count);
-		return 0;
+			hlog_info(SCRIPTS_MODULE, "Invalid jump count param [%s], ignoring", param);
+		return -1;
 	}
-	fs_lseek(script->fd, script->jumps[i]->to->offset, LFS_SEEK_SET);
-	script->jumps[i]->count++;
-	if (IS_DEBUG(script->ctx))
-		hlog_info(SCRIPTS_MODULE, "Jump at %d to [%s]:%d, count %d",
-				  script->jumps[i]->offset, script->jumps[i]->to->name,
-				  script->jumps[i]->to->offset, script->jumps[i]->count);
+	/* The label is resolved when the whole script is parsed */
+	idx = script_code_add(&script->code, SCRIPT_OP_JUMP, -1, limit);
+	if (idx < 0)
+		return -1;
+	strcpy(comp->jumps[comp->jump_count].label, label);
+	comp->jumps[comp->jump_count].instr = idx;
+	comp->jump_count++;
 
 	return 0;
 }
@@ -464,27 +505,48 @@ static int script_param_exec(struct script_t *script, char *line, bool init)
 	}
 
 	if (IS_DEBUG(script->ctx))
-		hlog_info(SCRIPTS_MODULE, "%s [%s] [%s]: %d", init ? "Load" : "Executed",
+		hlog_info(SCRIPTS_MODULE, "%s [%s] [%s]: %d", init ? "Load" : "Reload",
 				  script_configs[i], line, ret);
 
 	return ret;
 }
 
-static int script_load(struct scripts_context_t *ctx, char *fname, struct script_t *script)
+static void script_jumps_resolve(struct script_t *script)
+{
+	struct script_compile_t *comp = &script->ctx->compile;
+	struct script_instr_t *instr;
+	int i, j;
+
+	for (i = 0; i < comp->jump_count; i++) {
+		instr = &script->code.instr[comp->jumps[i].instr];
+		for (j = 0; j < comp->label_count; j++) {
+			if (!strcmp(comp->jumps[i].label, comp->labels[j].name))
+				break;
+		}
+		if (j < comp->label_count) {
+			instr->arg = comp->labels[j].offset;
+			continue;
+		}
+		instr->op = SCRIPT_OP_NOP;
+		if (IS_DEBUG(script->ctx))
+			hlog_info(SCRIPTS_MODULE, "Jump to uknown label [%s], ignoring", comp->jumps[i].label);
+	}
+}
+
+/* Parse the script file into instructions, cached in RAM */
+static int script_compile(struct scripts_context_t *ctx, struct script_t *script, bool init)
 {
-	int elen = strlen(SCRIPT_EXTENSION);
-	int fd = -1;
 	char *ldata;
-	int ret;
+	int ret, off;
+	int fd;
 
-	if (sys_asprintf(&script->file, "%s/%s", SCRIPTS_DIR, fname) <= 0)
-		goto out_err;
+	script_code_free(&script->code);
+	memset(&ctx->compile, 0, sizeof(ctx->compile));
+	script->code.fs_changes = fs_get_changes();
 
 	fd = fs_open(script->file, LFS_O_RDONLY);
 	if (fd < 0)
-		goto out_err;
-	script->fd = fd;
-	script->ctx = ctx;
+		return -1;
 	do {
 		ret = fs_gets(fd, ctx->line, MAX_LINE);
 		if (ret < 0)
@@ -497,9 +559,40 @@ static int script_load(struct scripts_context_t *ctx, char *fname, struct script
 			continue;
 		if (IS_COMMENT(ldata))
 			continue;
-		if (IS_SPEC_COMMAND(ldata))
-			script_param_exec(script, ldata, true);
-	} while (true);
+		if (IS_SPEC_COMMAND(ldata)) {
+			script_param_exec(script, ldata, init);
+			continue;
+		}
+		off = script_code_add_text(&script->code, ldata);
+		if (off >= 0)
+			script_code_add(&script->code, SCRIPT_OP_CMD, off, 0);
+	} while (!script->code.oom);
+	fs_close(fd);
+
+	if (script->code.oom) {
+		hlog_warning(SCRIPTS_MODULE, "Not enough memory to load script %s", script->file);
+		script_code_free(&script->code);
+		return -1;
+	}
+	script_jumps_resolve(script);
+	script->code.valid = true;
+
+	if (IS_DEBUG(ctx))
+		hlog_info(SCRIPTS_MODULE, "Compiled %s: %d instructions, %d bytes text",
+				  script->file, script->code.count, script->code.text_len);
+	return 0;
+}
+
+static int script_load(struct scripts_context_t *ctx, char *fname, struct script_t *script)
+{
+	int elen = strlen(SCRIPT_EXTENSION);
+
+	if (sys_asprintf(&script->file, "%s/%s", SCRIPTS_DIR, fname) <= 0)
+		goto out_err;
+
+	script->ctx = ctx;
+	if (script_compile(ctx, script, true))
+		goto out_err;
 
 	if (!script->name) {
 		script->name = strdup(fname);
@@ -510,8 +603,6 @@ static int script_load(struct scripts_context_t *ctx, char *fname, struct script
 
 	if (script->cron.valid && script->cron.enable)
 		script_cron_set_next(ctx, script);
-	script->fd = -1;
-	fs_close(fd);
 
 	if (IS_DEBUG(ctx))
 		hlog_info(SCRIPTS_MODULE, "Loaded script [%s]\t%s", script->name, script->desc ? script->desc : "");
@@ -525,8 +616,7 @@ out_err:
 	script->name = NULL;
 	free(script->desc);
 	script->desc = NULL;
-	if (fd >= 0)
-		fs_close(fd);
+	script_code_free(&script->code);
 	return -1;
 }
 
@@ -549,6 +639,7 @@ static void scripts_init(struct scripts_context_t *ctx)
 			free(ctx->scripts[i].name);
 			free(ctx->scripts[i].desc);
 			free(ctx->scripts[i].file);
+			script_code_free(&ctx->scripts[i].code);
 		}
 		free(ctx->scripts);
 		ctx->scripts = NULL;
@@ -602,10 +693,7 @@ static void script_reset(struct script_t *script)
 	struct tm date;
 	int i;
 
-	if (script->fd >= 0) {
-		fs_close(script->fd);
-		script->fd = -1;
-	}
+	script->code.pc = 0;
 	script->wait = 0;
 	script->last_run = time_ms_since_boot();
 	if (tz_datetime_get(&date))
@@ -613,51 +701,62 @@ static void script_reset(struct script_t *script)
 	script->exec_count++;
 	script->mqtt.script.force = true;
 
-	for (i = 0; i < JUMP_COUNT_MAX; i++) {
-		if (!script->jumps[i])
-			continue;
-		script->jumps[i]->count = 0;
+	for (i = 0; i < script->code.count; i++) {
+		if (script->code.instr[i].op == SCRIPT_OP_JUMP)
+			script->code.instr[i].count = 0;
 	}
 }
 
+/* Execute the next instruction of the running script */
 static void script_exec(struct scripts_context_t *ctx)
 {
-	char *ldata;
+	struct script_t *script = ctx->run;
+	struct script_instr_t *instr;
 	int ret;
 
-	if (ctx->run->fd < 0)
-		ctx->run->fd = fs_open(ctx->run->file, LFS_O_RDONLY);
-	if (ctx->run->fd < 0)
+	if (!script->code.valid)
 		goto out_end;
-	if (ctx->run->wait && ctx->run->wait > time_ms_since_boot())
+	if (script->wait && script->wait > time_ms_since_boot())
 		return;
-	do {
-		ret = fs_gets(ctx->run->fd, ctx->line, MAX_LINE);
-		if (ret < 0)
-			goto out_end;
-		if (!ret)
-			continue;
-		ldata = ctx->line;
-		ldata += strspn(ldata, " \t");
-		if (strlen(ldata) < 1)
-			continue;
-		if (IS_COMMENT(ldata))
-			continue;
-		if (IS_SPEC_COMMAND(ldata)) {
-			if (!script_param_exec(ctx->run, ldata, false))
-				break;
-			continue;
+	while (script->code.pc < script->code.count) {
+		instr = &script->code.instr[script->code.pc++];
+		switch (instr->op) {
+		case SCRIPT_OP_CMD:
+			/* The command handlers modify the string, pass a copy */
+			strcpy(ctx->line, script->code.text + instr->arg);
+			ret = cmd_exec(&(ctx->cmd_ctx), ctx->line);
+			if (IS_DEBUG(ctx))
+				hlog_info(SCRIPTS_MODULE, "Executed command [%s]: %d",
+						  script->code.text + instr->arg, ret);
+			return;
+		case SCRIPT_OP_WAIT:
+			if (instr->arg > 0) {
+				script->wait = time_ms_since_boot() + instr->arg;
+				if (IS_DEBUG(ctx))
+					hlog_info(SCRIPTS_MODULE, "Wait for [%ld] msec", instr->arg);
+			} else {
+				script->wait = 0;
+			}
+			return;
+		case SCRIPT_OP_JUMP:
+			if (instr->limit && instr->count >= instr->limit) {
+				if (IS_DEBUG(ctx))
+					hlog_info(SCRIPTS_MODULE, "Jump at %d limit %d reached, ignoring",
+							  script->code.pc - 1, instr->count);
+				return;
+			}
+			instr->count++;
+			script->code.pc = instr->arg;
+			if (IS_DEBUG(ctx))
+				hlog_info(SCRIPTS_MODULE, "Jump to %d, count %d", instr->arg, instr->count);
+			return;
+		default:
+			break;
 		}
-		ret = cmd_exec(&(ctx->cmd_ctx), ldata);
-		if (IS_DEBUG(ctx))
-			hlog_info(SCRIPTS_MODULE, "Executed command [%s]: %d", ldata, ret);
-		break;
-	} while (true);
-
-	return;
+	}
 
 out_end:
-	script_reset(ctx->run);
+	script_reset(script);
 	ctx->run = NULL;
 }
 
@@ -671,17 +770,12 @@ static void script_notify(struct script_t *script)
 	webhook_send(notify_buff);
 }
 
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int script_mqtt_send(struct scripts_context_t *ctx, int idx)
 {
 	uint64_t now = time_ms_since_boot();
 	static char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
 	struct tm dt = {0};
-	int count = 0;
+	json_writer_t js;
 	int ret;
 
 	if (!ctx->count || idx < 0 || idx >= ctx->count)
@@ -690,28 +784,29 @@ static int script_mqtt_send(struct scripts_context_t *ctx, int idx)
 	     ctx->scripts[idx].mqtt.last_send && (now - ctx->scripts[idx].mqtt.last_send) < WH_SEND_DELAY_MS)
 		return 0;
 
-	ADD_MQTT_MSG("{");
-	ADD_MQTT_MSG_VAR("\"timestamp\": \"%s\"", get_current_time_str(time_buff, TIME_STR))
-	ADD_MQTT_MSG_VAR(",\"name\": \"%s\"", ctx->scripts[idx].name);
-	ADD_MQTT_MSG_VAR(",\"exec_count\": \"%d\"", ctx->scripts[idx].exec_count);
-	ADD_MQTT_MSG_VAR(",\"cron_enabled\": \"%d\"", ctx->scripts[idx].cron.enable);
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "timestamp", get_current_time_str(time_buff, TIME_STR));
+	json_add_str(&js, "name", ctx->scripts[idx].name);
+	json_add_int(&js, "exec_count", ctx->scripts[idx].exec_count);
+	json_add_int(&js, "cron_enabled", ctx->scripts[idx].cron.enable);
 	if (ctx->scripts[idx].last_run_date) {
 		epoch2time(&ctx->scripts[idx].last_run_date, &dt);
 		time_to_str(time_buff, TIME_STR, &dt);
-		ADD_MQTT_MSG_VAR(",\"last_run\":\"%s\"", time_buff);
+		json_add_str(&js, "last_run", time_buff);
 	} else {
-		ADD_MQTT_MSG(",\"last_run\":\"N/A\"");
+		json_add_str(&js, "last_run", "N/A");
 	}
 	if (ctx->scripts[idx].cron.next > 0) {
 		epoch2time(&ctx->scripts[idx].cron.next, &dt);
 		time_to_str(time_buff, TIME_STR, &dt);
-		ADD_MQTT_MSG_VAR(",\"next_run\":\"%s\"", time_buff);
+		json_add_str(&js, "next_run", time_buff);
 	} else {
-		ADD_MQTT_MSG(",\"next_run\":\"N/A\"");
+		json_add_str(&js, "next_run", "N/A");
+	}
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
 	}
-
-	ADD_MQTT_MSG("}")
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(&ctx->scripts[idx].mqtt.script, ctx->mqtt_payload);
 
 	if (!ret)
@@ -758,6 +853,7 @@ static void sys_scripts_run(void *context)
 	struct scripts_context_t *ctx = (struct scripts_context_t *)context;
 	static uint16_t idx;
 	int i, j = -1;
+	uint64_t now;
 
 	if (ctx->count < 1)
 		return;
@@ -770,8 +866,10 @@ static void sys_scripts_run(void *context)
 	if (ctx->startup_count)
 		script_startup(ctx);
 
+	now = time_ms_since_boot();
 	for (i = 0; i < ctx->count; i++) {
-		if (!ctx->scripts[i].run_now)
+		/* Not requested, or waiting for its startup delay */
+		if (!ctx->scripts[i].run_now || ctx->scripts[i].run_now > now)
 			continue;
 		if (j < 0 || ctx->scripts[i].run_now < ctx->scripts[j].run_now)
 			j = i;
@@ -780,6 +878,9 @@ static void sys_scripts_run(void *context)
 	if (j >= 0) {
 		ctx->run = &ctx->scripts[j];
 		ctx->scripts[j].run_now = 0;
+		/* Parse the script again, if it may be changed on the file system */
+		if (!ctx->run->code.valid || ctx->run->code.fs_changes != fs_get_changes())
+			script_compile(ctx, ctx->run, false);
 		if (ctx->scripts[j].notify_enable)
 			script_notify(&ctx->scripts[j]);
 		if (IS_DEBUG(ctx))
@@ -845,7 +946,7 @@ static bool sys_scripts_init(struct scripts_context_t **ctx)
 
 	fd = pico_dir_open(SCRIPTS_DIR);
 	if (fd < 0)
-		pico_mkdir(SCRIPTS_DIR);
+		fs_mkdir(SCRIPTS_DIR);
 	else
 		pico_dir_close(fd);
 
@@ -24,7 +24,7 @@
 #define LOG_STATUS_DELAY_MS	100
 
 #define TIME_STR	64
-#define MQTT_COUNT	2
+#define MQTT_COUNT	3
 #define MQTT_DATA_LEN		512
 
 typedef struct {
@@ -36,7 +36,6 @@ struct sys_state_context_t {
 	sys_module_t mod;
 	uint32_t periodic_log_ms;
 	uint64_t last_log;
-	uint64_t last_run;
 	uint32_t debug;
 
 	log_status_hook_t log_status[LOG_STATUS_HOOKS_COUNT];
@@ -72,26 +71,40 @@ static void sys_state_mqtt_init(struct sys_state_context_t *ctx)
 	ctx->mqtt_comp[1].name = "sys_error";
 	ctx->mqtt_comp[1].state_topic = ctx->mqtt_comp[0].state_topic;
 	mqtt_msg_component_register(&(ctx->mqtt_comp[1]));
+
+	/* Run time of the slowest module */
+	ctx->mqtt_comp[2].module = SYS_STAT_MODULE;
+	ctx->mqtt_comp[2].platform = "sensor";
+	ctx->mqtt_comp[2].dev_class = "duration";
+	ctx->mqtt_comp[2].unit = "μs";
+	ctx->mqtt_comp[2].value_template = "{{ value_json['sys_loop_p99'] }}";
+	ctx->mqtt_comp[2].name = "sys_loop_p99";
+	ctx->mqtt_comp[2].state_topic = ctx->mqtt_comp[0].state_topic;
+	mqtt_msg_component_register(&(ctx->mqtt_comp[2]));
 }
 
-#define ADD_MQTT_MSG(_S_) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-							count += snprintf(ctx->mqtt_payload + count, len - count, _S_); }
-#define ADD_MQTT_MSG_VAR(_S_, ...) { if ((len - count) < 0) { printf("%s: Buffer full\n\r", __func__); return -1; } \
-				     count += snprintf(ctx->mqtt_payload + count, len - count, _S_, __VA_ARGS__); }
 static int sys_state_mqtt_send(struct sys_state_context_t *ctx)
 {
+	uint32_t loop_p99 = 0, loop_max = 0;
+	char *loop_mod = NULL;
 	char time_buff[TIME_STR];
-	int len = MQTT_DATA_LEN;
-	int count = 0;
+	json_writer_t js;
 	int ret = -1;
 
-	ADD_MQTT_MSG("{");
-		ADD_MQTT_MSG_VAR("\"time\":\"%s\"", get_current_time_str(time_buff, TIME_STR));
-		ADD_MQTT_MSG_VAR(",\"sys_uptime\": \"%s\"", get_uptime());
-		ADD_MQTT_MSG_VAR(",\"sys_error\": \"%d\"", !sys_state_is_healthy());
-	ADD_MQTT_MSG("}")
+	json_begin(&js, ctx->mqtt_payload, MQTT_DATA_LEN + 1);
+	json_add_str(&js, "time", get_current_time_str(time_buff, TIME_STR));
+	json_add_str(&js, "sys_uptime", get_uptime());
+	json_add_int(&js, "sys_error", !sys_state_is_healthy());
+	if (sys_modules_stats_slowest(&loop_mod, &loop_p99, &loop_max)) {
+		json_add_uint(&js, "sys_loop_p99", loop_p99);
+		json_add_uint(&js, "sys_loop_max", loop_max);
+		json_add_str(&js, "sys_loop_module", loop_mod);
+	}
+	if (json_end(&js) < 0) {
+		printf("%s: Buffer full\n\r", __func__);
+		return -1;
+	}
 
-	ctx->mqtt_payload[MQTT_DATA_LEN] = 0;
 	ret = mqtt_msg_component_publish(&(ctx->mqtt_comp[0]), ctx->mqtt_payload);
 
 	return ret;
@@ -180,7 +193,6 @@ static bool sys_state_periodic(struct sys_state_context_t  *ctx)
 static void sys_state_log_run(void *context)
 {
 	struct sys_state_context_t  *ctx = (struct sys_state_context_t *)context;
-	uint64_t now = time_ms_since_boot();
 	int idx = ctx->log_status_progress;
 	bool ret = true;
 
@@ -191,9 +203,6 @@ static void sys_state_log_run(void *context)
 		return;
 	}
 
-	if (now - ctx->last_run < LOG_STATUS_DELAY_MS)
-		return;
-
 	if (ctx->log_status[idx].hook)
 		ret = ctx->log_status[idx].hook(ctx->log_status[idx].user_context);
 
@@ -206,8 +215,6 @@ static void sys_state_log_run(void *context)
 		ctx->mqtt_comp[0].force = true;
 		sys_state_mqtt_send(ctx);
 	}
-
-	ctx->last_run = now;
 }
 
 void sys_state_register(void)
@@ -219,6 +226,8 @@ void sys_state_register(void)
 
 	ctx->mod.name = SYS_STAT_MODULE;
 	ctx->mod.run = sys_state_log_run;
+	/* One status hook is logged on each run */
+	ctx->mod.run_interval_ms = LOG_STATUS_DELAY_MS;
 	ctx->mod.log = sys_state_log;
 	ctx->mod.debug = sys_state_debug_set;
 	ctx->mod.context = ctx;
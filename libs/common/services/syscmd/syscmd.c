@@ -16,6 +16,8 @@
 
 #define SYSCMD_MODULE		"sys"
 #define SYSCMD_DESC			"System commands"
+/* Check for the end of the status log, to close the web client */
+#define RUN_INTERVAL_MS		100
 
 #define DEBUG_LOG	0x01
 
@@ -313,6 +315,7 @@ void sys_syscmd_register(void)
 
 	ctx->mod.name = SYSCMD_MODULE;
 	ctx->mod.run = sys_commands_run;
+	ctx->mod.run_interval_ms = RUN_INTERVAL_MS;
 	ctx->mod.debug = sys_commands_debug_set;
 	ctx->mod.commands.hooks = syscmd_requests;
 	ctx->mod.commands.count = ARRAY_SIZE(syscmd_requests);
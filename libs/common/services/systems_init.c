@@ -90,4 +90,8 @@ void systems_register_and_init(void)
 	SYS_REGISTER(sys_wol_register);
 #endif /* HAVE_WOL */
 
+#ifdef HAVE_SYS_CORE1
+	SYS_REGISTER(sys_core1_register);
+#endif /* HAVE_SYS_CORE1 */
+
 }
@@ -20,6 +20,8 @@
 #define MAX_WIFI_NETS	3
 #define CONNECT_TIMEOUT_MS	30000
 #define WIFI_MODULE	"wifi"
+/* Check of the connection state */
+#define RUN_INTERVAL_MS	100
 
 struct wifi_net_t {
 	char *ssid;
@@ -206,6 +208,7 @@ void sys_wifi_register(void)
 
 	ctx->mod.name = WIFI_MODULE;
 	ctx->mod.run = sys_wifi_connect;
+	ctx->mod.run_interval_ms = RUN_INTERVAL_MS;
 	ctx->mod.log = sys_wifi_log_status;
 	ctx->mod.debug = sys_wifi_debug_set;
 	ctx->mod.context = ctx;
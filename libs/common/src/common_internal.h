@@ -65,7 +65,7 @@ extern "C" {
 	}
 #else
 #define LOOP_FUNC_RUN(N, F, args...) { F(args); wd_update(); }
-#define LOOP_RET_FUNC_RUN(N, F, args...) { (R) = F(args); wd_update(); }
+#define LOOP_RET_FUNC_RUN(N, R, F, args...) { (R) = F(args); wd_update(); }
 #endif
 
 typedef struct {
@@ -84,6 +84,8 @@ typedef struct {
 	sys_commands_t commands;
 	void *context;
 	uint32_t job_flags;
+	/* Call run every run_interval_ms, or on each loop pass if 0 */
+	uint32_t run_interval_ms;
 	/* Callbacks */
 	sys_module_run_cb_t run;
 	sys_module_run_cb_t reconnect;
@@ -94,9 +96,12 @@ int sys_module_register(sys_module_t *module);
 
 void sys_modules_init(void);
 void sys_modules_run(void);
+void sys_modules_sleep(void);
+void sys_module_wakeup(sys_module_t *module);
 void sys_modules_log(void);
 void sys_modules_reconnect(void);
 void sys_modules_debug_set(int debug);
+bool sys_modules_stats_slowest(char **name, uint32_t *percentile_us, uint32_t *max_us);
 void sys_job_state_set(uint32_t job);
 void sys_job_state_clear(uint32_t job);
 
@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2025-2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "pico/stdlib.h"
+#include "common_lib.h"
+
+/*
+ * Small JSON writer for the MQTT payloads. Writes into a caller buffer,
+ * without heap and without printf. The output is always NUL terminated.
+ * When the buffer is full, the writer stops and marks the output as
+ * truncated, json_end() returns -1 in that case.
+ */
+
+#define JSON_MAX_DECIMALS	6
+
+static const uint32_t json_pow10[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static void json_put(json_writer_t *js, const char *str, int len)
+{
+	if (js->truncated)
+		return;
+	if (len > js->size - 1 - js->len) {
+		len = js->size - 1 - js->len;
+		js->truncated = true;
+	}
+	memcpy(js->buf + js->len, str, len);
+	js->len += len;
+	js->buf[js->len] = 0;
+}
+
+static void json_putc(json_writer_t *js, char c)
+{
+	json_put(js, &c, 1);
+}
+
+static void json_put_uint(json_writer_t *js, uint32_t val, int min_digits)
+{
+	char digits[10];
+	int i = sizeof(digits);
+
+	do {
+		digits[--i] = '0' + (val % 10);
+		val /= 10;
+		min_digits--;
+	} while (val || min_digits > 0);
+	json_put(js, digits + i, sizeof(digits) - i);
+}
+
+static void json_put_str(json_writer_t *js, const char *str)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *s = str;
+	char esc[6];
+
+	json_putc(js, '"');
+	while (*s) {
+		/* Copy the runs, that need no escaping, at once */
+		str = s;
+		while (*s && *s != '"' && *s != '\\' && (uint8_t)*s >= 0x20)
+			s++;
+		json_put(js, str, s - str);
+		if (!*s)
+			break;
+		esc[0] = '\\';
+		switch (*s) {
+		case '"':
+		case '\\':
+			esc[1] = *s;
+			json_put(js, esc, 2);
+			break;
+		case '\n':
+			json_put(js, "\\n", 2);
+			break;
+		case '\r':
+			json_put(js, "\\r", 2);
+			break;
+		case '\t':
+			json_put(js, "\\t", 2);
+			break;
+		default:
+			esc[1] = 'u';
+			esc[2] = '0';
+			esc[3] = '0';
+			esc[4] = hex[((uint8_t)*s) >> 4];
+			esc[5] = hex[((uint8_t)*s) & 0xF];
+			json_put(js, esc, 6);
+			break;
+		}
+		s++;
+	}
+	json_putc(js, '"');
+}
+
+void json_begin(json_writer_t *js, char *buf, int size)
+{
+	js->buf = buf;
+	js->size = size;
+	js->len = 0;
+	js->truncated = size < 1;
+	js->first = true;
+	if (size > 0)
+		buf[0] = 0;
+	json_putc(js, '{');
+}
+
+/* Returns the length of the payload, or -1 if it does not fit in the buffer */
+int json_end(json_writer_t *js)
+{
+	json_putc(js, '}');
+	return js->truncated ? -1 : js->len;
+}
+
+void json_key(json_writer_t *js, const char *key)
+{
+	if (!js->first)
+		json_putc(js, ',');
+	js->first = false;
+	json_put_str(js, key);
+	json_putc(js, ':');
+}
+
+/* Key in format <prefix><idx><suffix>, i.e. "cell_5_v" */
+void json_key_idx(json_writer_t *js, const char *prefix, int idx, const char *suffix)
+{
+	if (!js->first)
+		json_putc(js, ',');
+	js->first = false;
+	json_putc(js, '"');
+	json_put(js, prefix, strlen(prefix));
+	json_put_uint(js, idx < 0 ? 0 : idx, 1);
+	json_put(js, suffix, strlen(suffix));
+	json_put(js, "\":", 2);
+}
+
+void json_val_str(json_writer_t *js, const char *val)
+{
+	json_put_str(js, val ? val : "");
+}
+
+void json_val_int(json_writer_t *js, int32_t val)
+{
+	if (val < 0) {
+		json_putc(js, '-');
+		json_put_uint(js, -(uint32_t)val, 1);
+	} else {
+		json_put_uint(js, val, 1);
+	}
+}
+
+void json_val_uint(json_writer_t *js, uint32_t val)
+{
+	json_put_uint(js, val, 1);
+}
+
+void json_val_bool(json_writer_t *js, bool val)
+{
+	if (val)
+		json_put(js, "true", 4);
+	else
+		json_put(js, "false", 5);
+}
+
+/*
+ * Fixed point value: val * 10^-scale, rounded to given decimals.
+ * i.e. val 3312, scale 3, decimals 2 is "3.31"
+ */
+void json_val_fixed(json_writer_t *js, int32_t val, int scale, int decimals)
+{
+	uint32_t abs = val < 0 ? -(uint32_t)val : (uint32_t)val;
+	uint32_t div;
+	int i;
+
+	if (scale < 0)
+		scale = 0;
+	if (scale > JSON_MAX_DECIMALS)
+		scale = JSON_MAX_DECIMALS;
+	if (decimals < 0)
+		decimals = 0;
+	if (decimals > JSON_MAX_DECIMALS)
+		decimals = JSON_MAX_DECIMALS;
+	if (decimals < scale) {
+		div = json_pow10[scale - decimals];
+		abs = abs / div + ((abs % div) >= div / 2 ? 1 : 0);
+		scale = decimals;
+	}
+	if (val < 0 && abs)
+		json_putc(js, '-');
+	json_put_uint(js, abs / json_pow10[scale], 1);
+	if (!decimals)
+		return;
+	json_putc(js, '.');
+	if (scale)
+		json_put_uint(js, abs % json_pow10[scale], scale);
+	/* More decimals than the precision of the value */
+	for (i = scale; i < decimals; i++)
+		json_putc(js, '0');
+}
+
+void json_val_float(json_writer_t *js, float val, int decimals)
+{
+	float scaled;
+
+	if (decimals > JSON_MAX_DECIMALS)
+		decimals = JSON_MAX_DECIMALS;
+	if (decimals < 0)
+		decimals = 0;
+	scaled = val * json_pow10[decimals];
+	/* No NaN and Inf in JSON */
+	if (isnan(val) || scaled >= 2147483647.0f || scaled <= -2147483647.0f) {
+		json_put(js, "null", 4);
+		return;
+	}
+	json_val_fixed(js, (int32_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f), decimals, decimals);
+}
+
+void json_add_str(json_writer_t *js, const char *key, const char *val)
+{
+	json_key(js, key);
+	json_val_str(js, val);
+}
+
+void json_add_int(json_writer_t *js, const char *key, int32_t val)
+{
+	json_key(js, key);
+	json_val_int(js, val);
+}
+
+void json_add_uint(json_writer_t *js, const char *key, uint32_t val)
+{
+	json_key(js, key);
+	json_val_uint(js, val);
+}
+
+void json_add_bool(json_writer_t *js, const char *key, bool val)
+{
+	json_key(js, key);
+	json_val_bool(js, val);
+}
+
+void json_add_fixed(json_writer_t *js, const char *key, int32_t val, int scale, int decimals)
+{
+	json_key(js, key);
+	json_val_fixed(js, val, scale, decimals);
+}
+
+void json_add_float(json_writer_t *js, const char *key, float val, int decimals)
+{
+	json_key(js, key);
+	json_val_float(js, val, decimals);
+}
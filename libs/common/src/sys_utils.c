@@ -97,27 +97,79 @@ uint8_t sys_value_to_percent(uint32_t range_min, uint32_t range_max, uint32_t va
 	return	(100 * (val - range_min)) / (range_max - range_min);
 }
 
-uint32_t samples_filter(uint32_t *samples, int total_count, int filter_count)
+/* FNV-1a hash of the buffer, start with hash = SYS_HASH_INIT */
+uint32_t sys_hash(uint32_t hash, const void *buf, int len)
+{
+	const uint8_t *data = (const uint8_t *)buf;
+
+	while (len-- > 0) {
+		hash ^= *data++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+#define SAMPLE_SWAP(A, B) { uint32_t sw = (A); (A) = (B); (B) = sw; }
+/* Reorder the samples, so that the k-th smallest is at position k, the smaller before it and the bigger after it */
+static void samples_select(uint32_t *samples, int left, int right, int k)
 {
-	uint32_t all;
-	uint16_t sw;
-	int i, j;
-
-	/* bubble sort */
-	for (i = 0 ; i < total_count - 1; i++) {
-		for (j = 0 ; j < total_count - i - 1; j++) {
-			if (samples[j] > samples[j+1]) {
-				sw  = samples[j];
-				samples[j] = samples[j+1];
-				samples[j+1] = sw;
-			}
+	uint32_t pivot;
+	int i, j, mid;
+
+	while (left < right) {
+		/* median of three as pivot, moved at left */
+		mid = left + (right - left) / 2;
+		if (samples[mid] < samples[left])
+			SAMPLE_SWAP(samples[mid], samples[left]);
+		if (samples[right] < samples[left])
+			SAMPLE_SWAP(samples[right], samples[left]);
+		if (samples[right] < samples[mid])
+			SAMPLE_SWAP(samples[right], samples[mid]);
+		SAMPLE_SWAP(samples[left], samples[mid]);
+		pivot = samples[left];
+
+		i = left;
+		j = right + 1;
+		while (true) {
+			while (samples[++i] < pivot && i < right)
+				;
+			while (samples[--j] > pivot)
+				;
+			if (i >= j)
+				break;
+			SAMPLE_SWAP(samples[i], samples[j]);
 		}
+		SAMPLE_SWAP(samples[left], samples[j]);
+
+		if (j == k)
+			return;
+		if (j < k)
+			left = j + 1;
+		else
+			right = j - 1;
+	}
+}
+
+/* Average of the samples, without the filter_count biggest and smallest. Reorders the samples */
+uint32_t samples_filter(uint32_t *samples, int total_count, int filter_count)
+{
+	uint64_t all;
+	int i;
+
+	if (filter_count < 0 || total_count - (2 * filter_count) <= 0)
+		return 0;
+
+	/* move the smallest at the beginning and the biggest at the end */
+	if (filter_count) {
+		samples_select(samples, 0, total_count - 1, filter_count);
+		samples_select(samples, filter_count, total_count - 1, total_count - filter_count - 1);
 	}
-	/* filter biggest and smallest */
+
 	all = 0;
 	for (i = filter_count ; i < total_count - filter_count; i++)
 		all += samples[i];
-	all /= total_count-(2*filter_count);
+	all /= total_count - (2 * filter_count);
 
 	return all;
 }
@@ -134,7 +186,12 @@ uint32_t get_total_heap(void)
 
 uint32_t get_free_heap(void)
 {
+#ifdef __GLIBC__
+	/* Host build, mallinfo() is deprecated in glibc */
+	struct mallinfo2 m = mallinfo2();
+#else
 	struct mallinfo m = mallinfo();
+#endif
 
 //	return m.fordblks;
 	return get_total_heap() - m.uordblks;
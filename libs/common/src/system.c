@@ -13,6 +13,9 @@
 #include "pico/binary_info.h"
 #include "hardware/clocks.h"
 #include "hardware/watchdog.h"
+#if LIB_PICO_STDIO_USB
+#include "tusb.h"
+#endif
 
 #include "herak_sys.h"
 #include "common_internal.h"
@@ -35,6 +38,12 @@ bi_decl(bi_program_url("github.com/tzstoyanov/herak-raspberry"));
 #define	BUSY_WAIT
 #endif
 #define BLINK_INTERVAL	100
+/* Max time to wait for a terminal on the USB console at boot */
+#ifndef BOOT_CONSOLE_WAIT_MS
+#define BOOT_CONSOLE_WAIT_MS	2000
+#endif
+/* Max time to wait for the USB host to enumerate the device */
+#define BOOT_USB_MOUNT_WAIT_MS	1000
 static struct {
 	uint64_t reboot_time;
 	bool reconnect;
@@ -48,7 +57,6 @@ static bool base_init(void)
 		return false;
 	}
 	cyw43_arch_enable_sta_mode();
-	busy_wait_ms(2000);
 	gpio_init(CYW43_WL_GPIO_LED_PIN);
 	gpio_set_dir(CYW43_WL_GPIO_LED_PIN, GPIO_OUT);
 	aon_timer_start_with_timeofday();
@@ -56,13 +64,30 @@ static bool base_init(void)
 	return true;
 }
 
+/* Wait for a terminal on the USB console, to not lose the boot logs */
+static void console_wait(void)
+{
+#if LIB_PICO_STDIO_USB
+	uint32_t start = to_ms_since_boot(get_absolute_time());
+	uint32_t now = start;
+
+	while (!stdio_usb_connected() && (now - start) < BOOT_CONSOLE_WAIT_MS) {
+		/* Not attached to USB host, or powered by a charger */
+		if (!tud_mounted() && (now - start) >= BOOT_USB_MOUNT_WAIT_MS)
+			break;
+		sleep_ms(10);
+		now = to_ms_since_boot(get_absolute_time());
+	}
+#endif
+}
+
 bool system_common_init(void)
 {
 	// Initialize the serial port, default 38400 baud
 	set_sys_clock_khz(120000, true);
 	stdio_init_all();
 	srand(to_us_since_boot(get_absolute_time()));
-	busy_wait_ms(2000);
+	console_wait();
 
 	watchdog_enable(WATCHDOG_TIMEOUT_MS, true);
 
@@ -103,6 +128,8 @@ void system_common_main(void)
 		system_common_run();
 		LED_OFF;
 		BUSY_WAIT;
+		if (!sys_context.reconnect)
+			sys_modules_sleep();
 	}
 }
 
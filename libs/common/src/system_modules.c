@@ -17,12 +17,110 @@
 #define MAX_MODULES 30
 #define SYSMODLOG   "sys_mod"
 
+/* Histogram of the run times, bucket N holds times up to 2^N usec */
+#define STATS_BUCKETS	32
+#define STATS_PERCENTILE	99
+/* Max time to sleep between two loop passes, must be less than the watchdog timeout */
+#define SLEEP_MAX_MS	500
+
+struct sys_module_stats_t {
+	uint32_t calls;
+	uint32_t min_us;
+	uint32_t max_us;
+	uint64_t total_us;
+	uint16_t hist[STATS_BUCKETS];
+};
+
 static struct {
 	int modules_count;
 	sys_module_t *modules[MAX_MODULES];
+	struct sys_module_stats_t stats[MAX_MODULES];
+	uint32_t next_run[MAX_MODULES];
+	volatile bool wakeup[MAX_MODULES];
 	uint32_t job_state;
+	uint64_t sleep_us;
 } sys_modules_context;
 
+static void sys_module_stats_add(struct sys_module_stats_t *stats, uint32_t us)
+{
+	int b = us ? 32 - __builtin_clz(us) : 0;
+	int i;
+
+	if (b >= STATS_BUCKETS)
+		b = STATS_BUCKETS - 1;
+	if (!stats->calls || us < stats->min_us)
+		stats->min_us = us;
+	if (us > stats->max_us)
+		stats->max_us = us;
+	stats->total_us += us;
+	stats->calls++;
+	/* Keep the distribution when a bucket is full */
+	if (stats->hist[b] == UINT16_MAX) {
+		for (i = 0; i < STATS_BUCKETS; i++)
+			stats->hist[i] >>= 1;
+	}
+	stats->hist[b]++;
+}
+
+/* Upper bound of the bucket, where the given percentile of the run times is */
+static uint32_t sys_module_stats_percentile(struct sys_module_stats_t *stats, int percent)
+{
+	uint32_t total = 0, sum = 0;
+	int i;
+
+	for (i = 0; i < STATS_BUCKETS; i++)
+		total += stats->hist[i];
+	if (!total)
+		return 0;
+	for (i = 0; i < STATS_BUCKETS; i++) {
+		sum += stats->hist[i];
+		if (sum * 100 >= total * percent)
+			break;
+	}
+	if (i >= STATS_BUCKETS)
+		i = STATS_BUCKETS - 1;
+	return 1UL << i;
+}
+
+static void sys_module_stats_log(int idx)
+{
+	struct sys_module_stats_t *stats = &sys_modules_context.stats[idx];
+
+	if (!sys_modules_context.modules[idx]->run)
+		return;
+	if (sys_modules_context.modules[idx]->run_interval_ms)
+		hlog_info(SYSMODLOG, "Run every %lu ms", sys_modules_context.modules[idx]->run_interval_ms);
+	hlog_info(SYSMODLOG, "Run %lu times, min %lu usec, avg %lu usec, max %lu usec, p%d < %lu usec",
+			  stats->calls, stats->min_us,
+			  stats->calls ? (uint32_t)(stats->total_us / stats->calls) : 0,
+			  stats->max_us, STATS_PERCENTILE,
+			  sys_module_stats_percentile(stats, STATS_PERCENTILE));
+}
+
+/* Find the module with the highest percentile of run times */
+bool sys_modules_stats_slowest(char **name, uint32_t *percentile_us, uint32_t *max_us)
+{
+	uint32_t p, pmax = 0;
+	int i, idx = -1;
+
+	for (i = 0; i < sys_modules_context.modules_count; i++) {
+		if (!sys_modules_context.stats[i].calls)
+			continue;
+		p = sys_module_stats_percentile(&sys_modules_context.stats[i], STATS_PERCENTILE);
+		if (idx < 0 || p > pmax ||
+		    (p == pmax && sys_modules_context.stats[i].max_us > sys_modules_context.stats[idx].max_us)) {
+			pmax = p;
+			idx = i;
+		}
+	}
+	if (idx < 0)
+		return false;
+	*name = sys_modules_context.modules[idx]->name;
+	*percentile_us = pmax;
+	*max_us = sys_modules_context.stats[idx].max_us;
+	return true;
+}
+
 int sys_module_register(sys_module_t *module)
 {
 	if (sys_modules_context.modules_count >= MAX_MODULES)
@@ -80,6 +178,7 @@ static int cmd_module_status(cmd_run_context_t *ctx, char *cmd, char *params, vo
 {
 	sys_module_t *mod = (sys_module_t *)user_data;
 	bool ret;
+	int i;
 
 	UNUSED(cmd);
 	UNUSED(ctx);
@@ -88,6 +187,13 @@ static int cmd_module_status(cmd_run_context_t *ctx, char *cmd, char *params, vo
 	if (!mod)
 		goto out;
 
+	for (i = 0; i < sys_modules_context.modules_count; i++) {
+		if (sys_modules_context.modules[i] == mod) {
+			sys_module_stats_log(i);
+			break;
+		}
+	}
+
 	if (!mod->log) {
 		hlog_info(SYSMODLOG, "Module %s does not support status reporting", mod->name);
 		goto out;
@@ -138,6 +244,7 @@ void sys_modules_init(void)
 	devices_register_and_init();
 
 	for (i = 0; i < sys_modules_context.modules_count; i++) {
+		sys_modules_context.next_run[i] = to_ms_since_boot(get_absolute_time());
 		sys_module_debug_init(sys_modules_context.modules[i]);
 		if (sys_modules_context.modules[i]->commands.hooks)	{
 #ifdef HAVE_COMMANDS
@@ -172,6 +279,10 @@ void sys_modules_log(void)
 
 	if (sys_modules_context.job_state)
 		hlog_info(SYSMODLOG, "  Running job 0x%04X", sys_modules_context.job_state);
+	if (sys_modules_context.sleep_us)
+		hlog_info(SYSMODLOG, "  Slept %llu sec, %d%% of the time",
+				  sys_modules_context.sleep_us / 1000000,
+				  (int)((sys_modules_context.sleep_us * 100) / time_us_64()));
 	hlog_info(SYSMODLOG, "  Registered %d modules:", sys_modules_context.modules_count);
 	for (i = 0; i < sys_modules_context.modules_count; i++) {
 		hlog_info(SYSMODLOG, "    [%s]%s",
@@ -206,20 +317,84 @@ void sys_modules_debug_set(int debug)
 	}
 }
 
+static bool sys_module_paused(int idx)
+{
+	return sys_modules_context.job_state &&
+		   !(sys_modules_context.job_state & sys_modules_context.modules[idx]->job_flags);
+}
+
+/* Force the next run of a module, before its interval expires. Safe to call from an IRQ */
+void sys_module_wakeup(sys_module_t *module)
+{
+	int i;
+
+	for (i = 0; i < sys_modules_context.modules_count; i++) {
+		if (sys_modules_context.modules[i] == module) {
+			sys_modules_context.wakeup[i] = true;
+			__sev();
+			break;
+		}
+	}
+}
+
 void sys_modules_run(void)
 {
+	uint32_t now = to_ms_since_boot(get_absolute_time());
+	uint32_t start;
 	int i;
 
 	for (i = 0; i < sys_modules_context.modules_count; i++) {
 		if (!sys_modules_context.modules[i]->run)
 			continue;
-		if (sys_modules_context.job_state &&
-			!(sys_modules_context.job_state & sys_modules_context.modules[i]->job_flags))
+		if (sys_module_paused(i))
 			continue;
+		if (sys_modules_context.modules[i]->run_interval_ms) {
+			if (!sys_modules_context.wakeup[i] &&
+			    (int32_t)(now - sys_modules_context.next_run[i]) < 0)
+				continue;
+			sys_modules_context.wakeup[i] = false;
+			sys_modules_context.next_run[i] = now + sys_modules_context.modules[i]->run_interval_ms;
+		}
+		start = time_us_32();
 		LOOP_FUNC_RUN(sys_modules_context.modules[i]->name,
 					  sys_modules_context.modules[i]->run,
 					  sys_modules_context.modules[i]->context);
+		sys_module_stats_add(&sys_modules_context.stats[i], time_us_32() - start);
+	}
+}
+
+/*
+ * Sleep until the nearest module deadline or an interrupt. Does nothing while
+ * there is a module that must run on each loop pass.
+ */
+void sys_modules_sleep(void)
+{
+	uint32_t now = to_ms_since_boot(get_absolute_time());
+	int32_t wait = SLEEP_MAX_MS;
+	uint64_t start;
+	int32_t diff;
+	int i;
+
+	for (i = 0; i < sys_modules_context.modules_count; i++) {
+		if (!sys_modules_context.modules[i]->run)
+			continue;
+		if (sys_module_paused(i))
+			continue;
+		if (!sys_modules_context.modules[i]->run_interval_ms)
+			return;
+		if (sys_modules_context.wakeup[i])
+			return;
+		diff = (int32_t)(sys_modules_context.next_run[i] - now);
+		if (diff <= 0)
+			return;
+		if (diff < wait)
+			wait = diff;
 	}
+
+	start = time_us_64();
+	best_effort_wfe_or_timeout(make_timeout_time_ms(wait));
+	sys_modules_context.sleep_us += time_us_64() - start;
+	wd_update();
 }
 
 void sys_job_state_set(uint32_t job)
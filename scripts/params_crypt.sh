@@ -17,7 +17,7 @@ function write_param() {
     cval=$(echo "$3" | tr -d '\r\n' | base64 -w 0)
     length=${#cval}
     for ((i = 0; i < length; i++)); do
-       vascii=$(echo -n "${cval:i:1}"|hexdump -ve '"%02X"')
+       vascii=$(printf '%02X' "'${cval:i:1}")
        if [ $i -ge 1 ]; then
           echo -n ", 0x$vascii" >> $fname.c
        else
@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * ADC and the DMA from its FIFO. The ADC converts in free running mode, at
+ * the rate of its clock divider, the values are given by the test. The
+ * conversions are moved to the DMA channel paced by DREQ_ADC when the
+ * registers of a channel are read. A long period of time is not simulated
+ * conversion by conversion, only the ones that stay in the memory are written.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#include "host_fakes.h"
+
+#define ADC_CLOCK_HZ	48000000.0
+
+adc_hw_t host_adc_hw;
+dma_hw_t host_dma_hw;
+
+struct host_dma_chan_t {
+	bool claimed;
+	bool busy;
+	dma_channel_config cfg;
+	volatile void *write_addr;
+	const volatile void *read_addr;
+	uint32_t written;
+};
+
+static struct {
+	bool run;
+	uint input;
+	uint mask;
+	float clkdiv;
+	uint order[NUM_ADC_CHANNELS];
+	int order_count;
+	uint64_t run_us;
+	uint64_t converted;
+	host_adc_source_t source;
+	struct host_dma_chan_t dma[NUM_DMA_CHANNELS];
+} host_adc;
+
+void host_adc_source_set(host_adc_source_t source)
+{
+	host_adc.source = source;
+}
+
+void adc_init(void)
+{
+	host_adc_hw.cs = ADC_CS_READY_BITS;
+	host_adc.run = false;
+	host_adc.input = 0;
+	host_adc.mask = 0;
+}
+
+void adc_gpio_init(uint gpio)
+{
+	gpio_init(gpio);
+}
+
+void adc_select_input(uint input)
+{
+	if (input < NUM_ADC_CHANNELS)
+		host_adc.input = input;
+}
+
+void adc_set_round_robin(uint input_mask)
+{
+	host_adc.mask = input_mask;
+}
+
+void adc_set_clkdiv(float clkdiv)
+{
+	host_adc.clkdiv = clkdiv;
+}
+
+void adc_irq_set_enabled(bool enabled)
+{
+	(void)enabled;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+	(void)en;
+	(void)dreq_en;
+	(void)dreq_thresh;
+	(void)err_in_fifo;
+	(void)byte_shift;
+}
+
+void adc_fifo_drain(void)
+{
+}
+
+static struct host_dma_chan_t *host_adc_dma_chan(uint *channel)
+{
+	uint i;
+
+	for (i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (host_adc.dma[i].busy && host_adc.dma[i].cfg.dreq == DREQ_ADC) {
+			*channel = i;
+			return &host_adc.dma[i];
+		}
+	}
+	return NULL;
+}
+
+/* Run the chained channel, only a reload of the count of another channel is supported */
+static void host_dma_chain(uint channel)
+{
+	struct host_dma_chan_t *ctrl;
+	uint chain = host_adc.dma[channel].cfg.chain_to;
+	uint i;
+
+	if (chain == channel || chain >= NUM_DMA_CHANNELS)
+		return;
+	ctrl = &host_adc.dma[chain];
+	for (i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (ctrl->write_addr != &host_dma_hw.ch[i].al1_transfer_count_trig)
+			continue;
+		host_dma_hw.ch[i].transfer_count = *(const volatile uint32_t *)ctrl->read_addr;
+		host_adc.dma[i].busy = true;
+	}
+}
+
+/* Store the conversion to the write address of the channel, in its ring */
+static void host_dma_write(struct host_dma_chan_t *dma, uint32_t idx, uint16_t value)
+{
+	uint32_t len = (1 << dma->cfg.ring_bits) / sizeof(uint16_t);
+
+	if (dma->cfg.ring_write && dma->cfg.ring_bits)
+		idx %= len;
+	((volatile uint16_t *)dma->write_addr)[idx] = value;
+}
+
+/* Move the conversions done by now to the DMA */
+static void host_adc_update(void)
+{
+	struct host_dma_chan_t *dma;
+	uint64_t total, count, skip, i, k;
+	double rate;
+	uint channel;
+
+	if (!host_adc.run)
+		return;
+	rate = ADC_CLOCK_HZ / (host_adc.clkdiv + 1);
+	total = (uint64_t)((double)(time_us_64() - host_adc.run_us) * rate / 1000000.0);
+	while (host_adc.converted < total) {
+		dma = host_adc_dma_chan(&channel);
+		if (!dma) {
+			/* The FIFO overflows */
+			host_adc.converted = total;
+			break;
+		}
+		count = MIN(total - host_adc.converted, host_dma_hw.ch[channel].transfer_count);
+		skip = 0;
+		if (dma->cfg.ring_write && dma->cfg.ring_bits)
+			skip = count - MIN(count, (uint64_t)(1 << dma->cfg.ring_bits) / sizeof(uint16_t));
+		for (i = skip; i < count; i++) {
+			k = host_adc.converted + i;
+			host_dma_write(dma, dma->written + i, host_adc.source ?
+				       host_adc.source(host_adc.order[k % host_adc.order_count], k) : 0);
+		}
+		dma->written += count;
+		host_adc.converted += count;
+		host_dma_hw.ch[channel].transfer_count -= count;
+		if (!host_dma_hw.ch[channel].transfer_count) {
+			dma->busy = false;
+			host_dma_chain(channel);
+		}
+	}
+}
+
+/* The round robin starts from the selected input */
+void adc_run(bool run)
+{
+	uint i, input;
+
+	host_adc_update();
+	host_adc.run = run;
+	if (!run)
+		return;
+	host_adc.run_us = time_us_64();
+	host_adc.converted = 0;
+	host_adc.order_count = 0;
+	for (i = 0; i < NUM_ADC_CHANNELS; i++) {
+		input = (host_adc.input + i) % NUM_ADC_CHANNELS;
+		if (input == host_adc.input || (host_adc.mask & (1 << input)))
+			host_adc.order[host_adc.order_count++] = input;
+	}
+}
+
+int dma_claim_unused_channel(bool required)
+{
+	int i;
+
+	(void)required;
+
+	for (i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (!host_adc.dma[i].claimed) {
+			host_adc.dma[i].claimed = true;
+			return i;
+		}
+	}
+	return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+	dma_channel_config c = {
+		.size = DMA_SIZE_32,
+		.read_increment = true,
+		.write_increment = false,
+		.dreq = DREQ_FORCE,
+		.chain_to = channel,
+	};
+
+	return c;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+			   const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+	if (channel >= NUM_DMA_CHANNELS)
+		return;
+	host_adc_update();
+	host_adc.dma[channel].cfg = *config;
+	host_adc.dma[channel].write_addr = write_addr;
+	host_adc.dma[channel].read_addr = read_addr;
+	host_adc.dma[channel].written = 0;
+	host_dma_hw.ch[channel].transfer_count = transfer_count;
+	host_adc.dma[channel].busy = trigger;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger)
+{
+	if (channel >= NUM_DMA_CHANNELS)
+		return;
+	host_adc_update();
+	host_adc.dma[channel].cfg = *config;
+	if (trigger)
+		host_adc.dma[channel].busy = true;
+}
+
+void dma_channel_abort(uint channel)
+{
+	if (channel >= NUM_DMA_CHANNELS)
+		return;
+	host_adc_update();
+	host_adc.dma[channel].busy = false;
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel)
+{
+	host_adc_update();
+	return &host_dma_hw.ch[channel];
+}
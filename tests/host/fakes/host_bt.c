@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Bluetooth API, without BTstack. The known devices are connected and
+ * disconnected by the tests, the notifications of a characteristic are
+ * sent by the tests as well. Each device has one service with the
+ * characteristics, given by the test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include <btstack_util.h>
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_fakes.h"
+
+#define HOST_BT_DEVICES	8
+#define HOST_BT_CHARS	4
+/* ID of a characteristic, based on its index and the index of the device */
+#define HOST_BT_CHAR_ID(I, C)	((((C) + 1) << 8) | (I))
+
+struct host_bt_char_t {
+	bt_uuid128_t uuid;
+	uint32_t properties;
+};
+
+struct host_bt_dev_t {
+	bt_addr_t addr;
+	bt_event_handler_t cb;
+	void *context;
+	bool connected;
+	bool notify;
+};
+
+static struct {
+	int count;
+	struct host_bt_dev_t devices[HOST_BT_DEVICES];
+	bt_uuid128_t svc_uuid;
+	int char_count;
+	struct host_bt_char_t chars[HOST_BT_CHARS];
+	struct host_bt_stats_t stats;
+	uint8_t last_write[HOST_BT_WRITE_MAX];
+	int last_write_len;
+} host_bt;
+
+/* The devices are numbered from 1, as in BTstack */
+static struct host_bt_dev_t *host_bt_dev(int idx)
+{
+	if (idx < 1 || idx > host_bt.count)
+		return NULL;
+	return &host_bt.devices[idx - 1];
+}
+
+static struct host_bt_char_t *host_bt_char(uint32_t char_id)
+{
+	int c = (int)(char_id >> 8) - 1;
+
+	if (c < 0 || c >= host_bt.char_count)
+		return NULL;
+	return &host_bt.chars[c];
+}
+
+static int host_bt_char_dev(uint32_t char_id)
+{
+	int idx = char_id & 0xFF;
+
+	if (!host_bt_char(char_id) || !host_bt_dev(idx))
+		return -1;
+	return idx;
+}
+
+/* The service and its first characteristic, which notifies and accepts requests */
+void host_bt_uuid_set(const bt_uuid128_t svc, const bt_uuid128_t charc)
+{
+	memcpy(host_bt.svc_uuid, svc, BT_UUID128_LEN);
+	host_bt.char_count = 0;
+	host_bt_char_add(charc, ATT_PROPERTY_READ | ATT_PROPERTY_WRITE_WITHOUT_RESPONSE |
+				ATT_PROPERTY_WRITE | ATT_PROPERTY_NOTIFY);
+}
+
+int host_bt_char_add(const bt_uuid128_t uuid, uint32_t properties)
+{
+	if (host_bt.char_count >= HOST_BT_CHARS)
+		return -1;
+	memcpy(host_bt.chars[host_bt.char_count].uuid, uuid, BT_UUID128_LEN);
+	host_bt.chars[host_bt.char_count].properties = properties;
+	return host_bt.char_count++;
+}
+
+void *host_bt_context(int idx)
+{
+	struct host_bt_dev_t *dev = host_bt_dev(idx);
+
+	return dev ? dev->context : NULL;
+}
+
+/* Connect, discover the characteristics and report the device ready */
+void host_bt_connect(int idx, const char *name)
+{
+	struct host_bt_dev_t *dev = host_bt_dev(idx);
+	bt_characteristic_t charc;
+	int c;
+
+	if (!dev || dev->connected)
+		return;
+	dev->connected = true;
+	dev->notify = false;
+	host_bt.stats.connects++;
+	dev->cb(idx, BT_CONNECTED, name, strlen(name) + 1, dev->context);
+	for (c = 0; c < host_bt.char_count; c++) {
+		memset(&charc, 0, sizeof(charc));
+		charc.char_id = HOST_BT_CHAR_ID(idx, c);
+		charc.properties = host_bt.chars[c].properties;
+		memcpy(charc.uuid128, host_bt.chars[c].uuid, BT_UUID128_LEN);
+		dev->cb(idx, BT_NEW_CHARACTERISTIC, &charc, sizeof(charc), dev->context);
+	}
+	dev->cb(idx, BT_READY, NULL, 0, dev->context);
+}
+
+void host_bt_disconnect(int idx)
+{
+	struct host_bt_dev_t *dev = host_bt_dev(idx);
+
+	if (!dev || !dev->connected)
+		return;
+	dev->connected = false;
+	dev->notify = false;
+	dev->cb(idx, BT_DISCONNECTED, NULL, 0, dev->context);
+}
+
+bool host_bt_connected(int idx)
+{
+	struct host_bt_dev_t *dev = host_bt_dev(idx);
+
+	return dev && dev->connected;
+}
+
+bool host_bt_notify_enabled(int idx)
+{
+	struct host_bt_dev_t *dev = host_bt_dev(idx);
+
+	return dev && dev->connected && dev->notify;
+}
+
+/* A value of the characteristic, as it comes from the device */
+void host_bt_notify_char(int idx, int c, uint8_t *data, int len)
+{
+	struct host_bt_dev_t *dev = host_bt_dev(idx);
+	bt_characteristicvalue_t val = {0};
+
+	if (!dev || !dev->connected || c < 0 || c >= host_bt.char_count)
+		return;
+	val.charId = HOST_BT_CHAR_ID(idx, c);
+	val.data = data;
+	val.len = len;
+	dev->cb(idx, BT_VALUE_RECEIVED, &val, sizeof(val), dev->context);
+}
+
+/* A notification of the first characteristic */
+void host_bt_notify(int idx, const uint8_t *data, int len)
+{
+	host_bt_notify_char(idx, 0, (uint8_t *)data, len);
+}
+
+struct host_bt_stats_t *host_bt_stats(void)
+{
+	return &host_bt.stats;
+}
+
+int host_bt_last_write(uint8_t *data, int max)
+{
+	int len = MIN(max, host_bt.last_write_len);
+
+	memcpy(data, host_bt.last_write, len);
+	return len;
+}
+
+int bt_add_known_device(bt_addr_t addr, char *pin, bt_event_handler_t cb, void *context)
+{
+	struct host_bt_dev_t *dev;
+
+	UNUSED(pin);
+
+	if (host_bt.count >= HOST_BT_DEVICES)
+		return -1;
+	dev = &host_bt.devices[host_bt.count++];
+	memcpy(dev->addr, addr, sizeof(bt_addr_t));
+	dev->cb = cb;
+	dev->context = context;
+	return host_bt.count;
+}
+
+int bt_service_get_uuid(uint32_t id, bt_uuid128_t *u128, uint16_t *u16)
+{
+	if (host_bt_char_dev(id) < 0)
+		return -1;
+	if (u128)
+		memcpy(*u128, host_bt.svc_uuid, BT_UUID128_LEN);
+	if (u16)
+		*u16 = 0;
+	return 0;
+}
+
+int bt_characteristic_get_uuid(uint32_t id, bt_uuid128_t *u128, uint16_t *u16)
+{
+	if (host_bt_char_dev(id) < 0)
+		return -1;
+	if (u128)
+		memcpy(*u128, host_bt_char(id)->uuid, BT_UUID128_LEN);
+	if (u16)
+		*u16 = 0;
+	return 0;
+}
+
+int bt_characteristic_read(uint32_t char_id)
+{
+	if (host_bt_char_dev(char_id) < 0)
+		return -1;
+	host_bt.stats.reads++;
+	return 0;
+}
+
+int bt_characteristic_write(uint32_t char_id, uint8_t *data, uint16_t data_len)
+{
+	int idx = host_bt_char_dev(char_id);
+
+	if (idx < 0 || !host_bt_dev(idx)->connected)
+		return -1;
+	host_bt.stats.writes++;
+	host_bt.last_write_len = MIN(data_len, HOST_BT_WRITE_MAX);
+	memcpy(host_bt.last_write, data, host_bt.last_write_len);
+	return 0;
+}
+
+int bt_characteristic_notify(uint32_t char_id, bool enable)
+{
+	int idx = host_bt_char_dev(char_id);
+
+	if (idx < 0 || !host_bt_dev(idx)->connected)
+		return -1;
+	host_bt_dev(idx)->notify = enable;
+	if (enable)
+		host_bt.stats.notify_on++;
+	else
+		host_bt.stats.notify_off++;
+	return 0;
+}
+
+int bt_device_disconnect(int device_idx)
+{
+	if (!host_bt_dev(device_idx))
+		return -1;
+	host_bt.stats.disconnects++;
+	host_bt_disconnect(device_idx);
+	return 0;
+}
+
+/* All devices are disconnected, as when the controller is powered off */
+int bt_stack_reset(void)
+{
+	int i;
+
+	host_bt.stats.resets++;
+	for (i = 1; i <= host_bt.count; i++)
+		host_bt_disconnect(i);
+	return 0;
+}
+
+/* Same as the BTstack one, CRC-8 of RFCOMM (ETSI TS 07.10) */
+uint8_t btstack_crc8_calc(uint8_t *data, uint16_t len)
+{
+	uint8_t crc = 0xFF;
+	int i;
+
+	while (len--) {
+		crc ^= *data++;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 0x01) ? (crc >> 1) ^ 0xE0 : crc >> 1;
+	}
+	return 0xFF - crc;
+}
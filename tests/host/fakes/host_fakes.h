@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Controls of the host fakes of the SDK, used by the tests */
+
+#ifndef _HOST_FAKES_H_
+#define _HOST_FAKES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "lwip/err.h"
+#include "hardware/pio.h"
+#include "bt/bt_api.h"
+
+/* Simulated time, does not move unless advanced or slept */
+void host_time_set_us(uint64_t us);
+void host_time_advance_us(uint64_t us);
+void host_time_advance_ms(uint32_t ms);
+uint32_t host_time_wfe_count(void);
+void host_time_set_epoch(time_t epoch);
+
+/* GPIO pins, the inputs are driven by the tests */
+void host_gpio_set(uint32_t gpio, bool value);
+bool host_gpio_out(uint32_t gpio);
+uint32_t host_gpio_put_count(uint32_t gpio);
+
+/* PIO state machines, the tests act as the device on the other side */
+typedef void (*host_pio_hook_t)(PIO pio, uint sm, const pio_sm_config *cfg, bool enabled);
+
+void host_pio_hook_set(host_pio_hook_t hook);
+void host_pio_tx_word_us(uint32_t us);
+int host_pio_tx_words(PIO pio, uint sm, uint32_t *words, int max);
+void host_pio_rx_push(PIO pio, uint sm, uint32_t word, uint64_t at_us);
+
+/* ADC, the value of each conversion is given by the test */
+typedef uint16_t (*host_adc_source_t)(uint input, uint64_t conversion);
+
+void host_adc_source_set(host_adc_source_t source);
+
+/* MQTT broker, records the published messages */
+typedef struct {
+	char *topic;
+	char *payload;
+	uint64_t time_ms;
+} host_mqtt_msg_t;
+
+void host_mqtt_reset(void);
+int host_mqtt_published_count(void);
+host_mqtt_msg_t *host_mqtt_published(int idx);
+host_mqtt_msg_t *host_mqtt_last(const char *topic);
+int host_mqtt_subscribed_count(void);
+void host_mqtt_publish_err_set(err_t err);
+void host_mqtt_incoming(const char *topic, const char *payload);
+
+/* UDP, records the sent datagrams */
+void host_udp_reset(void);
+int host_udp_sent_count(void);
+char *host_udp_sent(int idx);
+int host_udp_pcb_count(void);
+void host_udp_send_err_set(err_t err);
+void host_pbuf_alloc_fail(bool fail);
+
+/* In-memory file system */
+void host_fs_format(void);
+void host_fs_power_cut(void);
+uint32_t host_fs_read_calls(void);
+uint32_t host_fs_write_calls(void);
+
+/* Bluetooth devices, connected and notifying on request of the tests */
+#define HOST_BT_WRITE_MAX	32
+struct host_bt_stats_t {
+	uint32_t connects;
+	uint32_t disconnects;
+	uint32_t resets;
+	uint32_t writes;
+	uint32_t reads;
+	uint32_t notify_on;
+	uint32_t notify_off;
+};
+
+void host_bt_uuid_set(const bt_uuid128_t svc, const bt_uuid128_t charc);
+int host_bt_char_add(const bt_uuid128_t uuid, uint32_t properties);
+void *host_bt_context(int idx);
+void host_bt_connect(int idx, const char *name);
+void host_bt_disconnect(int idx);
+bool host_bt_connected(int idx);
+bool host_bt_notify_enabled(int idx);
+void host_bt_notify(int idx, const uint8_t *data, int len);
+void host_bt_notify_char(int idx, int c, uint8_t *data, int len);
+struct host_bt_stats_t *host_bt_stats(void);
+int host_bt_last_write(uint8_t *data, int max);
+
+/* System reboots, requested by the code */
+uint32_t host_sys_reboot_count(void);
+
+#endif /* _HOST_FAKES_H_ */
@@ -0,0 +1,470 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * In-memory pico-littlefs. As in littlefs, the changes of an opened file
+ * are committed on close, a power cut drops them.
+ */
+
+#include "pico/stdlib.h"
+#include "pico_hal.h"
+
+#include "host_fakes.h"
+
+#define HOST_FS_BLOCK	4096
+#define HOST_FS_NODES	256
+#define HOST_FS_FILES	16
+
+struct host_fs_node_t {
+	bool used;
+	bool dir;
+	char path[LFS_NAME_MAX + 1];
+	char *data;
+	int size;
+};
+
+struct host_fs_file_t {
+	bool used;
+	bool dir;
+	int node;
+	int flags;
+	int pos;
+	char *data;
+	int size;
+};
+
+static struct {
+	bool mounted;
+	struct host_fs_node_t nodes[HOST_FS_NODES];
+	struct host_fs_file_t files[HOST_FS_FILES];
+	uint32_t read_calls;
+	uint32_t write_calls;
+} host_fs;
+
+/* Paths are kept without the leading and trailing slashes, the root is "" */
+static void host_fs_path(const char *path, char *out)
+{
+	int len;
+
+	while (*path == '/')
+		path++;
+	snprintf(out, LFS_NAME_MAX + 1, "%s", path);
+	len = strlen(out);
+	while (len > 0 && out[len - 1] == '/')
+		out[--len] = 0;
+}
+
+static int host_fs_find(const char *path)
+{
+	int i;
+
+	for (i = 0; i < HOST_FS_NODES; i++) {
+		if (host_fs.nodes[i].used && !strcmp(host_fs.nodes[i].path, path))
+			return i;
+	}
+	return -1;
+}
+
+static bool host_fs_parent_exists(const char *path)
+{
+	char parent[LFS_NAME_MAX + 1];
+	char *sep;
+	int n;
+
+	strcpy(parent, path);
+	sep = strrchr(parent, '/');
+	if (!sep)
+		return true;
+	*sep = 0;
+	n = host_fs_find(parent);
+	return n >= 0 && host_fs.nodes[n].dir;
+}
+
+/* Is the node a direct child of the dir */
+static bool host_fs_child(const char *dir, const char *path)
+{
+	int len = strlen(dir);
+
+	if (!len)
+		return !strchr(path, '/');
+	if (strncmp(dir, path, len) || path[len] != '/')
+		return false;
+	return !strchr(path + len + 1, '/');
+}
+
+static int host_fs_node_add(const char *path, bool dir)
+{
+	int i;
+
+	for (i = 0; i < HOST_FS_NODES; i++) {
+		if (host_fs.nodes[i].used)
+			continue;
+		memset(&host_fs.nodes[i], 0, sizeof(host_fs.nodes[i]));
+		host_fs.nodes[i].used = true;
+		host_fs.nodes[i].dir = dir;
+		strcpy(host_fs.nodes[i].path, path);
+		return i;
+	}
+	return LFS_ERR_NOSPC;
+}
+
+static int host_fs_file_get(void)
+{
+	int i;
+
+	for (i = 0; i < HOST_FS_FILES; i++) {
+		if (!host_fs.files[i].used) {
+			memset(&host_fs.files[i], 0, sizeof(host_fs.files[i]));
+			host_fs.files[i].used = true;
+			return i;
+		}
+	}
+	return LFS_ERR_NOMEM;
+}
+
+static struct host_fs_file_t *host_fs_file(int file, bool dir)
+{
+	if (file < 0 || file >= HOST_FS_FILES || !host_fs.files[file].used ||
+	    host_fs.files[file].dir != dir)
+		return NULL;
+	return &host_fs.files[file];
+}
+
+void host_fs_format(void)
+{
+	int i;
+
+	for (i = 0; i < HOST_FS_FILES; i++) {
+		free(host_fs.files[i].data);
+		host_fs.files[i].data = NULL;
+		host_fs.files[i].used = false;
+	}
+	for (i = 0; i < HOST_FS_NODES; i++) {
+		free(host_fs.nodes[i].data);
+		host_fs.nodes[i].data = NULL;
+		host_fs.nodes[i].used = false;
+	}
+}
+
+/* Drop the opened files, without committing the changes */
+void host_fs_power_cut(void)
+{
+	int i;
+
+	for (i = 0; i < HOST_FS_FILES; i++) {
+		free(host_fs.files[i].data);
+		host_fs.files[i].data = NULL;
+		host_fs.files[i].used = false;
+	}
+	host_fs.mounted = false;
+}
+
+uint32_t host_fs_read_calls(void)
+{
+	return host_fs.read_calls;
+}
+
+uint32_t host_fs_write_calls(void)
+{
+	return host_fs.write_calls;
+}
+
+int pico_mount(bool format)
+{
+	if (format)
+		host_fs_format();
+	host_fs.mounted = true;
+	return LFS_ERR_OK;
+}
+
+int pico_unmount(void)
+{
+	host_fs.mounted = false;
+	return LFS_ERR_OK;
+}
+
+int pico_remove(const char *path)
+{
+	char p[LFS_NAME_MAX + 1];
+	int n, i;
+
+	host_fs_path(path, p);
+	n = host_fs_find(p);
+	if (n < 0)
+		return LFS_ERR_NOENT;
+	if (host_fs.nodes[n].dir) {
+		for (i = 0; i < HOST_FS_NODES; i++) {
+			if (host_fs.nodes[i].used && host_fs_child(p, host_fs.nodes[i].path))
+				return LFS_ERR_NOTEMPTY;
+		}
+	}
+	free(host_fs.nodes[n].data);
+	host_fs.nodes[n].data = NULL;
+	host_fs.nodes[n].used = false;
+	return LFS_ERR_OK;
+}
+
+int pico_rename(const char *oldpath, const char *newpath)
+{
+	char op[LFS_NAME_MAX + 1], np[LFS_NAME_MAX + 1];
+	int n, old;
+
+	host_fs_path(oldpath, op);
+	host_fs_path(newpath, np);
+	n = host_fs_find(op);
+	if (n < 0)
+		return LFS_ERR_NOENT;
+	if (!host_fs_parent_exists(np))
+		return LFS_ERR_NOENT;
+	old = host_fs_find(np);
+	if (old == n)
+		return LFS_ERR_OK;
+	if (old >= 0) {
+		if (host_fs.nodes[old].dir != host_fs.nodes[n].dir)
+			return host_fs.nodes[old].dir ? LFS_ERR_ISDIR : LFS_ERR_NOTDIR;
+		if (pico_remove(newpath) < 0)
+			return LFS_ERR_NOTEMPTY;
+	}
+	strcpy(host_fs.nodes[n].path, np);
+	return LFS_ERR_OK;
+}
+
+int pico_open(const char *path, int flags)
+{
+	struct host_fs_file_t *f;
+	char p[LFS_NAME_MAX + 1];
+	int n, fd;
+
+	host_fs_path(path, p);
+	n = host_fs_find(p);
+	if (n >= 0 && host_fs.nodes[n].dir)
+		return LFS_ERR_ISDIR;
+	if (n >= 0 && (flags & LFS_O_CREAT) && (flags & LFS_O_EXCL))
+		return LFS_ERR_EXIST;
+	if (n < 0) {
+		if (!(flags & LFS_O_CREAT))
+			return LFS_ERR_NOENT;
+		if (!host_fs_parent_exists(p))
+			return LFS_ERR_NOENT;
+		n = host_fs_node_add(p, false);
+		if (n < 0)
+			return n;
+	}
+	fd = host_fs_file_get();
+	if (fd < 0)
+		return fd;
+	f = &host_fs.files[fd];
+	f->node = n;
+	f->flags = flags;
+	if (!(flags & LFS_O_TRUNC) && host_fs.nodes[n].size) {
+		f->data = malloc(host_fs.nodes[n].size);
+		memcpy(f->data, host_fs.nodes[n].data, host_fs.nodes[n].size);
+		f->size = host_fs.nodes[n].size;
+	}
+	return fd;
+}
+
+int pico_close(int file)
+{
+	struct host_fs_file_t *f = host_fs_file(file, false);
+	struct host_fs_node_t *node;
+
+	if (!f)
+		return LFS_ERR_BADF;
+	node = &host_fs.nodes[f->node];
+	if ((f->flags & LFS_O_WRONLY) && node->used) {
+		free(node->data);
+		node->data = f->data;
+		node->size = f->size;
+		f->data = NULL;
+	}
+	free(f->data);
+	f->data = NULL;
+	f->used = false;
+	return LFS_ERR_OK;
+}
+
+lfs_size_t pico_write(int file, const void *buffer, lfs_size_t size)
+{
+	struct host_fs_file_t *f = host_fs_file(file, false);
+	char *data;
+
+	host_fs.write_calls++;
+	if (!f || !(f->flags & LFS_O_WRONLY))
+		return (lfs_size_t)LFS_ERR_BADF;
+	if (f->flags & LFS_O_APPEND)
+		f->pos = f->size;
+	if (f->pos + (int)size > FS_SIZE)
+		return (lfs_size_t)LFS_ERR_NOSPC;
+	if (f->pos + (int)size > f->size) {
+		data = realloc(f->data, f->pos + size);
+		if (!data)
+			return (lfs_size_t)LFS_ERR_NOMEM;
+		memset(data + f->size, 0, f->pos + size - f->size);
+		f->data = data;
+		f->size = f->pos + size;
+	}
+	memcpy(f->data + f->pos, buffer, size);
+	f->pos += size;
+	return size;
+}
+
+lfs_size_t pico_read(int file, void *buffer, lfs_size_t size)
+{
+	struct host_fs_file_t *f = host_fs_file(file, false);
+	int len;
+
+	host_fs.read_calls++;
+	if (!f || !(f->flags & LFS_O_RDONLY))
+		return (lfs_size_t)LFS_ERR_BADF;
+	len = f->size - f->pos;
+	if (len > (int)size)
+		len = size;
+	if (len <= 0)
+		return 0;
+	memcpy(buffer, f->data + f->pos, len);
+	f->pos += len;
+	return len;
+}
+
+lfs_soff_t pico_lseek(int file, lfs_soff_t off, int pos)
+{
+	struct host_fs_file_t *f = host_fs_file(file, false);
+	int npos;
+
+	if (!f)
+		return LFS_ERR_BADF;
+	switch (pos) {
+	case LFS_SEEK_SET:
+		npos = off;
+		break;
+	case LFS_SEEK_CUR:
+		npos = f->pos + off;
+		break;
+	case LFS_SEEK_END:
+		npos = f->size + off;
+		break;
+	default:
+		return LFS_ERR_INVAL;
+	}
+	if (npos < 0)
+		return LFS_ERR_INVAL;
+	f->pos = npos;
+	return npos;
+}
+
+lfs_soff_t pico_tell(int file)
+{
+	struct host_fs_file_t *f = host_fs_file(file, false);
+
+	if (!f)
+		return LFS_ERR_BADF;
+	return f->pos;
+}
+
+lfs_soff_t pico_size(int file)
+{
+	struct host_fs_file_t *f = host_fs_file(file, false);
+
+	if (!f)
+		return LFS_ERR_BADF;
+	return f->size;
+}
+
+int pico_fsstat(struct pico_fsstat_t *stat)
+{
+	int i;
+
+	stat->block_size = HOST_FS_BLOCK;
+	stat->block_count = FS_SIZE / HOST_FS_BLOCK;
+	/* The superblock pair */
+	stat->blocks_used = 2;
+	for (i = 0; i < HOST_FS_NODES; i++) {
+		if (!host_fs.nodes[i].used)
+			continue;
+		stat->blocks_used += (host_fs.nodes[i].size + HOST_FS_BLOCK - 1) / HOST_FS_BLOCK;
+		if (host_fs.nodes[i].dir)
+			stat->blocks_used += 2;
+	}
+	return LFS_ERR_OK;
+}
+
+int pico_mkdir(const char *path)
+{
+	char p[LFS_NAME_MAX + 1];
+	int n;
+
+	host_fs_path(path, p);
+	if (!p[0] || host_fs_find(p) >= 0)
+		return LFS_ERR_EXIST;
+	if (!host_fs_parent_exists(p))
+		return LFS_ERR_NOENT;
+	n = host_fs_node_add(p, true);
+	return n < 0 ? n : LFS_ERR_OK;
+}
+
+int pico_dir_open(const char *path)
+{
+	char p[LFS_NAME_MAX + 1];
+	int n, fd;
+
+	host_fs_path(path, p);
+	n = -1;
+	if (p[0]) {
+		n = host_fs_find(p);
+		if (n < 0)
+			return LFS_ERR_NOENT;
+		if (!host_fs.nodes[n].dir)
+			return LFS_ERR_NOTDIR;
+	}
+	fd = host_fs_file_get();
+	if (fd < 0)
+		return fd;
+	host_fs.files[fd].dir = true;
+	host_fs.files[fd].node = n;
+	return fd;
+}
+
+int pico_dir_close(int dir)
+{
+	struct host_fs_file_t *f = host_fs_file(dir, true);
+
+	if (!f)
+		return LFS_ERR_BADF;
+	f->used = false;
+	return LFS_ERR_OK;
+}
+
+/* As littlefs, list "." and ".." first. Returns 1 on entry, 0 at the end */
+int pico_dir_read(int dir, struct lfs_info *info)
+{
+	struct host_fs_file_t *f = host_fs_file(dir, true);
+	const char *dpath, *name;
+	int i;
+
+	if (!f)
+		return LFS_ERR_BADF;
+	memset(info, 0, sizeof(*info));
+	if (f->pos < 2) {
+		info->type = LFS_TYPE_DIR;
+		strcpy(info->name, f->pos ? ".." : ".");
+		f->pos++;
+		return 1;
+	}
+	dpath = f->node < 0 ? "" : host_fs.nodes[f->node].path;
+	for (i = f->pos - 2; i < HOST_FS_NODES; i++) {
+		if (!host_fs.nodes[i].used || !host_fs_child(dpath, host_fs.nodes[i].path))
+			continue;
+		name = strrchr(host_fs.nodes[i].path, '/');
+		name = name ? name + 1 : host_fs.nodes[i].path;
+		strcpy(info->name, name);
+		info->type = host_fs.nodes[i].dir ? LFS_TYPE_DIR : LFS_TYPE_REG;
+		info->size = host_fs.nodes[i].size;
+		f->pos = i + 3;
+		return 1;
+	}
+	f->pos = HOST_FS_NODES + 2;
+	return 0;
+}
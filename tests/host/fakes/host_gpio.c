@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Simulated GPIO pins, the inputs are driven by the tests */
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+#include "host_fakes.h"
+
+static struct {
+	struct {
+		bool init;
+		bool out;
+		bool value;
+		bool pull_up;
+		enum gpio_function func;
+		uint32_t irq_mask;
+		uint32_t puts;
+	} pins[NUM_BANK0_GPIOS];
+	gpio_irq_callback_t irq_callback;
+} host_gpio;
+
+static bool pin_valid(uint gpio)
+{
+	return gpio < NUM_BANK0_GPIOS;
+}
+
+void gpio_init(uint gpio)
+{
+	if (!pin_valid(gpio))
+		return;
+	host_gpio.pins[gpio].init = true;
+	host_gpio.pins[gpio].out = false;
+	host_gpio.pins[gpio].value = false;
+	host_gpio.pins[gpio].func = GPIO_FUNC_SIO;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+	if (pin_valid(gpio))
+		host_gpio.pins[gpio].out = out;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+	if (pin_valid(gpio))
+		host_gpio.pins[gpio].func = fn;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+	if (!pin_valid(gpio))
+		return;
+	host_gpio.pins[gpio].puts++;
+	if (host_gpio.pins[gpio].out)
+		host_gpio.pins[gpio].value = value;
+}
+
+bool gpio_get(uint gpio)
+{
+	if (!pin_valid(gpio))
+		return false;
+	return host_gpio.pins[gpio].value;
+}
+
+void gpio_pull_up(uint gpio)
+{
+	if (!pin_valid(gpio))
+		return;
+	host_gpio.pins[gpio].pull_up = true;
+	if (!host_gpio.pins[gpio].out)
+		host_gpio.pins[gpio].value = true;
+}
+
+void gpio_pull_down(uint gpio)
+{
+	if (!pin_valid(gpio))
+		return;
+	host_gpio.pins[gpio].pull_up = false;
+	if (!host_gpio.pins[gpio].out)
+		host_gpio.pins[gpio].value = false;
+}
+
+void gpio_disable_pulls(uint gpio)
+{
+	if (pin_valid(gpio))
+		host_gpio.pins[gpio].pull_up = false;
+}
+
+/* As in the SDK, there is one callback for all pins */
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+										gpio_irq_callback_t callback)
+{
+	if (!pin_valid(gpio))
+		return;
+	if (enabled)
+		host_gpio.pins[gpio].irq_mask |= event_mask;
+	else
+		host_gpio.pins[gpio].irq_mask &= ~event_mask;
+	host_gpio.irq_callback = callback;
+}
+
+/* Drive an input pin, the enabled edge interrupt is called at once */
+void host_gpio_set(uint32_t gpio, bool value)
+{
+	uint32_t event;
+
+	if (!pin_valid(gpio) || host_gpio.pins[gpio].out)
+		return;
+	if (host_gpio.pins[gpio].value == value)
+		return;
+	host_gpio.pins[gpio].value = value;
+	event = value ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+	if (host_gpio.irq_callback && (host_gpio.pins[gpio].irq_mask & event))
+		host_gpio.irq_callback(gpio, event);
+}
+
+/* Last value, set by the code on an output pin */
+bool host_gpio_out(uint32_t gpio)
+{
+	if (!pin_valid(gpio) || !host_gpio.pins[gpio].out)
+		return false;
+	return host_gpio.pins[gpio].value;
+}
+
+uint32_t host_gpio_put_count(uint32_t gpio)
+{
+	if (!pin_valid(gpio))
+		return 0;
+	return host_gpio.pins[gpio].puts;
+}
@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Fake lwIP MQTT client and DNS, the broker accepts and records everything */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "lwip/dns.h"
+#include "lwip/apps/mqtt.h"
+#include "lwjson/lwjson.h"
+
+#include "host_fakes.h"
+
+struct mqtt_client_s {
+	bool connected;
+	mqtt_incoming_publish_cb_t pub_cb;
+	mqtt_incoming_data_cb_t data_cb;
+	void *inpub_arg;
+};
+
+static struct {
+	mqtt_client_t *client;
+	host_mqtt_msg_t *msgs;
+	int count;
+	int size;
+	int subscribed;
+	err_t publish_err;
+} host_mqtt;
+
+void host_mqtt_reset(void)
+{
+	int i;
+
+	for (i = 0; i < host_mqtt.count; i++) {
+		free(host_mqtt.msgs[i].topic);
+		free(host_mqtt.msgs[i].payload);
+	}
+	host_mqtt.count = 0;
+}
+
+int host_mqtt_published_count(void)
+{
+	return host_mqtt.count;
+}
+
+host_mqtt_msg_t *host_mqtt_published(int idx)
+{
+	if (idx < 0 || idx >= host_mqtt.count)
+		return NULL;
+	return &host_mqtt.msgs[idx];
+}
+
+host_mqtt_msg_t *host_mqtt_last(const char *topic)
+{
+	int i;
+
+	for (i = host_mqtt.count - 1; i >= 0; i--) {
+		if (!strcmp(host_mqtt.msgs[i].topic, topic))
+			return &host_mqtt.msgs[i];
+	}
+	return NULL;
+}
+
+int host_mqtt_subscribed_count(void)
+{
+	return host_mqtt.subscribed;
+}
+
+void host_mqtt_publish_err_set(err_t err)
+{
+	host_mqtt.publish_err = err;
+}
+
+mqtt_client_t *mqtt_client_new(void)
+{
+	return calloc(1, sizeof(mqtt_client_t));
+}
+
+void mqtt_client_free(mqtt_client_t *client)
+{
+	free(client);
+}
+
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *ipaddr, u16_t port,
+						  mqtt_connection_cb_t cb, void *arg,
+						  const struct mqtt_connect_client_info_t *client_info)
+{
+	(void)ipaddr;
+	(void)port;
+	(void)client_info;
+
+	client->connected = true;
+	host_mqtt.client = client;
+	if (cb)
+		cb(client, arg, MQTT_CONNECT_ACCEPTED);
+	return ERR_OK;
+}
+
+void mqtt_disconnect(mqtt_client_t *client)
+{
+	client->connected = false;
+}
+
+u8_t mqtt_client_is_connected(mqtt_client_t *client)
+{
+	return client->connected;
+}
+
+void mqtt_set_inpub_callback(mqtt_client_t *client, mqtt_incoming_publish_cb_t pub_cb,
+							 mqtt_incoming_data_cb_t data_cb, void *arg)
+{
+	client->pub_cb = pub_cb;
+	client->data_cb = data_cb;
+	client->inpub_arg = arg;
+}
+
+err_t mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos,
+					 mqtt_request_cb_t cb, void *arg, u8_t sub)
+{
+	(void)topic;
+	(void)qos;
+
+	if (!client->connected)
+		return ERR_CONN;
+	if (sub)
+		host_mqtt.subscribed++;
+	if (cb)
+		cb(arg, ERR_OK);
+	return ERR_OK;
+}
+
+err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length,
+				   u8_t qos, u8_t retain, mqtt_request_cb_t cb, void *arg)
+{
+	host_mqtt_msg_t *msg;
+
+	(void)qos;
+	(void)retain;
+
+	if (!client->connected)
+		return ERR_CONN;
+	if (host_mqtt.publish_err != ERR_OK)
+		return host_mqtt.publish_err;
+	if (host_mqtt.count >= host_mqtt.size) {
+		msg = realloc(host_mqtt.msgs, (host_mqtt.size + 64) * sizeof(host_mqtt_msg_t));
+		if (!msg)
+			return ERR_MEM;
+		host_mqtt.msgs = msg;
+		host_mqtt.size += 64;
+	}
+	msg = &host_mqtt.msgs[host_mqtt.count++];
+	msg->topic = strdup(topic);
+	msg->payload = strndup(payload, payload_length);
+	msg->time_ms = to_ms_since_boot(get_absolute_time());
+	if (cb)
+		cb(arg, ERR_OK);
+	return ERR_OK;
+}
+
+/* Deliver a message from the broker, to the last connected client */
+void host_mqtt_incoming(const char *topic, const char *payload)
+{
+	mqtt_client_t *client = host_mqtt.client;
+	int len = strlen(payload);
+
+	if (!client || !client->pub_cb || !client->data_cb)
+		return;
+	client->pub_cb(client->inpub_arg, topic, len);
+	client->data_cb(client->inpub_arg, (const u8_t *)payload, len, MQTT_DATA_FLAG_LAST);
+}
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr,
+						dns_found_callback found, void *callback_arg)
+{
+	(void)hostname;
+	(void)found;
+	(void)callback_arg;
+
+	addr->addr = 0x0100007F;
+	return ERR_OK;
+}
+
+char *ipaddr_ntoa(const ip_addr_t *addr)
+{
+	static char buf[16];
+
+	snprintf(buf, sizeof(buf), "%u.%u.%u.%u",
+			 addr->addr & 0xFF, (addr->addr >> 8) & 0xFF,
+			 (addr->addr >> 16) & 0xFF, (addr->addr >> 24) & 0xFF);
+	return buf;
+}
+
+/* The JSON parser is not built on the host */
+lwjsonr_t lwjson_init(lwjson_t *lwobj, lwjson_token_t *tokens, size_t tokens_len)
+{
+	memset(lwobj, 0, sizeof(*lwobj));
+	lwobj->tokens = tokens;
+	lwobj->tokens_len = tokens_len;
+	return lwjsonOK;
+}
+
+lwjsonr_t lwjson_parse_ex(lwjson_t *lwobj, const void *json_data, size_t len)
+{
+	(void)lwobj;
+	(void)json_data;
+	(void)len;
+
+	return lwjsonERR;
+}
+
+lwjsonr_t lwjson_free(lwjson_t *lwobj)
+{
+	(void)lwobj;
+
+	return lwjsonOK;
+}
+
+const lwjson_token_t *lwjson_find(lwjson_t *lwobj, const char *path)
+{
+	(void)lwobj;
+	(void)path;
+
+	return NULL;
+}
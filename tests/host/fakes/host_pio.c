@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * PIO state machines. The programs are not executed, the tests act as the
+ * device on the other side: they read the words sent by the TX FIFO and push
+ * the reply in the RX FIFO, at given time.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+#include "host_fakes.h"
+
+#define PIO_INSTRUCTIONS	32
+#define PIO_FIFO_SIZE		4
+
+pio_hw_t host_pio_hw[2];
+
+struct host_pio_sm_t {
+	pio_sm_config cfg;
+	bool enabled;
+	uint64_t enabled_us;
+	uint32_t tx[PIO_FIFO_SIZE];
+	int tx_count;
+	uint32_t rx[PIO_FIFO_SIZE];
+	uint64_t rx_at[PIO_FIFO_SIZE];
+	int rx_count;
+};
+
+static struct {
+	struct host_pio_sm_t sm[2][NUM_PIO_STATE_MACHINES];
+	host_pio_hook_t hook;
+	uint32_t tx_word_us;
+} host_pio;
+
+static struct host_pio_sm_t *pio_sm_get_state(PIO pio, uint sm)
+{
+	if (sm >= NUM_PIO_STATE_MACHINES)
+		return NULL;
+	if (pio == pio0)
+		return &host_pio.sm[0][sm];
+	if (pio == pio1)
+		return &host_pio.sm[1][sm];
+	return NULL;
+}
+
+void host_pio_hook_set(host_pio_hook_t hook)
+{
+	host_pio.hook = hook;
+}
+
+void host_pio_tx_word_us(uint32_t us)
+{
+	host_pio.tx_word_us = us;
+}
+
+int host_pio_tx_words(PIO pio, uint sm, uint32_t *words, int max)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+	int i;
+
+	if (!st)
+		return 0;
+	for (i = 0; i < st->tx_count && i < max; i++)
+		words[i] = st->tx[i];
+	return i;
+}
+
+void host_pio_rx_push(PIO pio, uint sm, uint32_t word, uint64_t at_us)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+
+	if (!st || st->rx_count >= PIO_FIFO_SIZE)
+		return;
+	st->rx[st->rx_count] = word;
+	st->rx_at[st->rx_count] = at_us;
+	st->rx_count++;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program)
+{
+	return pio->used + program->length <= PIO_INSTRUCTIONS;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+	uint offset = pio->used;
+
+	pio->used += program->length;
+	return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset)
+{
+	if (loaded_offset + program->length == pio->used)
+		pio->used = loaded_offset;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+	uint sm;
+
+	(void)required;
+
+	for (sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+		if (!(pio->claimed & (1 << sm))) {
+			pio->claimed |= (1 << sm);
+			return sm;
+		}
+	}
+	return -1;
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+
+	(void)initial_pc;
+
+	if (!st)
+		return -1;
+	memset(st, 0, sizeof(*st));
+	if (config)
+		st->cfg = *config;
+	return 0;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+
+	if (!st || st->enabled == enabled)
+		return;
+	st->enabled = enabled;
+	if (enabled)
+		st->enabled_us = time_us_64();
+	if (host_pio.hook)
+		host_pio.hook(pio, sm, &st->cfg, enabled);
+}
+
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values)
+{
+	(void)pio;
+	(void)sm;
+	(void)pin_values;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+	(void)pio;
+	(void)sm;
+	(void)pin_base;
+	(void)pin_count;
+	(void)is_out;
+}
+
+/* There is no one to pull the data on the host, a full FIFO drops it */
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+
+	if (!st || st->tx_count >= PIO_FIFO_SIZE)
+		return;
+	st->tx[st->tx_count++] = data;
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+	uint32_t data;
+
+	if (!pio_sm_get_rx_fifo_level(pio, sm))
+		return 0;
+	data = st->rx[0];
+	memmove(st->rx, st->rx + 1, (st->rx_count - 1) * sizeof(st->rx[0]));
+	memmove(st->rx_at, st->rx_at + 1, (st->rx_count - 1) * sizeof(st->rx_at[0]));
+	st->rx_count--;
+	return data;
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+	uint64_t now = time_us_64();
+	uint level = 0;
+
+	if (!st)
+		return 0;
+	while ((int)level < st->rx_count && st->rx_at[level] <= now)
+		level++;
+	return level;
+}
+
+/* The first word is pulled when the state machine is enabled, the next ones every tx_word_us */
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+	uint64_t pulled;
+
+	if (!st)
+		return 0;
+	if (!st->enabled)
+		return st->tx_count;
+	if (!host_pio.tx_word_us)
+		return 0;
+	pulled = 1 + (time_us_64() - st->enabled_us) / host_pio.tx_word_us;
+	return pulled >= (uint64_t)st->tx_count ? 0 : st->tx_count - pulled;
+}
+
+void pio_sm_drain_tx_fifo(PIO pio, uint sm)
+{
+	struct host_pio_sm_t *st = pio_sm_get_state(pio, sm);
+
+	if (st)
+		st->tx_count = 0;
+}
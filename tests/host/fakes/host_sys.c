@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Fakes of the system services, which are not built on the host */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/flash.h"
+
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "fs_internal.h"
+#include "params.h"
+
+#include "host_fakes.h"
+
+cyw43_t cyw43_state;
+
+static uint32_t host_sys_reboots;
+
+/* Used by get_total_heap(), there is no linker script on the host */
+char __StackLimit, __bss_end__;
+
+void wd_update(void)
+{
+}
+
+wifi_state_t wifi_get_state(void)
+{
+	return WIFI_CONNECTED;
+}
+
+int sys_state_callback_add(log_status_cb_t cb, void *user_context)
+{
+	UNUSED(cb);
+	UNUSED(user_context);
+
+	return 0;
+}
+
+void sys_state_log_version(void)
+{
+}
+
+void sys_state_log_status(void)
+{
+}
+
+/* From system.c, which needs the whole SDK */
+char *system_get_hostname(void)
+{
+	static char *host_name;
+
+	if (!host_name)
+		host_name = USER_PRAM_GET(DEV_HOSTNAME);
+	return host_name ? host_name : "pico";
+}
+
+/* The reboot is only counted, the test goes on */
+void system_force_reboot(int delay_ms)
+{
+	UNUSED(delay_ms);
+
+	host_sys_reboots++;
+}
+
+uint32_t host_sys_reboot_count(void)
+{
+	return host_sys_reboots;
+}
+
+/* There is no second core on the host */
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+	UNUSED(enter_exit_timeout_ms);
+
+	func(param);
+	return PICO_OK;
+}
+
+/* The web server is not built on the host */
+int webserv_client_close(int client_idx)
+{
+	UNUSED(client_idx);
+
+	return 0;
+}
+
+/* TFTP is not supported on the host */
+int tftp_url_parse(char *url, struct tftp_file_t *file)
+{
+	UNUSED(url);
+	UNUSED(file);
+
+	return -1;
+}
+
+int tftp_file_get(const struct tftp_context *hooks, struct tftp_file_t *file, void *user_context)
+{
+	UNUSED(hooks);
+	UNUSED(file);
+	UNUSED(user_context);
+
+	return -1;
+}
+
+int tftp_file_put(const struct tftp_context *hooks, struct tftp_file_t *file, void *user_context)
+{
+	UNUSED(hooks);
+	UNUSED(file);
+	UNUSED(user_context);
+
+	return -1;
+}
+
+const struct tftp_context *fs_tftp_hooks_get(void)
+{
+	return NULL;
+}
+
+/* No webhook endpoint on the host, the notifications are not sent */
+bool webhook_connected(void)
+{
+	return false;
+}
+
+int webhook_send(char *message)
+{
+	UNUSED(message);
+
+	return -1;
+}
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "pico/aon_timer.h"
+#include "herak_sys.h"
+
+#include "host_fakes.h"
+
+static struct {
+	uint64_t now_us;
+	uint32_t wfe_count;
+	bool event;
+	bool epoch_set;
+	time_t epoch;
+} host_time;
+
+void host_time_set_epoch(time_t epoch)
+{
+	host_time.epoch = epoch - (time_t)(host_time.now_us / 1000000);
+	host_time.epoch_set = true;
+}
+
+void host_time_set_us(uint64_t us)
+{
+	host_time.now_us = us;
+}
+
+void host_time_advance_us(uint64_t us)
+{
+	host_time.now_us += us;
+}
+
+void host_time_advance_ms(uint32_t ms)
+{
+	host_time.now_us += (uint64_t)ms * 1000;
+}
+
+uint32_t host_time_wfe_count(void)
+{
+	return host_time.wfe_count;
+}
+
+absolute_time_t get_absolute_time(void)
+{
+	return host_time.now_us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms)
+{
+	return host_time.now_us + (uint64_t)ms * 1000;
+}
+
+uint32_t time_us_32(void)
+{
+	return (uint32_t)host_time.now_us;
+}
+
+uint64_t time_us_64(void)
+{
+	return host_time.now_us;
+}
+
+/* UTC calendar time, valid after host_time_set_epoch() */
+bool aon_timer_get_time_calendar(struct tm *tm)
+{
+	time_t now;
+
+	if (!host_time.epoch_set)
+		return false;
+	now = host_time.epoch + (time_t)(host_time.now_us / 1000000);
+	gmtime_r(&now, tm);
+	return true;
+}
+
+/* From the NTP service, the time is valid once the epoch is set */
+bool ntp_time_valid(void)
+{
+	return host_time.epoch_set;
+}
+
+void sleep_us(uint64_t us)
+{
+	host_time_advance_us(us);
+}
+
+void sleep_ms(uint32_t ms)
+{
+	host_time_advance_ms(ms);
+}
+
+void busy_wait_us(uint64_t us)
+{
+	host_time_advance_us(us);
+}
+
+void busy_wait_ms(uint32_t ms)
+{
+	host_time_advance_ms(ms);
+}
+
+/* Sleep until the timeout, or return at once if there is a pending event */
+bool best_effort_wfe_or_timeout(absolute_time_t timeout)
+{
+	host_time.wfe_count++;
+	if (host_time.event) {
+		host_time.event = false;
+		return false;
+	}
+	if (timeout > host_time.now_us)
+		host_time.now_us = timeout;
+	return true;
+}
+
+void __sev(void)
+{
+	host_time.event = true;
+}
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Fake lwIP UDP and packet buffers, the sent datagrams are recorded */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "lwip/udp.h"
+
+#include "host_fakes.h"
+
+static struct {
+	char **msgs;
+	int count;
+	int size;
+	int pcbs;
+	err_t send_err;
+	bool alloc_fail;
+} host_udp;
+
+void host_udp_reset(void)
+{
+	int i;
+
+	for (i = 0; i < host_udp.count; i++)
+		free(host_udp.msgs[i]);
+	host_udp.count = 0;
+}
+
+int host_udp_sent_count(void)
+{
+	return host_udp.count;
+}
+
+char *host_udp_sent(int idx)
+{
+	if (idx < 0 || idx >= host_udp.count)
+		return NULL;
+	return host_udp.msgs[idx];
+}
+
+int host_udp_pcb_count(void)
+{
+	return host_udp.pcbs;
+}
+
+void host_udp_send_err_set(err_t err)
+{
+	host_udp.send_err = err;
+}
+
+void host_pbuf_alloc_fail(bool fail)
+{
+	host_udp.alloc_fail = fail;
+}
+
+struct udp_pcb *udp_new_ip_type(u8_t type)
+{
+	struct udp_pcb *pcb = calloc(1, sizeof(struct udp_pcb));
+
+	if (pcb) {
+		pcb->type = type;
+		host_udp.pcbs++;
+	}
+	return pcb;
+}
+
+void udp_remove(struct udp_pcb *pcb)
+{
+	if (!pcb)
+		return;
+	host_udp.pcbs--;
+	free(pcb);
+}
+
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port)
+{
+	char **msgs;
+
+	if (!pcb || !p || !dst_ip || !dst_port)
+		return ERR_ARG;
+	if (host_udp.send_err != ERR_OK)
+		return host_udp.send_err;
+	if (host_udp.count >= host_udp.size) {
+		msgs = realloc(host_udp.msgs, (host_udp.size + 64) * sizeof(char *));
+		if (!msgs)
+			return ERR_MEM;
+		host_udp.msgs = msgs;
+		host_udp.size += 64;
+	}
+	host_udp.msgs[host_udp.count++] = strndup(p->payload, p->len);
+	return ERR_OK;
+}
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type)
+{
+	struct pbuf *p;
+
+	(void)layer;
+	(void)type;
+
+	if (host_udp.alloc_fail)
+		return NULL;
+	p = calloc(1, sizeof(struct pbuf) + length);
+	if (!p)
+		return NULL;
+	p->payload = p + 1;
+	p->len = length;
+	p->tot_len = length;
+	return p;
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+	free(p);
+	return 1;
+}
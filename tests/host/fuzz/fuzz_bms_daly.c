@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Fuzzing of the Daly BMS responses decoder. The input is a value of the
+ * read characteristic of the serial terminal. The first byte of the input:
+ *   bit 0: fix the CRC of the response, to reach the decoder of the command.
+ */
+
+#include "pico/stdlib.h"
+#include <btstack_util.h>
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "solar.h"
+
+#include "host_fakes.h"
+
+#define BMS_IDX		1
+#define FUZZ_FIX_CRC	0x01
+#define RESPONSE_LEN	13
+#define RESPONSE_CRC	12
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static const bt_uuid128_t serial_svc = {0x00, 0x00, 0xff, 0xf0, 0x00, 0x00, 0x10, 0x00,
+					0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb};
+static const bt_uuid128_t serial_read = {0x00, 0x00, 0xff, 0xf1, 0x00, 0x00, 0x10, 0x00,
+					 0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb};
+static const bt_uuid128_t serial_write = {0x00, 0x00, 0xff, 0xf2, 0x00, 0x00, 0x10, 0x00,
+					  0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb};
+
+/* The MQTT of the solar app is not built, the decoded data is dropped */
+void mqtt_data_bms(mqtt_bms_data_t *data)
+{
+	UNUSED(data);
+}
+
+static void fuzz_init(void)
+{
+	static bool init;
+
+	if (init)
+		return;
+	init = true;
+	host_time_set_us(1000000);
+	host_bt_uuid_set(serial_svc, serial_read);
+	host_bt_char_add(serial_write, ATT_PROPERTY_WRITE_WITHOUT_RESPONSE);
+	sys_modules_init();
+	if (!bms_solar_init())
+		abort();
+	host_bt_connect(BMS_IDX, "DL-fuzz");
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	uint8_t *buf;
+	size_t len;
+
+	fuzz_init();
+	if (size < 2)
+		return 0;
+	len = size - 1;
+
+	/* A copy of the exact size, the reads out of it are caught. The decoder modifies it */
+	buf = malloc(len);
+	if (!buf)
+		return 0;
+	memcpy(buf, data + 1, len);
+	if ((data[0] & FUZZ_FIX_CRC) && len >= RESPONSE_LEN) {
+		buf[RESPONSE_CRC] = 0;
+		buf[RESPONSE_CRC] = btstack_crc8_calc(buf, RESPONSE_LEN);
+	}
+
+	host_bt_notify_char(BMS_IDX, 0, buf, len);
+
+	free(buf);
+	return 0;
+}
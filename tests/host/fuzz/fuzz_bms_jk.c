@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Fuzzing of the JK BMS frame assembly and decoder. The input is sent as
+ * GATT notifications of the terminal characteristic and processed by a
+ * pass of the main loop. The first byte of the input:
+ *   bits 0-6: size of the notifications, 0 for the whole input at once.
+ *   bit 7: fix the CRC of each 300 bytes block, to reach the decoder.
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "bms_jk.h"
+
+#include "host_fakes.h"
+
+#define BMS_IDX		1
+#define FUZZ_CHUNK_MASK	0x7F
+#define FUZZ_FIX_CRC	0x80
+
+extern void bms_jk_register(void);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static const bt_uuid128_t term_svc = {0x00, 0x00, 0xFF, 0xE0, 0x00, 0x00, 0x10, 0x00,
+				      0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+static const bt_uuid128_t term_charc = {0x00, 0x00, 0xFF, 0xE1, 0x00, 0x00, 0x10, 0x00,
+					0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+
+static void fuzz_init(void)
+{
+	static bool init;
+
+	if (init)
+		return;
+	init = true;
+	host_time_set_us(1000000);
+	host_bt_uuid_set(term_svc, term_charc);
+	bms_jk_register();
+	sys_modules_init();
+	host_bt_connect(BMS_IDX, "JK-fuzz");
+	/* Subscribe for notifications */
+	sys_modules_run();
+}
+
+static void fuzz_fix_crc(uint8_t *buf, size_t size)
+{
+	size_t ofs, i;
+	uint8_t crc;
+
+	for (ofs = 0; ofs + NOTIFY_PACKET_SIZE <= size; ofs += NOTIFY_PACKET_SIZE) {
+		crc = 0;
+		for (i = 0; i < NOTIFY_PACKET_SIZE - 1; i++)
+			crc += buf[ofs + i];
+		buf[ofs + NOTIFY_PACKET_SIZE - 1] = crc;
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	size_t ofs, chunk, len;
+	uint8_t *buf;
+
+	fuzz_init();
+	if (size < 2)
+		return 0;
+	chunk = data[0] & FUZZ_CHUNK_MASK;
+	len = size - 1;
+	if (!chunk)
+		chunk = len;
+
+	/* A copy of the exact size, the reads out of it are caught */
+	buf = malloc(len);
+	if (!buf)
+		return 0;
+	memcpy(buf, data + 1, len);
+	if (data[0] & FUZZ_FIX_CRC)
+		fuzz_fix_crc(buf, len);
+
+	for (ofs = 0; ofs < len; ofs += chunk)
+		host_bt_notify(BMS_IDX, buf + ofs, MIN(chunk, len - ofs));
+	sys_modules_run();
+
+	free(buf);
+	return 0;
+}
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Driver of the fuzz harnesses, when libFuzzer is not available. Runs the
+ * seed inputs, then random mutations of them. Takes a subset of the libFuzzer
+ * arguments:
+ *   fuzz_<name> [-runs=<count>] [-seed=<number>] <seed file or dir> ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define FUZZ_SEEDS_MAX	64
+#define FUZZ_INPUT_MAX	4096
+#define FUZZ_MUTATIONS	4
+
+#ifndef MIN
+#define MIN(a, b)	((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)	((a) > (b) ? (a) : (b))
+#endif
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+struct fuzz_input_t {
+	uint8_t *data;
+	size_t size;
+};
+
+static struct {
+	int count;
+	struct fuzz_input_t seeds[FUZZ_SEEDS_MAX];
+	uint64_t rand;
+} fuzz;
+
+/* xorshift64, the runs are repeatable with the same seed */
+static uint32_t fuzz_rand(uint32_t max)
+{
+	fuzz.rand ^= fuzz.rand << 13;
+	fuzz.rand ^= fuzz.rand >> 7;
+	fuzz.rand ^= fuzz.rand << 17;
+	return max ? (uint32_t)(fuzz.rand % max) : 0;
+}
+
+static int fuzz_seed_load(const char *path)
+{
+	struct fuzz_input_t *in;
+	FILE *f;
+	long size;
+
+	if (fuzz.count >= FUZZ_SEEDS_MAX)
+		return -1;
+	f = fopen(path, "rb");
+	if (!f)
+		return -1;
+	in = &fuzz.seeds[fuzz.count];
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size <= 0 || size > FUZZ_INPUT_MAX)
+		goto out;
+	in->data = malloc(size);
+	if (!in->data)
+		goto out;
+	in->size = fread(in->data, 1, size, f);
+	fuzz.count++;
+out:
+	fclose(f);
+	return 0;
+}
+
+static int fuzz_seeds_load(const char *path)
+{
+	char file[512];
+	struct dirent *de;
+	struct stat st;
+	DIR *dir;
+
+	if (stat(path, &st))
+		return -1;
+	if (!S_ISDIR(st.st_mode))
+		return fuzz_seed_load(path);
+	dir = opendir(path);
+	if (!dir)
+		return -1;
+	while ((de = readdir(dir))) {
+		if (de->d_name[0] == '.')
+			continue;
+		snprintf(file, sizeof(file), "%s/%s", path, de->d_name);
+		fuzz_seed_load(file);
+	}
+	closedir(dir);
+	return 0;
+}
+
+/* Mutate the input in place, returns its new size */
+static size_t fuzz_mutate(uint8_t *buf, size_t size)
+{
+	struct fuzz_input_t *other;
+	size_t ofs, len;
+	int i, count;
+
+	count = 1 + fuzz_rand(FUZZ_MUTATIONS);
+	for (i = 0; i < count && size; i++) {
+		ofs = fuzz_rand(size);
+		switch (fuzz_rand(7)) {
+		case 0: /* Flip a bit */
+			buf[ofs] ^= 1 << fuzz_rand(8);
+			break;
+		case 1: /* Random byte */
+			buf[ofs] = fuzz_rand(256);
+			break;
+		case 2: /* Interesting byte */
+			buf[ofs] = (const uint8_t []){0x00, 0x01, 0x7F, 0x80, 0xFF}[fuzz_rand(5)];
+			break;
+		case 3: /* Truncate */
+			size = ofs + 1;
+			break;
+		case 4: /* Erase a range */
+			len = fuzz_rand(size - ofs);
+			memmove(buf + ofs, buf + ofs + len, size - ofs - len);
+			size -= len;
+			break;
+		case 5: /* Duplicate a range */
+			len = fuzz_rand(MIN(size - ofs, FUZZ_INPUT_MAX - size) + 1);
+			memmove(buf + ofs + len, buf + ofs, size - ofs);
+			size += len;
+			break;
+		case 6: /* Splice with the tail of another seed */
+			other = &fuzz.seeds[fuzz_rand(fuzz.count)];
+			len = fuzz_rand(other->size) + 1;
+			len = MIN(len, FUZZ_INPUT_MAX - ofs);
+			memcpy(buf + ofs, other->data + other->size - len, len);
+			size = MAX(size, ofs + len);
+			break;
+		}
+	}
+	return size;
+}
+
+/* Each input in a buffer of its exact size, the reads out of it are caught */
+static void fuzz_run(const uint8_t *data, size_t size)
+{
+	uint8_t *buf = malloc(size ? size : 1);
+
+	if (!buf)
+		return;
+	memcpy(buf, data, size);
+	LLVMFuzzerTestOneInput(buf, size);
+	free(buf);
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t input[FUZZ_INPUT_MAX];
+	struct fuzz_input_t *seed;
+	long runs = 0, i;
+	size_t size;
+
+	fuzz.rand = 1;
+	for (i = 1; i < argc; i++) {
+		if (!strncmp(argv[i], "-runs=", 6))
+			runs = strtol(argv[i] + 6, NULL, 0);
+		else if (!strncmp(argv[i], "-seed=", 6))
+			fuzz.rand = strtoull(argv[i] + 6, NULL, 0) | 1;
+		else if (argv[i][0] != '-' && fuzz_seeds_load(argv[i]))
+			fprintf(stderr, "Failed to load seeds from %s\n", argv[i]);
+	}
+	if (!fuzz.count) {
+		fprintf(stderr, "No seeds\n");
+		return 1;
+	}
+
+	for (i = 0; i < fuzz.count; i++)
+		fuzz_run(fuzz.seeds[i].data, fuzz.seeds[i].size);
+	for (i = 0; i < runs; i++) {
+		seed = &fuzz.seeds[fuzz_rand(fuzz.count)];
+		memcpy(input, seed->data, seed->size);
+		size = fuzz_mutate(input, seed->size);
+		fuzz_run(input, size);
+	}
+	printf("Done %d seeds and %ld mutated inputs\n", fuzz.count, runs);
+
+	return 0;
+}
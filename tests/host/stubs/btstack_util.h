@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_BTSTACK_UTIL_H_
+#define _HOST_BTSTACK_UTIL_H_
+
+#include <stdint.h>
+
+/* BTstack is not built on the host, the devices use the bt_api and these helpers */
+#define ATT_PROPERTY_BROADCAST			0x01
+#define ATT_PROPERTY_READ			0x02
+#define ATT_PROPERTY_WRITE_WITHOUT_RESPONSE	0x04
+#define ATT_PROPERTY_WRITE			0x08
+#define ATT_PROPERTY_NOTIFY			0x10
+#define ATT_PROPERTY_INDICATE			0x20
+
+uint8_t btstack_crc8_calc(uint8_t *data, uint16_t len);
+
+#endif /* _HOST_BTSTACK_UTIL_H_ */
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Host stub of the pico-sdk ADC, the conversions are simulated in fakes/host_adc.c */
+
+#ifndef _HOST_HARDWARE_ADC_H_
+#define _HOST_HARDWARE_ADC_H_
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_ADC_CHANNELS	5
+#define ADC_CS_READY_BITS	0x00000100
+
+typedef struct {
+	volatile uint32_t cs;
+	volatile uint32_t result;
+	volatile uint32_t fcs;
+	volatile uint32_t fifo;
+	volatile uint32_t div;
+} adc_hw_t;
+
+extern adc_hw_t host_adc_hw;
+#define adc_hw	(&host_adc_hw)
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_round_robin(uint input_mask);
+void adc_set_clkdiv(float clkdiv);
+void adc_run(bool run);
+void adc_irq_set_enabled(bool enabled);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_fifo_drain(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_HARDWARE_ADC_H_ */
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_HARDWARE_CLOCKS_H_
+#define _HOST_HARDWARE_CLOCKS_H_
+
+#include "pico/types.h"
+
+#define HOST_CLK_SYS_HZ	125000000
+
+enum clock_index {
+	clk_gpout0 = 0,
+	clk_ref = 4,
+	clk_sys = 5,
+	clk_peri = 6,
+};
+
+static inline uint32_t clock_get_hz(enum clock_index clk_index)
+{
+	(void)clk_index;
+	return HOST_CLK_SYS_HZ;
+}
+
+#endif /* _HOST_HARDWARE_CLOCKS_H_ */
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Host stub of the pico-sdk DMA. Only the transfers from the ADC FIFO are
+ * simulated, in fakes/host_adc.c. The addresses are kept by the fake, the
+ * registers of a channel hold only the transfer count.
+ */
+
+#ifndef _HOST_HARDWARE_DMA_H_
+#define _HOST_HARDWARE_DMA_H_
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_DMA_CHANNELS	12
+#define DREQ_ADC			36
+#define DREQ_FORCE			63
+
+enum dma_channel_transfer_size {
+	DMA_SIZE_8 = 0,
+	DMA_SIZE_16 = 1,
+	DMA_SIZE_32 = 2
+};
+
+typedef struct {
+	enum dma_channel_transfer_size size;
+	bool read_increment;
+	bool write_increment;
+	uint dreq;
+	bool ring_write;
+	uint ring_bits;
+	uint chain_to;
+} dma_channel_config;
+
+typedef struct {
+	volatile uint32_t read_addr;
+	volatile uint32_t write_addr;
+	volatile uint32_t transfer_count;
+	volatile uint32_t ctrl_trig;
+	volatile uint32_t al1_ctrl;
+	volatile uint32_t al1_read_addr;
+	volatile uint32_t al1_write_addr;
+	volatile uint32_t al1_transfer_count_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+	dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+} dma_hw_t;
+
+extern dma_hw_t host_dma_hw;
+#define dma_hw	(&host_dma_hw)
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c,
+							 enum dma_channel_transfer_size size)
+{
+	c->size = size;
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+	c->read_increment = incr;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+	c->write_increment = incr;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+	c->dreq = dreq;
+}
+
+static inline void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+	c->ring_write = write;
+	c->ring_bits = size_bits;
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+	c->chain_to = chain_to;
+}
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+			   const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_abort(uint channel);
+/* Not inline, the fake runs the transfers due when the registers are read */
+dma_channel_hw_t *dma_channel_hw_addr(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_HARDWARE_DMA_H_ */
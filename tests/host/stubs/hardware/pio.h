@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Host stub of the pico-sdk PIO, the state machines are simulated in fakes/host_pio.c */
+
+#ifndef _HOST_HARDWARE_PIO_H_
+#define _HOST_HARDWARE_PIO_H_
+
+#include "pico/types.h"
+#include "hardware/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_PIO_STATE_MACHINES	4
+
+/* Instruction memory and state machines in use */
+typedef struct pio_hw {
+	uint used;
+	uint claimed;
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_hw[2];
+#define pio0	(&host_pio_hw[0])
+#define pio1	(&host_pio_hw[1])
+
+typedef struct pio_program {
+	const uint16_t *instructions;
+	uint8_t length;
+	int8_t origin;
+} pio_program_t;
+
+typedef struct {
+	float clkdiv;
+	uint out_base;
+	uint set_base;
+	uint in_base;
+	uint jmp_pin;
+	bool out_shift_right;
+	bool in_shift_right;
+	uint wrap_target;
+	uint wrap;
+} pio_sm_config;
+
+static inline pio_sm_config pio_get_default_sm_config(void)
+{
+	pio_sm_config c = { .clkdiv = 1.0f };
+
+	return c;
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div)
+{
+	c->clkdiv = div;
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count)
+{
+	(void)out_count;
+	c->out_base = out_base;
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count)
+{
+	(void)set_count;
+	c->set_base = set_base;
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint in_base)
+{
+	c->in_base = in_base;
+}
+
+static inline void sm_config_set_jmp_pin(pio_sm_config *c, uint pin)
+{
+	c->jmp_pin = pin;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap)
+{
+	c->wrap_target = wrap_target;
+	c->wrap = wrap;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+	(void)autopull;
+	(void)pull_threshold;
+	c->out_shift_right = shift_right;
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+	(void)autopush;
+	(void)push_threshold;
+	c->in_shift_right = shift_right;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+void pio_sm_drain_tx_fifo(PIO pio, uint sm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_HARDWARE_PIO_H_ */
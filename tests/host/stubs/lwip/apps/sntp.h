@@ -0,0 +1,11 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_LWIP_SNTP_H_
+#define _HOST_LWIP_SNTP_H_
+
+/* The SNTP client is not part of the host build */
+
+#endif /* _HOST_LWIP_SNTP_H_ */
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_LWIP_TFTP_CLIENT_H_
+#define _HOST_LWIP_TFTP_CLIENT_H_
+
+#include "lwip/arch.h"
+#include "lwip/pbuf.h"
+
+struct tftp_context {
+	void *(*open)(const char *fname, const char *mode, u8_t write);
+	void (*close)(void *handle);
+	int (*read)(void *handle, void *buf, int bytes);
+	int (*write)(void *handle, struct pbuf *p);
+	void (*error)(void *handle, int err, const char *msg, int size);
+};
+
+#endif /* _HOST_LWIP_TFTP_CLIENT_H_ */
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_LWIP_INET_H_
+#define _HOST_LWIP_INET_H_
+
+#include "lwip/ip_addr.h"
+
+#define inet_ntoa(addr)	ipaddr_ntoa(&(addr))
+
+#endif /* _HOST_LWIP_INET_H_ */
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_LWIP_IP_ADDR_H_
+#define _HOST_LWIP_IP_ADDR_H_
+
+#include "lwip/arch.h"
+
+typedef struct ip4_addr {
+	u32_t addr;
+} ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+
+char *ipaddr_ntoa(const ip_addr_t *addr);
+
+#endif /* _HOST_LWIP_IP_ADDR_H_ */
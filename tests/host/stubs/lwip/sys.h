@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_LWIP_SYS_H_
+#define _HOST_LWIP_SYS_H_
+
+#include "lwip/arch.h"
+#include "lwip/err.h"
+
+typedef int sys_prot_t;
+
+/* Single threaded host build, nothing to protect */
+#define SYS_ARCH_DECL_PROTECT(lev)	sys_prot_t lev = 0
+#define SYS_ARCH_PROTECT(lev)		(void)(lev)
+#define SYS_ARCH_UNPROTECT(lev)		(void)(lev)
+
+#endif /* _HOST_LWIP_SYS_H_ */
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Host stub of the lwjson API. The parser is not built on the host,
+ * lwjson_parse_ex() always fails and the listeners get a NULL lwjson.
+ */
+
+#ifndef _HOST_LWJSON_H_
+#define _HOST_LWJSON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+	lwjsonOK = 0,
+	lwjsonERR,
+	lwjsonERRJSON,
+	lwjsonERRMEM,
+	lwjsonERRPAR
+} lwjsonr_t;
+
+typedef enum {
+	LWJSON_TYPE_STRING = 0,
+	LWJSON_TYPE_NUM_INT,
+	LWJSON_TYPE_NUM_REAL,
+	LWJSON_TYPE_OBJECT,
+	LWJSON_TYPE_ARRAY,
+	LWJSON_TYPE_TRUE,
+	LWJSON_TYPE_FALSE,
+	LWJSON_TYPE_NULL
+} lwjson_type_t;
+
+typedef struct lwjson_token {
+	struct lwjson_token *next;
+	lwjson_type_t type;
+	const char *token_name;
+	size_t token_name_len;
+	union {
+		struct {
+			const char *token_value;
+			size_t token_value_len;
+		} str;
+		double num_real;
+		long long num_int;
+		struct lwjson_token *first_child;
+	} u;
+} lwjson_token_t;
+
+typedef struct {
+	lwjson_token_t *tokens;
+	size_t tokens_len;
+	size_t next_free_token_pos;
+	lwjson_token_t first_token;
+} lwjson_t;
+
+#define LWJSON_ARRAYSIZE(x)	(sizeof(x) / sizeof((x)[0]))
+
+lwjsonr_t lwjson_init(lwjson_t *lwobj, lwjson_token_t *tokens, size_t tokens_len);
+lwjsonr_t lwjson_parse_ex(lwjson_t *lwobj, const void *json_data, size_t len);
+lwjsonr_t lwjson_free(lwjson_t *lwobj);
+const lwjson_token_t *lwjson_find(lwjson_t *lwobj, const char *path);
+
+#endif /* _HOST_LWJSON_H_ */
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Host stub of the header, generated by pioasm from opentherm_dev.pio in the firmware build.
+ * Only the interface is needed, the state machines are simulated by the tests.
+ */
+
+#ifndef _HOST_OPENTHERM_DEV_PIO_H_
+#define _HOST_OPENTHERM_DEV_PIO_H_
+
+#include "hardware/pio.h"
+
+#define opentherm_tx_wrap_target 0
+#define opentherm_tx_wrap 17
+
+static const uint16_t opentherm_tx_program_instructions[18];
+
+static const struct pio_program opentherm_tx_program = {
+	.instructions = opentherm_tx_program_instructions,
+	.length = 18,
+	.origin = -1,
+};
+
+static inline pio_sm_config opentherm_tx_program_get_default_config(uint offset)
+{
+	pio_sm_config c = pio_get_default_sm_config();
+
+	sm_config_set_wrap(&c, offset + opentherm_tx_wrap_target, offset + opentherm_tx_wrap);
+	return c;
+}
+
+#define opentherm_rx_wrap_target 0
+#define opentherm_rx_wrap 15
+
+static const uint16_t opentherm_rx_program_instructions[16];
+
+static const struct pio_program opentherm_rx_program = {
+	.instructions = opentherm_rx_program_instructions,
+	.length = 16,
+	.origin = -1,
+};
+
+static inline pio_sm_config opentherm_rx_program_get_default_config(uint offset)
+{
+	pio_sm_config c = pio_get_default_sm_config();
+
+	sm_config_set_wrap(&c, offset + opentherm_rx_wrap_target, offset + opentherm_rx_wrap);
+	return c;
+}
+
+#endif /* _HOST_OPENTHERM_DEV_PIO_H_ */
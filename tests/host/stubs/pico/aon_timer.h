@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_AON_TIMER_H_
+#define _HOST_PICO_AON_TIMER_H_
+
+#include <stdbool.h>
+#include <time.h>
+
+/* The calendar time follows the simulated time, see host_time_set_epoch() */
+bool aon_timer_get_time_calendar(struct tm *tm);
+
+#endif /* _HOST_PICO_AON_TIMER_H_ */
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_CYW43_ARCH_H_
+#define _HOST_PICO_CYW43_ARCH_H_
+
+#include "pico/types.h"
+#include "lwip/ip_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CYW43_WL_GPIO_LED_PIN	0
+
+struct netif {
+	ip_addr_t ip_addr;
+};
+
+typedef struct {
+	struct netif netif[2];
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+static inline void cyw43_arch_lwip_begin(void) {}
+static inline void cyw43_arch_lwip_end(void) {}
+static inline void cyw43_arch_gpio_put(unsigned int pin, bool value)
+{
+	(void)pin;
+	(void)value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_PICO_CYW43_ARCH_H_ */
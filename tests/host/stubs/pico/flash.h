@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_FLASH_H_
+#define _HOST_PICO_FLASH_H_
+
+#include <stdint.h>
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+
+#endif /* _HOST_PICO_FLASH_H_ */
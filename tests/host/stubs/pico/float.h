@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_FLOAT_H_
+#define _HOST_PICO_FLOAT_H_
+
+#include <math.h>
+
+#include "pico/types.h"
+
+#endif /* _HOST_PICO_FLOAT_H_ */
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_MUTEX_H_
+#define _HOST_PICO_MUTEX_H_
+
+/* Single threaded host build, the mutexes are never contended */
+typedef struct {
+	int owned;
+} mutex_t;
+
+static inline void mutex_init(mutex_t *mtx)
+{
+	mtx->owned = 0;
+}
+
+static inline void mutex_enter_blocking(mutex_t *mtx)
+{
+	mtx->owned++;
+}
+
+static inline void mutex_exit(mutex_t *mtx)
+{
+	mtx->owned--;
+}
+
+#endif /* _HOST_PICO_MUTEX_H_ */
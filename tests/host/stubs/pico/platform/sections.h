@@ -0,0 +1,14 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_SECTIONS_H_
+#define _HOST_PICO_SECTIONS_H_
+
+#define __in_flash(...)
+#define __not_in_flash(...)
+#define __not_in_flash_func(f)	f
+#define __time_critical_func(f)	f
+
+#endif /* _HOST_PICO_SECTIONS_H_ */
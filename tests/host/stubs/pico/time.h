@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_PICO_TIME_H_
+#define _HOST_PICO_TIME_H_
+
+/* The time API is declared with the stdlib one */
+#include "pico/stdlib.h"
+
+#endif /* _HOST_PICO_TIME_H_ */
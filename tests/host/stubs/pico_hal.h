@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Host stub of the pico-littlefs API, implemented in RAM in fakes/host_fs.c */
+
+#ifndef _HOST_PICO_HAL_H_
+#define _HOST_PICO_HAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LFS_NAME_MAX	255
+
+typedef uint32_t lfs_size_t;
+typedef uint32_t lfs_off_t;
+typedef int32_t lfs_ssize_t;
+typedef int32_t lfs_soff_t;
+
+enum lfs_error {
+	LFS_ERR_OK		= 0,
+	LFS_ERR_IO		= -5,
+	LFS_ERR_CORRUPT		= -84,
+	LFS_ERR_NOENT		= -2,
+	LFS_ERR_EXIST		= -17,
+	LFS_ERR_NOTDIR		= -20,
+	LFS_ERR_ISDIR		= -21,
+	LFS_ERR_NOTEMPTY	= -39,
+	LFS_ERR_BADF		= -9,
+	LFS_ERR_FBIG		= -27,
+	LFS_ERR_INVAL		= -22,
+	LFS_ERR_NOSPC		= -28,
+	LFS_ERR_NOMEM		= -12,
+	LFS_ERR_NOATTR		= -61,
+	LFS_ERR_NAMETOOLONG	= -36
+};
+
+enum lfs_type {
+	LFS_TYPE_REG	= 0x001,
+	LFS_TYPE_DIR	= 0x002
+};
+
+enum lfs_open_flags {
+	LFS_O_RDONLY	= 1,
+	LFS_O_WRONLY	= 2,
+	LFS_O_RDWR	= 3,
+	LFS_O_CREAT	= 0x0100,
+	LFS_O_EXCL	= 0x0200,
+	LFS_O_TRUNC	= 0x0400,
+	LFS_O_APPEND	= 0x0800
+};
+
+enum lfs_whence_flags {
+	LFS_SEEK_SET	= 0,
+	LFS_SEEK_CUR	= 1,
+	LFS_SEEK_END	= 2
+};
+
+struct lfs_info {
+	uint8_t type;
+	lfs_size_t size;
+	char name[LFS_NAME_MAX + 1];
+};
+
+struct pico_fsstat_t {
+	lfs_size_t block_size;
+	lfs_size_t block_count;
+	lfs_size_t blocks_used;
+};
+
+int pico_mount(bool format);
+int pico_unmount(void);
+int pico_remove(const char *path);
+int pico_rename(const char *oldpath, const char *newpath);
+int pico_open(const char *path, int flags);
+int pico_close(int file);
+lfs_size_t pico_write(int file, const void *buffer, lfs_size_t size);
+lfs_size_t pico_read(int file, void *buffer, lfs_size_t size);
+lfs_soff_t pico_lseek(int file, lfs_soff_t off, int pos);
+lfs_soff_t pico_tell(int file);
+lfs_soff_t pico_size(int file);
+int pico_fsstat(struct pico_fsstat_t *stat);
+int pico_mkdir(const char *path);
+int pico_dir_open(const char *path);
+int pico_dir_close(int dir);
+int pico_dir_read(int dir, struct lfs_info *info);
+
+#endif /* _HOST_PICO_HAL_H_ */
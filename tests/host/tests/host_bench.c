@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/* Micro benchmarks of the hot paths of the common code, on the host CPU */
+
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "lwip/apps/mqtt.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "mqtt_internal.h"
+
+#include "host_fakes.h"
+
+#define BENCH_LOOPS	100000
+#define BENCH_TOPICS	64
+
+typedef void (*bench_func_t)(void *data);
+
+static volatile uint32_t bench_sink;
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_run(const char *name, bench_func_t func, void *data, int loops)
+{
+	uint64_t start;
+	int i;
+
+	start = host_ns();
+	for (i = 0; i < loops; i++)
+		func(data);
+	printf("%-32s %10.1f ns/op\n", name, (double)(host_ns() - start) / loops);
+}
+
+static int samples_cmp(const void *a, const void *b)
+{
+	uint32_t va = *(const uint32_t *)a, vb = *(const uint32_t *)b;
+
+	return va < vb ? -1 : va > vb;
+}
+
+static uint32_t bench_samples[256], bench_samples_work[256];
+
+static void bench_filter_qsort(void *data)
+{
+	int count = (int)(intptr_t)data;
+	uint64_t all = 0;
+	int i;
+
+	memcpy(bench_samples_work, bench_samples, count * sizeof(uint32_t));
+	qsort(bench_samples_work, count, sizeof(uint32_t), samples_cmp);
+	for (i = count / 10; i < count - count / 10; i++)
+		all += bench_samples_work[i];
+	bench_sink += all / (count - 2 * (count / 10));
+}
+
+static void bench_filter(void *data)
+{
+	int count = (int)(intptr_t)data;
+
+	memcpy(bench_samples_work, bench_samples, count * sizeof(uint32_t));
+	bench_sink += samples_filter(bench_samples_work, count, count / 10);
+}
+
+static int bench_cmd_cb(cmd_run_context_t *ctx, char *cmd, char *params, void *user_data)
+{
+	UNUSED(ctx);
+	UNUSED(cmd);
+	UNUSED(params);
+	UNUSED(user_data);
+
+	bench_sink++;
+	return 0;
+}
+
+static void bench_cmd_exec(void *data)
+{
+	cmd_run_context_t ctx = { .type = CMD_CTX_SCRIPT };
+	char cmd[32];
+
+	snprintf(cmd, sizeof(cmd), "%s", (char *)data);
+	cmd_exec(&ctx, cmd);
+}
+
+static void bench_topic_cb(void *context, char *topic, char *data, int size, lwjson_t *lwjson)
+{
+	UNUSED(context);
+	UNUSED(topic);
+	UNUSED(data);
+	UNUSED(lwjson);
+
+	bench_sink += size;
+}
+
+static void bench_topic_dispatch(void *data)
+{
+	struct mqtt_context_t *ctx = mqtt_context_get();
+	char *topic = (char *)data;
+
+	mqtt_incoming_publish(ctx, topic, 2);
+	mqtt_incoming_data(ctx, (const u8_t *)"on", 2, MQTT_DATA_FLAG_LAST);
+	mqtt_incoming_ready(ctx);
+}
+
+static void bench_loop(void *data)
+{
+	UNUSED(data);
+
+	sys_modules_run();
+	host_time_advance_us(100);
+}
+
+static void bench_register(void)
+{
+	static app_command_t cmds[40][10];
+	static char names[40][16], cmd_names[10][16];
+	char topic[MQTT_MAX_TOPIC_SIZE];
+	int i, j;
+
+	for (j = 0; j < 10; j++)
+		snprintf(cmd_names[j], sizeof(cmd_names[j]), "cmd%d", j);
+	for (i = 0; i < 40; i++) {
+		snprintf(names[i], sizeof(names[i]), "mod%d", i);
+		for (j = 0; j < 10; j++) {
+			cmds[i][j].command = cmd_names[j];
+			cmds[i][j].help = "";
+			cmds[i][j].cb = bench_cmd_cb;
+		}
+		cmd_handler_add(names[i], cmds[i], 10, "bench", NULL);
+	}
+	for (i = 0; i < BENCH_TOPICS; i++) {
+		snprintf(topic, sizeof(topic), "host/dev%d/set", i);
+		mqtt_topic_listen(topic, bench_topic_cb, NULL, false);
+	}
+	mqtt_topic_listen("host/+/state", bench_topic_cb, NULL, false);
+	mqtt_topic_listen("host/#", bench_topic_cb, NULL, false);
+}
+
+int main(void)
+{
+	int i;
+
+	host_time_set_us(1000000);
+	sys_modules_init();
+	/* Connect to the fake broker, to get the incoming callbacks */
+	for (i = 0; i < 100 && !mqtt_is_connected(); i++)
+		sys_modules_run();
+	bench_register();
+
+	srand(1);
+	for (i = 0; i < 256; i++)
+		bench_samples[i] = rand();
+
+	bench_run("main loop pass", bench_loop, NULL, BENCH_LOOPS);
+	bench_run("filter 30 samples, qsort", bench_filter_qsort, (void *)30, BENCH_LOOPS);
+	bench_run("filter 30 samples", bench_filter, (void *)30, BENCH_LOOPS);
+	bench_run("filter 256 samples, qsort", bench_filter_qsort, (void *)256, BENCH_LOOPS);
+	bench_run("filter 256 samples", bench_filter, (void *)256, BENCH_LOOPS);
+	bench_run("command, first module", bench_cmd_exec, "mod0?cmd0:1", BENCH_LOOPS);
+	bench_run("command, last module", bench_cmd_exec, "mod39?cmd9:1", BENCH_LOOPS);
+	bench_run("command, unknown", bench_cmd_exec, "mod39?none", BENCH_LOOPS);
+	bench_run("topic, exact match", bench_topic_dispatch, "host/dev63/set", BENCH_LOOPS);
+	bench_run("topic, wildcard match", bench_topic_dispatch, "host/dev1/state", BENCH_LOOPS);
+	bench_run("topic, no match", bench_topic_dispatch, "other/dev1/set", BENCH_LOOPS);
+
+	return bench_sink ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+static int host_test_failed;
+
+#define TEST_ASSERT(C) {\
+		if (!(C)) {\
+			printf("%s:%d: %s: assertion \"%s\" failed\n", __FILE__, __LINE__, __func__, #C);\
+			host_test_failed++;\
+		}\
+	}
+
+#define TEST_ASSERT_STR(A, B) {\
+		const char *__a__ = (A), *__b__ = (B);\
+		if (!__a__ || !__b__ || strcmp(__a__, __b__)) {\
+			printf("%s:%d: %s: \"%s\" != \"%s\"\n", __FILE__, __LINE__, __func__,\
+				   __a__ ? __a__ : "(null)", __b__ ? __b__ : "(null)");\
+			host_test_failed++;\
+		}\
+	}
+
+#define TEST_RUN(F) {\
+		int __failed__ = host_test_failed;\
+		F();\
+		printf("%s %s\n", __failed__ == host_test_failed ? "PASS" : "FAIL", #F);\
+	}
+
+#define TEST_RESULT	(host_test_failed ? 1 : 0)
+
+#endif /* _HOST_TEST_H_ */
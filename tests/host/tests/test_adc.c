@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "dev_lib.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define TEMP_INPUT	4
+/* Each tenth conversion is a spike, filtered out */
+#define SPIKE_EVERY	10
+#define SPIKE_VALUE	4095
+/* 10000 conversions per second, of all inputs */
+#define SAMPLE_US	100
+
+static uint16_t adc_values[5];
+
+static uint16_t adc_source(uint input, uint64_t conversion)
+{
+	if (!(conversion % SPIKE_EVERY))
+		return SPIKE_VALUE;
+	return adc_values[input];
+}
+
+/* Measure, the samples are converted in background and it does not wait for them */
+static bool measure(struct adc_sensor_t *s)
+{
+	uint64_t start = time_us_64();
+	bool ret;
+
+	ret = adc_sensor_measure(s);
+	TEST_ASSERT(time_us_64() == start);
+	return ret;
+}
+
+static struct adc_sensor_t *s0, *s1, *s2;
+
+static void test_window(void)
+{
+	adc_values[0] = 1000;
+	s0 = adc_sensor_init(26, 1.0, 2.0);
+	TEST_ASSERT(s0 != NULL);
+	TEST_ASSERT(adc_sensor_init(20, 0, 1) == NULL);
+
+	/* 30 samples are needed */
+	TEST_ASSERT(!measure(s0));
+	host_time_advance_us(29 * SAMPLE_US);
+	TEST_ASSERT(!measure(s0));
+	host_time_advance_us(2 * SAMPLE_US);
+	TEST_ASSERT(measure(s0));
+	TEST_ASSERT(adc_sensor_get_raw(s0) == 1000);
+	TEST_ASSERT(adc_sensor_get_value(s0) == 2001.0f);
+	/* Not changed */
+	host_time_advance_ms(10);
+	TEST_ASSERT(!measure(s0));
+}
+
+static void test_inputs(void)
+{
+	/* Three inputs, the ring is not a multiple of the round */
+	adc_values[1] = 2000;
+	adc_values[TEMP_INPUT] = 3000;
+	s1 = adc_sensor_init(27, 0, 1);
+	s2 = adc_sensor_init(-1, 0, 1);
+	TEST_ASSERT(s1 && s2);
+
+	/* Restarted with the new inputs */
+	host_time_advance_us(80 * SAMPLE_US);
+	TEST_ASSERT(!measure(s1));
+	host_time_advance_us(11 * SAMPLE_US);
+	TEST_ASSERT(measure(s1));
+	TEST_ASSERT(measure(s2));
+	TEST_ASSERT(adc_sensor_get_raw(s0) == 1000);
+	TEST_ASSERT(adc_sensor_get_raw(s1) == 2000);
+	TEST_ASSERT(adc_sensor_get_raw(s2) == 3000);
+
+	/* The ring wraps many times, the latest samples are read */
+	adc_values[1] = 2500;
+	host_time_advance_ms(1000);
+	TEST_ASSERT(measure(s1));
+	TEST_ASSERT(!measure(s0));
+	TEST_ASSERT(adc_sensor_get_raw(s1) == 2500);
+	TEST_ASSERT(adc_sensor_get_percent(s1) == sys_value_to_percent(0, 4095, 2500));
+}
+
+static void test_free_running(void)
+{
+	int i;
+
+	/* A few runs of the DMA, ~22h each, restarted by the chained channel */
+	for (i = 0; i < 5; i++) {
+		adc_values[0] = 100 + i;
+		adc_values[1] = 200 + i;
+		adc_values[TEMP_INPUT] = 300 + i;
+		host_time_advance_us(13ULL * 3600 * 1000000 + 1234567);
+		TEST_ASSERT(measure(s0));
+		TEST_ASSERT(measure(s1));
+		TEST_ASSERT(measure(s2));
+		TEST_ASSERT(adc_sensor_get_raw(s0) == (uint32_t)(100 + i));
+		TEST_ASSERT(adc_sensor_get_raw(s1) == (uint32_t)(200 + i));
+		TEST_ASSERT(adc_sensor_get_raw(s2) == (uint32_t)(300 + i));
+	}
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	host_adc_source_set(adc_source);
+	sys_modules_init();
+
+	TEST_RUN(test_window);
+	TEST_RUN(test_inputs);
+	TEST_RUN(test_free_running);
+
+	return TEST_RESULT;
+}
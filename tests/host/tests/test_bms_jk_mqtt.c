@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Replay of a simulated day of a JK BMS: the MQTT messages sent, the longest
+ * gap between two messages of the same kind and how long the published pack
+ * voltage and remaining capacity stay behind the values of the battery.
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "bms_jk.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define BMS_IDX		1
+#define FRAME_LEN	NOTIFY_PACKET_SIZE
+/* A pass of the main loop */
+#define PASS_MS		100
+#define MIN_MS		60000
+#define HOUR_MS		(60 * MIN_MS)
+#define DAY_MS		(24 * HOUR_MS)
+#define REFRESH_MS	300000
+/* Steps of the published values */
+#define STEP_PACK_V	100
+#define STEP_CAP	100
+/* MQTT_RATE_PPM is not set, the client holds the messages over the default 12 per minute */
+#define RATE_HOLD_MS	MIN_MS
+
+/* Offsets in the frames */
+#define FRAME_TYPE		4
+#define FRAME_CELLS_V		6
+#define FRAME_CELLS_EN		70
+#define FRAME_V_AVG		74
+#define FRAME_V_DELTA		76
+#define FRAME_POWER_TEMP	144
+#define FRAME_BATT_VOLT		150
+#define FRAME_BATT_POWER	154
+#define FRAME_BATT_CHARGE	158
+#define FRAME_TEMP_1		162
+#define FRAME_BATT_ACTION	172
+#define FRAME_BATT_STATE	173
+#define FRAME_CAP_REMAIN	174
+#define FRAME_CAP_NOMINAL	178
+#define FRAME_CYCLE_CAP		186
+#define FRAME_RUNTIME		194
+#define FRAME_CELLS		16
+#define CAP_NOMINAL_MAH		280000
+
+extern void bms_jk_register(void);
+
+static const bt_uuid128_t term_svc = {0x00, 0x00, 0xFF, 0xE0, 0x00, 0x00, 0x10, 0x00,
+				      0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+static const bt_uuid128_t term_charc = {0x00, 0x00, 0xFF, 0xE1, 0x00, 0x00, 0x10, 0x00,
+					0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+
+/* The simulated battery */
+static struct {
+	int32_t curr_ma;
+	/* Remaining capacity, in mAh * 1000 to not lose the small steps */
+	int64_t cap_uah;
+	uint64_t cycles_uah;
+	uint16_t cells_mv[FRAME_CELLS];
+	uint16_t temp;
+	uint32_t rand;
+} batt;
+
+enum {
+	MSG_CELLS_V = 0,
+	MSG_CELLS_R,
+	MSG_DATA,
+	MSG_INFO,
+	MSG_MAX
+};
+
+static const char * const msg_names[MSG_MAX] = {"cells_v", "cells_r", "data", "info"};
+
+static struct {
+	uint32_t count[MSG_MAX];
+	uint64_t last[MSG_MAX];
+	uint64_t max_gap[MSG_MAX];
+	uint32_t minute_count;
+	uint32_t minute_max;
+	uint64_t minute_start;
+	uint64_t stale_start[2];
+	uint64_t stale_max[2];
+} day;
+
+static struct jk_bms_dev_t *dev;
+static mqtt_component_t *msg_comp[MSG_MAX];
+static uint8_t frame[FRAME_LEN];
+
+static uint32_t batt_rand(uint32_t max)
+{
+	batt.rand = batt.rand * 1103515245 + 12345;
+	return (batt.rand >> 16) % max;
+}
+
+static void put16(uint8_t *buf, int ofs, uint16_t val)
+{
+	buf[ofs] = val & 0xFF;
+	buf[ofs + 1] = val >> 8;
+}
+
+static void put32(uint8_t *buf, int ofs, uint32_t val)
+{
+	put16(buf, ofs, val & 0xFFFF);
+	put16(buf, ofs + 2, val >> 16);
+}
+
+/*
+ * The charge current during the day: a load at night, solar charge with
+ * clouds from 8 to 17 and a bigger load in the evening.
+ */
+static int32_t batt_current(uint64_t now)
+{
+	uint32_t hour = (now % DAY_MS) / HOUR_MS;
+
+	if (hour >= 8 && hour < 17)
+		return 20000 + (int32_t)batt_rand(30000) - 10000;
+	if (hour >= 17 && hour < 23)
+		return -15000 - (int32_t)batt_rand(2000);
+	return -3000 - (int32_t)batt_rand(500);
+}
+
+static void batt_update(uint64_t now, uint32_t ms)
+{
+	uint32_t soc;
+	int i;
+
+	batt.curr_ma = batt_current(now);
+	batt.cap_uah += (int64_t)batt.curr_ma * ms / 3600;
+	if (batt.cap_uah < 0)
+		batt.cap_uah = 0;
+	if (batt.cap_uah > (int64_t)CAP_NOMINAL_MAH * 1000)
+		batt.cap_uah = (int64_t)CAP_NOMINAL_MAH * 1000;
+	if (batt.curr_ma < 0)
+		batt.cycles_uah += (uint64_t)(-batt.curr_ma) * ms / 3600;
+	soc = batt.cap_uah / (CAP_NOMINAL_MAH * 10);
+	/* The cells follow the state of charge, with a few mV of noise */
+	for (i = 0; i < FRAME_CELLS; i++)
+		batt.cells_mv[i] = 3200 + soc * 2 + batt.curr_ma / 2000 + batt_rand(3);
+	batt.temp = 250 + (batt.curr_ma > 0 ? batt.curr_ma / 1000 : 0);
+}
+
+static void frame_answer(uint8_t type)
+{
+	uint32_t volt = 0, cap;
+	uint16_t vmin = UINT16_MAX, vmax = 0;
+	uint8_t crc = 0;
+	int i;
+
+	memset(frame, 0, FRAME_LEN);
+	frame[0] = 0x55;
+	frame[1] = 0xAA;
+	frame[2] = 0xEB;
+	frame[3] = 0x90;
+	frame[FRAME_TYPE] = type;
+	if (type == 0x02) {
+		for (i = 0; i < FRAME_CELLS; i++) {
+			put16(frame, FRAME_CELLS_V + i * 2, batt.cells_mv[i]);
+			volt += batt.cells_mv[i];
+			vmin = MIN(vmin, batt.cells_mv[i]);
+			vmax = MAX(vmax, batt.cells_mv[i]);
+		}
+		cap = batt.cap_uah / 1000;
+		put32(frame, FRAME_CELLS_EN, (1 << FRAME_CELLS) - 1);
+		put16(frame, FRAME_V_AVG, volt / FRAME_CELLS);
+		put16(frame, FRAME_V_DELTA, vmax - vmin);
+		put16(frame, FRAME_POWER_TEMP, batt.temp);
+		put32(frame, FRAME_BATT_VOLT, volt);
+		put32(frame, FRAME_BATT_POWER, (uint32_t)((int64_t)volt * abs(batt.curr_ma) / 1000));
+		put32(frame, FRAME_BATT_CHARGE, (uint32_t)batt.curr_ma);
+		put16(frame, FRAME_TEMP_1, batt.temp);
+		frame[FRAME_BATT_ACTION] = batt.curr_ma > 0 ? 1 : 2;
+		frame[FRAME_BATT_STATE] = cap * 100 / CAP_NOMINAL_MAH;
+		put32(frame, FRAME_CAP_REMAIN, cap);
+		put32(frame, FRAME_CAP_NOMINAL, CAP_NOMINAL_MAH);
+		put32(frame, FRAME_CYCLE_CAP, batt.cycles_uah / 1000);
+		put32(frame, FRAME_RUNTIME, time_ms_since_boot() / 1000);
+	}
+	for (i = 0; i < FRAME_LEN - 1; i++)
+		crc += frame[i];
+	frame[FRAME_LEN - 1] = crc;
+	host_bt_notify(BMS_IDX, frame, FRAME_LEN);
+}
+
+static void device_answer(void)
+{
+	uint8_t req[HOST_BT_WRITE_MAX];
+
+	if (host_bt_last_write(req, sizeof(req)) > 4)
+		frame_answer(req[4] == 0x97 ? 0x03 : 0x02);
+}
+
+/* Value of a key in the JSON payload, scaled by 1000 */
+static int64_t payload_value(const char *payload, const char *key)
+{
+	const char *val = strstr(payload, key);
+
+	if (!val)
+		return -1;
+	return (int64_t)(strtod(val + strlen(key) + 1, NULL) * 1000 + 0.5);
+}
+
+/* How long the published value is behind the value of the device, more than the step */
+static void stale_check(int idx, int64_t published, int64_t value, int64_t step, uint64_t now)
+{
+	if (llabs(published - value) < step) {
+		day.stale_start[idx] = 0;
+		return;
+	}
+	if (!day.stale_start[idx])
+		day.stale_start[idx] = now;
+	if (now - day.stale_start[idx] > day.stale_max[idx])
+		day.stale_max[idx] = now - day.stale_start[idx];
+}
+
+static void messages_check(int from)
+{
+	uint64_t now = time_ms_since_boot();
+	host_mqtt_msg_t *msg, *data;
+	int i, m;
+
+	for (i = from; (msg = host_mqtt_published(i)) != NULL; i++) {
+		for (m = 0; m < MSG_MAX; m++) {
+			if (strcmp(msg->topic, msg_comp[m]->state_topic))
+				continue;
+			day.count[m]++;
+			if (day.last[m] && msg->time_ms - day.last[m] > day.max_gap[m])
+				day.max_gap[m] = msg->time_ms - day.last[m];
+			day.last[m] = msg->time_ms;
+			day.minute_count++;
+		}
+	}
+	if (now - day.minute_start >= MIN_MS) {
+		day.minute_max = MAX(day.minute_max, day.minute_count);
+		day.minute_count = 0;
+		day.minute_start = now;
+	}
+
+	data = host_mqtt_last(msg_comp[MSG_DATA]->state_topic);
+	if (!data || !dev->cell_info.valid)
+		return;
+	stale_check(0, payload_value(data->payload, "\"batt_volt\""), dev->cell_info.batt_volt, STEP_PACK_V, now);
+	stale_check(1, payload_value(data->payload, "\"batt_cap_rem\""), dev->cell_info.batt_cap_rem, STEP_CAP, now);
+}
+
+static void main_loop(uint32_t ms)
+{
+	uint64_t end = time_ms_since_boot() + ms;
+	uint32_t writes;
+	int published;
+
+	while (time_ms_since_boot() < end) {
+		batt_update(time_ms_since_boot(), PASS_MS);
+		writes = host_bt_stats()->writes;
+		published = host_mqtt_published_count();
+		sys_modules_run();
+		if (host_bt_stats()->writes != writes)
+			device_answer();
+		messages_check(published);
+		host_time_advance_ms(PASS_MS);
+	}
+}
+
+static void test_connect(void)
+{
+	dev = host_bt_context(BMS_IDX);
+	TEST_ASSERT(dev != NULL);
+	msg_comp[MSG_CELLS_V] = dev->mqtt.cells_v;
+	msg_comp[MSG_CELLS_R] = dev->mqtt.cells_res;
+	msg_comp[MSG_DATA] = dev->mqtt.bms_data;
+	msg_comp[MSG_INFO] = dev->mqtt.bms_info;
+
+	batt.rand = 1;
+	batt.cap_uah = (int64_t)CAP_NOMINAL_MAH * 500;
+	host_bt_connect(BMS_IDX, "JK-test");
+	main_loop(MIN_MS);
+	TEST_ASSERT(mqtt_is_discovery_sent());
+	TEST_ASSERT(dev->cell_info.valid);
+	memset(&day, 0, sizeof(day));
+}
+
+static void test_day(void)
+{
+	uint32_t total = 0;
+	int m;
+
+	main_loop(DAY_MS);
+	for (m = 0; m < MSG_MAX; m++) {
+		printf("%-8s messages %5d, max gap %3ds\n",
+		       msg_names[m], day.count[m], (int)(day.max_gap[m] / 1000));
+		total += day.count[m];
+		/* Each message is refreshed on its own timer */
+		TEST_ASSERT(day.count[m] >= DAY_MS / REFRESH_MS);
+		TEST_ASSERT(day.max_gap[m] <= REFRESH_MS + RATE_HOLD_MS);
+	}
+	printf("total    messages %5d, per min avg %.1f max %d\n",
+	       total, (double)total * MIN_MS / DAY_MS, day.minute_max);
+	printf("pack voltage behind the battery at most %dms, remaining capacity %dms\n",
+	       (int)day.stale_max[0], (int)day.stale_max[1]);
+
+	/* The pack voltage and the capacity follow the battery, not only on refresh */
+	TEST_ASSERT(day.count[MSG_DATA] > 2 * DAY_MS / REFRESH_MS);
+	TEST_ASSERT(day.stale_max[0] <= RATE_HOLD_MS);
+	TEST_ASSERT(day.stale_max[1] <= RATE_HOLD_MS);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	host_bt_uuid_set(term_svc, term_charc);
+	/* The devices are registered after the MQTT client, as in the firmware */
+	sys_modules_init();
+	bms_jk_register();
+
+	TEST_RUN(test_connect);
+	TEST_RUN(test_day);
+
+	return TEST_RESULT;
+}
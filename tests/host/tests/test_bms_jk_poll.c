@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Replay of a JK BMS answering the requests, with an idle and a changing
+ * battery: the number of requests, the age of the cell info and the delay
+ * before a change of the battery is seen, with the adaptive poll interval.
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "bms_jk.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define BMS_IDX		1
+#define FRAME_LEN	NOTIFY_PACKET_SIZE
+/* A pass of the main loop */
+#define PASS_MS		100
+#define HOUR_MS		(3600 * 1000)
+/* BMS_POLL_SEC from params.txt */
+#define POLL_MIN_MS	4000
+#define POLL_MAX_MS	40000
+/* The requests of a fixed 5s interval, for comparison */
+#define FIXED_POLL_MS	5000
+#define DEV_POLL_MS	300000
+
+/* Offsets in the frames */
+#define FRAME_TYPE		4
+#define FRAME_CELLS_V		6
+#define FRAME_BATT_CHARGE	158
+#define FRAME_CELLS		16
+/* Command in the requests */
+#define REQUEST_CMD		4
+#define CMD_CELL_INFO		0x96
+#define CMD_DEVICE_INFO		0x97
+
+extern void bms_jk_register(void);
+
+static const bt_uuid128_t term_svc = {0x00, 0x00, 0xFF, 0xE0, 0x00, 0x00, 0x10, 0x00,
+				      0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+static const bt_uuid128_t term_charc = {0x00, 0x00, 0xFF, 0xE1, 0x00, 0x00, 0x10, 0x00,
+					0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+
+/* The battery, as the device reports it */
+static struct {
+	int32_t curr_ma;
+	uint16_t cell_mv;
+	/* Change the current on each reply */
+	int32_t swing_ma;
+} batt;
+
+/* What the device got and sent */
+static struct {
+	uint32_t cell_requests;
+	uint32_t dev_requests;
+	uint64_t last_cell;
+	uint64_t max_age;
+} replay;
+
+static struct jk_bms_dev_t *dev;
+static uint8_t frame[FRAME_LEN];
+
+static void put16(uint8_t *buf, int ofs, uint16_t val)
+{
+	buf[ofs] = val & 0xFF;
+	buf[ofs + 1] = val >> 8;
+}
+
+static void put32(uint8_t *buf, int ofs, uint32_t val)
+{
+	put16(buf, ofs, val & 0xFFFF);
+	put16(buf, ofs + 2, val >> 16);
+}
+
+static void frame_answer(uint8_t type)
+{
+	uint8_t crc = 0;
+	int i;
+
+	memset(frame, 0, FRAME_LEN);
+	frame[0] = 0x55;
+	frame[1] = 0xAA;
+	frame[2] = 0xEB;
+	frame[3] = 0x90;
+	frame[FRAME_TYPE] = type;
+	if (type == 0x02) {
+		for (i = 0; i < FRAME_CELLS; i++)
+			put16(frame, FRAME_CELLS_V + i * 2, batt.cell_mv);
+		put32(frame, FRAME_BATT_CHARGE, (uint32_t)batt.curr_ma);
+	}
+	for (i = 0; i < FRAME_LEN - 1; i++)
+		crc += frame[i];
+	frame[FRAME_LEN - 1] = crc;
+	host_bt_notify(BMS_IDX, frame, FRAME_LEN);
+}
+
+/* The device answers each request with the current state of the battery */
+static void device_answer(void)
+{
+	uint8_t req[HOST_BT_WRITE_MAX];
+	uint64_t now = time_ms_since_boot();
+
+	if (host_bt_last_write(req, sizeof(req)) <= REQUEST_CMD)
+		return;
+	if (req[REQUEST_CMD] == CMD_DEVICE_INFO) {
+		replay.dev_requests++;
+		frame_answer(0x03);
+		return;
+	}
+	replay.cell_requests++;
+	if (replay.last_cell && now - replay.last_cell > replay.max_age)
+		replay.max_age = now - replay.last_cell;
+	replay.last_cell = now;
+	batt.curr_ma += batt.swing_ma;
+	batt.swing_ma = -batt.swing_ma;
+	frame_answer(0x02);
+}
+
+static void main_loop(uint32_t ms)
+{
+	uint64_t end = time_ms_since_boot() + ms;
+	uint32_t writes;
+
+	while (time_ms_since_boot() < end) {
+		writes = host_bt_stats()->writes;
+		sys_modules_run();
+		if (host_bt_stats()->writes != writes)
+			device_answer();
+		host_time_advance_ms(PASS_MS);
+	}
+}
+
+/* Run the main loop until the next cell info reply is processed, returns the time it took */
+static uint64_t wait_cell_reply(void)
+{
+	uint64_t start = time_ms_since_boot();
+	uint32_t requests = replay.cell_requests;
+
+	while (replay.cell_requests == requests && time_ms_since_boot() - start <= HOUR_MS)
+		main_loop(PASS_MS);
+	main_loop(PASS_MS);
+	return time_ms_since_boot() - start;
+}
+
+static void replay_reset(void)
+{
+	memset(&replay, 0, sizeof(replay));
+}
+
+static void replay_print(const char *name)
+{
+	printf("%-10s cell info requests/h %4d (fixed %ds: %d), device info %2d, max age %2d.%ds\n",
+	       name, replay.cell_requests, FIXED_POLL_MS / 1000, HOUR_MS / FIXED_POLL_MS,
+	       replay.dev_requests, (int)(replay.max_age / 1000), (int)(replay.max_age % 1000) / 100);
+}
+
+static void test_config(void)
+{
+	dev = host_bt_context(BMS_IDX);
+	TEST_ASSERT(dev != NULL);
+	TEST_ASSERT(dev->poll.min_ms == POLL_MIN_MS);
+	TEST_ASSERT(dev->poll.max_ms == POLL_MAX_MS);
+
+	batt.cell_mv = 3300;
+	host_bt_connect(BMS_IDX, "JK-test");
+	TEST_ASSERT(dev->poll.interval_ms == POLL_MIN_MS);
+}
+
+/* The interval grows up to the max and stays there */
+static void test_idle(void)
+{
+	replay_reset();
+	main_loop(HOUR_MS);
+	replay_print("idle");
+	TEST_ASSERT(dev->poll.interval_ms == POLL_MAX_MS);
+	TEST_ASSERT(replay.cell_requests >= HOUR_MS / POLL_MAX_MS);
+	TEST_ASSERT(replay.cell_requests <= HOUR_MS / POLL_MAX_MS + 10);
+	TEST_ASSERT(replay.max_age <= POLL_MAX_MS + PASS_MS);
+	TEST_ASSERT(replay.dev_requests >= HOUR_MS / DEV_POLL_MS);
+	TEST_ASSERT(replay.dev_requests <= HOUR_MS / DEV_POLL_MS + 1);
+}
+
+/* A change of the battery is seen by the next request, then the interval drops to the min */
+static void test_step(void)
+{
+	batt.curr_ma += 5000;
+	TEST_ASSERT(wait_cell_reply() <= POLL_MAX_MS + 2 * PASS_MS);
+	TEST_ASSERT(dev->cell_info.batt_charge_curr == batt.curr_ma);
+	TEST_ASSERT(dev->poll.interval_ms == POLL_MIN_MS);
+
+	/* A cell voltage change keeps the interval at the min */
+	batt.cell_mv += 10;
+	TEST_ASSERT(wait_cell_reply() <= POLL_MIN_MS + 2 * PASS_MS);
+	TEST_ASSERT(dev->cell_info.cells_v[0] == batt.cell_mv);
+	TEST_ASSERT(dev->poll.interval_ms == POLL_MIN_MS);
+
+	/* Grows again without changes */
+	wait_cell_reply();
+	TEST_ASSERT(dev->poll.interval_ms == POLL_MIN_MS + POLL_MIN_MS / 2);
+}
+
+/* The charge current jumps on each reply, the interval stays at the min */
+static void test_changing(void)
+{
+	replay_reset();
+	batt.swing_ma = 1500;
+	main_loop(HOUR_MS);
+	batt.swing_ma = 0;
+	replay_print("changing");
+	TEST_ASSERT(dev->poll.interval_ms == POLL_MIN_MS);
+	TEST_ASSERT(replay.cell_requests >= HOUR_MS / (POLL_MIN_MS + 2 * PASS_MS));
+	TEST_ASSERT(replay.max_age <= POLL_MIN_MS + PASS_MS);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	host_bt_uuid_set(term_svc, term_charc);
+	bms_jk_register();
+	sys_modules_init();
+
+	TEST_RUN(test_config);
+	TEST_RUN(test_idle);
+	TEST_RUN(test_step);
+	TEST_RUN(test_changing);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Recovery of a JK BMS which stops sending notifications: the steps are taken
+ * in order, each one after the previous did not help, while the other modules
+ * keep running.
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "bms_jk.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define BMS_IDX		1
+#define FRAME_LEN	NOTIFY_PACKET_SIZE
+/* A pass of the main loop */
+#define PASS_MS		100
+/* BMS_TIMEOUT_SEC from params.txt */
+#define TIMEOUT_MS	600000
+#define STEP_MS		60000
+#define MONITOR_MS	1000
+#define STEPS_MAX	8
+
+extern void bms_jk_register(void);
+
+static const bt_uuid128_t term_svc = {0x00, 0x00, 0xFF, 0xE0, 0x00, 0x00, 0x10, 0x00,
+				      0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+static const bt_uuid128_t term_charc = {0x00, 0x00, 0xFF, 0xE1, 0x00, 0x00, 0x10, 0x00,
+					0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+
+/* Another module of the system, it must keep running during the recovery */
+static struct {
+	sys_module_t mod;
+	uint32_t calls;
+} monitor;
+
+/* The recovery steps, as seen on the BT layer */
+static struct {
+	int count;
+	enum jk_recover_t step[STEPS_MAX];
+	uint64_t time[STEPS_MAX];
+} steps;
+
+static struct jk_bms_dev_t *dev;
+static uint8_t frame[FRAME_LEN];
+static uint8_t seq;
+
+static void monitor_run(void *context)
+{
+	UNUSED(context);
+	monitor.calls++;
+}
+
+/* Cell info frame, as the device sends it on request */
+static void frame_answer(void)
+{
+	uint8_t crc = 0;
+	int i;
+
+	memset(frame, 0, FRAME_LEN);
+	frame[0] = 0x55;
+	frame[1] = 0xAA;
+	frame[2] = 0xEB;
+	frame[3] = 0x90;
+	frame[4] = 0x02;
+	frame[5] = seq++;
+	for (i = 0; i < FRAME_LEN - 1; i++)
+		crc += frame[i];
+	frame[FRAME_LEN - 1] = crc;
+	host_bt_notify(BMS_IDX, frame, FRAME_LEN);
+}
+
+static void step_add(enum jk_recover_t step)
+{
+	if (steps.count >= STEPS_MAX)
+		return;
+	steps.step[steps.count] = step;
+	steps.time[steps.count] = time_ms_since_boot();
+	steps.count++;
+}
+
+/*
+ * Run the main loop for given time. The device answers the requests if asked to,
+ * the BT layer connects again to the device when it is disconnected.
+ */
+static void main_loop(uint32_t ms, bool answer)
+{
+	uint64_t end = time_ms_since_boot() + ms;
+	struct host_bt_stats_t before;
+	uint32_t reboots;
+
+	while (time_ms_since_boot() < end) {
+		before = *host_bt_stats();
+		reboots = host_sys_reboot_count();
+		sys_modules_run();
+		if (host_bt_stats()->notify_off != before.notify_off)
+			step_add(JK_RECOVER_NOTIFY);
+		if (host_bt_stats()->disconnects != before.disconnects)
+			step_add(JK_RECOVER_RECONNECT);
+		if (host_bt_stats()->resets != before.resets)
+			step_add(JK_RECOVER_BT_RESET);
+		if (host_sys_reboot_count() != reboots)
+			step_add(JK_RECOVER_REBOOT);
+		if (!host_bt_connected(BMS_IDX))
+			host_bt_connect(BMS_IDX, "JK-test");
+		else if (answer && host_bt_notify_enabled(BMS_IDX) &&
+			 host_bt_stats()->writes != before.writes)
+			frame_answer();
+		host_time_advance_ms(PASS_MS);
+	}
+}
+
+static void test_connect(void)
+{
+	dev = host_bt_context(BMS_IDX);
+	TEST_ASSERT(dev != NULL);
+	TEST_ASSERT(dev->timeout_msec == TIMEOUT_MS);
+	host_bt_connect(BMS_IDX, "JK-test");
+
+	/* The device answers, no recovery */
+	main_loop(2 * TIMEOUT_MS, true);
+	TEST_ASSERT(dev->request_count > 0);
+	TEST_ASSERT(steps.count == 0);
+	TEST_ASSERT(dev->recover_step == JK_RECOVER_NONE);
+}
+
+static void test_escalation(void)
+{
+	static const enum jk_recover_t order[] = {JK_RECOVER_NOTIFY, JK_RECOVER_RECONNECT,
+						  JK_RECOVER_BT_RESET, JK_RECOVER_REBOOT};
+	struct host_bt_stats_t before = *host_bt_stats();
+	uint64_t start = time_ms_since_boot();
+	uint64_t last_reply = dev->last_reply;
+	uint32_t calls = monitor.calls;
+	uint32_t i;
+
+	/* The device stops sending notifications */
+	main_loop(TIMEOUT_MS + 4 * STEP_MS + 10000, false);
+	TEST_ASSERT(steps.count == ARRAY_SIZE(order));
+	for (i = 0; i < ARRAY_SIZE(order) && (int)i < steps.count; i++) {
+		TEST_ASSERT(steps.step[i] == order[i]);
+		TEST_ASSERT(dev->recover_count[order[i]] == 1);
+	}
+	/* The first step on timeout, each next one when the previous did not help */
+	TEST_ASSERT(steps.time[0] > last_reply + TIMEOUT_MS);
+	TEST_ASSERT(steps.time[0] <= last_reply + TIMEOUT_MS + PASS_MS);
+	for (i = 1; (int)i < steps.count; i++) {
+		TEST_ASSERT(steps.time[i] > steps.time[i - 1] + STEP_MS);
+		TEST_ASSERT(steps.time[i] <= steps.time[i - 1] + STEP_MS + 2 * PASS_MS);
+	}
+	TEST_ASSERT(dev->recover_step == JK_RECOVER_REBOOT);
+	/* Subscribed again after the first step, connected again after the second and the third */
+	TEST_ASSERT(host_bt_stats()->notify_on > before.notify_on + 2);
+	TEST_ASSERT(host_bt_stats()->connects == before.connects + 2);
+	TEST_ASSERT(host_sys_reboot_count() == 1);
+
+	/* The reboot is the last step */
+	main_loop(5 * STEP_MS, false);
+	TEST_ASSERT(steps.count == ARRAY_SIZE(order));
+	TEST_ASSERT(host_sys_reboot_count() == 1);
+
+	/* The other modules are not blocked by the recovery */
+	TEST_ASSERT(monitor.calls >= calls + (time_ms_since_boot() - start) / MONITOR_MS - 1);
+
+	/* A valid frame ends the recovery, the counters are kept */
+	main_loop(STEP_MS, true);
+	TEST_ASSERT(dev->recover_step == JK_RECOVER_NONE);
+	TEST_ASSERT(dev->last_reply > steps.time[steps.count - 1]);
+	TEST_ASSERT(dev->recover_count[JK_RECOVER_REBOOT] == 1);
+	TEST_ASSERT(steps.count == ARRAY_SIZE(order));
+}
+
+static void test_first_step(void)
+{
+	struct host_bt_stats_t before = *host_bt_stats();
+
+	/* The device stops sending notifications, until subscribed again */
+	steps.count = 0;
+	main_loop(TIMEOUT_MS + PASS_MS, false);
+	TEST_ASSERT(steps.count == 1);
+	TEST_ASSERT(steps.step[0] == JK_RECOVER_NOTIFY);
+	TEST_ASSERT(dev->recover_step == JK_RECOVER_NOTIFY);
+
+	main_loop(4 * STEP_MS, true);
+	TEST_ASSERT(steps.count == 1);
+	TEST_ASSERT(dev->recover_step == JK_RECOVER_NONE);
+	TEST_ASSERT(dev->recover_count[JK_RECOVER_NOTIFY] == 2);
+	TEST_ASSERT(dev->recover_count[JK_RECOVER_RECONNECT] == 1);
+	TEST_ASSERT(host_bt_stats()->disconnects == before.disconnects);
+
+	/* Starts again from the first step on the next timeout */
+	steps.count = 0;
+	main_loop(TIMEOUT_MS + STEP_MS + STEP_MS / 2, false);
+	TEST_ASSERT(steps.count == 2);
+	TEST_ASSERT(steps.step[0] == JK_RECOVER_NOTIFY);
+	TEST_ASSERT(steps.step[1] == JK_RECOVER_RECONNECT);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	host_bt_uuid_set(term_svc, term_charc);
+	monitor.mod.name = "monitor";
+	monitor.mod.run = monitor_run;
+	monitor.mod.run_interval_ms = MONITOR_MS;
+	sys_module_register(&monitor.mod);
+	bms_jk_register();
+	sys_modules_init();
+
+	TEST_RUN(test_connect);
+	TEST_RUN(test_escalation);
+	TEST_RUN(test_first_step);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+/*
+ * Replay of JK BMS cell info frames, split in GATT notifications of
+ * different sizes, duplicated and truncated.
+ */
+
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "bms_jk.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define BMS_IDX		1
+#define FRAME_LEN	NOTIFY_PACKET_SIZE
+/* BLE MTU of 23 bytes, without the ATT header */
+#define CHUNK_MTU	20
+#define RATE_FRAMES	20000
+
+/* Offsets in the cell info frame */
+#define FRAME_TYPE		4
+#define FRAME_SEQ		5
+#define FRAME_CELLS_V		6
+#define FRAME_CELLS_EN		70
+#define FRAME_BATT_VOLT		150
+#define FRAME_BATT_CHARGE	158
+#define FRAME_BATT_STATE	173
+#define FRAME_CAP_REMAIN	174
+#define FRAME_CELLS		16
+
+extern void bms_jk_register(void);
+
+static const bt_uuid128_t term_svc = {0x00, 0x00, 0xFF, 0xE0, 0x00, 0x00, 0x10, 0x00,
+				      0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+static const bt_uuid128_t term_charc = {0x00, 0x00, 0xFF, 0xE1, 0x00, 0x00, 0x10, 0x00,
+					0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+
+static struct jk_bms_dev_t *dev;
+static uint8_t frame[FRAME_LEN];
+
+static void put16(uint8_t *buf, int ofs, uint16_t val)
+{
+	buf[ofs] = val & 0xFF;
+	buf[ofs + 1] = val >> 8;
+}
+
+static void put32(uint8_t *buf, int ofs, uint32_t val)
+{
+	put16(buf, ofs, val & 0xFFFF);
+	put16(buf, ofs + 2, val >> 16);
+}
+
+/* Cell info frame, with values derived from its sequence number */
+static void frame_build(uint8_t *buf, int seq)
+{
+	uint8_t crc = 0;
+	int i;
+
+	memset(buf, 0, FRAME_LEN);
+	buf[0] = 0x55;
+	buf[1] = 0xAA;
+	buf[2] = 0xEB;
+	buf[3] = 0x90;
+	buf[FRAME_TYPE] = 0x02;
+	buf[FRAME_SEQ] = seq;
+	for (i = 0; i < FRAME_CELLS; i++)
+		put16(buf, FRAME_CELLS_V + i * 2, 3200 + (seq % 100) + i);
+	put32(buf, FRAME_CELLS_EN, (1 << FRAME_CELLS) - 1);
+	put32(buf, FRAME_BATT_VOLT, 52000 + seq);
+	put32(buf, FRAME_BATT_CHARGE, (uint32_t)(-2000 + seq));
+	buf[FRAME_BATT_STATE] = seq % 101;
+	put32(buf, FRAME_CAP_REMAIN, 100000 + seq);
+	for (i = 0; i < FRAME_LEN - 1; i++)
+		crc += buf[i];
+	buf[FRAME_LEN - 1] = crc;
+}
+
+static bool frame_decoded(int seq)
+{
+	bms_cells_info_t *ci = &dev->cell_info;
+	int i;
+
+	if (!ci->valid)
+		return false;
+	for (i = 0; i < FRAME_CELLS; i++) {
+		if (ci->cells_v[i] != 3200 + (seq % 100) + i)
+			return false;
+	}
+	return ci->cells_enabled == (1 << FRAME_CELLS) - 1 &&
+	       ci->batt_volt == (uint32_t)(52000 + seq) &&
+	       ci->batt_charge_curr == -2000 + seq &&
+	       ci->batt_state == seq % 101 &&
+	       ci->batt_cap_rem == (uint32_t)(100000 + seq);
+}
+
+/* Send the frame in chunks of given sizes, the last size repeats */
+static void frame_send(const uint8_t *buf, int len, const int *sizes, int count)
+{
+	int ofs = 0, i = 0, size;
+
+	while (ofs < len) {
+		size = MIN(sizes[i], len - ofs);
+		host_bt_notify(BMS_IDX, buf + ofs, size);
+		ofs += size;
+		if (i < count - 1)
+			i++;
+	}
+}
+
+static void frame_send_mtu(const uint8_t *buf, int len)
+{
+	int mtu = CHUNK_MTU;
+
+	frame_send(buf, len, &mtu, 1);
+}
+
+static void test_connect(void)
+{
+	uint32_t writes = host_bt_stats()->writes;
+
+	dev = host_bt_context(BMS_IDX);
+	TEST_ASSERT(dev != NULL);
+	host_bt_connect(BMS_IDX, "JK-test");
+	TEST_ASSERT(dev->state == BT_READY);
+	TEST_ASSERT(TERM_IS_ACTIVE(dev));
+
+	/* The first request subscribes for notifications */
+	sys_modules_run();
+	TEST_ASSERT(host_bt_stats()->writes == writes + 1);
+	TEST_ASSERT(host_bt_notify_enabled(BMS_IDX));
+}
+
+static void test_fragmented(void)
+{
+	static const int whole[] = {FRAME_LEN};
+	static const int bytes[] = {1};
+	static const int odd[] = {3, 7, 11, 13};
+	/* The start magic split in two */
+	static const int magic[] = {2, 1, 29};
+	int seq = 1;
+
+	frame_build(frame, seq);
+	frame_send(frame, FRAME_LEN, whole, ARRAY_SIZE(whole));
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	frame_build(frame, ++seq);
+	frame_send_mtu(frame, FRAME_LEN);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	frame_build(frame, ++seq);
+	frame_send(frame, FRAME_LEN, bytes, ARRAY_SIZE(bytes));
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	frame_build(frame, ++seq);
+	frame_send(frame, FRAME_LEN, odd, ARRAY_SIZE(odd));
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	frame_build(frame, ++seq);
+	frame_send(frame, FRAME_LEN, magic, ARRAY_SIZE(magic));
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+}
+
+static void test_duplicated(void)
+{
+	int seq = 10;
+
+	frame_build(frame, seq);
+	frame_send_mtu(frame, FRAME_LEN);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	/* A chunk in the middle twice, the CRC does not match */
+	frame_build(frame, seq + 1);
+	frame_send_mtu(frame, 5 * CHUNK_MTU);
+	host_bt_notify(BMS_IDX, frame + 4 * CHUNK_MTU, CHUNK_MTU);
+	frame_send_mtu(frame + 5 * CHUNK_MTU, FRAME_LEN - 5 * CHUNK_MTU);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	/* The first chunk twice, the frame starts again */
+	frame_build(frame, ++seq);
+	host_bt_notify(BMS_IDX, frame, CHUNK_MTU);
+	frame_send_mtu(frame, FRAME_LEN);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	/* The whole frame twice, before the loop processes the first one */
+	frame_build(frame, ++seq);
+	frame_send_mtu(frame, FRAME_LEN);
+	frame_build(frame, seq + 1);
+	frame_send_mtu(frame, FRAME_LEN);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+}
+
+static void test_truncated(void)
+{
+	static const uint8_t garbage[CHUNK_MTU] = {0x01, 0x02, 0x03};
+	int seq = 20;
+
+	/* The last chunk is lost, the next frame is not mixed with it */
+	frame_build(frame, seq);
+	frame_send_mtu(frame, FRAME_LEN - CHUNK_MTU);
+	sys_modules_run();
+	TEST_ASSERT(!frame_decoded(seq));
+	frame_build(frame, ++seq);
+	frame_send_mtu(frame, FRAME_LEN);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	/* The first chunk is lost, the rest is dropped */
+	frame_build(frame, ++seq);
+	frame_send_mtu(frame + CHUNK_MTU, FRAME_LEN - CHUNK_MTU);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq - 1));
+
+	/* Data without frame start, between two frames */
+	host_bt_notify(BMS_IDX, garbage, sizeof(garbage));
+	host_bt_notify(BMS_IDX, garbage, 2);
+	frame_build(frame, ++seq);
+	frame_send_mtu(frame, FRAME_LEN);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq));
+
+	/* Truncated and then garbage, the garbage is not taken as its tail */
+	frame_build(frame, ++seq);
+	frame_send_mtu(frame, 10 * CHUNK_MTU);
+	frame_send_mtu(garbage, sizeof(garbage));
+	frame_send_mtu(frame + 11 * CHUNK_MTU, FRAME_LEN - 11 * CHUNK_MTU);
+	sys_modules_run();
+	TEST_ASSERT(frame_decoded(seq - 1));
+}
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Frames in MTU chunks, each processed by a pass of the main loop */
+static void test_rate(void)
+{
+	uint64_t start, ns;
+	int i, seq = 100;
+
+	start = host_ns();
+	for (i = 0; i < RATE_FRAMES; i++) {
+		frame_build(frame, seq + (i % 100));
+		frame_send_mtu(frame, FRAME_LEN);
+		sys_modules_run();
+		if (!frame_decoded(seq + (i % 100)))
+			break;
+	}
+	ns = host_ns() - start;
+	TEST_ASSERT(i == RATE_FRAMES);
+	printf("Replayed %d frames in %d byte chunks: %.0f frames/s\n",
+	       RATE_FRAMES, CHUNK_MTU, (double)RATE_FRAMES * 1000000000.0 / (double)(ns ? ns : 1));
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	host_bt_uuid_set(term_svc, term_charc);
+	bms_jk_register();
+	sys_modules_init();
+
+	TEST_RUN(test_connect);
+	TEST_RUN(test_fragmented);
+	TEST_RUN(test_duplicated);
+	TEST_RUN(test_truncated);
+	TEST_RUN(test_rate);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "pico_hal.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "base64.h"
+#include "params.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define CFG_JOURNAL	"/device_cfg.jrn"
+#define CFG_DIR		"/device_cfg"
+#define JRN_MAX		16384
+
+static char jrn_buf[JRN_MAX];
+
+static int exec(const char *str)
+{
+	cmd_run_context_t ctx = { .type = CMD_CTX_SCRIPT };
+	char cmd[128];
+
+	snprintf(cmd, sizeof(cmd), "%s", str);
+	return cmd_exec(&ctx, cmd);
+}
+
+static void file_write(const char *path, const char *data)
+{
+	int fd;
+
+	fd = pico_open(path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+	if (fd < 0)
+		return;
+	pico_write(fd, data, strlen(data));
+	pico_close(fd);
+}
+
+/* Read the whole file, returns its size or -1 if it does not exist */
+static int file_read(const char *path, char *buf, int size)
+{
+	int fd, len;
+
+	fd = pico_open(path, LFS_O_RDONLY);
+	if (fd < 0)
+		return -1;
+	len = pico_read(fd, buf, size - 1);
+	pico_close(fd);
+	if (len < 0)
+		return -1;
+	buf[len] = 0;
+	return len;
+}
+
+/* Append a journal record in the same format as the config store */
+static void jrn_record_add(char *jrn, char op, const char *name, const char *value)
+{
+	char line[256];
+	char *enc = NULL;
+	int len;
+
+	if (value)
+		enc = base64_encode(value, strlen(value));
+	len = snprintf(line, sizeof(line), "%c:%s:%s", op, name, enc ? enc : "");
+	sprintf(jrn + strlen(jrn), "\n%s:%08X", line, (unsigned int)sys_hash(SYS_HASH_INIT, line, len));
+	free(enc);
+}
+
+/*
+ * Replay the journal, returns the number of records or -1 if there is
+ * an invalid one. The value of name is returned in val, if it is not NULL.
+ */
+static int jrn_replay(const char *name, char **val)
+{
+	char *line, *rest, *hstr, *pname, *pval;
+	int records = 0;
+
+	if (val)
+		*val = NULL;
+	if (file_read(CFG_JOURNAL, jrn_buf, JRN_MAX) < 0)
+		return 0;
+	rest = jrn_buf;
+	while ((line = strtok_r(rest, "\n", &rest)) != NULL) {
+		records++;
+		hstr = strrchr(line, ':');
+		if (!hstr || strlen(hstr + 1) != 8)
+			return -1;
+		*hstr++ = 0;
+		if (strtoul(hstr, NULL, 16) != sys_hash(SYS_HASH_INIT, line, strlen(line)))
+			return -1;
+		pname = line + 2;
+		pval = strchr(pname, ':');
+		if (!pval)
+			return -1;
+		*pval++ = 0;
+		if (!val || strcmp(pname, name))
+			continue;
+		free(*val);
+		*val = NULL;
+		if (line[0] == 'S')
+			*val = base64_decode(pval, strlen(pval));
+	}
+	return records;
+}
+
+static void check_param(char *name, const char *expected)
+{
+	char *val, *jval;
+
+	val = cfgs_param_get(name);
+	if (expected) {
+		TEST_ASSERT_STR(val, expected);
+	} else {
+		TEST_ASSERT(val == NULL);
+	}
+	/* The journal gives the same value */
+	TEST_ASSERT(jrn_replay(name, &jval) >= 0);
+	if (expected) {
+		TEST_ASSERT_STR(jval, expected);
+	} else {
+		TEST_ASSERT(jval == NULL);
+	}
+	free(val);
+	free(jval);
+}
+
+/* Old and new store, written by the previous firmware */
+static void test_prepare(void)
+{
+	char *enc;
+
+	jrn_buf[0] = 0;
+	jrn_record_add(jrn_buf, 'S', "DEV_HOSTNAME", "cfg-host");
+	jrn_record_add(jrn_buf, 'S', "A", "1");
+	jrn_record_add(jrn_buf, 'S', "B", "2");
+	jrn_record_add(jrn_buf, 'D', "B", NULL);
+	jrn_record_add(jrn_buf, 'S', "A", "3");
+	/* Bad hash and a record, torn by a power cut */
+	strcat(jrn_buf, "\nS:E:MQ==:DEADBEEF");
+	strcat(jrn_buf, "\nS:C:MQ==:12");
+	pico_mount(true);
+	file_write(CFG_JOURNAL, jrn_buf);
+
+	pico_mkdir(CFG_DIR);
+	enc = base64_encode("legacy", 6);
+	file_write(CFG_DIR "/L", enc);
+	free(enc);
+	enc = base64_encode("old", 3);
+	file_write(CFG_DIR "/A", enc);
+	free(enc);
+}
+
+static void test_load(void)
+{
+	check_param("A", "3");
+	check_param("B", NULL);
+	check_param("C", NULL);
+	check_param("E", NULL);
+	check_param("L", "legacy");
+	/* Imported and compacted */
+	TEST_ASSERT(pico_dir_open(CFG_DIR) < 0);
+	TEST_ASSERT(jrn_replay(NULL, NULL) == 3);
+}
+
+static void test_params(void)
+{
+	char *val;
+
+	/* The stored value overrides the one from the build */
+	val = USER_PRAM_GET(DEV_HOSTNAME);
+	TEST_ASSERT_STR(val, "cfg-host");
+	free(val);
+	val = USER_PRAM_GET(MQTT_USER);
+	TEST_ASSERT_STR(val, "user;pass");
+	free(val);
+}
+
+static void test_set_del(void)
+{
+	int records;
+
+	TEST_ASSERT(cfgs_param_set("X", "value") == 0);
+	check_param("X", "value");
+	TEST_ASSERT(cfgs_param_check("X"));
+	TEST_ASSERT(!cfgs_param_check("Z"));
+
+	/* No record, if the value is not changed */
+	records = jrn_replay(NULL, NULL);
+	TEST_ASSERT(cfgs_param_set("X", "value") == 0);
+	TEST_ASSERT(jrn_replay(NULL, NULL) == records);
+
+	TEST_ASSERT(cfgs_param_del("X") == 0);
+	check_param("X", NULL);
+	TEST_ASSERT(jrn_replay(NULL, NULL) == records + 1);
+	TEST_ASSERT(cfgs_param_del("X") == 0);
+	TEST_ASSERT(jrn_replay(NULL, NULL) == records + 1);
+
+	TEST_ASSERT(exec("config?set:Y:a:b") == 0);
+	check_param("Y", "a:b");
+	TEST_ASSERT(exec("config?del:Y") == 0);
+	check_param("Y", NULL);
+	TEST_ASSERT(exec("config?set") < 0);
+	TEST_ASSERT(exec("config?list") == 0);
+}
+
+static void test_compact(void)
+{
+	char val[16];
+	int i;
+
+	for (i = 0; i < 200; i++) {
+		snprintf(val, sizeof(val), "v%d", i);
+		TEST_ASSERT(cfgs_param_set("X", val) == 0);
+	}
+	check_param("X", "v199");
+	check_param("A", "3");
+	check_param("L", "legacy");
+	/* Stored are DEV_HOSTNAME, A, L and X */
+	TEST_ASSERT(jrn_replay(NULL, NULL) <= 2 * 4 + 32 + 1);
+}
+
+static void test_reset(void)
+{
+	TEST_ASSERT(exec("config?reset") == 0);
+	TEST_ASSERT(file_read(CFG_JOURNAL, jrn_buf, JRN_MAX) < 0);
+	check_param("A", NULL);
+	check_param("DEV_HOSTNAME", NULL);
+	TEST_ASSERT(cfgs_param_set("A", "new") == 0);
+	check_param("A", "new");
+	TEST_ASSERT(jrn_replay(NULL, NULL) == 1);
+}
+
+int main(void)
+{
+	test_prepare();
+	sys_modules_init();
+
+	TEST_RUN(test_load);
+	TEST_RUN(test_params);
+	TEST_RUN(test_set_del);
+	TEST_RUN(test_compact);
+	TEST_RUN(test_reset);
+
+	return TEST_RESULT;
+}
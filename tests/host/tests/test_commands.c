@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_test.h"
+
+#define TEST_MODULES	40
+#define TEST_COMMANDS	10
+
+static struct {
+	char name[16];
+	app_command_t commands[TEST_COMMANDS];
+	char command_names[TEST_COMMANDS][16];
+} test_mods[TEST_MODULES];
+
+static struct {
+	void *user_data;
+	char cmd[16];
+	char params[32];
+	int calls;
+} last_call;
+
+static int test_cmd_cb(cmd_run_context_t *ctx, char *cmd, char *params, void *user_data)
+{
+	UNUSED(ctx);
+
+	last_call.user_data = user_data;
+	snprintf(last_call.cmd, sizeof(last_call.cmd), "%s", cmd);
+	snprintf(last_call.params, sizeof(last_call.params), "%s", params);
+	last_call.calls++;
+	return 0;
+}
+
+static int test_cmd_dup_cb(cmd_run_context_t *ctx, char *cmd, char *params, void *user_data)
+{
+	UNUSED(ctx);
+	UNUSED(cmd);
+	UNUSED(params);
+	UNUSED(user_data);
+
+	return -1;
+}
+
+static int exec(const char *str)
+{
+	cmd_run_context_t ctx = { .type = CMD_CTX_SCRIPT };
+	char cmd[64];
+
+	snprintf(cmd, sizeof(cmd), "%s", str);
+	return cmd_exec(&ctx, cmd);
+}
+
+static void test_register(void)
+{
+	int i, j;
+
+	for (i = 0; i < TEST_MODULES; i++) {
+		snprintf(test_mods[i].name, sizeof(test_mods[i].name), "mod%d", i);
+		for (j = 0; j < TEST_COMMANDS; j++) {
+			snprintf(test_mods[i].command_names[j], 16, "cmd%d", j);
+			test_mods[i].commands[j].command = test_mods[i].command_names[j];
+			test_mods[i].commands[j].help = " - test command";
+			test_mods[i].commands[j].cb = test_cmd_cb;
+		}
+		TEST_ASSERT(cmd_handler_add(test_mods[i].name, test_mods[i].commands,
+									TEST_COMMANDS, "test", &test_mods[i]) == 0);
+	}
+}
+
+static void test_dispatch(void)
+{
+	char str[32];
+	int i, j;
+
+	for (i = 0; i < TEST_MODULES; i++) {
+		for (j = 0; j < TEST_COMMANDS; j++) {
+			snprintf(str, sizeof(str), "mod%d?cmd%d:%d", i, j, i * j);
+			last_call.user_data = NULL;
+			TEST_ASSERT(exec(str) == 0);
+			TEST_ASSERT(last_call.user_data == &test_mods[i]);
+			snprintf(str, sizeof(str), "cmd%d", j);
+			TEST_ASSERT_STR(last_call.cmd, str);
+			snprintf(str, sizeof(str), ":%d", i * j);
+			TEST_ASSERT_STR(last_call.params, str);
+		}
+	}
+	TEST_ASSERT(exec("mod3?cmd4") == 0);
+	TEST_ASSERT_STR(last_call.params, "");
+}
+
+static void test_unknown(void)
+{
+	int calls = last_call.calls;
+
+	TEST_ASSERT(exec("mod3?cmd") < 0);
+	TEST_ASSERT(exec("mod3?cmd44") < 0);
+	TEST_ASSERT(exec("mod?cmd4") < 0);
+	TEST_ASSERT(exec("mod3cmd4") < 0);
+	TEST_ASSERT(exec("?") < 0);
+	TEST_ASSERT(exec("") < 0);
+	TEST_ASSERT(last_call.calls == calls);
+	TEST_ASSERT(exec("help") == 0);
+	TEST_ASSERT(exec("about") == 0);
+	TEST_ASSERT(exec("version") == 0);
+	/* Common commands of a system module */
+	TEST_ASSERT(exec("commands?help") == 0);
+}
+
+static void test_duplicate(void)
+{
+	static app_command_t dup[] = {
+		{"cmd1", " - duplicated command", test_cmd_dup_cb},
+		{"new", " - new command", test_cmd_dup_cb},
+	};
+
+	/* The first registered command wins */
+	TEST_ASSERT(cmd_handler_add(test_mods[0].name, dup, ARRAY_SIZE(dup), "dup", NULL) == 0);
+	TEST_ASSERT(exec("mod0?cmd1") == 0);
+	TEST_ASSERT(last_call.user_data == &test_mods[0]);
+	TEST_ASSERT(exec("mod0?new") < 0);
+	/* No more hooks for that module */
+	TEST_ASSERT(cmd_handler_add(test_mods[0].name, dup, ARRAY_SIZE(dup), "dup", NULL) < 0);
+}
+
+int main(void)
+{
+	sys_modules_init();
+
+	TEST_RUN(test_register);
+	TEST_RUN(test_dispatch);
+	TEST_RUN(test_unknown);
+	TEST_RUN(test_duplicate);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "pico_hal.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define TEST_LINES	100
+
+static char file_buf[8192];
+
+static void file_write(const char *path, const char *data, int len)
+{
+	int fd;
+
+	fd = pico_open(path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+	if (fd < 0)
+		return;
+	pico_write(fd, data, len);
+	pico_close(fd);
+}
+
+static int lines_prepare(void)
+{
+	int i;
+
+	file_buf[0] = 0;
+	for (i = 0; i < TEST_LINES; i++)
+		sprintf(file_buf + strlen(file_buf), "line %d of the test file\n", i);
+	file_write("/lines.txt", file_buf, strlen(file_buf));
+	return strlen(file_buf);
+}
+
+static void test_gets(void)
+{
+	char line[64], expected[64];
+	uint32_t reads;
+	int fd, i, size;
+
+	size = lines_prepare();
+	fd = fs_open("/lines.txt", LFS_O_RDONLY);
+	TEST_ASSERT(fd >= 0);
+	reads = host_fs_read_calls();
+	for (i = 0; fs_gets(fd, line, sizeof(line)) >= 0; i++) {
+		snprintf(expected, sizeof(expected), "line %d of the test file", i);
+		TEST_ASSERT_STR(line, expected);
+	}
+	fs_close(fd);
+	TEST_ASSERT(i == TEST_LINES);
+	/* Read in blocks, not byte by byte */
+	TEST_ASSERT(host_fs_read_calls() - reads <= (uint32_t)size / 256 + 2);
+}
+
+static void test_gets_edges(void)
+{
+	char data[] = "first\r\n\nlast without new line";
+	char line[8];
+	int fd;
+
+	file_write("/edges.txt", data, strlen(data));
+	fd = fs_open("/edges.txt", LFS_O_RDONLY);
+	TEST_ASSERT(fd >= 0);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) == 5);
+	TEST_ASSERT_STR(line, "first");
+	/* Each of \r and \n ends a line */
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) == 0);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) == 0);
+	/* A long line is split, without losing data */
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) == (int)sizeof(line) - 1);
+	TEST_ASSERT_STR(line, "last wi");
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) == (int)sizeof(line) - 1);
+	TEST_ASSERT_STR(line, "thout n");
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) == 7);
+	TEST_ASSERT_STR(line, "ew line");
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) < 0);
+	fs_close(fd);
+}
+
+static void test_mixed(void)
+{
+	char line[64], buf[16];
+	int fd, pos;
+
+	lines_prepare();
+	fd = fs_open("/lines.txt", LFS_O_RDWR);
+	TEST_ASSERT(fd >= 0);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) > 0);
+	/* The position is where the user stopped, not the read ahead */
+	pos = strlen("line 0 of the test file\n");
+	TEST_ASSERT(fs_get_pos(fd) == pos);
+
+	/* Plain read continues from the buffered data */
+	TEST_ASSERT(fs_read(fd, buf, 6) == 6);
+	TEST_ASSERT(!memcmp(buf, "line 1", 6));
+	TEST_ASSERT(fs_get_pos(fd) == pos + 6);
+
+	/* Seek drops the buffered data */
+	TEST_ASSERT(fs_lseek(fd, 0, LFS_SEEK_SET) == 0);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) > 0);
+	TEST_ASSERT_STR(line, "line 0 of the test file");
+
+	/* Write goes at the user position */
+	TEST_ASSERT(fs_write(fd, "LINE", 4) == 4);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) > 0);
+	TEST_ASSERT_STR(line, " 1 of the test file");
+	fs_close(fd);
+
+	fd = fs_open("/lines.txt", LFS_O_RDONLY);
+	TEST_ASSERT(fd >= 0);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) > 0);
+	TEST_ASSERT(fs_gets(fd, line, sizeof(line)) > 0);
+	TEST_ASSERT_STR(line, "LINE 1 of the test file");
+	fs_close(fd);
+}
+
+int main(void)
+{
+	sys_modules_init();
+
+	TEST_RUN(test_gets);
+	TEST_RUN(test_gets_edges);
+	TEST_RUN(test_mixed);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "lwip/udp.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define TEST_TOPIC	"logtest"
+
+/* Run the main loop for given time, a loop pass takes 1ms */
+static void main_loop(uint32_t ms)
+{
+	uint64_t end = time_us_64() + (uint64_t)ms * 1000;
+
+	while (time_us_64() < end) {
+		sys_modules_run();
+		host_time_advance_ms(1);
+	}
+}
+
+/*
+ * Check the test messages received by the syslog server, ignoring the logs of
+ * the other modules. Returns the number of messages, or -1 if they are not
+ * first, first + 1, ... in that order.
+ */
+static int received_check(int first)
+{
+	char expected[32], *msg;
+	int count = 0;
+	int i;
+
+	for (i = 0; (msg = host_udp_sent(i)) != NULL; i++) {
+		if (!strstr(msg, " " TEST_TOPIC ": "))
+			continue;
+		snprintf(expected, sizeof(expected), TEST_TOPIC ": message %d\r\n", first + count);
+		if (!strstr(msg, expected))
+			return -1;
+		count++;
+	}
+	return count;
+}
+
+static void messages_log(int first, int count)
+{
+	int i;
+
+	for (i = first; i < first + count; i++)
+		hlog_info(TEST_TOPIC, "message %d", i);
+}
+
+static void test_connect(void)
+{
+	main_loop(10);
+	TEST_ASSERT(hlog_remoute());
+	TEST_ASSERT(host_udp_pcb_count() == 1);
+}
+
+static void test_send(void)
+{
+	char *msg;
+
+	host_udp_reset();
+	messages_log(0, 5);
+	/* Queued, sent from the run callback */
+	TEST_ASSERT(received_check(0) == 0);
+	main_loop(1);
+	TEST_ASSERT(received_check(0) == 5);
+	/* RFC5424 header */
+	msg = host_udp_sent(0);
+	TEST_ASSERT(msg && !strncmp(msg, "<14>1 ", 6));
+	TEST_ASSERT(msg && strstr(msg, " host-test " TEST_TOPIC ": "));
+}
+
+static void test_flush_limit(void)
+{
+	host_udp_reset();
+	messages_log(0, 40);
+	sys_modules_run();
+	TEST_ASSERT(host_udp_sent_count() == 16);
+	main_loop(5);
+	TEST_ASSERT(received_check(0) == 40);
+}
+
+static void test_send_no_mem(void)
+{
+	host_udp_reset();
+	host_udp_send_err_set(ERR_MEM);
+	messages_log(0, 5);
+	main_loop(10);
+	TEST_ASSERT(host_udp_sent_count() == 0);
+	TEST_ASSERT(hlog_remoute());
+
+	/* Not lost, sent in order when the stack has memory again */
+	host_udp_send_err_set(ERR_OK);
+	main_loop(1);
+	TEST_ASSERT(received_check(0) == 5);
+
+	host_udp_reset();
+	host_pbuf_alloc_fail(true);
+	messages_log(5, 3);
+	main_loop(10);
+	TEST_ASSERT(host_udp_sent_count() == 0);
+	host_pbuf_alloc_fail(false);
+	main_loop(1);
+	TEST_ASSERT(received_check(5) == 3);
+}
+
+static void test_send_no_route(void)
+{
+	host_udp_reset();
+	messages_log(0, 3);
+	host_udp_send_err_set(ERR_RTE);
+	sys_modules_run();
+	TEST_ASSERT(host_udp_sent_count() == 0);
+	/* Disconnected, the queued messages are kept */
+	TEST_ASSERT(!hlog_remoute());
+
+	host_udp_send_err_set(ERR_OK);
+	main_loop(10);
+	TEST_ASSERT(hlog_remoute());
+	TEST_ASSERT(received_check(0) == 3);
+	TEST_ASSERT(host_udp_pcb_count() == 1);
+}
+
+static void test_overflow(void)
+{
+	int count;
+
+	host_udp_reset();
+	host_udp_send_err_set(ERR_MEM);
+	messages_log(0, 200);
+	main_loop(10);
+	host_udp_send_err_set(ERR_OK);
+	main_loop(50);
+	/* The oldest messages are kept, the new ones are dropped */
+	count = received_check(0);
+	TEST_ASSERT(count > 16 && count < 200);
+
+	/* There is space again */
+	host_udp_reset();
+	messages_log(0, 5);
+	main_loop(1);
+	TEST_ASSERT(received_check(0) == 5);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	sys_modules_init();
+
+	TEST_RUN(test_connect);
+	TEST_RUN(test_send);
+	TEST_RUN(test_flush_limit);
+	TEST_RUN(test_send_no_mem);
+	TEST_RUN(test_send_no_route);
+	TEST_RUN(test_overflow);
+
+	return TEST_RESULT;
+}
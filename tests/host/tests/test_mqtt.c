@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "lwip/apps/mqtt.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "mqtt_internal.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US		1000000
+#define TEST_COMPONENTS	40
+#define DISCOVERY_TOPIC	"homeassistant/sensor/"
+
+static struct {
+	mqtt_component_t comp;
+	char name[16];
+	char value[32];
+} test_cmps[TEST_COMPONENTS];
+
+static struct {
+	char topic[MQTT_MAX_TOPIC_SIZE];
+	char data[64];
+	int calls;
+} test_listen[4];
+
+static struct mqtt_context_t *mqtt_ctx;
+
+/* Run the main loop for given time, a loop pass takes 1ms */
+static void main_loop(uint32_t ms)
+{
+	uint64_t end = time_us_64() + (uint64_t)ms * 1000;
+
+	while (time_us_64() < end) {
+		sys_modules_run();
+		host_time_advance_ms(1);
+	}
+}
+
+static int published_count(const char *prefix)
+{
+	host_mqtt_msg_t *msg;
+	int count = 0;
+	int i;
+
+	for (i = 0; (msg = host_mqtt_published(i)) != NULL; i++) {
+		if (!strncmp(msg->topic, prefix, strlen(prefix)))
+			count++;
+	}
+	return count;
+}
+
+static void test_listen_cb(void *context, char *topic, char *data, int size, lwjson_t *lwjson)
+{
+	int idx = (int)(intptr_t)context;
+
+	UNUSED(size);
+	UNUSED(lwjson);
+
+	snprintf(test_listen[idx].topic, MQTT_MAX_TOPIC_SIZE, "%s", topic);
+	snprintf(test_listen[idx].data, sizeof(test_listen[idx].data), "%s", data);
+	test_listen[idx].calls++;
+}
+
+static void test_connect(void)
+{
+	int i;
+
+	for (i = 0; i < TEST_COMPONENTS; i++) {
+		snprintf(test_cmps[i].name, sizeof(test_cmps[i].name), "c%d", i);
+		test_cmps[i].comp.module = "test";
+		test_cmps[i].comp.name = test_cmps[i].name;
+		test_cmps[i].comp.platform = "sensor";
+		test_cmps[i].comp.value_template = "{{ value_json['value'] }}";
+		TEST_ASSERT(mqtt_msg_component_register(&test_cmps[i].comp) == i);
+	}
+	main_loop(1000);
+
+	TEST_ASSERT(mqtt_is_connected());
+	TEST_ASSERT(mqtt_is_discovery_sent());
+	TEST_ASSERT(host_mqtt_last("host/status") != NULL);
+	TEST_ASSERT_STR(host_mqtt_last("host/status")->payload, ONLINE_MSG);
+	TEST_ASSERT(host_mqtt_last("homeassistant/device/host/config") != NULL);
+	TEST_ASSERT(published_count(DISCOVERY_TOPIC) == TEST_COMPONENTS);
+	TEST_ASSERT(host_mqtt_last("homeassistant/sensor/host_test_c7_config") == NULL);
+	TEST_ASSERT(host_mqtt_last("homeassistant/sensor/host_test_c7/config") != NULL);
+	TEST_ASSERT(strstr(host_mqtt_last("homeassistant/sensor/host_test_c7/config")->payload,
+					   "\"unique_id\": \"host-test_test_c7\"") != NULL);
+	TEST_ASSERT_STR(test_cmps[7].comp.state_topic, "host/test/c7/status");
+	/* The command topic */
+	TEST_ASSERT(host_mqtt_subscribed_count() == 1);
+}
+
+static void test_discovery_cache(void)
+{
+	int dev = published_count("homeassistant/device/");
+	int comp = published_count(DISCOVERY_TOPIC);
+
+	/* Periodic resend of the config, the components are not changed */
+	host_time_advance_ms(3600 * 1000);
+	main_loop(1000);
+	TEST_ASSERT(published_count("homeassistant/device/") == dev + 1);
+	TEST_ASSERT(published_count(DISCOVERY_TOPIC) == comp);
+	TEST_ASSERT(mqtt_is_discovery_sent());
+
+	/* Only the changed component is sent again */
+	test_cmps[3].comp.unit = "V";
+	host_time_advance_ms(3600 * 1000);
+	main_loop(1000);
+	TEST_ASSERT(published_count(DISCOVERY_TOPIC) == comp + 1);
+	TEST_ASSERT(strstr(host_mqtt_last("homeassistant/sensor/host_test_c3/config")->payload,
+					   "\"unit_of_measurement\": \"V\"") != NULL);
+}
+
+static void test_listen_topics(void)
+{
+	int subscribed = host_mqtt_subscribed_count();
+	char cmd[] = "mqtt?debug:0";
+
+	TEST_ASSERT(mqtt_topic_listen("host/+/set", test_listen_cb, (void *)0, false) == 0);
+	TEST_ASSERT(mqtt_topic_listen("host/#", test_listen_cb, (void *)1, false) == 0);
+	TEST_ASSERT(mqtt_topic_listen("#", test_listen_cb, (void *)2, false) == 0);
+	TEST_ASSERT(mqtt_topic_listen("other/a", test_listen_cb, (void *)3, false) == 0);
+	TEST_ASSERT(mqtt_topic_listen("host/a#", test_listen_cb, NULL, false) < 0);
+	TEST_ASSERT(mqtt_topic_listen("host/#/a", test_listen_cb, NULL, false) < 0);
+	TEST_ASSERT(mqtt_topic_listen("", test_listen_cb, NULL, false) < 0);
+	main_loop(100);
+	TEST_ASSERT(host_mqtt_subscribed_count() == subscribed + 4);
+
+	host_mqtt_incoming("host/relay/set", "on");
+	main_loop(10);
+	TEST_ASSERT(test_listen[0].calls == 1 && test_listen[1].calls == 1 && test_listen[2].calls == 1);
+	TEST_ASSERT_STR(test_listen[0].topic, "host/relay/set");
+	TEST_ASSERT_STR(test_listen[0].data, "on");
+	TEST_ASSERT(test_listen[3].calls == 0);
+
+	/* "host/#" matches the parent level as well */
+	host_mqtt_incoming("host", "parent");
+	main_loop(10);
+	TEST_ASSERT(test_listen[0].calls == 1 && test_listen[1].calls == 2 && test_listen[2].calls == 2);
+
+	host_mqtt_incoming("other/a", "exact");
+	main_loop(10);
+	TEST_ASSERT(test_listen[1].calls == 2 && test_listen[2].calls == 3 && test_listen[3].calls == 1);
+	host_mqtt_incoming("other/a/b", "deeper");
+	main_loop(10);
+	TEST_ASSERT(test_listen[2].calls == 4 && test_listen[3].calls == 1);
+
+	/* No wildcard matching of the system topics */
+	host_mqtt_incoming("$SYS/broker", "sys");
+	main_loop(10);
+	TEST_ASSERT(test_listen[2].calls == 4);
+
+	/* Commands, received on the command topic */
+	mqtt_ctx->debug = 0;
+	host_mqtt_incoming("host/command", "mqtt?debug:3");
+	main_loop(10);
+	TEST_ASSERT(mqtt_ctx->debug == 3);
+	TEST_ASSERT(test_listen[1].calls == 3);
+	TEST_ASSERT(cmd_exec(&mqtt_ctx->cmd_ctx, cmd) == 0);
+	TEST_ASSERT(mqtt_ctx->debug == 0);
+}
+
+static void test_rate_limit(void)
+{
+	int sent = host_mqtt_published_count();
+	char topic[32], value[32];
+	uint64_t start;
+	int queued;
+	int i;
+
+	/* Burst of updates of all components, the rate limited ones are queued */
+	start = time_ms_since_boot();
+	for (i = 0; i < TEST_COMPONENTS; i++) {
+		snprintf(test_cmps[i].value, sizeof(test_cmps[i].value), "{\"value\": %d}", i);
+		TEST_ASSERT(mqtt_msg_component_publish(&test_cmps[i].comp, test_cmps[i].value) == 0);
+	}
+	/* After a long idle, the current and the next rate window are used */
+	sent = host_mqtt_published_count() - sent;
+	TEST_ASSERT(sent >= (int)mqtt_ctx->max_ppm && sent <= 2 * (int)mqtt_ctx->max_ppm);
+	queued = mqtt_ctx->pending.count;
+	TEST_ASSERT(queued == TEST_COMPONENTS - sent);
+	TEST_ASSERT(mqtt_ctx->pending.dropped == 0);
+
+	/* A second burst, the queued topics are replaced with the latest values */
+	for (i = 0; i < TEST_COMPONENTS; i++) {
+		snprintf(test_cmps[i].value, sizeof(test_cmps[i].value), "{\"value\": %d}", 100 + i);
+		TEST_ASSERT(mqtt_msg_component_publish(&test_cmps[i].comp, test_cmps[i].value) == 0);
+	}
+	TEST_ASSERT(mqtt_ctx->pending.count == TEST_COMPONENTS);
+	TEST_ASSERT(mqtt_ctx->pending.replaced == (uint32_t)queued);
+	TEST_ASSERT(mqtt_ctx->pending.dropped == 0);
+
+	/* Topics, not registered as components, have limited slots */
+	for (i = 0; i <= MQTT_PENDING_MAX; i++) {
+		snprintf(topic, sizeof(topic), "host/raw/%d", i);
+		snprintf(value, sizeof(value), "%d", i);
+		mqtt_msg_publish(topic, value);
+	}
+	TEST_ASSERT(mqtt_ctx->pending.count == TEST_COMPONENTS + MQTT_PENDING_MAX);
+	TEST_ASSERT(mqtt_ctx->pending.dropped == 1);
+
+	/* Drained in the limits of the rate */
+	main_loop(10000);
+	TEST_ASSERT(mqtt_ctx->pending.count > 0);
+	main_loop(5 * 60 * 1000);
+	TEST_ASSERT(mqtt_ctx->pending.count == 0);
+	for (i = 0; i < TEST_COMPONENTS; i++) {
+		TEST_ASSERT(host_mqtt_last(test_cmps[i].comp.state_topic) != NULL);
+		TEST_ASSERT_STR(host_mqtt_last(test_cmps[i].comp.state_topic)->payload, test_cmps[i].value);
+	}
+	TEST_ASSERT(host_mqtt_last("host/raw/7") != NULL);
+	TEST_ASSERT(host_mqtt_last("host/raw/8") == NULL);
+	TEST_ASSERT(host_mqtt_published(host_mqtt_published_count() - 1)->time_ms - start >=
+				3 * MSEC2MIN);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	sys_modules_init();
+	mqtt_ctx = mqtt_context_get();
+	if (!mqtt_ctx) {
+		printf("FAIL no MQTT config\n");
+		return 1;
+	}
+
+	TEST_RUN(test_connect);
+	TEST_RUN(test_discovery_cache);
+	TEST_RUN(test_listen_topics);
+	TEST_RUN(test_rate_limit);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "opentherm.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define RX_PIN		15
+#define TX_PIN		14
+/* 34 manchester bits at 1ms each, a PIO word is pulled per half of the frame */
+#define TX_WORD_US	17000
+#define REPLY_MS	40
+/* Receiver clock, at which the frames of the boiler are decoded */
+#define BOILER_HZ_MIN	96000
+#define BOILER_HZ_MAX	97000
+#define END_BIT		0x80000000
+#define FLOW_TEMP	0x3780	/* 55.5, f8.8 */
+/* The interval between the lookups, when the device is lost */
+#define LOOKUP_INTERVAL_MS	300000
+
+extern void opentherm_register(void);
+
+/* The boiler, on the other side of the PIO state machines */
+static struct {
+	bool online;
+	PIO tx_pio;
+	uint tx_sm;
+	bool request_valid;
+	uint32_t request;
+	int requests[256];
+	int rx_early;
+	int replies;
+	uint32_t reply_hz;
+} boiler;
+
+static uint64_t pass_max_us;
+
+static uint32_t frame_encode(uint8_t msg_type, uint8_t id, uint16_t value)
+{
+	uint32_t frame = ((msg_type & 0x07) << 28) | (id << 16) | value;
+
+	if (__builtin_popcount(frame) & 1)
+		frame |= 0x80000000;
+	return frame;
+}
+
+static void boiler_request(PIO pio, uint sm)
+{
+	uint32_t words[2];
+	uint32_t f;
+
+	boiler.tx_pio = pio;
+	boiler.tx_sm = sm;
+	boiler.request_valid = false;
+	if (host_pio_tx_words(pio, sm, words, 2) != 2)
+		return;
+	if (manchester_decode(((uint64_t)words[0] << 32) | words[1], true, &f))
+		return;
+	boiler.request = f;
+	boiler.request_valid = true;
+	boiler.requests[(f >> 16) & 0xFF]++;
+}
+
+static void boiler_reply(PIO pio, uint sm, const pio_sm_config *cfg)
+{
+	uint64_t at = time_us_64() + REPLY_MS * 1000;
+	uint32_t hz = HOST_CLK_SYS_HZ / cfg->clkdiv;
+	uint8_t msg_type, id;
+	uint64_t m;
+
+	/* The receiver must be started when the request is sent */
+	if (pio_sm_get_tx_fifo_level(boiler.tx_pio, boiler.tx_sm))
+		boiler.rx_early++;
+	if (!boiler.online || !boiler.request_valid)
+		return;
+	/* Too slow receiver clock misses the frame, too fast one gets garbage */
+	if (hz < BOILER_HZ_MIN)
+		return;
+	if (hz > BOILER_HZ_MAX) {
+		host_pio_rx_push(pio, sm, 0x5A5A5A5A, at);
+		host_pio_rx_push(pio, sm, 0xA5A5A5A5, at);
+		host_pio_rx_push(pio, sm, 0x12345, at);
+		return;
+	}
+
+	msg_type = (boiler.request >> 28) & 0x07;
+	id = (boiler.request >> 16) & 0xFF;
+	msg_type = msg_type == MSG_TYPE_WRITE_DATA ? MSG_TYPE_WRITE_ACK : MSG_TYPE_READ_ACK;
+	if (id == DATA_ID_TBOILER)
+		m = manchester_encode(frame_encode(msg_type, id, FLOW_TEMP), false);
+	else
+		m = manchester_encode(frame_encode(msg_type, id, boiler.request & 0xFFFF), false);
+	host_pio_rx_push(pio, sm, (uint32_t)(m >> 32), at);
+	host_pio_rx_push(pio, sm, (uint32_t)m, at);
+	host_pio_rx_push(pio, sm, END_BIT, at);
+	boiler.reply_hz = hz;
+	boiler.replies++;
+}
+
+static void boiler_hook(PIO pio, uint sm, const pio_sm_config *cfg, bool enabled)
+{
+	if (!enabled)
+		return;
+	if (cfg->out_base == TX_PIN)
+		boiler_request(pio, sm);
+	else if (cfg->in_base == RX_PIN)
+		boiler_reply(pio, sm, cfg);
+}
+
+/* Run the main loop for given time, a loop pass takes 1ms */
+static void main_loop(uint32_t ms)
+{
+	uint64_t end = time_us_64() + (uint64_t)ms * 1000;
+	uint64_t start;
+
+	while (time_us_64() < end) {
+		start = time_us_64();
+		sys_modules_run();
+		if (time_us_64() - start > pass_max_us)
+			pass_max_us = time_us_64() - start;
+		host_time_advance_ms(1);
+	}
+}
+
+/* Run until the boiler is asked for the flow temperature, or the timeout */
+static bool data_wait(uint32_t ms)
+{
+	int count = boiler.requests[DATA_ID_TBOILER];
+	uint32_t i;
+
+	for (i = 0; i < ms; i += 100) {
+		main_loop(100);
+		if (boiler.requests[DATA_ID_TBOILER] > count)
+			return true;
+	}
+	return false;
+}
+
+static bool data_published(const char *value)
+{
+	host_mqtt_msg_t *msg;
+	int i;
+
+	for (i = 0; (msg = host_mqtt_published(i)) != NULL; i++) {
+		if (strstr(msg->payload, value))
+			return true;
+	}
+	return false;
+}
+
+static void test_lookup(void)
+{
+	boiler.online = true;
+	TEST_ASSERT(data_wait(120000));
+	/* Found in the middle of the window of the boiler */
+	TEST_ASSERT(boiler.reply_hz >= BOILER_HZ_MIN && boiler.reply_hz <= BOILER_HZ_MAX);
+	TEST_ASSERT(boiler.requests[DATA_ID_STATUS] > 100);
+	TEST_ASSERT(!boiler.rx_early);
+	/* The lookup of ~25s of frames does not block the main loop */
+	TEST_ASSERT(pass_max_us == 0);
+}
+
+static void test_data(void)
+{
+	int count = boiler.requests[DATA_ID_TBOILER];
+
+	host_mqtt_reset();
+	main_loop(20000);
+	TEST_ASSERT(data_published("\"flow_temp\":55.5"));
+	/* Polled periodically */
+	TEST_ASSERT(boiler.requests[DATA_ID_TBOILER] - count >= 2);
+	TEST_ASSERT(!boiler.rx_early);
+	TEST_ASSERT(pass_max_us == 0);
+}
+
+static void test_lost(void)
+{
+	int status;
+
+	/* The boiler stops replying, the device is detached after a minute */
+	boiler.online = false;
+	main_loop(90000);
+	TEST_ASSERT(!data_wait(10000));
+
+	/* Found again by the next lookup */
+	status = boiler.requests[DATA_ID_STATUS];
+	boiler.online = true;
+	TEST_ASSERT(data_wait(LOOKUP_INTERVAL_MS + 60000));
+	TEST_ASSERT(boiler.requests[DATA_ID_STATUS] > status + 100);
+	TEST_ASSERT(!boiler.rx_early);
+	TEST_ASSERT(pass_max_us == 0);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	host_pio_tx_word_us(TX_WORD_US);
+	host_pio_hook_set(boiler_hook);
+	opentherm_register();
+	sys_modules_init();
+
+	TEST_RUN(test_lookup);
+	TEST_RUN(test_data);
+	TEST_RUN(test_lost);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "pico_hal.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+/* Thu Jan  1 10:00:00 UTC 2026 */
+#define START_EPOCH	1767261600
+#define CALLS_MAX	64
+
+static struct {
+	char cmd[32];
+	uint64_t time_ms;
+} calls[CALLS_MAX];
+static int calls_count;
+
+static int test_cmd_cb(cmd_run_context_t *ctx, char *cmd, char *params, void *user_data)
+{
+	UNUSED(ctx);
+	UNUSED(user_data);
+
+	if (calls_count >= CALLS_MAX)
+		return -1;
+	snprintf(calls[calls_count].cmd, sizeof(calls[calls_count].cmd), "%s%s", cmd, params ? params : "");
+	calls[calls_count].time_ms = time_ms_since_boot();
+	calls_count++;
+	return 0;
+}
+
+static app_command_t test_cmds[] = {
+	{"on", ":<val>", test_cmd_cb},
+	{"step", NULL, test_cmd_cb},
+	{"off", NULL, test_cmd_cb},
+	{"boot", NULL, test_cmd_cb},
+	{"cron", NULL, test_cmd_cb},
+};
+
+static int exec(const char *str)
+{
+	cmd_run_context_t ctx = { .type = CMD_CTX_SCRIPT };
+	char cmd[64];
+
+	snprintf(cmd, sizeof(cmd), "%s", str);
+	return cmd_exec(&ctx, cmd);
+}
+
+static void file_write(const char *path, const char *data)
+{
+	int fd;
+
+	fd = pico_open(path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+	if (fd < 0)
+		return;
+	pico_write(fd, data, strlen(data));
+	pico_close(fd);
+}
+
+/* Run the main loop for given time, with ms steps */
+static void main_loop(uint32_t ms, uint32_t step)
+{
+	uint64_t end = time_us_64() + (uint64_t)ms * 1000;
+
+	while (time_us_64() < end) {
+		sys_modules_run();
+		host_time_advance_ms(step);
+	}
+}
+
+static int calls_find(const char *cmd, int from)
+{
+	int i;
+
+	for (i = from; i < calls_count; i++) {
+		if (!strcmp(calls[i].cmd, cmd))
+			return i;
+	}
+	return -1;
+}
+
+static int calls_num(const char *cmd)
+{
+	int i, n = 0;
+
+	for (i = 0; i < calls_count; i++) {
+		if (!strcmp(calls[i].cmd, cmd))
+			n++;
+	}
+	return n;
+}
+
+/* The scripts are loaded at boot, from the file system */
+static void test_prepare(void)
+{
+	pico_mount(true);
+	pico_mkdir("/scripts");
+	file_write("/scripts/loop.run",
+			   "@name loop\n"
+			   "@desc Loop test\n"
+			   "# comment\n"
+			   "tst?on:1\n"
+			   "@wait 1000\n"
+			   "@label start\n"
+			   "  tst?step\n"
+			   "@wait 500\n"
+			   "@jump start;3\n"
+			   "tst?off\n");
+	file_write("/scripts/boot.run",
+			   "@startup 2000\n"
+			   "tst?boot\n");
+	file_write("/scripts/cron.run",
+			   "@cron 0 */10 * * * *\n"
+			   "@cron_enable 1\n"
+			   "tst?cron\n");
+	file_write("/scripts/skip.txt", "tst?off\n");
+}
+
+static void test_startup(void)
+{
+	uint64_t start = time_ms_since_boot();
+	int i;
+
+	TEST_ASSERT(script_exist("loop", false) == 1);
+	TEST_ASSERT(script_exist("boot", false) == 1);
+	TEST_ASSERT(script_exist("skip", false) == 0);
+	TEST_ASSERT(script_exist("c", true) == 1);
+
+	main_loop(1900, 1);
+	TEST_ASSERT(calls_num("boot") == 0);
+	main_loop(200, 1);
+	i = calls_find("boot", 0);
+	TEST_ASSERT(i >= 0 && calls[i].time_ms - start >= 2000);
+	/* Only once */
+	main_loop(5000, 1);
+	TEST_ASSERT(calls_num("boot") == 1);
+	TEST_ASSERT(calls_num("on:1") == 0 && calls_num("cron") == 0);
+}
+
+static void test_loop(void)
+{
+	uint64_t start = time_ms_since_boot();
+	int i, on, off;
+
+	calls_count = 0;
+	TEST_ASSERT(script_run("loop", false) == 0);
+	TEST_ASSERT(script_run("none", false) < 0);
+	main_loop(10000, 1);
+
+	on = calls_find("on:1", 0);
+	off = calls_find("off", 0);
+	TEST_ASSERT(on == 0 && off == 5);
+	TEST_ASSERT(calls_num("step") == 4);
+	TEST_ASSERT(calls[on].time_ms - start < 10);
+	/* Each step waits the interval after the previous command */
+	for (i = on + 1; i <= off; i++)
+		TEST_ASSERT(calls[i].time_ms - calls[i - 1].time_ms >= (i == on + 1 ? 1000 : 500));
+	TEST_ASSERT(calls[off].time_ms - start < 1000 + 4 * 500 + 50);
+
+	/* The jump counters are reset on the next run */
+	calls_count = 0;
+	TEST_ASSERT(exec("scripts?run:loop") == 0);
+	main_loop(10000, 1);
+	TEST_ASSERT(calls_num("step") == 4 && calls_num("off") == 1);
+}
+
+static void test_compiled(void)
+{
+	char script[] = "@name loop\ntst?on:2\n@wait 100\ntst?off\n";
+	uint32_t reads;
+	int fd;
+
+	/* Run from RAM, the file is not read again */
+	calls_count = 0;
+	reads = host_fs_read_calls();
+	TEST_ASSERT(script_run("loop", false) == 0);
+	main_loop(10000, 1);
+	TEST_ASSERT(calls_num("step") == 4 && calls_num("off") == 1);
+	TEST_ASSERT(host_fs_read_calls() == reads);
+
+	/* Changed through the fs API, parsed again on the next run */
+	fd = fs_open("/scripts/loop.run", LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+	TEST_ASSERT(fd >= 0);
+	fs_write(fd, script, strlen(script));
+	fs_close(fd);
+	calls_count = 0;
+	TEST_ASSERT(script_run("loop", false) == 0);
+	main_loop(1000, 1);
+	TEST_ASSERT(calls_count == 2);
+	TEST_ASSERT_STR(calls[0].cmd, "on:2");
+	TEST_ASSERT(calls[1].time_ms - calls[0].time_ms >= 100);
+	TEST_ASSERT(host_fs_read_calls() > reads);
+}
+
+static void test_cron(void)
+{
+	calls_count = 0;
+	main_loop(25 * 60 * 1000, 10);
+	TEST_ASSERT(calls_num("cron") == 2);
+
+	TEST_ASSERT(script_auto("cron", false, false) == 0);
+	main_loop(25 * 60 * 1000, 10);
+	TEST_ASSERT(calls_num("cron") == 2);
+	TEST_ASSERT(script_auto("loop", false, true) < 0);
+}
+
+int main(void)
+{
+	setenv("TZ", "UTC", 1);
+	host_time_set_us(START_US);
+	host_time_set_epoch(START_EPOCH);
+	test_prepare();
+	sys_modules_init();
+	cmd_handler_add("tst", test_cmds, ARRAY_SIZE(test_cmds), "test", NULL);
+
+	TEST_RUN(test_startup);
+	TEST_RUN(test_loop);
+	TEST_RUN(test_compiled);
+	TEST_RUN(test_cron);
+
+	return TEST_RESULT;
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+#define ECHO_PIN	16
+#define TRIGGER_PIN	17
+/* Time from the trigger to the start of the echo pulse */
+#define ECHO_DELAY_US	450
+/* 30 samples per measurement, one per loop pass */
+#define MEASURE_MS	2000
+
+extern void sonar_register(void);
+
+/* The sensor, on the other side of the pins */
+static struct {
+	bool online;
+	uint32_t pulse_us;
+	/* Every N-th echo is a spike of given length */
+	int spike_every;
+	uint32_t spike_us;
+	uint32_t triggers;
+	uint32_t puts;
+} sensor;
+
+static uint64_t pass_max_us;
+
+/*
+ * A trigger pulse ends with a low put on the trigger pin. The echo pulse
+ * comes between two passes of the main loop, its edges are timestamped by
+ * the GPIO interrupt.
+ */
+static void sensor_echo(void)
+{
+	uint32_t puts = host_gpio_put_count(TRIGGER_PIN);
+	uint32_t pulse_us = sensor.pulse_us;
+
+	if (puts == sensor.puts || host_gpio_out(TRIGGER_PIN))
+		return;
+	sensor.puts = puts;
+	sensor.triggers++;
+	if (!sensor.online)
+		return;
+	if (sensor.spike_every && !(sensor.triggers % sensor.spike_every))
+		pulse_us = sensor.spike_us;
+	host_time_advance_us(ECHO_DELAY_US);
+	host_gpio_set(ECHO_PIN, true);
+	host_time_advance_us(pulse_us);
+	host_gpio_set(ECHO_PIN, false);
+}
+
+/* Run the main loop for given time, a loop pass takes 1ms */
+static void main_loop(uint32_t ms)
+{
+	uint64_t end = time_us_64() + (uint64_t)ms * 1000;
+	uint64_t start;
+
+	while (time_us_64() < end) {
+		start = time_us_64();
+		sys_modules_run();
+		if (time_us_64() - start > pass_max_us)
+			pass_max_us = time_us_64() - start;
+		sensor_echo();
+		host_time_advance_ms(1);
+	}
+}
+
+/* The distance, in the last published message of the sensor */
+static bool distance_published(const char *distance)
+{
+	host_mqtt_msg_t *msg, *last = NULL;
+	char expected[32];
+	int i;
+
+	for (i = 0; (msg = host_mqtt_published(i)) != NULL; i++) {
+		if (strstr(msg->payload, "\"distance\":"))
+			last = msg;
+	}
+	snprintf(expected, sizeof(expected), "\"distance\":%s", distance);
+	return last && strstr(last->payload, expected);
+}
+
+static void test_distance(void)
+{
+	/* 6000us is 1020mm */
+	sensor.online = true;
+	sensor.pulse_us = 6000;
+	main_loop(MEASURE_MS);
+	TEST_ASSERT(sensor.triggers >= 30);
+	TEST_ASSERT(distance_published("102.00"));
+
+	sensor.pulse_us = 3000;
+	main_loop(MEASURE_MS);
+	TEST_ASSERT(distance_published("51.00"));
+	/* The echo is timed in the interrupt, the loop does not wait for it */
+	TEST_ASSERT(pass_max_us < 100);
+}
+
+static void test_spikes(void)
+{
+	/* Less than 5 spikes of 30 samples are filtered out */
+	sensor.pulse_us = 6000;
+	sensor.spike_every = 7;
+	sensor.spike_us = 40000;
+	main_loop(MEASURE_MS);
+	TEST_ASSERT(distance_published("102.00"));
+
+	sensor.spike_us = 100;
+	main_loop(MEASURE_MS);
+	TEST_ASSERT(distance_published("102.00"));
+	sensor.spike_every = 0;
+	TEST_ASSERT(pass_max_us < 100);
+}
+
+static void test_no_echo(void)
+{
+	/* Each sample waits for the echo timeout */
+	sensor.online = false;
+	main_loop(2 * MEASURE_MS);
+	TEST_ASSERT(distance_published("0.00"));
+	TEST_ASSERT(pass_max_us < 100);
+
+	sensor.online = true;
+	main_loop(MEASURE_MS);
+	TEST_ASSERT(distance_published("102.00"));
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	sonar_register();
+	sys_irq_init();
+	sensor.puts = host_gpio_put_count(TRIGGER_PIN);
+	sys_modules_init();
+
+	TEST_RUN(test_distance);
+	TEST_RUN(test_spikes);
+	TEST_RUN(test_no_echo);
+
+	return TEST_RESULT;
+}
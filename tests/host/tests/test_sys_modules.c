@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define START_US	1000000
+
+struct test_mod_t {
+	sys_module_t mod;
+	uint32_t calls;
+	uint32_t run_us;
+	uint32_t debug;
+};
+
+static struct test_mod_t mod_fast, mod_slow, mod_tick, mod_tock;
+
+static void test_mod_run(void *context)
+{
+	struct test_mod_t *ctx = (struct test_mod_t *)context;
+
+	ctx->calls++;
+	host_time_advance_us(ctx->run_us);
+}
+
+static void test_mod_debug(uint32_t debug, void *context)
+{
+	struct test_mod_t *ctx = (struct test_mod_t *)context;
+
+	ctx->debug = debug;
+}
+
+static bool test_mod_log(void *context)
+{
+	UNUSED(context);
+
+	return true;
+}
+
+static void test_mod_init(struct test_mod_t *ctx, char *name, uint32_t interval_ms, uint32_t run_us)
+{
+	ctx->mod.name = name;
+	ctx->mod.run = test_mod_run;
+	ctx->mod.run_interval_ms = interval_ms;
+	ctx->mod.debug = test_mod_debug;
+	ctx->mod.log = test_mod_log;
+	/* Keep running, while the modules of the system are paused */
+	ctx->mod.job_flags = OTA_JOB;
+	ctx->mod.context = ctx;
+	ctx->run_us = run_us;
+}
+
+/* Run the main loop for given number of passes, returns the time it took in usec */
+static uint64_t main_loop(uint32_t passes)
+{
+	uint64_t start = time_us_64();
+
+	while (passes--)
+		sys_modules_run();
+	return time_us_64() - start;
+}
+
+/* Run the main loop, with the sleep between the passes, for given time. Returns the number of passes */
+static uint32_t main_loop_sleep(uint32_t ms)
+{
+	uint64_t end = time_us_64() + (uint64_t)ms * 1000;
+	uint32_t passes = 0;
+
+	while (time_us_64() < end) {
+		sys_modules_run();
+		sys_modules_sleep();
+		passes++;
+	}
+	return passes;
+}
+
+static void test_run(void)
+{
+	uint64_t took;
+
+	took = main_loop(100);
+	/* Each module on every pass */
+	TEST_ASSERT(mod_fast.calls == 100);
+	TEST_ASSERT(mod_slow.calls == 100);
+	TEST_ASSERT(took == 100 * (10 + 300));
+}
+
+static void test_pause(void)
+{
+	uint32_t fast = mod_fast.calls;
+	uint32_t slow = mod_slow.calls;
+
+	mod_fast.mod.job_flags = 0;
+	main_loop(10);
+	TEST_ASSERT(mod_fast.calls == fast);
+	TEST_ASSERT(mod_slow.calls == slow + 10);
+	sys_job_state_clear(OTA_JOB);
+	main_loop(10);
+	TEST_ASSERT(mod_fast.calls == fast + 10);
+	mod_fast.mod.job_flags = OTA_JOB;
+	sys_job_state_set(OTA_JOB);
+}
+
+static void test_commands(void)
+{
+	cmd_run_context_t ctx = { 0 };
+	char cmd[32];
+
+	strcpy(cmd, "fast?debug:0x12");
+	TEST_ASSERT(cmd_exec(&ctx, cmd) == 0);
+	TEST_ASSERT(mod_fast.debug == 0x12);
+	strcpy(cmd, "fast?debug");
+	TEST_ASSERT(cmd_exec(&ctx, cmd) < 0);
+	strcpy(cmd, "fast?status");
+	TEST_ASSERT(cmd_exec(&ctx, cmd) == 0);
+	strcpy(cmd, "slow?help");
+	TEST_ASSERT(cmd_exec(&ctx, cmd) == 0);
+	sys_modules_debug_set(0x3);
+	TEST_ASSERT(mod_fast.debug == 0x3 && mod_slow.debug == 0x3);
+}
+
+/* Run the fast module for given number of passes, with a spike of its run time every N passes */
+static void fast_spikes(uint32_t passes, uint32_t every, uint32_t spike_us)
+{
+	uint32_t i;
+
+	for (i = 0; i < passes; i++) {
+		mod_fast.run_us = (i % every) ? 10 : spike_us;
+		sys_modules_run();
+	}
+	mod_fast.run_us = 10;
+}
+
+static void test_stats(void)
+{
+	uint32_t percentile, max;
+	char *name = NULL;
+
+	TEST_ASSERT(sys_modules_stats_slowest(&name, &percentile, &max));
+	TEST_ASSERT_STR(name, "slow");
+	/* Upper bound of the histogram bucket */
+	TEST_ASSERT(percentile == 512);
+	TEST_ASSERT(max == 300);
+
+	/* Rare spikes are seen in the max time only */
+	fast_spikes(1000, 200, 5000);
+	TEST_ASSERT(sys_modules_stats_slowest(&name, &percentile, &max));
+	TEST_ASSERT_STR(name, "slow");
+	TEST_ASSERT(percentile == 512 && max == 300);
+
+	/* In more than 1% of the runs */
+	fast_spikes(1000, 20, 5000);
+	TEST_ASSERT(sys_modules_stats_slowest(&name, &percentile, &max));
+	TEST_ASSERT_STR(name, "fast");
+	TEST_ASSERT(percentile == 8192 && max == 5000);
+
+	/* The histogram is halved when a bucket is full, the distribution is kept */
+	fast_spikes(70000, 50, 5000);
+	TEST_ASSERT(sys_modules_stats_slowest(&name, &percentile, &max));
+	TEST_ASSERT_STR(name, "fast");
+	TEST_ASSERT(percentile == 8192);
+	fast_spikes(200000, 200000, 5000);
+	TEST_ASSERT(sys_modules_stats_slowest(&name, &percentile, &max));
+	TEST_ASSERT_STR(name, "slow");
+	TEST_ASSERT(percentile == 512 && max == 300);
+}
+
+static void test_intervals(void)
+{
+	uint32_t wfe = host_time_wfe_count();
+	uint32_t passes;
+
+	/* Only the modules with run interval are left */
+	mod_fast.mod.run = NULL;
+	mod_slow.mod.run = NULL;
+	TEST_ASSERT(sys_module_register(&mod_tick.mod) == 0);
+	TEST_ASSERT(sys_module_register(&mod_tock.mod) == 0);
+	passes = main_loop_sleep(10000);
+	/* At the start and then every interval */
+	TEST_ASSERT(mod_tick.calls == 100);
+	TEST_ASSERT(mod_tock.calls == 40);
+	/* Sleep between the deadlines, no busy polling */
+	TEST_ASSERT(passes <= 130);
+	TEST_ASSERT(host_time_wfe_count() - wfe == passes);
+}
+
+static void test_poll(void)
+{
+	uint32_t wfe = host_time_wfe_count();
+	uint32_t fast = mod_fast.calls;
+	uint32_t tick = mod_tick.calls;
+	uint32_t passes;
+
+	/* A module without interval runs on each pass, the loop does not sleep */
+	mod_fast.mod.run = test_mod_run;
+	passes = main_loop_sleep(1000);
+	TEST_ASSERT(mod_fast.calls - fast == passes);
+	TEST_ASSERT(host_time_wfe_count() == wfe);
+	TEST_ASSERT(mod_tick.calls - tick >= 10 && mod_tick.calls - tick <= 11);
+	mod_fast.mod.run = NULL;
+}
+
+static void test_wakeup(void)
+{
+	uint32_t tock;
+	uint64_t now;
+
+	sys_modules_run();
+	tock = mod_tock.calls;
+
+	/* Pending wakeup, do not sleep */
+	sys_module_wakeup(&mod_tock.mod);
+	now = time_us_64();
+	sys_modules_sleep();
+	TEST_ASSERT(time_us_64() == now);
+	sys_modules_run();
+	TEST_ASSERT(mod_tock.calls == tock + 1);
+
+	/* The event of the wakeup is still latched, the wait returns at once */
+	now = time_us_64();
+	sys_modules_sleep();
+	TEST_ASSERT(time_us_64() == now);
+	/* Sleep until the nearest deadline */
+	sys_modules_sleep();
+	TEST_ASSERT(time_us_64() > now && time_us_64() - now <= 100000);
+
+	/* Wakeup from an IRQ, while sleeping */
+	__sev();
+	now = time_us_64();
+	sys_modules_sleep();
+	TEST_ASSERT(time_us_64() == now);
+}
+
+int main(void)
+{
+	host_time_set_us(START_US);
+	test_mod_init(&mod_fast, "fast", 0, 10);
+	test_mod_init(&mod_slow, "slow", 0, 300);
+	test_mod_init(&mod_tick, "tick", 100, 10);
+	test_mod_init(&mod_tock, "tock", 250, 10);
+	sys_module_register(&mod_fast.mod);
+	sys_module_register(&mod_slow.mod);
+	sys_modules_init();
+	/* Pause the system modules, run only the test ones */
+	sys_job_state_set(OTA_JOB);
+
+	TEST_RUN(test_run);
+	TEST_RUN(test_pause);
+	TEST_RUN(test_commands);
+	TEST_RUN(test_stats);
+	TEST_RUN(test_intervals);
+	TEST_RUN(test_poll);
+	TEST_RUN(test_wakeup);
+
+	return TEST_RESULT;
+}
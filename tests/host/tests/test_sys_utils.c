@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Copyright (C) 2026, Tzvetomir Stoyanov <tz.stoyanov@gmail.com>
+ */
+
+#include "pico/stdlib.h"
+#include "herak_sys.h"
+#include "common_internal.h"
+#include "base64.h"
+#include "params.h"
+
+#include "host_fakes.h"
+#include "host_test.h"
+
+#define SAMPLES_MAX	256
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t va = *(const uint32_t *)a, vb = *(const uint32_t *)b;
+
+	return va < vb ? -1 : va > vb;
+}
+
+/* Reference: sort and average the middle */
+static uint32_t samples_filter_ref(uint32_t *samples, int total_count, int filter_count)
+{
+	uint64_t all = 0;
+	int i;
+
+	qsort(samples, total_count, sizeof(uint32_t), cmp_u32);
+	for (i = filter_count; i < total_count - filter_count; i++)
+		all += samples[i];
+	return all / (total_count - (2 * filter_count));
+}
+
+static uint32_t sample_rand(int run)
+{
+	switch (run % 3) {
+	case 0:
+		/* Few distinct values, to have duplicates */
+		return rand() % 4;
+	case 1:
+		return rand() % 0xFFFF;
+	default:
+		/* Full range of the ADC counters and the timers */
+		return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+	}
+}
+
+static void test_samples_filter(void)
+{
+	uint32_t samples[SAMPLES_MAX], ref[SAMPLES_MAX];
+	static const int counts[] = { 1, 2, 3, 10, 30, 31, 256 };
+	unsigned int c;
+	int run, filter, i;
+
+	srand(1);
+	for (c = 0; c < ARRAY_SIZE(counts); c++) {
+		for (run = 0; run < 60; run++) {
+			for (i = 0; i < counts[c]; i++)
+				samples[i] = sample_rand(run);
+			for (filter = 0; filter * 2 < counts[c]; filter++) {
+				memcpy(ref, samples, sizeof(samples));
+				TEST_ASSERT(samples_filter(samples, counts[c], filter) ==
+							samples_filter_ref(ref, counts[c], filter));
+				/* Only reordered */
+				qsort(samples, counts[c], sizeof(uint32_t), cmp_u32);
+				TEST_ASSERT(!memcmp(samples, ref, counts[c] * sizeof(uint32_t)));
+			}
+			/* Nothing left after the filter */
+			TEST_ASSERT(samples_filter(samples, counts[c], filter) == 0);
+			TEST_ASSERT(samples_filter(samples, counts[c], counts[c]) == 0);
+			TEST_ASSERT(samples_filter(samples, counts[c], -1) == 0);
+		}
+	}
+
+	/* The sum does not overflow */
+	for (i = 0; i < SAMPLES_MAX; i++)
+		samples[i] = i % 2 ? 0xFFFFFFFF : 0xFFFFFFFD;
+	TEST_ASSERT(samples_filter(samples, SAMPLES_MAX, 0) == 0xFFFFFFFE);
+	for (i = 0; i < SAMPLES_MAX; i++)
+		samples[i] = i == 7 ? 0 : 0xFFFFFFFF;
+	TEST_ASSERT(samples_filter(samples, SAMPLES_MAX, 1) == 0xFFFFFFFF);
+	TEST_ASSERT(samples_filter(samples, 0, 0) == 0);
+}
+
+static void test_base64(void)
+{
+	static const char *strs[] = { "a", "ab", "abc", "abcd", "user;pass", "localhost:1883" };
+	char *enc, *dec;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(strs); i++) {
+		enc = base64_encode(strs[i], strlen(strs[i]));
+		TEST_ASSERT(enc != NULL);
+		if (!enc)
+			continue;
+		dec = base64_decode(enc, strlen(enc));
+		TEST_ASSERT_STR(dec, strs[i]);
+		free(dec);
+		free(enc);
+	}
+	enc = base64_encode("host", 4);
+	TEST_ASSERT_STR(enc, "aG9zdA==");
+	free(enc);
+}
+
+static void test_params(void)
+{
+	char *val;
+
+	val = USER_PRAM_GET(MQTT_USER);
+	TEST_ASSERT_STR(val, "user;pass");
+	free(val);
+	val = USER_PRAM_GET(DEV_HOSTNAME);
+	TEST_ASSERT_STR(val, "host-test");
+	free(val);
+	/* Params, not set in the config */
+	TEST_ASSERT(NTP_SERVERS_len <= 1);
+}
+
+static void test_misc(void)
+{
+	float f = 0;
+	char *str;
+
+	TEST_ASSERT(sys_value_to_percent(10, 20, 5) == 0);
+	TEST_ASSERT(sys_value_to_percent(10, 20, 15) == 50);
+	TEST_ASSERT(sys_value_to_percent(10, 20, 25) == 100);
+	TEST_ASSERT(sys_strtof("12.5", &f) == 0 && f == 12.5f);
+	TEST_ASSERT(sys_strtof("abc", &f) < 0);
+	TEST_ASSERT(sys_strtof("nan", &f) < 0);
+	TEST_ASSERT(sys_asprintf(&str, "%s-%d", "a", 12) == 4);
+	TEST_ASSERT_STR(str, "a-12");
+	free(str);
+}
+
+static void test_irq_cb(void *context)
+{
+	(*(int *)context)++;
+}
+
+static void test_gpio_irq(void)
+{
+	static int rise, fall;
+
+	TEST_ASSERT(sys_add_irq_callback(5, test_irq_cb, GPIO_IRQ_EDGE_RISE, &rise) == 0);
+	TEST_ASSERT(sys_add_irq_callback(6, test_irq_cb, GPIO_IRQ_EDGE_FALL, &fall) == 0);
+	TEST_ASSERT(sys_add_irq_callback(5, test_irq_cb, GPIO_IRQ_EDGE_FALL, &fall) < 0);
+	TEST_ASSERT(sys_add_irq_callback(GPIO_PIN_MAX + 1, test_irq_cb, GPIO_IRQ_EDGE_FALL, &fall) < 0);
+	sys_irq_init();
+
+	host_gpio_set(5, true);
+	host_gpio_set(5, true);
+	host_gpio_set(5, false);
+	host_gpio_set(6, true);
+	host_gpio_set(6, false);
+	host_gpio_set(7, true);
+	TEST_ASSERT(rise == 1 && fall == 1);
+	TEST_ASSERT(gpio_get(7));
+
+	gpio_init(8);
+	gpio_set_dir(8, GPIO_OUT);
+	gpio_put(8, true);
+	TEST_ASSERT(host_gpio_out(8) && host_gpio_put_count(8) == 1);
+}
+
+int main(void)
+{
+	TEST_RUN(test_samples_filter);
+	TEST_RUN(test_base64);
+	TEST_RUN(test_params);
+	TEST_RUN(test_misc);
+	TEST_RUN(test_gpio_irq);
+
+	return TEST_RESULT;
+}